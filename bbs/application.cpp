@@ -66,7 +66,7 @@
 #include "core/version.h"
 #include "local_io/local_io.h"
 #include "local_io/local_io_curses.h"
-#include "local_io/null_local_io.h" // Used for Linux build.
+#include "local_io/null_local_io.h"
 #include "local_io/wconstants.h"
 #include "sdk/status.h"
 
@@ -721,6 +721,8 @@ int Application::Run(int argc, char* argv[]) {
   cmdline.add_argument(
       BooleanCommandLineArgument{"beginday", 'e', "Load for beginday event only", false});
   cmdline.add_argument({"handle", 'h', "Socket handle", "0"});
+  cmdline.add_argument(BooleanCommandLineArgument{
+      "headless", "Never use the local screen for a user logged in with -x.", false});
   cmdline.add_argument(BooleanCommandLineArgument{"no_modem", 'm',
                                                   "Don't access the modem at all", false});
   cmdline.add_argument({"instance", 'n', "Designate instance number <inst>", "1"});
@@ -803,7 +805,10 @@ int Application::Run(int argc, char* argv[]) {
   }
 
   // Setup the full-featured localIO if we have a TTY (or console)
-  if (isatty(fileno(stdin))) {
+  if (cmdline.barg("headless") && type != CommunicationType::NONE) {
+    // Nobody is watching this node locally, so skip the local screen.
+    reset_local_io(new NullLocalIO());
+  } else if (isatty(fileno(stdin))) {
 #if defined(_WIN32) && !defined(WWIV_WIN32_CURSES_IO)
     reset_local_io(new Win32ConsoleIO());
 #else
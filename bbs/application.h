@@ -35,6 +35,7 @@
 #include "core/file.h"
 #include "local_io/local_io.h"
 #include "sdk/config.h"
+#include "sdk/files/file_catalog.h"
 #include "sdk/msgapi/message_api_wwiv.h"
 #include "sdk/msgapi/msgapi.h"
 #include "sdk/names.h"
@@ -229,6 +230,7 @@ public:
 
   wwiv::sdk::StatusMgr* status_manager() { return statusMgr.get(); }
   wwiv::sdk::UserManager* users() { return user_manager_.get(); }
+  wwiv::sdk::files::FileCatalog* file_catalog() { return file_catalog_.get(); }
 
   const std::string& temp_directory() const { return temp_directory_; }
   const std::string& batch_directory() const { return batch_directory_; }
@@ -436,6 +438,7 @@ private:
   void read_chains();
   bool read_language();
   void read_gfile();
+  bool read_config_snapshot();
   void check_phonenum();
   void create_phone_file();
 
@@ -458,6 +461,7 @@ private:
 
   std::unique_ptr<wwiv::sdk::StatusMgr> statusMgr;
   std::unique_ptr<wwiv::sdk::UserManager> user_manager_;
+  std::unique_ptr<wwiv::sdk::files::FileCatalog> file_catalog_;
   std::string attach_dir_;
   wwiv::sdk::User thisuser_;
   int effective_sl_{0};
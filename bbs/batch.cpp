@@ -261,10 +261,8 @@ static void uploaded(const string& file_name, long lCharsPerSecond) {
               add_to_file_database(u.filename);
               a()->user()->SetUploadK(a()->user()->GetUploadK() +
                   static_cast<int>(bytes_to_k(u.numbytes)));
-              a()->status_manager()->Run([](WStatus& s) {
-                s.IncrementNumUploadsToday();
-                s.IncrementFileChangedFlag(WStatus::fileChangeUpload);
-              });
+              a()->status_manager()->Increment(StatusCounter::uploads_today);
+              a()->status_manager()->IncrementFileChangedFlag(WStatus::fileChangeUpload);
               File fileDn(a()->download_filename_);
               fileDn.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite);
               FileAreaSetRecord(fileDn, nRecNum);
@@ -227,6 +227,9 @@ void Output::dump() {
 }
 
 int Output::wherex() { 
+  if (headless_) {
+    return x_;
+  }
   int x = localIO()->WhereX();
   if (x != x_) {
     VLOG(1) << "x: " << x << " != x_: " << x_;
@@ -70,16 +70,23 @@ int Output::bputch(char c, bool use_buffer) {
     }
   } else {
     displayed = 1;
-    // Pass through to SDK ansi interpreter.
-    auto last_state = ansi_->state();
-    ansi_->write(c);
-
-    if (ansi_->state() == wwiv::sdk::ansi::AnsiMode::not_in_sequence &&
-        last_state == wwiv::sdk::ansi::AnsiMode::not_in_sequence) {
-      // Only add to the current line if we're not in an ansi sequence.
-      // Otherwise we get gibberish ansi strings that will be displayed
-      // raw to the user.
+    if (headless_ && c != ESC &&
+        ansi_->state() == wwiv::sdk::ansi::AnsiMode::not_in_sequence) {
+      // Outside of an ansi sequence the interpreter would only draw c on
+      // the local screen, which nobody is looking at.
       current_line_.push_back({c, static_cast<uint8_t>(curatr())});
+    } else {
+      // Pass through to SDK ansi interpreter.
+      auto last_state = ansi_->state();
+      ansi_->write(c);
+
+      if (ansi_->state() == wwiv::sdk::ansi::AnsiMode::not_in_sequence &&
+          last_state == wwiv::sdk::ansi::AnsiMode::not_in_sequence) {
+        // Only add to the current line if we're not in an ansi sequence.
+        // Otherwise we get gibberish ansi strings that will be displayed
+        // raw to the user.
+        current_line_.push_back({c, static_cast<uint8_t>(curatr())});
+      }
     }
 
     const auto screen_width = a()->user()->GetScreenChars();
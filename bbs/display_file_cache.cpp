@@ -0,0 +1,163 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "bbs/display_file_cache.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+#include "core/stl.h"
+#include "core/strings.h"
+#include "core/textfile.h"
+#include "local_io/keycodes.h"
+
+using std::string;
+using namespace wwiv::core;
+using namespace wwiv::stl;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace bbs {
+
+// Start over rather than growing without bound if a BBS displays lots of
+// distinct files (like per-directory or per-sub descriptions).
+static constexpr size_t kMaxEntries = 512;
+
+// static
+std::shared_ptr<const DisplayFile> DisplayFile::Load(const std::string& path) {
+  TextFile tf(path, "rb");
+  if (!tf.IsOpen()) {
+    return {};
+  }
+  auto f = std::make_shared<DisplayFile>();
+  for (const auto& s : tf.ReadFileIntoVector()) {
+    display_line_t line;
+    line.tokens = TokenizePipeCodes(StrCat(s, "\r\n"));
+    line.has_ansi = contains(s, ESC);
+    f->lines_.emplace_back(std::move(line));
+    if (contains(s, CZ)) {
+      // We are done here on a control-Z since that's DOS EOF.  Also ANSI
+      // files created with PabloDraw expect that anything after a Control-Z
+      // is fair game for metadata and includes SAUCE metadata after it which
+      // we do not want to render in the bbs.
+      break;
+    }
+  }
+  return f;
+}
+
+// static
+std::map<std::string, time_t> DisplayFileCache::dir_stamps(const std::vector<std::string>& candidates) {
+  // Creating, removing or renaming a file changes the mtime of its directory.
+  std::map<std::string, time_t> dirs;
+  for (const auto& c : candidates) {
+    File dir(File(c).parent());
+    if (!contains(dirs, dir.full_pathname())) {
+      dirs.emplace(dir.full_pathname(), dir.last_write_time());
+    }
+  }
+  return dirs;
+}
+
+std::string DisplayFileCache::Resolve(const std::vector<std::string>& candidates) {
+  const auto key = JoinStrings(candidates, "\n");
+  auto dirs = dir_stamps(candidates);
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = resolved_.find(key);
+    if (it != resolved_.end() && !it->second.racy && it->second.dirs == dirs) {
+      return it->second.path;
+    }
+  }
+
+  const auto now = time(nullptr);
+  string path;
+  for (const auto& c : candidates) {
+    if (File::Exists(c)) {
+      path = c;
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  ++probes_;
+  if (resolved_.size() >= kMaxEntries) {
+    resolved_.clear();
+  }
+  auto& e = resolved_[key];
+  e.path = path;
+  e.racy = false;
+  for (const auto& d : dirs) {
+    // A change made later in the same second would not change the mtime, so
+    // check again next time.
+    if (d.second >= now) {
+      e.racy = true;
+    }
+  }
+  e.dirs = std::move(dirs);
+  return path;
+}
+
+std::shared_ptr<const DisplayFile> DisplayFileCache::Get(const std::string& path) {
+  File f(path);
+  if (!f.Exists() || f.IsDirectory()) {
+    std::lock_guard<std::mutex> lock(mu_);
+    files_.erase(path);
+    return {};
+  }
+  const auto size = f.length();
+  const auto mtime = f.last_write_time();
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = files_.find(path);
+    if (it != files_.end() && !it->second.racy && it->second.size == size &&
+        it->second.mtime == mtime) {
+      return it->second.file;
+    }
+  }
+
+  const auto now = time(nullptr);
+  auto file = DisplayFile::Load(path);
+  std::lock_guard<std::mutex> lock(mu_);
+  ++loads_;
+  if (!file) {
+    files_.erase(path);
+    return {};
+  }
+  if (files_.size() >= kMaxEntries) {
+    files_.clear();
+  }
+  auto& e = files_[path];
+  e.file = file;
+  e.size = size;
+  e.mtime = mtime;
+  e.racy = mtime >= now;
+  return file;
+}
+
+void DisplayFileCache::InvalidateAll() {
+  std::lock_guard<std::mutex> lock(mu_);
+  files_.clear();
+  resolved_.clear();
+}
+
+}  // namespace bbs
+}  // namespace wwiv
@@ -0,0 +1,104 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_BBS_DISPLAY_FILE_CACHE_H__
+#define __INCLUDED_BBS_DISPLAY_FILE_CACHE_H__
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bbs/pipe_codes.h"
+
+namespace wwiv {
+namespace bbs {
+
+/** One line of a display file, ending with "\r\n". */
+struct display_line_t {
+  std::vector<pipe_token_t> tokens;
+  /** True if the line contains an ANSI escape sequence. */
+  bool has_ansi{false};
+};
+
+/**
+ * A display file (.ans, .b&w, .msg, etc) read into memory and already split
+ * into lines of tokens. Lines after the first one containing a control-Z are
+ * not kept since they are never displayed.
+ */
+class DisplayFile {
+public:
+  /** Loads the file at path. Returns nullptr if it can not be read. */
+  static std::shared_ptr<const DisplayFile> Load(const std::string& path);
+
+  const std::vector<display_line_t>& lines() const noexcept { return lines_; }
+  bool empty() const noexcept { return lines_.empty(); }
+
+private:
+  std::vector<display_line_t> lines_;
+};
+
+/**
+ * Process wide cache of DisplayFiles keyed by their full path, and of which
+ * of a list of candidate filenames exists. Files are loaded again once their
+ * size or mtime changes, and candidates are probed again once the directories
+ * containing them change.
+ */
+class DisplayFileCache {
+public:
+  DisplayFileCache() = default;
+
+  /** Returns the first of candidates that exists, or an empty string. */
+  std::string Resolve(const std::vector<std::string>& candidates);
+  /** Returns the file at path, or nullptr if it does not exist. */
+  std::shared_ptr<const DisplayFile> Get(const std::string& path);
+  void InvalidateAll();
+
+  /** Number of times a file was loaded from disk. */
+  int loads() const noexcept { return loads_; }
+  /** Number of times the candidates were checked for on disk. */
+  int probes() const noexcept { return probes_; }
+
+private:
+  struct file_entry_t {
+    std::shared_ptr<const DisplayFile> file;
+    off_t size{0};
+    time_t mtime{0};
+    bool racy{false};
+  };
+  struct resolved_entry_t {
+    std::string path;
+    std::map<std::string, time_t> dirs;
+    bool racy{false};
+  };
+  static std::map<std::string, time_t> dir_stamps(const std::vector<std::string>& candidates);
+
+  std::mutex mu_;
+  std::unordered_map<std::string, file_entry_t> files_;
+  std::unordered_map<std::string, resolved_entry_t> resolved_;
+  int loads_{0};
+  int probes_{0};
+};
+
+}  // namespace bbs
+}  // namespace wwiv
+
+#endif  // __INCLUDED_BBS_DISPLAY_FILE_CACHE_H__
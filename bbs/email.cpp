@@ -329,13 +329,12 @@ void sendout_email(EmailData& data) {
     sysoplog() << logMessage << logMessagePart;
   }
 
-  auto status = a()->status_manager()->BeginTransaction();
   if (data.user_number == 1 && data.system_number == 0) {
-    status->IncrementNumFeedbackSentToday();
+    a()->status_manager()->Increment(StatusCounter::feedback_today);
     a()->user()->SetNumFeedbackSent(a()->user()->GetNumFeedbackSent() + 1);
     a()->user()->SetNumFeedbackSentToday(a()->user()->GetNumFeedbackSentToday() + 1);
   } else {
-    status->IncrementNumEmailSentToday();
+    a()->status_manager()->Increment(StatusCounter::email_today);
     a()->user()->SetNumEmailSentToday(a()->user()->GetNumEmailSentToday() + 1);
     if (data.system_number == 0) {
       a()->user()->SetNumEmailSent(a()->user()->GetNumEmailSent() + 1);
@@ -343,7 +342,6 @@ void sendout_email(EmailData& data) {
       a()->user()->SetNumNetEmailSent(a()->user()->GetNumNetEmailSent() + 1);
     }
   }
-  a()->status_manager()->CommitTransaction(std::move(status));
   if (!data.silent_mode) {
     bout.Color(3);
     bout << logMessage;
@@ -496,10 +496,8 @@ static void UpdateUserStatsForLogin() {
     a()->set_current_user_dir_num(0);
   }
   if (a()->effective_sl() != 255 && !a()->context().guest_user()) {
-    a()->status_manager()->Run([](WStatus& s) {
-      s.IncrementCallerNumber();
-      s.IncrementNumCallsToday();
-    });
+    a()->status_manager()->Increment(StatusCounter::caller_number);
+    a()->status_manager()->Increment(StatusCounter::calls_today);
   }
 }
 
@@ -987,11 +985,10 @@ void logoff() {
   a()->user()->add_timeon(seconds_used_duration);
   a()->user()->add_timeon_today(seconds_used_duration);
 
-  a()->status_manager()->Run([=](WStatus& s) {
-    int active_today = s.GetMinutesActiveToday();
-    auto minutes_used_now = std::chrono::duration_cast<std::chrono::minutes>(seconds_used_duration).count();
-    s.SetMinutesActiveToday(active_today + minutes_used_now);
-  });
+  const auto minutes_used_now =
+      std::chrono::duration_cast<std::chrono::minutes>(seconds_used_duration).count();
+  a()->status_manager()->Increment(StatusCounter::minutes_active_today,
+                                   static_cast<int>(minutes_used_now));
 
   if (a()->context().scanned_files()) {
     a()->user()->SetNewScanDateNumber(a()->user()->GetLastOnDateNumber());
@@ -1034,9 +1031,7 @@ void logoff() {
         }
       }
       pFileEmail->set_length(static_cast<long>(sizeof(mailrec)) * static_cast<long>(w));
-      a()->status_manager()->Run([](WStatus& s) {
-        s.IncrementFileChangedFlag(WStatus::fileChangeEmail);
-      });
+      a()->status_manager()->IncrementFileChangedFlag(WStatus::fileChangeEmail);
       pFileEmail->Close();
     }
   }
@@ -43,10 +43,12 @@
 using std::string;
 using std::vector;
 using namespace wwiv::core;
+using namespace wwiv::sdk;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
 
 // Local function prototypes
+static bool prefilter_criteria(const search_record& sr, const uploadsrec& ur);
 int  compare_criteria(search_record * sr, uploadsrec * ur);
 bool lp_compare_strings(const char *raw, const char *formula);
 bool lp_compare_strings_wh(const char *raw, const char *formula, unsigned *pos, int size);
@@ -138,6 +140,21 @@ int listfiles_plus_function(int type) {
   }
   int max_lines = calc_max_lines();
 
+  // Use the file catalog to skip directories without any possible matches
+  // when searching more than the current directory.
+  vector<char> has_matches;
+  if (search_rec.alldirs == ALL_DIRS) {
+    vector<string> areas;
+    for (uint16_t i = 0; i < a()->directories.size() && a()->udir[i].subnum != -1; i++) {
+      areas.emplace_back(a()->directories[a()->udir[i].subnum].filename);
+    }
+    has_matches.resize(areas.size());
+    for (auto i : a()->file_catalog()->AreasWithMatches(
+             areas, [&search_rec](const uploadsrec& u) { return prefilter_criteria(search_rec, u); })) {
+      has_matches[i] = 1;
+    }
+  }
+
   bool all_done = false;
   for (uint16_t this_dir = 0; (this_dir < a()->directories.size()) && (!a()->hangup_) && (a()->udir[this_dir].subnum != -1)
        && !all_done; this_dir++) {
@@ -159,6 +176,10 @@ int listfiles_plus_function(int type) {
       }
     }
 
+    if (scan_dir && this_dir < has_matches.size() && !has_matches[this_dir]) {
+      scan_dir = false;
+    }
+
     int save_first_file = 0;
     if (scan_dir) {
       a()->set_current_user_dir_num(this_dir);
@@ -170,21 +191,32 @@ int listfiles_plus_function(int type) {
       int lines = 0;
       int changedir = 0;
 
-      File fileDownload(a()->download_filename_);
+      std::shared_ptr<const files::catalog_area_t> files;
       while (!done && !a()->hangup_ && !all_done) {
         checka(&all_done);
         if (!amount) {
-          if (!fileDownload.Open(File::modeBinary | File::modeReadOnly)) {
-            done = true;
-            continue;
+          // Picks up any changes made by the sysop commands below.
+          files = a()->file_catalog()->area(a()->current_dir().filename);
+          // Load the extended descriptions for the next page in one go.
+          vector<string> names;
+          for (auto i = static_cast<size_t>(first_file - 1);
+               i < files->size() && size_int(names) < max_lines; i++) {
+            if (files->at(i).mask & mask_extended) {
+              names.emplace_back(files->at(i).filename);
+            }
           }
+          preload_extended_descriptions(names);
           print_searching(&search_rec);
         }
         if (a()->numf) {
           changedir = 0;
           bool force_menu = false;
-          FileAreaSetRecord(fileDownload, first_file + amount);
-          fileDownload.Read(file_recs[matches], sizeof(uploadsrec));
+          const auto index = static_cast<size_t>(first_file + amount - 1);
+          if (index < files->size()) {
+            *file_recs[matches] = files->at(index);
+          } else {
+            memset(file_recs[matches], 0, sizeof(uploadsrec));
+          }
           if (compare_criteria(&search_rec, file_recs[matches])) {
             int lines_left = max_lines - lines;
             int needed = check_lines_needed(file_recs[matches]);
@@ -211,7 +243,6 @@ int listfiles_plus_function(int type) {
           }
 
           if (lines >= max_lines || a()->numf < first_file + amount || force_menu) {
-            fileDownload.Close();
             if (matches) {
               file_pos = save_file_pos;
               drawfile(vert_pos[file_pos], file_handle[file_pos]);
@@ -538,7 +569,6 @@ TOGGLE_EXTENDED:
             }
           }
         } else {
-          fileDownload.Close();
           if (!changedir) {
             done = true;
           } else if (changedir == 1) {
@@ -569,6 +599,15 @@ TOGGLE_EXTENDED:
   return (all_done) ? 1 : 0;
 }
 
+// The parts of compare_criteria that only look at the file record, so they
+// are safe to run on the file catalog's search threads.
+static bool prefilter_criteria(const search_record& sr, const uploadsrec& ur) {
+  if (sr.filemask != "        .   " && !compare(sr.filemask.c_str(), ur.filename)) {
+    return false;
+  }
+  return !sr.nscandate || ur.daten >= sr.nscandate;
+}
+
 int compare_criteria(search_record * sr, uploadsrec * ur) {
   // "        .   "
   if (sr->filemask != "        .   ") {
@@ -259,81 +259,47 @@ std::string MenuInstance::create_menu_filename(const string& extension) const {
   return MenuInstance::create_menu_filename(menu_directory_, menu_name_, extension);
 }
 
-bool MenuInstance::CreateMenuMap(File& menu_file) {
-  insertion_order_.clear();
-  auto nAmount = menu_file.length() / sizeof(MenuRec);
-
-  for (size_t nRec = 1; nRec < nAmount; nRec++) {
-    MenuRec menu{};
-    menu_file.Seek(nRec * sizeof(MenuRec), File::Whence::begin);
-    menu_file.Read(&menu, sizeof(MenuRec));
-
-    string key = menu.szKey;
-    menu_command_map_.insert(std::make_pair(key, menu));
-    if (nRec != 0 && !(menu.nFlags & MENU_FLAG_DELETED)) {
-      insertion_order_.push_back(menu.szKey);
-    }
-  }
-  return true;
+MenuCache& menu_cache() {
+  static MenuCache cache;
+  return cache;
+}
+
+const std::vector<menu_command_t>& MenuInstance::exit_script() const {
+  static const std::vector<menu_command_t> empty;
+  return menu_ ? menu_->exit_script() : empty;
 }
 
 bool MenuInstance::OpenImpl() {
-  // Open up the main data file
-  File menu_file(create_menu_filename("mnu"));
-  if (!menu_file.Open(File::modeBinary | File::modeReadOnly, File::shareDenyNone)) {
+  const auto base = FilePath(FilePath(GetMenuDirectory(), menu_directory_), menu_name_);
+  menu_ = menu_cache().Get(base);
+  if (!menu_) {
     // Unable to open menu
     MenuSysopLog("Unable to open Menu");
     return false;
   }
-
-  // Read the header (control) record into memory
-  menu_file.Seek(0L, File::Whence::begin);
-  menu_file.Read(&header, sizeof(MenuHeader));
-
-  // Version numbers can be checked here.
-  if (!CreateMenuMap(menu_file)) {
-    MenuSysopLog("Unable to create menu index.");
-    return false;
-  }
+  header = menu_->header();
 
   if (!CheckMenuSecurity(&header, true)) {
     MenuSysopLog("< Menu Sec");
     return false;
   }
 
-  // Open/Rease/Close Prompt file.  We use binary mode since we want the
-  // \r to remain on windows (and linux).
-  TextFile prompt_file(create_menu_filename("pro"), "rb");
-  if (prompt_file.IsOpen()) {
-    string tmp = prompt_file.ReadFileIntoString();
-    string::size_type end = tmp.find(".end.");
-    if (end != string::npos) {
-      prompt = tmp.substr(0, end);
-    } else {
-      prompt = tmp;
-    }
-  } else {
-    prompt = "|09Command? ";
-  }
+  prompt = menu_->prompt();
 
   // Execute command to use on entering the menu (if any).
-  if (header.szScript[0]) {
-    InterpretCommand(this, header.szScript);
-  }
+  InterpretCommand(this, menu_->enter_script());
   return true;
 }
 
 string MenuInstance::GetHelpFileName() const {
   if (a()->user()->HasAnsi()) {
     if (a()->user()->HasColor()) {
-      const string filename = create_menu_filename("ans");
-      if (File::Exists(filename)) {
-        return filename;
+      if (menu_ && menu_->has_help_file("ans")) {
+        return create_menu_filename("ans");
       }
     }
-    const string filename = create_menu_filename("b&w");
-    if (File::Exists(filename)) {
-      return filename;
+    if (menu_ && menu_->has_help_file("b&w")) {
+      return create_menu_filename("b&w");
     }
   }
   return create_menu_filename("msg");
@@ -399,30 +365,47 @@ std::vector<MenuRec> MenuInstance::LoadMenuRecord(const std::string& command) {
     }
   }
 
-  if (menu_command_map_.count(command) > 0) {
-    auto range = menu_command_map_.equal_range(command);
-    for (auto i = range.first; i != range.second; ++i) {
-      auto& m = i->second;
-      if (CheckMenuItemSecurity(&m, true)) {
-        result.push_back(m);
-      } else {
-        MenuSysopLog(StrCat("|06< item security : ", command));
-      }
+  for (const auto* item : FindMenuItems(command)) {
+    result.push_back(item->rec);
+  }
+  return result;
+}
+
+std::vector<const compiled_menu_item_t*> MenuInstance::FindMenuItems(const std::string& command) const {
+  std::vector<const compiled_menu_item_t*> result;
+  if (!menu_) {
+    return result;
+  }
+  for (const auto* item : menu_->items(command)) {
+    if (CheckMenuItemSecurity(&item->rec, true)) {
+      result.push_back(item);
+    } else {
+      MenuSysopLog(StrCat("|06< item security : ", command));
     }
   }
   return result;
 }
 
 void MenuInstance::MenuExecuteCommand(const string& command) {
-  const auto menus = LoadMenuRecord(command);
-  if (menus.empty()) {
+  if (IsNumber(command) &&
+      (header.nums == MENU_NUMFLAG_SUBNUMBER || header.nums == MENU_NUMFLAG_DIRNUMBER)) {
+    for (const auto& menu : LoadMenuRecord(command)) {
+      LogUserFunction(this, command, &menu);
+      InterpretCommand(this, menu.szExecute);
+    }
+    return;
+  }
+
+  const auto items = FindMenuItems(command);
+  if (items.empty()) {
     LogUserFunction(this, command, nullptr);
     return;
   }
 
-  for (const auto& menu : menus) {
-    LogUserFunction(this, command, &menu);
-    InterpretCommand(this, menu.szExecute);
+  for (const auto* item : items) {
+    LogUserFunction(this, command, &item->rec);
+    // Use the script parsed when the menu was loaded.
+    InterpretCommand(this, item->script);
   }
 }
 
@@ -577,11 +560,9 @@ void MenuInstance::GenerateMenu() const {
     bout.bprintf("|#1%-8.8s  |#2%-25.25s  ", "[#]", "Change Sub/Dir #");
     ++lines_displayed;
   }
-  for (const auto& key : insertion_order_) {
-    if (menu_command_map_.count(key) == 0) {
-      continue;
-    }
-    const MenuRec& menu = menu_command_map_.find(key)->second;
+  const auto items = menu_ ? menu_->display_items() : std::vector<const compiled_menu_item_t*>{};
+  for (const auto* item : items) {
+    const MenuRec& menu = item->rec;
     if (CheckMenuItemSecurity(&menu, false) && menu.nHide != MENU_HIDE_REGULAR &&
         menu.nHide != MENU_HIDE_BOTH) {
       string keystr;
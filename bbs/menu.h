@@ -29,6 +29,8 @@
 #include "core/file.h"
 #include "core/stl.h"
 #include "core/textfile.h"
+#include "bbs/menu_cache.h"
+#include "bbs/menu_parser.h"
 #include "sdk/menu.h"
 
 namespace wwiv {
@@ -46,13 +48,14 @@ public:
   void GenerateMenu() const;
 
   const std::string menu_directory() { return menu_directory_; }
+  /** The parsed exit script, executed when returning from this menu. */
+  const std::vector<menu_command_t>& exit_script() const;
 
   bool finished = false;
   bool reload = false;  /* true if we are going to reload the menus */
 
   std::string prompt;
-  std::vector<std::string> insertion_order_;
-  MenuHeader header;   /* Holds the header info for current menu set in memory */
+  MenuHeader header{};   /* Holds the header info for current menu set in memory */
 private:
   const std::string menu_directory_;
   const std::string menu_name_;
@@ -62,12 +65,12 @@ private:
   std::string GetHelpFileName() const;
   std::string create_menu_filename(const std::string& extension) const;
 
+  std::vector<const compiled_menu_item_t*> FindMenuItems(const std::string& command) const;
   void MenuExecuteCommand(const std::string& command);
-  bool CreateMenuMap(wwiv::core::File& menu_file);
   void PrintMenuPrompt() const;
   std::string GetCommand() const;
 
-  std::multimap<std::string, MenuRec> menu_command_map_;
+  std::shared_ptr<const CompiledMenu> menu_;
 };
 
 class MenuDescriptions {
@@ -100,6 +103,12 @@ void TurnMCIOn();
  */
 void InterpretCommand(MenuInstance* menudata, const std::string& script);
 
+/** Executes the already parsed menu commands. */
+void InterpretCommand(MenuInstance* menudata, const std::vector<menu_command_t>& commands);
+
+/** Returns the process wide cache of compiled menus. */
+MenuCache& menu_cache();
+
 }  // namespace menus
 }  // namespace wwiv
 
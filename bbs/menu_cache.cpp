@@ -0,0 +1,170 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "bbs/menu_cache.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "core/textfile.h"
+
+using std::string;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace menus {
+
+static const char* kHelpFileExtensions[] = {"ans", "b&w"};
+
+// static
+std::shared_ptr<const CompiledMenu> CompiledMenu::Compile(const std::string& base_path) {
+  File menu_file(StrCat(base_path, ".mnu"));
+  if (!menu_file.Open(File::modeBinary | File::modeReadOnly, File::shareDenyNone)) {
+    return {};
+  }
+
+  const auto num_records = static_cast<size_t>(menu_file.length()) / sizeof(MenuRec);
+  if (num_records == 0) {
+    return {};
+  }
+  // The header is the same size as a menu record, so read everything at once.
+  std::vector<MenuRec> records(num_records);
+  const auto num_bytes = num_records * sizeof(MenuRec);
+  if (menu_file.Read(&records[0], num_bytes) != static_cast<ssize_t>(num_bytes)) {
+    return {};
+  }
+  menu_file.Close();
+
+  auto m = std::make_shared<CompiledMenu>();
+  memcpy(&m->header_, &records[0], sizeof(MenuHeader));
+  m->enter_script_ = ParseMenuScript(m->header_.szScript);
+  m->exit_script_ = ParseMenuScript(m->header_.szExitScript);
+
+  m->items_.reserve(num_records - 1);
+  for (size_t i = 1; i < num_records; i++) {
+    const auto& rec = records[i];
+    const auto idx = m->items_.size();
+    m->items_.push_back({rec, ParseMenuScript(rec.szExecute)});
+    auto& indexes = m->keys_[rec.szKey];
+    indexes.push_back(idx);
+    if (!(rec.nFlags & MENU_FLAG_DELETED)) {
+      // Menus have always listed the first item for a key, so keep that.
+      m->display_order_.push_back(indexes.front());
+    }
+  }
+
+  // Use binary mode since we want the \r to remain on windows (and linux).
+  TextFile prompt_file(StrCat(base_path, ".pro"), "rb");
+  if (prompt_file.IsOpen()) {
+    const auto tmp = prompt_file.ReadFileIntoString();
+    const auto end = tmp.find(".end.");
+    m->prompt_ = (end != string::npos) ? tmp.substr(0, end) : tmp;
+  } else {
+    m->prompt_ = "|09Command? ";
+  }
+
+  for (const auto& ext : kHelpFileExtensions) {
+    m->help_files_[ext] = File::Exists(StrCat(base_path, ".", ext));
+  }
+  return m;
+}
+
+std::vector<const compiled_menu_item_t*> CompiledMenu::items(const std::string& key) const {
+  std::vector<const compiled_menu_item_t*> result;
+  auto it = keys_.find(key);
+  if (it == keys_.end()) {
+    return result;
+  }
+  for (const auto idx : it->second) {
+    result.push_back(&items_[idx]);
+  }
+  return result;
+}
+
+std::vector<const compiled_menu_item_t*> CompiledMenu::display_items() const {
+  std::vector<const compiled_menu_item_t*> result;
+  for (const auto idx : display_order_) {
+    result.push_back(&items_[idx]);
+  }
+  return result;
+}
+
+bool CompiledMenu::has_help_file(const std::string& ext) const {
+  auto it = help_files_.find(ext);
+  return it != help_files_.end() && it->second;
+}
+
+// static
+MenuCache::stamp_t MenuCache::stamp_for(const std::string& base_path) {
+  stamp_t s{};
+  File mnu(StrCat(base_path, ".mnu"));
+  s.mnu_size = mnu.length();
+  s.mnu_mtime = mnu.last_write_time();
+  File pro(StrCat(base_path, ".pro"));
+  s.pro_size = pro.length();
+  s.pro_mtime = pro.last_write_time();
+  // Adding or removing a help file changes the directory's mtime.
+  File dir(mnu.parent());
+  s.dir_mtime = dir.last_write_time();
+  return s;
+}
+
+std::shared_ptr<const CompiledMenu> MenuCache::Get(const std::string& base_path) {
+  const auto stamp = stamp_for(base_path);
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = menus_.find(base_path);
+    if (it != menus_.end() && !it->second.racy && it->second.stamp == stamp) {
+      return it->second.menu;
+    }
+  }
+
+  const auto now = time(nullptr);
+  auto menu = CompiledMenu::Compile(base_path);
+  std::lock_guard<std::mutex> lock(mu_);
+  ++loads_;
+  if (!menu) {
+    menus_.erase(base_path);
+    return {};
+  }
+  auto& e = menus_[base_path];
+  e.menu = menu;
+  e.stamp = stamp;
+  // A change made later in the same second would not change the mtime, so
+  // check again next time.
+  e.racy = stamp.mnu_mtime >= now || stamp.pro_mtime >= now || stamp.dir_mtime >= now;
+  return menu;
+}
+
+void MenuCache::Invalidate(const std::string& base_path) {
+  std::lock_guard<std::mutex> lock(mu_);
+  menus_.erase(base_path);
+}
+
+void MenuCache::InvalidateAll() {
+  std::lock_guard<std::mutex> lock(mu_);
+  menus_.clear();
+}
+
+}  // namespace menus
+}  // namespace wwiv
@@ -0,0 +1,118 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_BBS_MENU_CACHE_H__
+#define __INCLUDED_BBS_MENU_CACHE_H__
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bbs/menu_parser.h"
+#include "sdk/menu.h"
+
+namespace wwiv {
+namespace menus {
+
+/** A menu item along with its already parsed script. */
+struct compiled_menu_item_t {
+  MenuRec rec;
+  std::vector<menu_command_t> script;
+};
+
+/**
+ * A menu (.mnu and .pro) loaded into memory with all of its scripts parsed,
+ * so entering a menu or executing a command does not touch the disk.
+ */
+class CompiledMenu {
+public:
+  /**
+   * Loads the menu at base_path (the full path to the menu without any
+   * extension). Returns nullptr if the .mnu file can not be read.
+   */
+  static std::shared_ptr<const CompiledMenu> Compile(const std::string& base_path);
+
+  const MenuHeader& header() const noexcept { return header_; }
+  const std::vector<menu_command_t>& enter_script() const noexcept { return enter_script_; }
+  const std::vector<menu_command_t>& exit_script() const noexcept { return exit_script_; }
+  const std::string& prompt() const noexcept { return prompt_; }
+
+  /** All items bound to key, in the order they appear in the .mnu file. */
+  std::vector<const compiled_menu_item_t*> items(const std::string& key) const;
+  /** The items to list when generating a menu, in display order. */
+  std::vector<const compiled_menu_item_t*> display_items() const;
+  /** Returns true if the help file with extension ext existed when loaded. */
+  bool has_help_file(const std::string& ext) const;
+
+private:
+  MenuHeader header_{};
+  std::vector<menu_command_t> enter_script_;
+  std::vector<menu_command_t> exit_script_;
+  std::string prompt_;
+  std::vector<compiled_menu_item_t> items_;
+  std::unordered_map<std::string, std::vector<size_t>> keys_;
+  std::vector<size_t> display_order_;
+  std::map<std::string, bool> help_files_;
+};
+
+/**
+ * Process wide cache of CompiledMenus, keyed by the menu's base path. A menu
+ * is loaded again once the .mnu or .pro file, or the directory containing
+ * them (for the help files), changes.
+ */
+class MenuCache {
+public:
+  MenuCache() = default;
+  std::shared_ptr<const CompiledMenu> Get(const std::string& base_path);
+  void Invalidate(const std::string& base_path);
+  void InvalidateAll();
+  /** Number of times a menu was loaded from disk. */
+  int loads() const noexcept { return loads_; }
+
+private:
+  struct stamp_t {
+    off_t mnu_size{0};
+    time_t mnu_mtime{0};
+    off_t pro_size{0};
+    time_t pro_mtime{0};
+    time_t dir_mtime{0};
+    bool operator==(const stamp_t& o) const {
+      return mnu_size == o.mnu_size && mnu_mtime == o.mnu_mtime && pro_size == o.pro_size &&
+             pro_mtime == o.pro_mtime && dir_mtime == o.dir_mtime;
+    }
+  };
+  struct entry_t {
+    std::shared_ptr<const CompiledMenu> menu;
+    stamp_t stamp;
+    bool racy{false};
+  };
+  static stamp_t stamp_for(const std::string& base_path);
+
+  std::mutex mu_;
+  std::unordered_map<std::string, entry_t> menus_;
+  int loads_{0};
+};
+
+}  // namespace menus
+}  // namespace wwiv
+
+#endif  // __INCLUDED_BBS_MENU_CACHE_H__
@@ -23,6 +23,7 @@
 #include <memory>
 
 #include "bbs/menu.h"
+#include "core/strings.h"
 
 
 namespace wwiv {
@@ -160,6 +161,27 @@ const char *MenuParseLine(const char *pszSrc, char *pszCmd, char *pszParam1, cha
   return pszSrc;
 }
 
+std::vector<menu_command_t> ParseMenuScript(const std::string& script) {
+  std::vector<menu_command_t> result;
+  if (script.empty()) {
+    return result;
+  }
+
+  char temp_script[255];
+  wwiv::strings::to_char_array(temp_script, script);
+
+  const char* p = temp_script;
+  while (p) {
+    char scmd[31], param1[51], param2[51];
+    p = MenuParseLine(p, scmd, param1, param2);
+
+    if (scmd[0] == 0) {
+      break;
+    }
+    result.push_back({scmd, param1, param2});
+  }
+  return result;
+}
 
 }  // namespace menus
 }  // namespace wwiv
@@ -18,11 +18,27 @@
 #ifndef __INCLUDED_BBS_MENU_PARSER_H__
 #define __INCLUDED_BBS_MENU_PARSER_H__
 
+#include <string>
+#include <vector>
+
 namespace wwiv {
 namespace menus {
 
 const char *MenuParseLine(const char *pszSrc, char *pszCmd, char *pszParam1, char *pszParam2);
 
+// A single command from a menu script.
+struct menu_command_t {
+  std::string cmd;
+  std::string param1;
+  std::string param2;
+};
+
+/**
+ * Parses a menu script (one or more commands separated by '~') into its
+ * commands, so it can be run many times without parsing it again.
+ */
+std::vector<menu_command_t> ParseMenuScript(const std::string& script);
+
 }  // namespace menus
 }  // namespace wwiv
 
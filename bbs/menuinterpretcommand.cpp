@@ -83,28 +83,20 @@ public:
 map<string, std::function<void(MenuItemContext&)>, wwiv::stl::ci_less> CreateCommandMap();
 
 void InterpretCommand(MenuInstance* menudata, const std::string& script) {
-  static map<string, std::function<void(MenuItemContext& context)>, wwiv::stl::ci_less> functions = CreateCommandMap();
-
   if (script.empty()) {
     return;
   }
+  InterpretCommand(menudata, ParseMenuScript(script));
+}
 
-  char temp_script[255];
-  to_char_array(temp_script, script);
-
-  const char* p = temp_script;
-  while (p) {
-    char scmd[31], param1[51], param2[51];
-    p = MenuParseLine(p, scmd, param1, param2);
-
-    if (scmd[0] == 0) { 
-      break;
-    }
+void InterpretCommand(MenuInstance* menudata, const std::vector<menu_command_t>& commands) {
+  static map<string, std::function<void(MenuItemContext& context)>, wwiv::stl::ci_less> functions = CreateCommandMap();
 
-    string cmd(scmd);
-    if (contains(functions, cmd)) {
-      MenuItemContext context(menudata, param1, param2);
-      functions.at(cmd)(context);
+  for (const auto& c : commands) {
+    auto it = functions.find(c.cmd);
+    if (it != functions.end()) {
+      MenuItemContext context(menudata, c.param1, c.param2);
+      it->second(context);
       if (menudata) {
         menudata->reload = context.need_reload;
         menudata->finished = (context.finished || context.need_reload);
@@ -128,7 +120,7 @@ map<string, std::function<void(MenuItemContext&)>, wwiv::stl::ci_less> CreateCom
     } },
     { "ReturnFromMenu", [](MenuItemContext& context) {
       if (context.pMenuData) {
-        InterpretCommand(context.pMenuData, context.pMenuData->header.szExitScript);
+        InterpretCommand(context.pMenuData, context.pMenuData->exit_script());
         context.finished = true;
       }
     } },
@@ -92,9 +92,7 @@ static void save_gat(File& file) {
   auto section_pos = static_cast<off_t>(gat_section) * GATSECLEN;
   file.Seek(section_pos, File::Whence::begin);
   file.Write(gat, GAT_SECTION_SIZE);
-  a()->status_manager()->Run([](WStatus& s) {
-    s.IncrementFileChangedFlag(WStatus::fileChangePosts);
-  });
+  a()->status_manager()->IncrementFileChangedFlag(WStatus::fileChangePosts);
 }
 
 /**
@@ -252,7 +252,7 @@ void post(const PostData& post_data) {
   p.msg = m;
   p.ownersys = 0;
   p.owneruser = static_cast<uint16_t>(a()->usernum);
-  a()->status_manager()->Run([&](WStatus& s) { p.qscan = s.IncrementQScanPointer(); });
+  p.qscan = a()->status_manager()->Increment(StatusCounter::qscan_pointer);
   p.daten = daten_t_now();
   p.status = 0;
   if (a()->user()->IsRestrictionValidate()) {
@@ -300,10 +300,8 @@ void post(const PostData& post_data) {
 
   a()->user()->SetNumMessagesPosted(a()->user()->GetNumMessagesPosted() + 1);
   a()->user()->SetNumPostsToday(a()->user()->GetNumPostsToday() + 1);
-  a()->status_manager()->Run([](WStatus& s) {
-    s.IncrementNumMessagesPostedToday();
-    s.IncrementNumLocalPosts();
-  });
+  a()->status_manager()->Increment(StatusCounter::posts_today);
+  a()->status_manager()->Increment(StatusCounter::local_posts);
 
   if (a()->HasConfigFlag(OP_FLAGS_POSTTIME_COMPENSATE)) {
     const auto end_time = DateTime::now().to_system_clock();
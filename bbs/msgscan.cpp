@@ -62,6 +62,7 @@
 #include "core/stl.h"
 #include "core/strings.h"
 #include "core/wwivassert.h"
+#include "sdk/ansi/screen_renderer.h"
 #include "sdk/filenames.h"
 #include "sdk/subxtr.h"
 
@@ -69,6 +70,7 @@ using std::string;
 using std::unique_ptr;
 using std::vector;
 using wwiv::endl;
+using wwiv::sdk::ansi::ScreenRenderer;
 using namespace wwiv::core;
 using namespace wwiv::sdk;
 using namespace wwiv::sdk::msgapi;
@@ -421,27 +423,24 @@ static std::vector<std::string> CreateMessageTitleVector(MessageArea* area, int
   return lines;
 }
 
-static void display_title_new(const std::vector<std::string>& lines, const FullScreenView& fs,
+static void display_title_new(const std::vector<std::string>& lines, ScreenRenderer& screen,
   int i, bool selected) {
-  bout.GotoXY(1, i + fs.lines_start());
-  const auto l = lines.at(i);
-  if (selected) {
-    bout << "|17|12>";
-  }
-  else {
-    bout << "|16|#0 ";
+  auto& frame = screen.frame();
+  frame.curatr(7);
+  if (i >= size_int(lines)) {
+    bout.PutsXY(frame, 0, i, std::string(screen.cols(), ' '));
+    return;
   }
-  bout << pad_to_ignore_colors(l, fs.screen_width() - 1) << "|#0";
+  const auto& l = lines.at(i);
+  const string marker = selected ? "|17|12>" : "|16|#0 ";
+  bout.PutsXY(frame, 0, i, StrCat(marker, pad_to_ignore_colors(l, screen.cols() - 1)));
 }
 
-static void display_titles_new(const std::vector<std::string>& lines, const FullScreenView& fs,
+static void display_titles_new(const std::vector<std::string>& lines, ScreenRenderer& screen,
   int start, int selected) {
-  for (int i = 0; i < fs.message_height(); i++) {
-    if (i >= size_int(lines)) {
-      break;
-    }
+  for (int i = 0; i < screen.rows(); i++) {
     bool is_selected = i == (selected - start);
-    display_title_new(lines, fs, i, is_selected);
+    display_title_new(lines, screen, i, is_selected);
   }
 }
 
@@ -470,6 +469,9 @@ static ReadMessageResult HandleListTitlesFullScreen(int &msgnum, MsgScanOption&
   fs.DrawTopBar();
   fs.DrawBottomBar("");
   fs.GotoContentAreaTop();
+  // Only the changes to the list are sent as the selection moves.
+  ScreenRenderer screen(fs.screen_width(), fs.message_height(), fs.lines_start() - 1);
+  screen.MarkCleared();
 
   const int window_top_min = 1;
   const int first = 1;
@@ -483,24 +485,14 @@ static ReadMessageResult HandleListTitlesFullScreen(int &msgnum, MsgScanOption&
   if (selected > window_bottom) selected = window_bottom;
 
   bool done = false;
-  bool need_redraw = true;
-  int last_selected = selected;
   while (!done) {
     CheckForHangup();
     auto lines = CreateMessageTitleVector(area.get(), window_top, height);
-    if (need_redraw) {
-      display_titles_new(lines, fs, window_top, selected);
-      need_redraw = false;
-    }
-    else if (last_selected != selected) {
-      display_title_new(lines, fs, (last_selected - window_top), false);
-      display_title_new(lines, fs, (selected - window_top), true);
-      need_redraw = false;
-    }
+    display_titles_new(lines, screen, window_top, selected);
+    screen.cursor(0, selected - window_top);
+    bout.Render(screen);
 
-    bout.GotoXY(1, fs.lines_start() + selected - (window_top - window_top_min) + window_top_min);
     fs.DrawBottomBar(StrCat("Selected: ", selected));
-    last_selected = selected;
 
     fs.ClearCommandLine();
     bout.GotoXY(1, fs.command_line_y());
@@ -520,7 +512,6 @@ static ReadMessageResult HandleListTitlesFullScreen(int &msgnum, MsgScanOption&
         if (window_top > window_top_min) {
           window_top--;
           selected--;
-          need_redraw = true;
         }
       }
       else {
@@ -532,10 +523,8 @@ static ReadMessageResult HandleListTitlesFullScreen(int &msgnum, MsgScanOption&
       selected -= height;
       window_top = std::max<int>(window_top, window_top_min);
       selected = std::max<int>(selected, 1);
-      need_redraw = true;
     } break;
     case COMMAND_HOME: {
-      need_redraw = true;
       selected = 1;
       window_top = window_top_min;
     } break;
@@ -548,7 +537,6 @@ static ReadMessageResult HandleListTitlesFullScreen(int &msgnum, MsgScanOption&
       else if (window_top < d) {
         selected++;
         window_top++;
-        need_redraw = true;
       }
     } break;
     case COMMAND_PAGEDN: {
@@ -556,12 +544,10 @@ static ReadMessageResult HandleListTitlesFullScreen(int &msgnum, MsgScanOption&
       selected += height;
       window_top = std::min<int>(window_top, num_msgs_in_area - height + window_top_min);
       selected = std::min<int>(selected, num_msgs_in_area);
-      need_redraw = true;
     } break;
     case COMMAND_END: {
       window_top = num_msgs_in_area - height + window_top_min;
       selected = window_top;
-      need_redraw = true;
     } break;
     case SOFTRETURN: {
       // Do nothing. SyncTerm sends CRLF on enter, not just CR
@@ -597,7 +583,7 @@ static ReadMessageResult HandleListTitlesFullScreen(int &msgnum, MsgScanOption&
           return result;
         } break;
         case '?': {
-          need_redraw = true;
+          screen.Invalidate();
           fs.ClearMessageArea();
           if (!printfile(TITLE_FSED_NOEXT)) {
             fs.ClearCommandLine();
@@ -733,9 +719,7 @@ void HandleMessageMove(int &nMessageNumber) {
       open_sub(true);
       p2.msg.storage_type = static_cast<unsigned char>(a()->current_sub().storage_type);
       savefile(b, &(p2.msg), (a()->current_sub().filename));
-      a()->status_manager()->Run([&](WStatus& s) {
-        p2.qscan = s.IncrementQScanPointer();
-      });
+      p2.qscan = a()->status_manager()->Increment(StatusCounter::qscan_pointer);
       if (a()->GetNumMessagesInCurrentMessageArea() >=
         a()->current_sub().maxmsgs) {
         int nTempMsgNum = 1;
@@ -114,17 +114,15 @@ void multimail(int *pnUserNumber, int numu) {
     a()->users()->writeuser(&user, pnUserNumber[cv]);
     const string pnunn = a()->names()->UserName(pnUserNumber[cv]);
     strcat(s, pnunn.c_str());
-    auto status = a()->status_manager()->BeginTransaction();
     if (pnUserNumber[cv] == 1) {
-      status->IncrementNumFeedbackSentToday();
+      a()->status_manager()->Increment(StatusCounter::feedback_today);
       a()->user()->SetNumFeedbackSentToday(a()->user()->GetNumFeedbackSentToday() + 1);
       a()->user()->SetNumFeedbackSent(a()->user()->GetNumFeedbackSent() + 1);
     } else {
-      status->IncrementNumEmailSentToday();
+      a()->status_manager()->Increment(StatusCounter::email_today);
       a()->user()->SetNumEmailSent(a()->user()->GetNumEmailSent() + 1);
       a()->user()->SetNumEmailSentToday(a()->user()->GetNumEmailSentToday() + 1);
     }
-    a()->status_manager()->CommitTransaction(std::move(status));
     sysoplog() << s;
     bout << s;
     bout.nl();
@@ -285,10 +285,8 @@ void normalupload(int dn) {
           fileDownload.Write(&u1, sizeof(uploadsrec));
           fileDownload.Close();
           if (ok == 1) {
-            a()->status_manager()->Run([](WStatus& s) {
-              s.IncrementNumUploadsToday();
-              s.IncrementFileChangedFlag(WStatus::fileChangeUpload);
-            });
+            a()->status_manager()->Increment(StatusCounter::uploads_today);
+            a()->status_manager()->IncrementFileChangedFlag(WStatus::fileChangeUpload);
             sysoplog() << StringPrintf("+ \"%s\" uploaded on %s", u.filename, a()->directories[dn].name);
             bout.nl(2);
             bout.bprintf("File uploaded.\r\n\nYour ratio is now: %-6.3f\r\n", ratio());
@@ -25,6 +25,7 @@
 
 #include "bbs/bbsutl.h"
 #include "local_io/keycodes.h"
+#include "local_io/null_local_io.h"
 #include "bbs/interpret.h"
 #include "bbs/com.h"
 #include "bbs/bbs.h"
@@ -88,6 +89,8 @@ void Output::SetLocalIO(LocalIO* local_io) {
   local_io_ = local_io;
   // Reset the curatr_provider on local_io since screen resets it.
   local_io_->set_curatr_provider(this);
+  // Nobody will ever see the local screen, so don't bother drawing it.
+  headless_ = dynamic_cast<NullLocalIO*>(local_io) != nullptr;
 }
 
 
@@ -251,79 +254,117 @@ void Output::mpl(int length) {
   bout.Left(length);
 }
 
-template <typename T>
-static int pipecode_int(T& it, const T end, int num_chars) {
-  std::string s;
-  while (it != end && num_chars-- > 0 && std::isdigit(static_cast<uint8_t>(*it))) {
-    s.push_back(*it);
-    it++; 
-  }
-  return to_number<int>(s);
+static wwiv::bbs::PipeProgramCache& pipe_program_cache() {
+  static wwiv::bbs::PipeProgramCache cache;
+  return cache;
 }
 
 int Output::bputs(const string& text) {
   CheckForHangup();
   if (text.empty() || a()->hangup_) { return 0; }
 
-  auto it = std::begin(text);
-  auto fin = std::end(text);
-  while (it != fin) {
-    // pipe codes.
-    if (*it == '|') {
-      it++;
-      if (it == fin) { bputch('|', true);  break; }
-      if (std::isdigit(*it)) {
-        int color = pipecode_int(it, fin, 2);
-        if (color < 16) {
-          bputs(MakeSystemColor(color | (curatr() & 0xf0)));
-        }
-        else {
-          uint8_t bg = static_cast<uint8_t>(color) << 4;
-          uint8_t fg = curatr() & 0x0f;
-          bputs(MakeSystemColor(bg | fg));
-        }
-      }
-      else if (*it == '@') {
-        it++;
-        BbsMacroContext ctx(a()->user(), a()->mci_enabled_);
-        auto s = ctx.interpret(*it++);
-        bout.bputs(s);
-      }
-      else if (*it == '#') {
-        it++;
-        int color = pipecode_int(it, fin, 1);
-        bputs(MakeColor(color));
+  static const char kCodeChars[] = {'|', CC, CO, ESC, '\0'};
+  if (text.find_first_of(kCodeChars) == string::npos) {
+    // Nothing to interpret or strip.
+    for (const auto c : text) {
+      bputch(c, true);
+    }
+    flush();
+    return text.size();
+  }
+
+  // Hold onto the program, since displaying it may call bputs again.
+  const auto program = pipe_program_cache().Get(text);
+  PutTokens(program->tokens);
+  flush();
+  return program->visible_length;
+}
+
+void Output::PutTokens(const std::vector<wwiv::bbs::pipe_token_t>& tokens) {
+  using wwiv::bbs::pipe_token_type_t;
+  CheckForHangup();
+  if (a()->hangup_) { return; }
+
+  for (const auto& t : tokens) {
+    string s;
+    switch (t.type) {
+    case pipe_token_type_t::text:
+      for (const auto c : t.text) {
+        bputch(c, true);
       }
-      else {
-        bputch('|', true);
+      continue;
+    case pipe_token_type_t::pipe_color:
+      if (t.value < 16) {
+        s = MakeSystemColor(t.value | (curatr() & 0xf0));
+      } else {
+        uint8_t bg = static_cast<uint8_t>(t.value) << 4;
+        uint8_t fg = curatr() & 0x0f;
+        s = MakeSystemColor(bg | fg);
       }
+      break;
+    case pipe_token_type_t::user_color:
+      s = MakeColor(t.value);
+      break;
+    case pipe_token_type_t::macro: {
+      BbsMacroContext ctx(a()->user(), a()->mci_enabled_);
+      // Macros may expand to text containing pipe codes.
+      PutTokens(wwiv::bbs::TokenizePipeCodes(ctx.interpret(static_cast<char>(t.value))));
+      continue;
     }
-    else if (*it == CC) {
-      it++;
-      if (it == fin) { bputch(CC, true);  break; }
-      unsigned char c = *it++;
-      if (c >= SPACE && c <= 126) {
-        bputs(MakeColor(c - '0'));
-      }
     }
-    else if (*it == CO) {
-      it++;
-      if (it == fin) { bputch(CO, true);  break; }
-      it++;
-      if (it == fin) { bputch(CO, true);  break; }
+    for (const auto c : s) {
+      bputch(c, true);
+    }
+  }
+}
+
+// Displays tokens on screen, the same way PutTokens does for the session.
+static void PutTokensOnScreen(wwiv::sdk::ansi::VScreen& screen,
+                              const std::vector<wwiv::bbs::pipe_token_t>& tokens) {
+  using wwiv::bbs::pipe_token_type_t;
+  for (const auto& t : tokens) {
+    switch (t.type) {
+    case pipe_token_type_t::text:
+      for (const auto c : t.text) {
+        screen.write(c);
+      }
+      break;
+    case pipe_token_type_t::pipe_color:
+      if (t.value < 16) {
+        screen.curatr(static_cast<uint8_t>(t.value | (screen.curatr() & 0xf0)));
+      } else {
+        uint8_t bg = static_cast<uint8_t>(t.value) << 4;
+        uint8_t fg = screen.curatr() & 0x0f;
+        screen.curatr(bg | fg);
+      }
+      break;
+    case pipe_token_type_t::user_color:
+      screen.curatr(a()->user()->color(t.value));
+      break;
+    case pipe_token_type_t::macro: {
       BbsMacroContext ctx(a()->user(), a()->mci_enabled_);
-      auto s = ctx.interpret(*it++);
-      bout.bputs(s);
-    } else if (it == fin) { 
-      break; 
+      PutTokensOnScreen(screen, wwiv::bbs::TokenizePipeCodes(ctx.interpret(static_cast<char>(t.value))));
+      break;
     }
-    else { 
-      bputch(*it++, true);
     }
   }
+}
 
+void Output::PutsXY(wwiv::sdk::ansi::VScreen& screen, int x, int y, const std::string& text) {
+  screen.gotoxy(x, y);
+  const auto program = pipe_program_cache().Get(text);
+  PutTokensOnScreen(screen, program->tokens);
+}
+
+void Output::Render(wwiv::sdk::ansi::ScreenRenderer& screen) {
+  if (!okansi()) {
+    return;
+  }
+  // bputch keeps the local screen and our idea of the cursor in sync.
+  for (const auto c : screen.Render(curatr())) {
+    bputch(c, true);
+  }
   flush();
-  return stripcolors(text).size();
 }
 
 // This one does a newline.  Since it used to be pla. Should make
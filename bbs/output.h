@@ -29,11 +29,13 @@
 #include <utility>
 #include <vector>
 
+#include "bbs/pipe_codes.h"
 #include "local_io/curatr_provider.h"
 #include "local_io/local_io.h"
 #include "sdk/wwivcolors.h"
 #include "sdk/ansi/ansi.h"
 #include "sdk/ansi/localio_screen.h"
+#include "sdk/ansi/screen_renderer.h"
 
 
 class outputstreambuf : public std::streambuf {
@@ -63,9 +65,20 @@ public:
   Output();
   virtual ~Output() {}
 
+  /**
+   * Sets the local IO. Using a NullLocalIO also makes this output headless.
+   */
   void SetLocalIO(LocalIO* local_io);
   LocalIO* localIO() const noexcept { return local_io_; }
 
+  /**
+   * When headless, nothing is drawn on the local screen. The current line,
+   * cursor column, colors and lines listed are still tracked for the remote
+   * user.
+   */
+  bool headless() const noexcept { return headless_; }
+  void set_headless(bool h) { headless_ = h; }
+
   void SetComm(RemoteIO* comm) { comm_ = comm; }
   RemoteIO* remoteIO() const noexcept { return comm_; }
 
@@ -138,6 +151,24 @@ public:
   int bputs(const std::string& text, bool* abort, bool* next);
   int bprintf(const char* fmt, ...);
 
+  /**
+   * Writes text, which may contain pipe color codes, into screen at x,y
+   * (0 based) instead of sending it to the user.
+   */
+  void PutsXY(wwiv::sdk::ansi::VScreen& screen, int x, int y, const std::string& text);
+
+  /**
+   * Sends only what changed in the screen since it was last rendered.
+   * If the user does not have ansi, this function does nothing.
+   */
+  void Render(wwiv::sdk::ansi::ScreenRenderer& screen);
+
+  /**
+   * Writes tokens from wwiv::bbs::TokenizePipeCodes into the output buffer
+   * without flushing it, so many lines can be sent in a few large writes.
+   */
+  void PutTokens(const std::vector<wwiv::bbs::pipe_token_t>& tokens);
+
   int bputch(char c, bool use_buffer = false);
   void flush();
   void rputch(char ch, bool use_buffer = false);
@@ -199,6 +230,7 @@ private:
   std::chrono::duration<double> logon_key_timeout_ = std::chrono::minutes(3);
 
   bool ansi_movement_occurred_{false};
+  bool headless_{false};
   int curatr_{7};
   bool okskey_{true};
   std::unique_ptr<wwiv::sdk::ansi::LocalIOScreen> screen_;
@@ -0,0 +1,133 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "bbs/pipe_codes.h"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "core/strings.h"
+#include "local_io/keycodes.h"
+
+using std::string;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace bbs {
+
+template <typename T>
+static int pipecode_int(T& it, const T end, int num_chars) {
+  string s;
+  while (it != end && num_chars-- > 0 && std::isdigit(static_cast<uint8_t>(*it))) {
+    s.push_back(*it);
+    it++;
+  }
+  return to_number<int>(s);
+}
+
+static void add_text(std::vector<pipe_token_t>& tokens, char c) {
+  if (tokens.empty() || tokens.back().type != pipe_token_type_t::text) {
+    tokens.push_back({pipe_token_type_t::text, {}, 0});
+  }
+  tokens.back().text.push_back(c);
+}
+
+std::vector<pipe_token_t> TokenizePipeCodes(const std::string& text) {
+  std::vector<pipe_token_t> tokens;
+  auto it = std::begin(text);
+  const auto fin = std::end(text);
+  while (it != fin) {
+    if (*it == '|') {
+      it++;
+      if (it == fin) {
+        add_text(tokens, '|');
+        break;
+      }
+      if (std::isdigit(static_cast<uint8_t>(*it))) {
+        tokens.push_back({pipe_token_type_t::pipe_color, {}, pipecode_int(it, fin, 2)});
+      } else if (*it == '@') {
+        it++;
+        if (it == fin) {
+          break;
+        }
+        tokens.push_back({pipe_token_type_t::macro, {}, *it++});
+      } else if (*it == '#') {
+        it++;
+        tokens.push_back({pipe_token_type_t::user_color, {}, pipecode_int(it, fin, 1)});
+      } else {
+        // Not a pipe code, the next character is displayed normally.
+        add_text(tokens, '|');
+      }
+    } else if (*it == CC) {
+      it++;
+      if (it == fin) {
+        add_text(tokens, CC);
+        break;
+      }
+      const unsigned char c = *it++;
+      if (c >= SPACE && c <= 126) {
+        tokens.push_back({pipe_token_type_t::user_color, {}, c - '0'});
+      }
+    } else if (*it == CO) {
+      it++;
+      if (it == fin) {
+        add_text(tokens, CO);
+        break;
+      }
+      it++;
+      if (it == fin) {
+        add_text(tokens, CO);
+        break;
+      }
+      tokens.push_back({pipe_token_type_t::macro, {}, *it++});
+    } else {
+      add_text(tokens, *it++);
+    }
+  }
+  return tokens;
+}
+
+pipe_program_t CompilePipeCodes(const std::string& text) {
+  pipe_program_t p;
+  p.tokens = TokenizePipeCodes(text);
+  p.visible_length = static_cast<int>(stripcolors(text).size());
+  return p;
+}
+
+std::shared_ptr<const pipe_program_t> PipeProgramCache::Get(const std::string& text) {
+  const auto cacheable = text.size() <= kMaxTextLength;
+  if (cacheable) {
+    auto it = programs_.find(text);
+    if (it != programs_.end()) {
+      return it->second;
+    }
+  }
+  ++compiles_;
+  auto p = std::make_shared<const pipe_program_t>(CompilePipeCodes(text));
+  if (cacheable) {
+    if (programs_.size() >= kMaxEntries) {
+      programs_.clear();
+    }
+    programs_.emplace(text, p);
+  }
+  return p;
+}
+
+}  // namespace bbs
+}  // namespace wwiv
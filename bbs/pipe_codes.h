@@ -0,0 +1,94 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_BBS_PIPE_CODES_H__
+#define __INCLUDED_BBS_PIPE_CODES_H__
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wwiv {
+namespace bbs {
+
+enum class pipe_token_type_t {
+  /** Literal text to display as-is (may include ANSI sequences). */
+  text,
+  /** |## system color. Values < 16 are a foreground, otherwise a background. */
+  pipe_color,
+  /** |#n or control-C n: one of the user's configured colors. */
+  user_color,
+  /** |@x or control-O: the macro named by value. */
+  macro
+};
+
+struct pipe_token_t {
+  pipe_token_type_t type;
+  std::string text;
+  int value{0};
+};
+
+/**
+ * Splits text into the literal spans and pipe, color and MCI codes that
+ * Output::bputs interprets, so that text which is displayed many times only
+ * needs to be scanned once.
+ */
+std::vector<pipe_token_t> TokenizePipeCodes(const std::string& text);
+
+/** Text compiled once so that it can be displayed many times. */
+struct pipe_program_t {
+  std::vector<pipe_token_t> tokens;
+  /** Length of the text without color codes, as returned by Output::bputs. */
+  int visible_length{0};
+};
+
+/** Compiles text into a pipe_program_t. */
+pipe_program_t CompilePipeCodes(const std::string& text);
+
+/**
+ * Cache of compiled text keyed by the text itself, for the prompts, menus
+ * and language strings that are displayed over and over. Text longer than
+ * kMaxTextLength is compiled every time, since it is rarely repeated.
+ *
+ * This is only used from the session thread, so it is not locked.
+ */
+class PipeProgramCache {
+public:
+  static constexpr std::size_t kMaxTextLength = 512;
+  static constexpr std::size_t kMaxEntries = 2048;
+
+  PipeProgramCache() = default;
+
+  std::shared_ptr<const pipe_program_t> Get(const std::string& text);
+  void Clear() { programs_.clear(); }
+
+  std::size_t size() const noexcept { return programs_.size(); }
+  /** Number of times text was compiled. */
+  int compiles() const noexcept { return compiles_; }
+
+private:
+  std::unordered_map<std::string, std::shared_ptr<const pipe_program_t>> programs_;
+  int compiles_{0};
+};
+
+}  // namespace bbs
+}  // namespace wwiv
+
+#endif  // __INCLUDED_BBS_PIPE_CODES_H__
@@ -24,13 +24,14 @@
 
 #include "bbs/bbs.h"
 #include "bbs/bbsutl.h"
+#include "bbs/display_file_cache.h"
+#include "bbs/instmsg.h"
 #include "local_io/keycodes.h"
 #include "bbs/pause.h"
 #include "bbs/application.h"
 #include "core/file.h"
 #include "core/stl.h"
 #include "core/strings.h"
-#include "core/textfile.h"
 
 using std::string;
 using std::unique_ptr;
@@ -38,38 +39,47 @@ using namespace wwiv::core;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
 
+using wwiv::bbs::DisplayFileCache;
+
 /**
- * Creates the fully qualified filename to display adding extensions and directories as needed.
+ * Returns the filenames that may be displayed for basename, in the order of
+ * preference, adding extensions and directories as needed.
  */
-string CreateFullPathToPrint(const string& basename) {
+static std::vector<string> CandidatesToPrint(const string& basename) {
+  std::vector<string> candidates;
   std::vector<string> dirs { a()->language_dir, a()->config()->gfilesdir()};
   for (const auto& base : dirs) {
-    File file(FilePath(base, basename));
+    const auto root_filename = FilePath(base, basename);
     if (basename.find('.') != string::npos) {
       // We have a file with extension.
-      if (file.Exists()) {
-        return file.full_pathname();
-      }
       // Since no wwiv filenames contain embedded dots skip to the next directory.
+      candidates.push_back(root_filename);
       continue;
     }
-    const auto root_filename = file.full_pathname();
     if (a()->user()->HasAnsi()) {
       if (a()->user()->HasColor()) {
         // ANSI and color
-        auto candidate = StrCat(root_filename, ".ans");
-        if (File::Exists(candidate)) {
-          return candidate;
-        }
+        candidates.push_back(StrCat(root_filename, ".ans"));
       }
       // ANSI.
-      auto candidate = StrCat(root_filename, ".b&w");
-      if (File::Exists(candidate)) {
-        return candidate;
-      }
+      candidates.push_back(StrCat(root_filename, ".b&w"));
     }
     // ANSI/Color optional
-    auto candidate = StrCat(root_filename , ".msg");
+    candidates.push_back(StrCat(root_filename , ".msg"));
+  }
+  return candidates;
+}
+
+static DisplayFileCache& display_file_cache() {
+  static DisplayFileCache cache;
+  return cache;
+}
+
+/**
+ * Creates the fully qualified filename to display adding extensions and directories as needed.
+ */
+string CreateFullPathToPrint(const string& basename) {
+  for (const auto& candidate : CandidatesToPrint(basename)) {
     if (File::Exists(candidate)) {
       return candidate;
     }
@@ -90,40 +100,34 @@ string CreateFullPathToPrint(const string& basename) {
  * @return true if the file exists and is not zero length
  */
 bool printfile(const string& filename, bool abortable, bool force_pause) {
-  const auto full_path_name = CreateFullPathToPrint(filename);
-  {
-    File f(full_path_name);
-    if (!f.Exists()) {
-      // No need to print a file that does not exist.
-      return false;
-    }
-    if (!f.IsFile()) {
-      // Not a file, no need to print a file that is not a file.
-      return false;
-    }
+  auto full_path_name = display_file_cache().Resolve(CandidatesToPrint(filename));
+  if (full_path_name.empty()) {
+    // Nothing matched, try the input.
+    full_path_name = filename;
+  }
+  // Display files are cached already split into lines and tokens, and are
+  // written into the output buffer so the file goes out in a few large writes.
+  auto file = display_file_cache().Get(full_path_name);
+  if (!file) {
+    // No need to print a file that does not exist or is not a file.
+    return false;
   }
 
-  TextFile tf(full_path_name, "rb");
-  auto v = tf.ReadFileIntoVector();
-  for (const auto& s : v) {
-    bout.bputs(s);
-    bout.nl();
-    auto has_ansi = contains(s, ESC);
+  for (const auto& line : file->lines()) {
+    // The line includes the \r\n.
+    bout.PutTokens(line.tokens);
+    if (inst_msg_waiting() && !a()->chatline_) {
+      bout.flush();
+      process_inst_msgs();
+    }
     // If this is an ANSI file, then don't pause
     // (since we may be moving around
     // on the screen, unless the caller tells us to pause anyway)
-    if (has_ansi && !force_pause) bout.clear_lines_listed();
-    if (contains(s, CZ)) {
-      // We are done here on a control-Z since that's DOS EOF.  Also ANSI
-      // files created with PabloDraw expect that anything after a Control-Z
-      // is fair game for metadata and includes SAUCE metadata after it which
-      // we do not want to render in the bbs.
-      break;
-    }
+    if (line.has_ansi && !force_pause) bout.clear_lines_listed();
     if (abortable && checka()) break;
   }
   bout.flush();
-  return !v.empty();
+  return !file->empty();
 }
 
 /**
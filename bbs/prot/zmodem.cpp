@@ -84,6 +84,43 @@ int	ZProtocol(ZModem *info);
 int ZDataReceived(ZModem *info, int crcGood);
 
 
+/* copy a run of data characters which need no special handling
+* straight into the data buffer, returns the number copied.
+*/
+static int DataRun( const u_char *str, int len, ZModem *info ) {
+	int	room = ZMaxPacket - info->chrCount;
+	u_char	*buf = info->buffer + info->chrCount;
+	u_long	crc = info->crc;
+	int	n = 0;
+
+	if( len > room ) {
+		len = room;
+	}
+	if( info->DataType == ZBIN ) {
+		for( ; n < len; ++n ) {
+			u_char c = str[n];
+			if( c == ZDLE || c == XON || c == XOFF ) {
+				break;
+			}
+			crc = updcrc(c, crc);
+			buf[n] = c;
+		}
+	} else if( info->DataType == ZBIN32 ) {
+		for( ; n < len; ++n ) {
+			u_char c = str[n];
+			if( c == ZDLE || c == XON || c == XOFF ) {
+				break;
+			}
+			crc = UPDC32(c, crc);
+			buf[n] = c;
+		}
+	}
+	info->crc = crc;
+	info->chrCount += n;
+	return n;
+}
+
+
 int ZmodemRcv( u_char *str, int len, ZModem *info ) {
 	u_char	c;
 	int	err;
@@ -91,6 +128,18 @@ int ZmodemRcv( u_char *str, int len, ZModem *info ) {
 	info->rcvlen = len;
 
 	while( --info->rcvlen >= 0 ) {
+		if( info->InputState == ZModem::Indata  &&  !info->escape  &&
+		        info->crcCount == 0 ) {
+			/* fast path for the bulk of a data subpacket */
+			int n = DataRun(str, info->rcvlen + 1, info);
+			if( n > 0 ) {
+				info->canCount = 0;
+				str += n;
+				info->rcvlen -= n - 1;
+				continue;
+			}
+		}
+
 		c = *str++;
 
 		if( c == CAN ) {
@@ -349,6 +398,13 @@ int DataChar( u_char c,  ZModem *info ) {
 	}
 
 
+	if( info->crcCount == 0  &&  info->chrCount >= ZMaxPacket ) {
+		/* subpacket is larger than any sender should send, treat
+		* it like a bad crc and wait for the next header. */
+		info->InputState = ZModem::Idle;
+		return ZDataReceived(info, 0);
+	}
+
 	switch( info->DataType ) {
 	/* TODO: are hex data packets ever used? */
 	case ZBIN:
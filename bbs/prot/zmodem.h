@@ -63,6 +63,9 @@
 #define	AlwaysSinit	1	/* always send ZSINIT header, even if not
 				 * needed, this makes protocol more robust */
 
+#define	ZMaxPacket	8192	/* largest data subpacket (ZedZap), also the
+				 * default transmit packet size */
+
 #define SendOnly	0	/* compiles smaller version for send only */
 #define RcvOnly		0	/* compiles smaller version for receive only */
 
@@ -77,6 +80,8 @@
 #include <stdio.h>
 #include <sys/types.h>
 
+class RemoteIO;
+
 
 //
 // Convenience types.  from bits/types.h in glibc
@@ -149,6 +154,8 @@ struct ZModem {
 	int	bufsize ;	/* receive buffer size, bytes */
 	int	packetsize ;	/* preferred transmit packet size */
 	int	windowsize ;	/* max window size */
+	RemoteIO *remote = nullptr ;	/* connection to use, or nullptr for the
+				 * caller's session */
 
 	/* file attributes: read-only */
 
@@ -405,6 +412,8 @@ int ZXmitHdrHex( int type, u_char data[4], ZModem *info );
 int ZXmitHdrBin( int type, u_char data[4], ZModem *info );
 int ZXmitHdrBin32( int type, u_char data[4], ZModem *info );
 extern	u_char	*putZdle( u_char *ptr, u_char c, ZModem *info ) ;
+extern	int	ZEscapeData( const u_char *data, int count, u_char *out,
+			     int *outlen, int room, ZModem *info ) ;
 
 extern	u_char	*ZEnc4( u_long n ) ;
 extern	u_long	ZDec4( u_char buf[4] );
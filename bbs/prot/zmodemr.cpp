@@ -59,7 +59,7 @@ int ZmodemRInit(ZModem *info) {
 	info->attn = nullptr;
 	info->file = nullptr;
 
-	info->buffer = (u_char *)malloc(8192);
+	info->buffer = (u_char *)malloc(ZMaxPacket);
 
 	info->state = RStart;
 	info->timeoutCount = 0;
@@ -214,7 +214,7 @@ int ZmodemTInit( ZModem *info ) {
 	info->waitflag = 0;
 
 	if( info->packetsize == 0 ) {
-		info->packetsize = 1024;
+		info->packetsize = ZMaxPacket;
 	}
 
 	/* we won't be receiving much data, pick a reasonable buffer
@@ -768,49 +768,35 @@ int SendMoreFileData( ZModem *info ) {
 
 
 	int	crc32 = info->crc32;
-	int c=0, c2, atSign=0;
 	u_long crc;
 	u_char *ptr = info->buffer;
+	u_char	data[ZMaxPacket];
 
 	crc = crc32 ? 0xffffffff : 0;
 
-	/* read characters from file and put into buffer until buffer is
-	* full or file is exhausted
+	/* read a block from the file and escape as much of it as fits
+	* into the buffer, then put back whatever did not fit.
 	*/
 
-	while( len > 0  && (c = getc(info->file)) != EOF ) {
-		if( !crc32 ) {
-			crc = updcrc(c, crc);
-		} else {
-			crc = UPDC32(c, crc);
-		}
+	if( len > ZMaxPacket ) {
+		len = ZMaxPacket;
+	}
+	int nread = fread(data, 1, len, info->file);
+	int outlen = 0;
+	int count = ZEscapeData(data, nread, ptr, &outlen, len, info);
+	if( count < nread ) {
+		fseek(info->file, count - nread, SEEK_CUR);
+	}
+	ptr += outlen;
+	len -= outlen;
+	info->offset += count;
 
-		/* zmodem protocol requires that CAN(ZDLE), DLE, XON, XOFF and
-		* a CR following '@' be escaped.  In addition, I escape '^]'
-		* to protect telnet, "<CR>~." to protect rlogin, and ESC for good
-		* measure.
-		*/
-		c2 = c & 0177;
-		if( c == ZDLE || c2 == 020 || c2 == 021 || c2 == 023 ||
-		        c2 == 0177  ||  c2 == '\r'  ||  c2 == '\n'  ||  c2 == 033  ||
-		        c2 == 035  || (c2 < 040 && info->escCtrl) ) {
-			*ptr++ = ZDLE;
-			if( c == 0177 ) {
-				*ptr = ZRUB0;
-			} else if( c == 0377 ) {
-				*ptr = ZRUB1;
-			} else {
-				*ptr = c^0100;
-			}
-			len -= 2;
+	for( int i = 0; i < count; ++i ) {
+		if( !crc32 ) {
+			crc = updcrc(data[i], crc);
 		} else {
-			*ptr = c;
-			--len;
+			crc = UPDC32(data[i], crc);
 		}
-		++ptr;
-
-		atSign = c2 == '@';
-		++info->offset;
 	}
 
 	/* if we've reached file end, a ZEOF header will follow.  If
@@ -818,7 +804,7 @@ int SendMoreFileData( ZModem *info ) {
 	* with ZCRCE and append the ZEOF header.  If there isn't room,
 	* we'll have to do a ZCRCW
 	*/
-	if( (info->fileEof = (c == EOF)) ) {
+	if( (info->fileEof = (len > 0)) ) {
 		if( qfull  ||  (info->bufsize != 0 && len < 24) ) {
 			type = ZCRCW;
 		} else {
@@ -45,6 +45,15 @@
 *		transmit buffer of data.
 *
 *
+*	int ZEscapeData(data, count, out, outlen, room, info)
+*		u_char	*data, *out;
+*		int	count, *outlen, room;
+*		ZModem	*info;
+*
+*		ZDLE escape file data into out until room is used up,
+*		returns the number of bytes of data consumed.
+*
+*
 *	u_long FileCrc(name)
 *		char	*name;
 *
@@ -246,6 +255,66 @@ int ZXmitHdr( int type, int format, u_char data[4], ZModem *info) {
 
 
 
+/* Characters that must be escaped in file data.  The zmodem
+* protocol requires that CAN(ZDLE), DLE, XON, XOFF and a CR
+* following '@' be escaped.  In addition, we escape '^]' to
+* protect telnet, "<CR>~." to protect rlogin (by escaping all
+* CR and LF), and ESC for good measure.  All of these are also
+* escaped with the 8th bit set.  The second table also escapes
+* all control characters, for when the receiver asks for that.
+*/
+struct ZEscapeTables {
+	u_char	table[2][256];
+	ZEscapeTables() {
+		for( int c = 0; c < 256; ++c ) {
+			int c2 = c & 0177;
+			int esc = c == ZDLE || c2 == 020 || c2 == 021 || c2 == 023 ||
+			          c2 == 0177  ||  c2 == '\r'  ||  c2 == '\n'  ||  c2 == 033  ||
+			          c2 == 035;
+			table[0][c] = esc;
+			table[1][c] = esc || c2 < 040;
+		}
+	}
+};
+
+int ZEscapeData( const u_char *data, int count, u_char *out, int *outlen,
+                 int room, ZModem *info ) {
+	static const ZEscapeTables tables;
+	const u_char *table = tables.table[info->escCtrl ? 1 : 0];
+	u_char	*ptr = out;
+	int	i = 0;
+
+	while( i < count  &&  room > 0 ) {
+		/* copy the run of characters which need no escaping */
+		int end = (count - i < room) ? count : i + room;
+		int run = i;
+		while( run < end  &&  !table[data[run]] ) {
+			++run;
+		}
+		memcpy(ptr, data+i, run-i);
+		ptr += run-i;
+		room -= run-i;
+		i = run;
+
+		if( i < count  &&  room > 0 ) {
+			u_char c = data[i++];
+			*ptr++ = ZDLE;
+			if( c == 0177 ) {
+				*ptr++ = ZRUB0;
+			} else if( c == 0377 ) {
+				*ptr++ = ZRUB1;
+			} else {
+				*ptr++ = c^0100;
+			}
+			room -= 2;
+		}
+	}
+
+	*outlen = ptr - out;
+	return i;
+}
+
+
 /* TODO: if input is not a file, need to keep old data
 * for possible retransmission */
 
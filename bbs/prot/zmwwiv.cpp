@@ -47,6 +47,11 @@ int doIO( ZModem *info );
 #pragma warning( disable : 4706 4127 4244 4100 )
 #endif
 
+// The connection to use for a transfer.
+static RemoteIO* remote_for(ZModem* info) {
+  return (info->remote != nullptr) ? info->remote : a()->remoteIO();
+}
+
 static void ProcessLocalKeyDuringZmodem() {
   if (!a()->localIO()->KeyPressed()) {
     return;
@@ -209,10 +214,12 @@ int doIO( ZModem *info ) {
 			zmodemlog( "[%ld] Then.  Timeout = %ld\r\n", tThen, info->timeout );
 		}
 #endif
-		// Don't loop/sleep if the timeout is 0 (which means streaming), this makes the
-		// performance < 1k/second vs. 8-9k/second locally
-		while ( ( info->timeout > 0 ) && !a()->remoteIO()->incoming() && !a()->hangup_ ) {
-			sleep_for(milliseconds(100));
+		// Don't wait if the timeout is 0 (which means streaming), this makes the
+		// performance < 1k/second vs. 8-9k/second locally.  Otherwise wake up as
+		// soon as data arrives, checking for local keys every 100ms.
+		RemoteIO* remote = remote_for(info);
+		while ( ( info->timeout > 0 ) && !remote->incoming() && !a()->hangup_ ) {
+			remote->wait_for_incoming(milliseconds(100));
 			time_t tNow = time( nullptr );
 			if ( ( tNow - tThen ) > info->timeout ) {
 #if defined(_DEBUG)
@@ -235,12 +242,12 @@ int doIO( ZModem *info ) {
 			//%%TODO: signal parent we aborted.
 			return 1;
 		}
-		bool bIncomming = a()->remoteIO()->incoming();
+		bool bIncomming = remote->incoming();
 		if( !bIncomming ) {
 			done = ZmodemTimeout(info);
 			//puts( "ZmodemTimeout\r\n" );
 		} else {
-			int len = a()->remoteIO()->read( reinterpret_cast<char*>( buffer ), ZMODEM_RECEIVE_BUFFER_SIZE );
+			int len = remote->read( reinterpret_cast<char*>( buffer ), ZMODEM_RECEIVE_BUFFER_SIZE );
 			done = ZmodemRcv( buffer, len, info );
 #if defined(_DEBUG)
 			zmodemlog( "ZmodemRcv [%d chars] [done:%d]\r\n", len, done );
@@ -256,13 +263,14 @@ int ZXmitStr(u_char *str, int len, ZModem *info) {
 #if defined(_DEBUG)
 	zmodemlog( "ZXmitStr Size=[%d]\r\n", len );
 #endif
-	a()->remoteIO()->write( reinterpret_cast<const char*>( str ),  len );
+	remote_for(info)->write( reinterpret_cast<const char*>( str ),  len );
 	return 0;
 }
 
 
 void ZIFlush(ZModem *info) {
-	sleep_for(milliseconds(100));
+	// Nothing to do, pending input is left for the parser.  This used to
+	// sleep for 100ms, which only slowed down every state change.
 	//puts( "ZIFlush" );
 	//if( connectionType == ConnectionSerial )
 	//  SerialFlush( 0 );
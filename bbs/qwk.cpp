@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <ctype.h>
 #include <fcntl.h>
@@ -57,14 +58,15 @@
 #include "bbs/xfertmp.h"
 #include "bbs/make_abs_cmd.h"
 #include "core/file.h"
+#include "core/findfiles.h"
 #include "core/strings.h"
 #include "core/wwivport.h"
 #include "core/datetime.h"
+#include "core/zip.h"
 #include "sdk/filenames.h"
 #include "sdk/status.h"
 #include "sdk/subxtr.h"
 #include "sdk/vardec.h"
-#include "sdk/ansi/makeansi.h"
 
 #define qwk_iscan(x)         (iscan1(a()->usub[x].subnum))
 
@@ -74,9 +76,10 @@ using namespace wwiv::bbs;
 using namespace wwiv::core;
 using namespace wwiv::strings;
 using namespace wwiv::sdk;
+using namespace wwiv::sdk::qwk;
 
 // Also used in qwk1.cpp
-const char *QWKFrom = "\x04""0QWKFrom:";
+const char *QWKFrom = QWK_FROM;
 
 static int qwk_percent;
 static uint16_t max_msgs;
@@ -92,7 +95,7 @@ static bool replacefile(char *src, char *dst) {
 }
 
 void build_qwk_packet() {
-  struct qwk_junk qwk_info;
+  qwk_junk qwk_info{};
   struct qwk_config qwk_cfg;
   bool save_conf = false;
   SaveQScanPointers save_qscan;
@@ -130,20 +133,16 @@ void build_qwk_packet() {
     return;
   }
 
-  // Setup index and other values
-  qwk_info.index = -1;
-  qwk_info.cursub = -1;
-
+  // Writes the required header at the start of MESSAGES.DAT
+  QwkMessagesWriter writer([&qwk_info](const char* data, size_t size) {
+    return write(qwk_info.file, data, size) == static_cast<ssize_t>(size);
+  });
+  qwk_info.writer = &writer;
+  qwk_info.prefetched = nullptr;
   qwk_info.in_email = 0;
-  qwk_info.personal = -1;
-  qwk_info.zero = -1;
-
-  // Required header at the start of MESSAGES.DAT
-  write(qwk_info.file, "Produced by Qmail...Copyright (c) 1987 by Sparkware.  All Rights Reserved (For Compatibility with Qmail)                        ", 128);
 
   // Logical record number
-  qwk_info.qwk_rec_num = 1;
-  qwk_info.qwk_rec_pos = 2;
+  qwk_info.qwk_rec_num = writer.next_logical_num();
 
   qwk_info.abort = 0;
 
@@ -174,13 +173,33 @@ void build_qwk_packet() {
          << '\xC5' << string(4, '\xC4') << '\xB4' << wwiv::endl;
   }
 
+  // Read the headers and text of the next few subs while the current one
+  // is being written.
+  const auto max_per_sub = a()->user()->data.qwk_max_msgs_per_sub;
+  std::vector<qwk_prefetch_request_t> requests;
+  for (size_t i = 0; (a()->usub[i].subnum != -1) && (i < a()->subs().subs().size()); i++) {
+    const auto sn = a()->usub[i].subnum;
+    if (a()->context().qsc_q[sn / 32] & (1L << (sn % 32))) {
+      qwk_prefetch_request_t r{};
+      r.filename = a()->subs().sub(sn).filename;
+      r.qscan = qwk_percent ? 0 : a()->context().qsc_p[sn];
+      r.max_messages = (max_per_sub && !qwk_percent) ? max_per_sub + 1 : 0;
+      requests.emplace_back(r);
+    }
+  }
+  QwkSubPrefetcher prefetcher(a()->config()->datadir(), a()->config()->msgsdir(), requests);
+
   bool msgs_ok = true;
   for (size_t i = 0; (a()->usub[i].subnum != -1) && (i < a()->subs().subs().size()) && (!a()->hangup_) && !qwk_info.abort && msgs_ok; i++) {
     msgs_ok = (max_msgs ? qwk_info.qwk_rec_num <= max_msgs : true);
     if (a()->context().qsc_q[a()->usub[i].subnum / 32] & (1L << (a()->usub[i].subnum % 32))) {
+      auto prefetched = prefetcher.Next();
+      qwk_info.prefetched = prefetched.get();
       qwk_gather_sub(i, &qwk_info);
+      qwk_info.prefetched = nullptr;
     }
   }
+  prefetcher.Cancel();
 
   bout << "|#7\xC3" << string(4, '\xC4') << '\xC5' << string(60, '\xC4') << '\xC5' << string(5, '\xC4') 
       << '\xC5' << string(4, '\xC4') << '\xB4' << wwiv::endl;
@@ -194,17 +213,20 @@ void build_qwk_packet() {
     }
   }
 
+  if (!writer.Flush()) {
+    bout.bputs("Write error");
+    sysoplog() << "Couldn't write MESSAGES.DAT";
+    qwk_info.abort = 1;
+  }
+  qwk_info.writer = nullptr;
   if (qwk_info.file != -1) {
     qwk_info.file = close(qwk_info.file);
   }
-  if (qwk_info.index != -1) {
-    qwk_info.index = close(qwk_info.index);
-  }
-  if (qwk_info.personal != -1) {
-    qwk_info.personal = close(qwk_info.personal);
-  }
-  if (qwk_info.zero != -1) {
-    qwk_info.zero = close(qwk_info.zero);
+  for (const auto& ndx : writer.indexes()) {
+    File ndx_file(FilePath(a()->batch_directory(), ndx.first));
+    if (ndx_file.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite | File::modeTruncate)) {
+      ndx_file.Write(ndx.second);
+    }
   }
   if (!qwk_info.abort) {
     build_control_dat(&qwk_info);
@@ -374,11 +396,6 @@ void make_pre_qwk(int msgnum, struct qwk_junk *qwk_info) {
 }
 
 void put_in_qwk(postrec *m1, const char *fn, int msgnum, struct qwk_junk *qwk_info) {
-  //std::cout << "put_in_qwk: " << m1->title << std::endl;
-  char n[205], d[81], temp[101];
-  char qwk_address[201];
-  char filename[255];
-
   postrec* pr = get_post(msgnum);
   if (pr == nullptr) {
     return;
@@ -389,234 +406,55 @@ void put_in_qwk(postrec *m1, const char *fn, int msgnum, struct qwk_junk *qwk_in
       return;
     }
   }
-  memset(&qwk_info->qwk_rec, ' ', sizeof(qwk_info->qwk_rec));
   messagerec m = (m1->msg);
-  int cur = 0;
 
   string ss;
-  if (!readfile(&m, fn, &ss)) {
+  const string* prefetched_text = qwk_info->prefetched ? qwk_info->prefetched->text(m1->qscan) : nullptr;
+  if (prefetched_text != nullptr) {
+    ss = *prefetched_text;
+  } else if (!readfile(&m, fn, &ss)) {
     bout.bprintf("File not found.");
     bout.nl();
     return;
   }
 
-  long len = ss.length();
-  int p = 0;
-  // n = name...
-  while ((ss[p] != 13) && ((long)p < len) && (p < 200) && !a()->hangup_) {
-    n[p] = ss[p];
-    p++;
-  }
-  n[p] = 0;
-  ++p;
-
-  // if next is ascii 10 (linefeed?) go one more...
-  int p1 = 0;
-  if (ss[p] == 10) {
-    ++p;
-  }
-
-  // d = date
-  while ((ss[p + p1] != 13) && ((long)p + p1 < len) && (p1 < 60) && !a()->hangup_) {
-    d[p1] = ss[(p1) + p];
-    p1++;
-  }
-  d[p1] = 0;
-
-  // ss+cur now is where the text starts
-  cur = p + p1 + 1;
-
-  sprintf(qwk_address, "%s%s", QWKFrom, n);  // Copy wwivnet address to qwk_address
-  if (!strchr(qwk_address, '@')) {
-    sprintf(temp, "@%d", m1->ownersys);
-    strcat(qwk_address, temp);
-  }
-
+  qwk_message_info_t info;
+  info.msgnum = msgnum;
+  info.daten = m1->daten;
+  info.ownersys = m1->ownersys;
   // Took the annonomouse stuff out right here
   if (!qwk_info->in_email) {
-    memcpy(qwk_info->qwk_rec.to, "ALL", 3);
+    info.to = "ALL";
+    info.subject = pr->title;
   } else {
-    strncpy(temp, a()->user()->GetName(), 25);
-    temp[25] = 0;
-    strupr(temp);
-
-    strncpy(qwk_info->qwk_rec.to, temp, 25);
+    info.to = a()->user()->GetName();
+    info.subject = string(qwk_info->email_title, strnlen(qwk_info->email_title, sizeof(qwk_info->email_title)));
   }
-  strncpy(qwk_info->qwk_rec.from, strupr(stripcolors(n)), 25);
+  info.conf_num = static_cast<uint16_t>(a()->current_user_sub().subnum + 1);
 
-  auto dt = DateTime::from_daten(m1->daten);
-  auto date = dt.to_string("%m-%d-%y");
-  // to_char_array uses strncpy_safe which expects buffer to be big enough for
-  // a trailing 0.  Use memcpy instead.
-  memcpy(qwk_info->qwk_rec.date, date.c_str(), sizeof(qwk_info->qwk_rec.date));
- 
-  p = 0;
-  p1 = 0;
+  qwk_text_options_t options;
+  options.remove_color = a()->user()->data.qwk_remove_color;
+  options.convert_color = a()->user()->data.qwk_convert_color;
+  options.keep_routing = a()->user()->data.qwk_keep_routing;
 
-  len = len - cur;
-  if (len <= 0) {
+  string text;
+  if (!ToQwkMessage(ss, info, options, qwk_info->qwk_rec, text)) {
     std::cout << "we have no text for this message." << std::endl;
     return;
   }
-  unique_ptr<char[]> ss_temp = std::make_unique<char[]>(ss.size() + 1);
-  memcpy(ss_temp.get(), &ss[0], len);
-  make_qwk_ready(&ss_temp[cur], &len, qwk_address);
-  ss.assign(ss_temp.get(), cur + len);
-
-  int amount_blocks = ((int)len / sizeof(qwk_info->qwk_rec)) + 2;
-
-  // Save Qwk Record
-  sprintf(qwk_info->qwk_rec.amount_blocks, "%d", amount_blocks);
-  sprintf(qwk_info->qwk_rec.msgnum, "%d", msgnum);
 
+  // Email is indexed in 000.NDX and PERSONAL.NDX, posts in the NDX for the sub.
+  std::vector<string> ndx_names{"000.NDX", "PERSONAL.NDX"};
   if (!qwk_info->in_email) {
-    strncpy(qwk_info->qwk_rec.subject, stripcolors(pr->title), 25);
-  } else {
-    strncpy(qwk_info->qwk_rec.subject,qwk_info->email_title, 25);
+    ndx_names = {StringPrintf("%03d.NDX", a()->current_user_sub().subnum + 1)};
   }
-
-  qwk_remove_null((char *) &qwk_info->qwk_rec, 123);
-  qwk_info->qwk_rec.conf_num = a()->current_user_sub().subnum + 1;
-  qwk_info->qwk_rec.logical_num = qwk_info->qwk_rec_num;
-
-  if (append_block(qwk_info->file, &qwk_info->qwk_rec, sizeof(qwk_info->qwk_rec)) != sizeof(qwk_info->qwk_rec)) {
+  if (!qwk_info->writer->Append(qwk_info->qwk_rec, text, ndx_names)) {
     qwk_info->abort = 1; // Must be out of disk space
     bout.bputs("Write error");
     pausescr();
   }
-
-  // Save Qwk NDX
-  qwk_info->qwk_ndx.pos = static_cast<float>(qwk_info->qwk_rec_pos);
-  float msbin;
-  _fieeetomsbin(&qwk_info->qwk_ndx.pos, &msbin);
-  qwk_info->qwk_ndx.pos = msbin;
-  qwk_info->qwk_ndx.nouse = 0;
-
-  if (!qwk_info->in_email) { // Only if currently doing messages...
-    // Create new index if it hasnt been already
-    if (a()->current_user_sub_num() != static_cast<unsigned int>(qwk_info->cursub) || qwk_info->index < 0) {
-      qwk_info->cursub = a()->current_user_sub_num();
-      sprintf(filename, "%s%03d.NDX", QWK_DIRECTORY, a()->current_user_sub().subnum + 1);
-      if (qwk_info->index > 0) {
-        qwk_info->index = close(qwk_info->index);
-      }
-      qwk_info->index = open(filename, O_RDWR | O_APPEND | O_BINARY | O_CREAT, S_IREAD | S_IWRITE);
-    }
-
-    append_block(qwk_info->index, &qwk_info->qwk_ndx, sizeof(qwk_info->qwk_ndx));
-  } else { // Write to email indexes
-    append_block(qwk_info->zero, &qwk_info->qwk_ndx, sizeof(qwk_info->qwk_ndx));
-    append_block(qwk_info->personal, &qwk_info->qwk_ndx, sizeof(qwk_info->qwk_ndx));
-  }
-
-  // Setup next NDX position
-  qwk_info->qwk_rec_pos += static_cast<uint16_t>(amount_blocks);
-
-  int cur_block = 2;
-  while (cur_block <= amount_blocks && !a()->hangup_) {
-    int this_pos;
-    memset(&qwk_info->qwk_rec, ' ', sizeof(qwk_info->qwk_rec));
-    this_pos = ((cur_block - 2) * sizeof(qwk_info->qwk_rec));
-
-    if (this_pos < len) {
-      size_t size = (this_pos + sizeof(qwk_info->qwk_rec) > static_cast<size_t>(len)) ? (len - this_pos - 1) : sizeof(qwk_info->qwk_rec);
-      memmove(&qwk_info->qwk_rec, ss.data() + cur + this_pos, size);
-    }
-    // Save this block
-    append_block(qwk_info->file, &qwk_info->qwk_rec, sizeof(qwk_info->qwk_rec));
-
-    this_pos += sizeof(qwk_info->qwk_rec);
-    ++cur_block;
-  }
   // Global variable on total amount of records saved
-  ++qwk_info->qwk_rec_num;
-}
-
-// Give us 3000 extra bytes to play with in the message text
-static constexpr int PAD_SPACE = 3000;
-
-// Takes text, deletes all ascii '10' and converts '13' to '227' ()
-// And does other conversions as specified
-void make_qwk_ready(char *text, long *len, char *address) {
-  int pos = 0;
-  int new_pos = 0;
-  unsigned char x;
-  long new_size = *len + PAD_SPACE + 1;
-
-  char* temp = static_cast<char *>(malloc(new_size));
-
-  if (!temp) {
-    sysoplog() << "Couldn't allocate memory to make qwk ready";
-    return;
-  }
-  while (pos < *len && new_pos < new_size && !a()->hangup_) {
-    x = (unsigned char)text[pos];
-    if (x == 0) {
-      break;
-    } else if (x == 13) {
-      temp[new_pos] = '\xE3';
-      ++pos;
-      ++new_pos;
-    } else if (x == 10 || x < 3) {
-    // Strip out Newlines, NULLS, 1's and 2's
-      ++pos;
-    } else if (a()->user()->data.qwk_remove_color && x == 3) {
-      pos += 2;
-    } else if (a()->user()->data.qwk_convert_color && x == 3) {
-      int save_curatr = bout.curatr();
-      bout.curatr(255);
-      // Only convert to ansi if we have memory for it, but still strip heart
-      // code even if we don't have the memory.
-      if (new_pos + 10 < new_size) {
-        const auto ansi_string = wwiv::sdk::ansi::makeansi(text[pos + 1], bout.curatr());
-        temp[new_pos] = 0;
-        strcat(temp, ansi_string.c_str());
-        new_pos = strlen(temp);
-      }
-      pos += 2;
-      bout.curatr(save_curatr);
-    } else if (a()->user()->data.qwk_keep_routing == false && x == 4 && text[pos + 1] == '0') {
-      if (text[pos + 1] == 0) {
-        ++pos;
-      } else { 
-        while (text[pos] != '\xE3' && text[pos] != '\r' && pos < *len && text[pos] != 0 && !a()->hangup_) {
-          ++pos;
-        }
-      }
-      ++pos;
-      if (text[pos] == '\n') {
-        ++pos;
-      }
-    } else if (x == 4 && text[pos + 1] != '0') {
-      pos += 2;
-    } else {
-      temp[new_pos] = x;
-      ++pos;
-      ++new_pos;
-    }
-  }
-
-  temp[new_pos] = 0;
-  strcpy(text, temp);
-  free(temp);
-
-  *len = new_pos;
-
-  // Only add address if it does not yet exist
-  if (!strstr(text, QWKFrom + 2)) { // Don't search for diamond or number, just text after that
-    insert_after_routing(text, address, len);
-  }
-}
-
-void qwk_remove_null(char *memory, int size) {
-  int pos = 0;
-
-  while (pos < size && !a()->hangup_) {
-    if (memory[pos] == 0) {
-      (memory)[pos] = ' ';
-    }
-    ++pos;
-  }
+  qwk_info->qwk_rec_num = qwk_info->writer->next_logical_num();
 }
 
 void build_control_dat(struct qwk_junk *qwk_info) {
@@ -947,37 +785,6 @@ unsigned short select_qwk_protocol(struct qwk_junk *qwk_info) {
   return protocol;
 }
 
-void insert_after_routing(char *text, char *text2insert, long *len) {
-  string temp = stripcolors(text2insert);
-  strcpy(text2insert, temp.c_str());
-
-  int pos = 0;
-  while (pos < *len && text[pos] != 0 && !a()->hangup_) {
-    if (text[pos] == 4 && text[pos + 1] == '0') {
-      while (pos < *len && text[pos] != '\xE3' && !a()->hangup_) {
-        ++pos;
-      }
-
-      if (text[pos] == '\xE3') {
-        ++pos;
-      }
-    } else if (pos < *len) {
-      strcat(text2insert, "\xE3\xE3");
-      int addsize = strlen(text2insert);
-
-      char* dst = text + pos + addsize;
-      char* src = text + pos;
-      long size = (*len) - pos + 1;
-
-      memmove(dst, src, size);
-      strncpy(src, text2insert, addsize);
-
-      *len = (*len) + addsize;
-      return;
-    }
-  }
-}
-
 void close_qwk_cfg(struct qwk_config *qwk_cfg) {
   int x = 0;
   while (x < qwk_cfg->amount_blts) {
@@ -1202,6 +1009,35 @@ void qwk_nscan() {
 #endif  // NEVER
 }
 
+// Packs everything in the QWK directory into qwk_path using the built in zip
+// support.  Returns false if the packet could not be created.
+static bool create_qwk_zip(const string& qwk_path, const string& qwkname) {
+  ZipWriter zip(qwk_path);
+  if (!zip) {
+    return false;
+  }
+  FindFiles files(a()->batch_directory(), "*", FindFilesType::files);
+  for (const auto& f : files) {
+    if (iequals(f.name, qwkname)) {
+      continue;
+    }
+    File file(FilePath(a()->batch_directory(), f.name));
+    if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+      return false;
+    }
+    string contents;
+    contents.resize(static_cast<size_t>(file.length()));
+    if (!contents.empty() &&
+        file.Read(&contents[0], contents.size()) != static_cast<ssize_t>(contents.size())) {
+      return false;
+    }
+    if (!zip.Add(f.name, contents, file.last_write_time())) {
+      return false;
+    }
+  }
+  return zip.Close();
+}
+
 void finish_qwk(struct qwk_junk *qwk_info) {
   char parem1[201], parem2[201];
   char qwkname[201];
@@ -1270,8 +1106,11 @@ void finish_qwk(struct qwk_junk *qwk_info) {
     sprintf(parem1, "%s%s", QWK_DIRECTORY, qwkname);
     sprintf(parem2, "%s*.*", QWK_DIRECTORY);
 
-    string command = stuff_in(a()->arcs[archiver].arca, parem1, parem2, "", "", "");
-    ExecuteExternalProgram(command, a()->spawn_option(SPAWNOPT_ARCH_A));
+    if (!iequals(a()->arcs[archiver].extension, "ZIP") || !create_qwk_zip(parem1, qwkname)) {
+      File::Remove(parem1);
+      string command = stuff_in(a()->arcs[archiver].arca, parem1, parem2, "", "", "");
+      ExecuteExternalProgram(command, a()->spawn_option(SPAWNOPT_ARCH_A));
+    }
 
     qwk_file_to_send = wwiv::strings::StringPrintf("%s%s", QWK_DIRECTORY, qwkname);
     // TODO(rushfan): Should we just have a make abs path?
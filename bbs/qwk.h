@@ -24,6 +24,8 @@
 
 #include "core/datetime.h"
 #include "sdk/vardec.h"
+#include "sdk/qwk/qwk_packet.h"
+#include "sdk/qwk/qwk_prefetch.h"
 #include "printfile.h"
 
 #define QWK_DIRECTORY (a()->batch_directory().c_str())
@@ -36,50 +38,23 @@
 #define BULL_SIZE     81
 #define BNAME_SIZE    13
 
+using wwiv::sdk::qwk::qwk_record;
+using wwiv::sdk::qwk::qwk_index;
 
 #pragma pack(push, 1)
-struct qwk_record {
-  char status;   // ' ' for public
-
-  char msgnum[7]; // all strings are space padded
-  char date[8];
-  char time[5];
-
-  char to[25]; // Uppercase, left justified
-  char from[25]; // Uppercase left justified
-  char subject[25];
-  char password[12];
-  char reference[8];
-
-  char amount_blocks[6];
-  char flag;
-
-  uint16_t conf_num;
-  uint16_t logical_num;
-  char tagline;
-};
-
-
-struct qwk_index {
-  float pos;
-  char nouse;
-};
-
 struct qwk_junk {
+  // Logical number of the next message.
   uint16_t qwk_rec_num;
-  uint16_t qwk_rec_pos;
 
   // File number for the MESSAGES.DAT file
   int file;
 
-  // File number for the *.NDX files
-  int index;
-  int cursub;
-  int personal;  // personal.ndx
-  int zero;      // 000.ndx for email
+  // Buffers writes to MESSAGES.DAT and collects the *.NDX files.
+  wwiv::sdk::qwk::QwkMessagesWriter* writer;
+  // Messages read ahead for the sub being gathered, may be null.
+  const wwiv::sdk::qwk::qwk_prefetched_sub_t* prefetched;
 
   struct qwk_record qwk_rec;
-  struct qwk_index qwk_ndx;
 
   bool abort;
 
@@ -130,15 +105,12 @@ void qwk_gather_sub(int bn, struct qwk_junk *qwk_info);
 void qwk_start_read(int msgnum, struct qwk_junk *qwk_info);
 void make_pre_qwk(int msgnum, struct qwk_junk *qwk_info);
 void put_in_qwk(postrec *m1, const char *fn, int msgnum, struct qwk_junk *qwk_info);
-void make_qwk_ready(char *text, long *len, char *address);
-void qwk_remove_null(char *memory, int size);
 void build_control_dat(struct qwk_junk *qwk_info);
 int _fmsbintoieee(float *src4, float *dest4);
 int _fieeetomsbin(float *src4, float *dest4);
 char* qwk_system_name(char *qwkname);
 void qwk_menu();
 unsigned short select_qwk_protocol(struct qwk_junk *qwk_info);
-void insert_after_routing(char *text, char *text2insert, long *len);
 void close_qwk_cfg(struct qwk_config *qwk_cfg);
 void read_qwk_cfg(struct qwk_config *qwk_cfg);
 void write_qwk_cfg(struct qwk_config *qwk_cfg);
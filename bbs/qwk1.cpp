@@ -148,7 +148,6 @@ void qwk_remove_email() {
 void qwk_gather_email(struct qwk_junk *qwk_info) {
   int i, mfl, curmail;
   bool done = false;
-  char filename[201];
   mailrec m;
   postrec junk;
 
@@ -199,13 +198,9 @@ void qwk_gather_email(struct qwk_junk *qwk_info) {
   curmail = 0;
   done = 0;
   
+  // PERSONAL.NDX and 000.NDX are written by put_in_qwk.
   qwk_info->in_email = 1;
 
-  sprintf(filename, "%sPERSONAL.NDX", QWK_DIRECTORY);
-  qwk_info->personal = open(filename, O_RDWR | O_APPEND | O_BINARY | O_CREAT, S_IREAD | S_IWRITE);
-  sprintf(filename, "%s000.NDX", QWK_DIRECTORY);
-  qwk_info->zero = open(filename, O_RDWR | O_APPEND | O_BINARY | O_CREAT, S_IREAD | S_IWRITE);
-
   do {
     read_same_email(mloc, mw, curmail, m, 0, 0);
 
@@ -870,11 +865,7 @@ void qwk_post_text(char *text, char *title, int sub) {
     p.msg = m;
     p.ownersys = 0;
     p.owneruser = static_cast<uint16_t>(a()->usernum);
-    {
-      a()->status_manager()->Run([&](WStatus& s) {
-        p.qscan = s.IncrementQScanPointer();
-      });
-    }
+    p.qscan = a()->status_manager()->Increment(StatusCounter::qscan_pointer);
     p.daten = daten_t_now();
     if (a()->user()->data.restrict & restrict_validate) {
       p.status = status_unvalidated;
@@ -922,12 +913,8 @@ void qwk_post_text(char *text, char *title, int sub) {
     ++a()->user()->data.msgpost;
     ++a()->user()->data.posttoday;
 
-    {
-      a()->status_manager()->Run([](WStatus& s) {
-        s.IncrementNumLocalPosts();
-        s.IncrementNumMessagesPostedToday();
-      });
-    }
+    a()->status_manager()->Increment(StatusCounter::local_posts);
+    a()->status_manager()->Increment(StatusCounter::posts_today);
 
     close_sub();
 
@@ -865,9 +865,7 @@ void readmail(int mode) {
             }
             p.msg.storage_type = (uint8_t)a()->current_sub().storage_type;
             savefile(b, &(p.msg), a()->current_sub().filename);
-            auto status = a()->status_manager()->BeginTransaction();
-            p.qscan = status->IncrementQScanPointer();
-            a()->status_manager()->CommitTransaction(std::move(status));
+            p.qscan = a()->status_manager()->Increment(StatusCounter::qscan_pointer);
             if (a()->GetNumMessagesInCurrentMessageArea() >=
               a()->current_sub().maxmsgs) {
               i1 = 1;
@@ -884,10 +882,8 @@ void readmail(int mode) {
               delete_message(i2);
             }
             add_post(&p);
-            status = a()->status_manager()->BeginTransaction();
-            status->IncrementNumMessagesPostedToday();
-            status->IncrementNumLocalPosts();
-            a()->status_manager()->CommitTransaction(std::move(status));
+            a()->status_manager()->Increment(StatusCounter::posts_today);
+            a()->status_manager()->Increment(StatusCounter::local_posts);
             close_sub();
             tmp_disable_conf(false);
             iscan(a()->current_user_sub_num());
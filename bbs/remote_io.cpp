@@ -22,6 +22,7 @@
 
 #include <string>
 
+#include "core/os.h"
 #include "core/scope_exit.h"
 #include "core/strings.h"
 #include "core/wwivport.h"
@@ -31,6 +32,18 @@
 // static
 std::string RemoteIO::error_text_;
 
+bool RemoteIO::wait_for_incoming(std::chrono::milliseconds timeout) {
+  const auto poll = std::chrono::milliseconds(10);
+  auto end = std::chrono::steady_clock::now() + timeout;
+  while (!incoming()) {
+    if (std::chrono::steady_clock::now() >= end) {
+      return false;
+    }
+    wwiv::os::sleep_for(poll);
+  }
+  return true;
+}
+
 const std::string RemoteIO::GetLastErrorText() {
 #if defined ( _WIN32 )
   char* error_text;
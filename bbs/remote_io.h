@@ -20,6 +20,7 @@
 #if !defined (__INCLUDED_BBS_REMOTE_IO_H__)
 #define __INCLUDED_BBS_REMOTE_IO_H__
 
+#include <chrono>
 #include <string>
 
 enum class CommunicationType {
@@ -62,6 +63,12 @@ class RemoteIO {
   virtual unsigned int write(const char *buffer, unsigned int count, bool bNoTranslation = false) = 0;
   virtual bool connected() = 0;
   virtual bool incoming() = 0;
+  /**
+   * Waits up to timeout for input to arrive, returning true if there is any.
+   * The default polls incoming(); implementations that can should wake up as
+   * soon as data arrives.
+   */
+  virtual bool wait_for_incoming(std::chrono::milliseconds timeout);
 
   virtual unsigned int GetHandle() const = 0;
   virtual unsigned int GetDoorHandle() const { return GetHandle(); }
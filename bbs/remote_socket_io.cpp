@@ -238,27 +238,29 @@ unsigned int RemoteSocketIO::write(const char *buffer, unsigned int count, bool
   // Early return on invalid sockets.
   if (!valid_socket()) { return 0; }
 
+  if (bNoTranslation || memchr(buffer, CHAR_TELNET_OPTION_IAC, count) == nullptr) {
+    // Nothing to escape, so send the caller's buffer as-is.
+    int num_sent = send(socket_, buffer, count, 0);
+    if (num_sent == SOCKET_ERROR) {
+      return 0;
+    }
+    return num_sent;
+  }
+
+  // There is a #255, so escape the #255's
   unique_ptr<char[]> tmp_buffer = make_unique<char[]>(count * 2 + 100);
-  memset(tmp_buffer.get(), 0, count * 2 + 100);
   int nCount = count;
-
-  if (!bNoTranslation && (memchr(buffer, CHAR_TELNET_OPTION_IAC, count) != nullptr)) {
-    // If there is a #255 then excape the #255's
-    const char* p = buffer;
-    char* p2 = tmp_buffer.get();
-    for (unsigned int i = 0; i < count; i++) {
-      if (*p == CHAR_TELNET_OPTION_IAC && !bNoTranslation) {
-        *p2++ = CHAR_TELNET_OPTION_IAC;
-        *p2++ = CHAR_TELNET_OPTION_IAC;
-        nCount++;
-      } else {
-        *p2++ = *p;
-      }
-      p++;
+  const char* p = buffer;
+  char* p2 = tmp_buffer.get();
+  for (unsigned int i = 0; i < count; i++) {
+    if (*p == CHAR_TELNET_OPTION_IAC) {
+      *p2++ = CHAR_TELNET_OPTION_IAC;
+      *p2++ = CHAR_TELNET_OPTION_IAC;
+      nCount++;
+    } else {
+      *p2++ = *p;
     }
-    *p2++ = '\0';
-  } else {
-    memcpy(tmp_buffer.get(), buffer, count);
+    p++;
   }
 
   int num_sent = send(socket_, tmp_buffer.get(), nCount, 0);
@@ -284,6 +286,15 @@ bool RemoteSocketIO::incoming() {
   return !queue_.empty();
 }
 
+bool RemoteSocketIO::wait_for_incoming(std::chrono::milliseconds timeout) {
+  // Early return on invalid sockets.
+  if (!valid_socket()) { return false; }
+
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait_for(lock, timeout, [this] { return !queue_.empty() || !valid_socket(); });
+  return !queue_.empty();
+}
+
 void RemoteSocketIO::StopThreads() {
   {
     lock_guard<std::mutex> lock(threads_started_mu_);
@@ -386,11 +397,13 @@ void RemoteSocketIO::InboundTelnetProc() {
         // Got Socket error.
         closesocket(socket_);
         socket_ = INVALID_SOCKET;
+        cv_.notify_all();
         return;
       } else if (num_read == 0) {
         // The other side has gracefully closed the socket.
         closesocket(socket_);
         socket_ = INVALID_SOCKET;
+        cv_.notify_all();
         return;
       }
       AddStringToInputBuffer(0, num_read, data.get());
@@ -399,6 +412,7 @@ void RemoteSocketIO::InboundTelnetProc() {
     LOG(ERROR) << "InboundTelnetProc exiting. Caught socket_error: " << e.what();
     closesocket(socket_);
     socket_ = INVALID_SOCKET;
+    cv_.notify_all();
   }
 }
 
@@ -474,4 +488,5 @@ void RemoteSocketIO::AddStringToInputBuffer(int nStart, int nEnd, char *buffer)
       queue_.push(buffer[i]);
     }
   }
+  cv_.notify_all();
 }
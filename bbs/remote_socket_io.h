@@ -23,6 +23,7 @@
 #include "core/net.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <mutex>
 #include <queue>
@@ -77,6 +78,7 @@ class RemoteSocketIO : public RemoteIO {
   unsigned int write(const char *buffer, unsigned int count, bool bNoTranslation = false) override;
   bool connected() override;
   bool incoming() override;
+  bool wait_for_incoming(std::chrono::milliseconds timeout) override;
   void StopThreads();
   void StartThreads();
   unsigned int GetHandle() const;
@@ -90,6 +92,8 @@ class RemoteSocketIO : public RemoteIO {
 
   std::queue<char> queue_;
   mutable std::mutex mu_;
+  // Signalled when input is added to queue_ or the socket is closed.
+  std::condition_variable cv_;
   mutable std::mutex threads_started_mu_;
   SOCKET socket_ = INVALID_SOCKET;
   std::thread read_thread_;
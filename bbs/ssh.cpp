@@ -459,6 +459,11 @@ bool IOSSH::incoming() {
   return io_->incoming();
 }
 
+bool IOSSH::wait_for_incoming(std::chrono::milliseconds timeout) {
+  if (!initialized_) return false;
+  return io_->wait_for_incoming(timeout);
+}
+
 unsigned int IOSSH::GetHandle() const { 
   if (!initialized_) return false;
   return io_->GetHandle();
@@ -85,6 +85,7 @@ public:
   unsigned int write(const char *buffer, unsigned int count, bool bNoTranslation) override;
   bool connected() override;
   bool incoming() override;
+  bool wait_for_incoming(std::chrono::milliseconds timeout) override;
   unsigned int GetHandle() const override;
   unsigned int GetDoorHandle() const override;
 
@@ -380,10 +380,8 @@ static int try_to_ul_wh(const string& orig_file_name) {
 
   a()->user()->SetUploadK(a()->user()->GetUploadK() + bytes_to_k(u.numbytes));
 
-  auto status = a()->status_manager()->BeginTransaction();
-  status->IncrementNumUploadsToday();
-  status->IncrementFileChangedFlag(WStatus::fileChangeUpload);
-  a()->status_manager()->CommitTransaction(std::move(status));
+  a()->status_manager()->Increment(StatusCounter::uploads_today);
+  a()->status_manager()->IncrementFileChangedFlag(WStatus::fileChangeUpload);
   sysoplog() << StringPrintf("+ \"%s\" uploaded on %s", u.filename, a()->directories[dn].name);
   return 0;                                 // This means success
 }
@@ -148,13 +148,15 @@ void voteprint() {
   if (x == nullptr) {
     return;
   }
-  for (int i = 0; i <= nNumUserRecords; i++) {
-    User u;
-    a()->users()->readuser(&u, i);
+  a()->users()->for_each_user([&](int i, User& u) {
+    if (i > nNumUserRecords) {
+      return false;
+    }
     for (int i1 = 0; i1 < 20; i1++) {
       x[ i1 + i * 20 ] = static_cast<char>(u.GetVote(i1));
     }
-  }
+    return true;
+  });
   File votingText(FilePath(a()->config()->gfilesdir(), VOTING_TXT));
   votingText.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile | File::modeText);
   votingText.Write(votingText.full_pathname());
@@ -23,15 +23,23 @@
 #include "bbs/bbs.h"
 
 #include "sdk/filenames.h"
+#include "sdk/qscan.h"
 
 using namespace wwiv::core;
+using namespace wwiv::sdk;
 
-static std::unique_ptr<File> qscanFile;
+// USER.QSC stays mapped between open_qscn and close_qscn, so that callers
+// looping over users with stay_open only map it once.  It's unmapped when
+// closed since wwivconfig may replace the file with a new layout.
+static std::unique_ptr<AllUserQScan> qscans;
 
 static bool open_qscn() {
-  if (!qscanFile) {
-    qscanFile.reset(new File(FilePath(a()->config()->datadir(), USER_QSC)));
-    if (!qscanFile->Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
+  if (!qscans) {
+    const auto* c = a()->config();
+    qscans = std::make_unique<AllUserQScan>(FilePath(c->datadir(), USER_QSC), c->qscn_len(),
+                                            c->max_subs(), c->max_dirs());
+    if (!qscans->IsOpen()) {
+      qscans.reset();
       return false;
     }
   }
@@ -40,8 +48,9 @@ static bool open_qscn() {
 
 
 void close_qscn() {
-  if (qscanFile->IsOpen()) {
-    qscanFile.reset();
+  if (qscans) {
+    qscans->flush();
+    qscans.reset();
   }
 }
 
@@ -58,16 +67,11 @@ void read_qscn(int user_number, uint32_t* qscn, bool stay_open, bool bForceRead)
       return;
     }
   }
-  if (open_qscn()) {
-    long lPos = static_cast<long>(a()->config()->qscn_len()) * static_cast<long>(user_number);
-    if (lPos + static_cast<long>(a()->config()->qscn_len()) <= qscanFile->length()) {
-      qscanFile->Seek(lPos, File::Whence::begin);
-      qscanFile->Read(qscn, a()->config()->qscn_len());
-      if (!stay_open) {
-        close_qscn();
-      }
-      return;
+  if (open_qscn() && qscans->read(user_number, qscn)) {
+    if (!stay_open) {
+      close_qscn();
     }
+    return;
   }
   if (!stay_open) {
     close_qscn();
@@ -92,9 +96,7 @@ void write_qscn(int user_number, uint32_t *qscn, bool stay_open) {
     }
   }
   if (open_qscn()) {
-    auto pos = static_cast<long>(a()->config()->qscn_len()) * static_cast<long>(user_number);
-    qscanFile->Seek(pos, File::Whence::begin);
-    qscanFile->Write(qscn, a()->config()->qscn_len());
+    qscans->write(user_number, qscn);
     if (!stay_open) {
       close_qscn();
     }
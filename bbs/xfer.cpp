@@ -17,6 +17,8 @@
 /*                                                                        */
 /**************************************************************************/
 
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -46,9 +48,11 @@
 #include "bbs/make_abs_cmd.h"
 #include "core/stl.h"
 #include "core/strings.h"
+#include "sdk/files/ext_desc.h"
 
 using std::string;
 using namespace wwiv::core;
+using namespace wwiv::sdk::files;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
 
@@ -58,61 +62,24 @@ static const int INDENTION = 24;
 int foundany;
 daten_t this_date;
 
-static int ed_num, ed_got;
-static ext_desc_rec *ed_info;
+// Extended descriptions for the current directory, and any preloaded
+// for the page being listed.
+static std::unique_ptr<ExtendedDescriptions> ext_descs;
+static std::map<string, string> ext_desc_cache;
 
 using std::string;
 using std::vector;
 
-void zap_ed_info() {
-  if (ed_info) {
-    free(ed_info);
-    ed_info = nullptr;
+static ExtendedDescriptions& ext_descriptions() {
+  if (!ext_descs || ext_descs->filename() != a()->extended_description_filename_) {
+    ext_descs = std::make_unique<ExtendedDescriptions>(a()->extended_description_filename_);
+    ext_desc_cache.clear();
   }
-  ed_num = 0;
-  ed_got = 0;
+  return *ext_descs;
 }
 
-void get_ed_info() {
-  if (ed_got) {
-    return;
-  }
-
-  zap_ed_info();
-  ed_got = 1;
-
-  if (!a()->numf) {
-    return;
-  }
-
-  long lCurFilePos = 0;
-  File fileExtDescr(a()->extended_description_filename_);
-  if (fileExtDescr.Open(File::modeReadOnly | File::modeBinary)) {
-    auto file_size = fileExtDescr.length();
-    if (file_size > 0) {
-      ed_info = static_cast<ext_desc_rec *>(BbsAllocA(static_cast<long>(a()->numf) * sizeof(ext_desc_rec)));
-      if (ed_info == nullptr) {
-        fileExtDescr.Close();
-        return;
-      }
-      ed_num = 0;
-      while (lCurFilePos < file_size && ed_num < a()->numf) {
-        fileExtDescr.Seek(lCurFilePos, File::Whence::begin);
-        ext_desc_type ed;
-        int num_read = fileExtDescr.Read(&ed, sizeof(ext_desc_type));
-        if (num_read == sizeof(ext_desc_type)) {
-          strcpy(ed_info[ed_num].name, ed.name);
-          ed_info[ed_num].offset = lCurFilePos;
-          lCurFilePos += static_cast<long>(ed.len) + sizeof(ext_desc_type);
-          ed_num++;
-        }
-      }
-      if (lCurFilePos < file_size) {
-        ed_got = 2;
-      }
-    }
-    fileExtDescr.Close();
-  }
+void zap_ed_info() {
+  ext_desc_cache.clear();
 }
 
 unsigned long bytes_to_k(unsigned long lBytes) {
@@ -364,100 +331,28 @@ void dliscan() {
 }
 
 void add_extended_description(const string& file_name, const string& description) {
-  ext_desc_type ed;
-
-  strcpy(ed.name, file_name.c_str());
-  ed.len = static_cast<int16_t>(description.size());
-
-  File file(a()->extended_description_filename_);
-  file.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile);
-  file.Seek(0L, File::Whence::end);
-  file.Write(&ed, sizeof(ext_desc_type));
-  file.Write(description.c_str(), ed.len);
-  file.Close();
-
+  ext_descriptions().Add(file_name, description);
   zap_ed_info();
 }
 
 void delete_extended_description(const string& file_name) {
-  ext_desc_type ed;
-
-  File fileExtDescr(a()->extended_description_filename_);
-  fileExtDescr.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite);
-  auto file_size = fileExtDescr.length();
-  long r = 0, w = 0;
-  while (r < file_size) {
-    fileExtDescr.Seek(r, File::Whence::begin);
-    fileExtDescr.Read(&ed, sizeof(ext_desc_type));
-    if (ed.len < 10000) {
-      auto ss = std::make_unique<char[]>(ed.len);
-      fileExtDescr.Read(ss.get(), ed.len);
-      if (file_name != ed.name) {
-        if (r != w) {
-          fileExtDescr.Seek(w, File::Whence::begin);
-          fileExtDescr.Write(&ed, sizeof(ext_desc_type));
-          fileExtDescr.Write(ss.get(), ed.len);
-        }
-        w += sizeof(ext_desc_type) + ed.len;
-      }
-    }
-    r += sizeof(ext_desc_type) + ed.len;
-  }
-  fileExtDescr.set_length(w);
-  fileExtDescr.Close();
+  ext_descriptions().Remove(file_name);
   zap_ed_info();
 }
 
 string read_extended_description(const string& file_name) {
-  get_ed_info();
-
-  if (ed_got && ed_info) {
-    for (int i = 0; i < ed_num; i++) {
-      if (file_name == ed_info[i].name) {
-        File fileExtDescr(a()->extended_description_filename_);
-        if (!fileExtDescr.Open(File::modeBinary | File::modeReadOnly)) {
-          return nullptr;
-        }
-        fileExtDescr.Seek(ed_info[i].offset, File::Whence::begin);
-        ext_desc_type ed;
-        int num_read = fileExtDescr.Read(&ed, sizeof(ext_desc_type));
-        if (num_read == sizeof(ext_desc_type) && file_name == ed.name) {
-          string ss;
-          ss.resize(ed.len);
-          fileExtDescr.Read(&ss[0], ed.len);
-          fileExtDescr.Close();
-          return ss;
-        } else {
-          zap_ed_info();
-          fileExtDescr.Close();
-          break;
-        }
-      }
-    }
-  }
-  if (ed_got != 1) {
-    File fileExtDescr(a()->extended_description_filename_);
-    if (fileExtDescr.Open(File::modeBinary | File::modeReadOnly)) {
-      auto file_size = fileExtDescr.length();
-      long lCurPos = 0;
-      while (lCurPos < file_size) {
-        fileExtDescr.Seek(lCurPos, File::Whence::begin);
-        ext_desc_type ed;
-        lCurPos += static_cast<long>(fileExtDescr.Read(&ed, sizeof(ext_desc_type)));
-        if (file_name == ed.name) {
-          string ss;
-          ss.resize(ed.len);
-          fileExtDescr.Read(&ss[0], ed.len);
-          fileExtDescr.Close();
-          return ss;
-        } else {
-          lCurPos += static_cast<long>(ed.len);
-        }
-      }
-      fileExtDescr.Close();
-    }
+  auto& ed = ext_descriptions();
+  auto it = ext_desc_cache.find(file_name);
+  if (it != ext_desc_cache.end()) {
+    return it->second;
   }
-  return "";
+  string ss;
+  ed.Read(file_name, &ss);
+  return ss;
+}
+
+void preload_extended_descriptions(const vector<string>& file_names) {
+  ext_desc_cache = ext_descriptions().Read(file_names);
 }
 
 void print_extended(const char *file_name, bool *abort, int numlist, int indent) {
@@ -765,16 +660,13 @@ void nscandir(uint16_t nDirNum, bool& need_title, bool *abort) {
       a()->set_current_user_dir_num(nOldCurDir);
       return;
     }
-    File fileDownload(a()->download_filename_);
-    fileDownload.Open(File::modeBinary | File::modeReadOnly);
-    for (int i = 1; i <= a()->numf && !(*abort) && !a()->hangup_; i++) {
+    const auto files = a()->file_catalog()->area(a()->current_dir().filename);
+    for (const auto& f : *files) {
+      if (*abort || a()->hangup_) {
+        break;
+      }
       CheckForHangup();
-      FileAreaSetRecord(fileDownload, i);
-      uploadsrec u;
-      fileDownload.Read(&u, sizeof(uploadsrec));
-      if (u.daten >= a()->context().nscandate()) {
-        fileDownload.Close();
-
+      if (f.daten >= a()->context().nscandate()) {
         if (need_title) {
           if (bout.lines_listed() >= a()->screenlinest - 7 && !a()->filelist.empty()) {
             tag_files(need_title);
@@ -785,13 +677,12 @@ void nscandir(uint16_t nDirNum, bool& need_title, bool *abort) {
           }
         }
 
+        auto u = f;
         printinfo(&u, abort);
-        fileDownload.Open(File::modeBinary | File::modeReadOnly);
       } else if (bkbhit()) {
         checka(abort);
       }
     }
-    fileDownload.Close();
   }
   a()->set_current_user_dir_num(nOldCurDir);
 }
@@ -873,59 +764,44 @@ void searchall() {
   bout.nl();
   bout << "|#2Searching ";
   bout.clear_lines_listed();
-  int count = 0;
-  int color = 3;
-  for (uint16_t i = 0; i < a()->directories.size() && !abort && !a()->hangup_
-       && a()->udir[i].subnum != -1; i++) {
-    int nDirNum = a()->udir[i].subnum;
-    bool bIsDirMarked = false;
-    if (a()->context().qsc_n[nDirNum / 32] & (1L << (nDirNum % 32))) {
-      bIsDirMarked = true;
-    }
-    bIsDirMarked = true;
-    // remove bIsDirMarked=true to search only marked a()->directories
-    if (bIsDirMarked) {
-      count++;
-      bout.Color(color);
-      bout << ".";
-      if (count >= NUM_DOTS) {
-        bout << "\r" << "|#2Searching ";
-        color++;
-        count = 0;
-        if (color == 4) {
-          color++;
-        }
-        if (color == 10) {
-          color = 0;
-        }
-      }
-      a()->set_current_user_dir_num(i);
+
+  // Search every directory from the file catalog at once, then list the
+  // matches a directory at a time.
+  vector<string> areas;
+  vector<uint16_t> udirs;
+  for (uint16_t i = 0; i < a()->directories.size() && a()->udir[i].subnum != -1; i++) {
+    areas.emplace_back(a()->directories[a()->udir[i].subnum].filename);
+    udirs.push_back(i);
+  }
+  const auto matches = a()->file_catalog()->Search(areas, [&filemask](const uploadsrec& u) {
+    return compare(filemask.c_str(), u.filename);
+  });
+
+  bool need_title = true;
+  int current_area = -1;
+  for (const auto& m : matches) {
+    if (abort || a()->hangup_) {
+      break;
+    }
+    if (m.area != current_area) {
+      current_area = m.area;
+      a()->set_current_user_dir_num(udirs[m.area]);
       dliscan();
-      bool need_title = true;
-      File fileDownload(a()->download_filename_);
-      fileDownload.Open(File::modeBinary | File::modeReadOnly);
-      for (int i1 = 1; i1 <= a()->numf && !abort && !a()->hangup_; i1++) {
-        FileAreaSetRecord(fileDownload, i1);
-        uploadsrec u;
-        fileDownload.Read(&u, sizeof(uploadsrec));
-        if (compare(filemask.c_str(), u.filename)) {
-          fileDownload.Close();
-          if (need_title) {
-            if (bout.lines_listed() >= a()->screenlinest - 7 && !a()->filelist.empty()) {
-              tag_files(need_title);
-            }
-            if (need_title) {
-              printtitle(&abort);
-              need_title = false;
-            }
-          }
-          printinfo(&u, &abort);
-          fileDownload.Open(File::modeBinary | File::modeReadOnly);
-        } else if (bkbhit()) {
-          checka(&abort);
-        }
+      need_title = true;
+    }
+    if (need_title) {
+      if (bout.lines_listed() >= a()->screenlinest - 7 && !a()->filelist.empty()) {
+        tag_files(need_title);
       }
-      fileDownload.Close();
+      if (need_title) {
+        printtitle(&abort);
+        need_title = false;
+      }
+    }
+    auto u = m.u;
+    printinfo(&u, &abort);
+    if (bkbhit()) {
+      checka(&abort);
     }
   }
   a()->set_current_user_dir_num(nOldCurDir);
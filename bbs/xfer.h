@@ -19,9 +19,9 @@
 #define __INCLUDED_BBS_XFER_H__
 
 #include <string>
+#include <vector>
 
 void zap_ed_info();
-void get_ed_info();
 unsigned long bytes_to_k(unsigned long lBytes);
 int  check_batch_queue(const char *file_name);
 bool check_ul_event(int directory_num, uploadsrec * upload_record);
@@ -36,6 +36,7 @@ void dliscan();
 void add_extended_description(const std::string& file_name, const std::string& description);
 void delete_extended_description(const std::string&file_name);
 std::string read_extended_description(const std::string& file_name);
+void preload_extended_descriptions(const std::vector<std::string>& file_names);
 void print_extended(const char *file_name, bool *abort, int numlist, int indent);
 void align(char *file_name);
 void align(std::string* file_name);
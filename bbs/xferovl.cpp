@@ -497,10 +497,8 @@ static bool upload_file(const std::string& file_name, uint16_t directory_num, co
     FileAreaSetRecord(fileDownload, 0);
     fileDownload.Write(&u1, sizeof(uploadsrec));
     fileDownload.Close();
-    auto status = a()->status_manager()->BeginTransaction();
-    status->IncrementNumUploadsToday();
-    status->IncrementFileChangedFlag(WStatus::fileChangeUpload);
-    a()->status_manager()->CommitTransaction(std::move(status));
+    a()->status_manager()->Increment(StatusCounter::uploads_today);
+    a()->status_manager()->IncrementFileChangedFlag(WStatus::fileChangeUpload);
     sysoplog() << "+ '" << u.filename << "' uploaded on " << d.name;
     a()->UpdateTopScreen();
   }
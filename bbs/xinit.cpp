@@ -57,6 +57,7 @@
 #include "sdk/status.h"
 
 #include "sdk/config.h"
+#include "sdk/config_snapshot.h"
 #include "sdk/filenames.h"
 #include "sdk/msgapi/message_api_wwiv.h"
 #include "sdk/msgapi/msgapi.h"
@@ -401,8 +402,9 @@ bool Application::ReadConfig() {
   }
 
   // initialize the user manager
-  user_manager_.reset(new UserManager(*config_));
+  user_manager_.reset(new UserManager(*config_, true));
   statusMgr.reset(new StatusMgr(config_->datadir(), StatusManagerCallback));
+  file_catalog_.reset(new wwiv::sdk::files::FileCatalog(config_->datadir()));
 
   IniFile ini(FilePath(bbsdir(), WWIV_INI), {StrCat("WWIV-", instance_number()), INI_TAG});
   if (!ini.IsOpen()) {
@@ -628,6 +630,41 @@ void Application::read_gfile() {
   }
 }
 
+template <typename T>
+static void assign_table(std::vector<T>& to, std::vector<T>& from, std::size_t max_records) {
+  if (max_records != 0 && from.size() > max_records) {
+    from.resize(max_records);
+  }
+  to = std::move(from);
+}
+
+bool Application::read_config_snapshot() {
+  wwiv::sdk::ConfigSnapshot snapshot(config()->datadir());
+  wwiv::sdk::config_tables_t t;
+  if (!snapshot.Load(t)) {
+    return false;
+  }
+  subs_.reset(new wwiv::sdk::Subs(config_->datadir(), net_networks));
+  subs_->set_subs(std::move(t.subs));
+  // Use the same limits as the read_* functions.
+  assign_table(directories, t.dirs, config()->max_dirs());
+  assign_table(chains, t.chains, max_chains);
+  assign_table(gfilesec, t.gfiles, max_gfilesec);
+  assign_table(arcs, t.arcs, MAX_ARCS);
+  assign_table(editors, t.editors, 10);
+  assign_table(externs, t.externs, 15);
+  assign_table(over_intern, t.over_intern, 3);
+  if (HasConfigFlag(OP_FLAGS_CHAIN_REG)) {
+    if (t.chains_reg.empty() && !chains.empty()) {
+      // read_chains creates chains.reg when it's missing.
+      read_chains();
+    } else {
+      assign_table(chains_reg, t.chains_reg, max_chains);
+    }
+  }
+  return true;
+}
+
 void Application::InitializeBBS() {
   Cls();
   std::clog << std::endl
@@ -686,36 +723,39 @@ void Application::InitializeBBS() {
   status->EnsureCallerNumberIsValid();
   statusMgr->CommitTransaction(std::move(status));
 
-  VLOG(1) << "Reading Gfiles.";
-  read_gfile();
-
   VLOG(1) << "Reading user names.";
   if (!read_names()) {
     AbortBBS();
   }
 
-  VLOG(1) << "Reading Message Areas.";
-  if (!read_subs()) {
-    AbortBBS();
-  }
+  VLOG(1) << "Reading configuration snapshot.";
+  if (!read_config_snapshot()) {
+    VLOG(1) << "Reading Gfiles.";
+    read_gfile();
 
-  VLOG(1) << "Reading File Areas.";
-  if (!read_dirs()) {
-    AbortBBS();
-  }
+    VLOG(1) << "Reading Message Areas.";
+    if (!read_subs()) {
+      AbortBBS();
+    }
+
+    VLOG(1) << "Reading File Areas.";
+    if (!read_dirs()) {
+      AbortBBS();
+    }
 
-  VLOG(1) << "Reading Chains.";
-  read_chains();
+    VLOG(1) << "Reading Chains.";
+    read_chains();
 
-  VLOG(1) << "Reading File Transfer Protocols.";
-  read_nextern();
-  read_nintern();
+    VLOG(1) << "Reading File Transfer Protocols.";
+    read_nextern();
+    read_nintern();
 
-  VLOG(1) << "Reading File Archivers.";
-  read_arcs();
+    VLOG(1) << "Reading File Archivers.";
+    read_arcs();
 
-  VLOG(1) << "Reading Full Screen Message Editors.";
-  read_editors();
+    VLOG(1) << "Reading Full Screen Message Editors.";
+    read_editors();
+  }
 
   if (!File::mkdirs(attach_dir_)) {
     LOG(ERROR) << "Your file attachment directory is invalid.";
@@ -59,3 +59,44 @@ TEST_F(BPutchTest, MultipleLetters) {
   EXPECT_EQ(kHelloWorld.size(), Puts(kHelloWorld));
   EXPECT_EQ(kHelloWorld, helper.io()->captured());
 }
+
+TEST_F(BPutchTest, Headless_NoLocalOutput) {
+  bout.set_headless(true);
+  const string kHelloWorld = "Hello World\r\n";
+  EXPECT_EQ(kHelloWorld.size(), Puts(kHelloWorld));
+  EXPECT_EQ("", helper.io()->captured());
+  EXPECT_FALSE(helper.io()->rcaptured().empty());
+  bout.set_headless(false);
+}
+
+TEST_F(BPutchTest, Headless_SameAsLocal) {
+  // bout is shared by all tests, so start both runs on a fresh line.
+  auto start = [&]() {
+    bout.reset();
+    bout.bputch('\n');
+    bout.clear_lines_listed();
+    bout.clear_ansi_movement_occurred();
+    helper.io()->Clear();
+  };
+  const string s = "\x1b[0;31mHello\tWorld\r\nAB\x1b[1mC\x1b[2;5HD";
+  start();
+  Puts(s);
+  const auto remote = helper.io()->rcaptured();
+  const auto x = bout.wherex();
+  const auto attr = bout.curatr();
+  const auto lines = bout.lines_listed();
+  const auto line = bout.SaveCurrentLine();
+  ASSERT_TRUE(bout.ansi_movement_occurred());
+
+  start();
+  bout.set_headless(true);
+  Puts(s);
+  EXPECT_EQ(remote, helper.io()->rcaptured());
+  EXPECT_EQ("", helper.io()->captured());
+  EXPECT_EQ(x, bout.wherex());
+  EXPECT_EQ(attr, bout.curatr());
+  EXPECT_EQ(lines, bout.lines_listed());
+  EXPECT_EQ(line.line, bout.SaveCurrentLine().line);
+  EXPECT_TRUE(bout.ansi_movement_occurred());
+  bout.set_headless(false);
+}
@@ -18,6 +18,7 @@
 /**************************************************************************/
 #include "gtest/gtest.h"
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -27,10 +28,12 @@
 #include "bbs_test/bbs_helper.h"
 #include "core/strings.h"
 #include "core_test/file_helper.h"
+#include "sdk/ansi/framebuffer.h"
 
 using std::cout;
 using std::endl;
 using std::string;
+using namespace wwiv::strings;
 
 class BPutsTest : public ::testing::Test {
 protected:
@@ -45,6 +48,17 @@ protected:
 
     }
 
+    // Displays line count times and returns what was sent to the remote.
+    string PutLines(const string& line, int count, bool headless) {
+      helper.io()->Clear();
+      bout.set_headless(headless);
+      for (int i = 0; i < count; i++) {
+        bout.bputs(line);
+      }
+      bout.set_headless(false);
+      return helper.io()->rcaptured();
+    }
+
     BbsHelper helper;
 };
 
@@ -106,3 +120,54 @@ TEST_F(BPutsTest, RepeatedPipe_WithEndLine) {
   EXPECT_EQ(kAnsiHelloWorldUnix, helper.io()->rcaptured());
 #endif
 }
+
+TEST_F(BPutsTest, PutsXY) {
+  wwiv::sdk::ansi::FrameBuffer screen(80);
+  screen.curatr(7);
+  bout.PutsXY(screen, 2, 1, "|#1A|12B|17C\x03" "2D|E");
+  EXPECT_EQ("ABCD|E", screen.row_as_text(1).substr(2));
+  // User color 1.
+  EXPECT_EQ(11, screen.cell(2, 1).a());
+  EXPECT_EQ(12, screen.cell(3, 1).a());
+  // Background 1, keeping the foreground.
+  EXPECT_EQ(0x1c, screen.cell(4, 1).a());
+  // User color 2.
+  EXPECT_EQ(14, screen.cell(5, 1).a());
+  EXPECT_EQ('|', screen.cell(6, 1).c());
+  // Nothing was sent to the session.
+  EXPECT_TRUE(helper.io()->rcaptured().empty());
+}
+
+// A line with a color change every few words.
+static string ColorfulLine() {
+  string line;
+  for (int i = 0; i < 8; i++) {
+    line += StrCat("|#", i, "Line of text with some pipe colors |16");
+  }
+  return line + "\r\n";
+}
+
+TEST_F(BPutsTest, Headless_SameRemoteOutput) {
+  const auto line = ColorfulLine();
+  const auto local = PutLines(line, 10, false);
+  const auto headless = PutLines(line, 10, true);
+  EXPECT_FALSE(local.empty());
+  EXPECT_EQ(local, headless);
+}
+
+// Reports the bputs throughput with and without the local screen.  Run with
+// --gtest_also_run_disabled_tests.
+TEST_F(BPutsTest, DISABLED_Benchmark_Headless) {
+  const auto line = ColorfulLine();
+  const int kLines = 5000;
+  const auto size = line.size() * kLines;
+  for (const auto headless : {false, true}) {
+    auto start = std::chrono::steady_clock::now();
+    PutLines(line, kLines, headless);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    std::cout << (headless ? "Headless: " : "Local:    ") << size << " bytes in " << elapsed
+              << "us (" << (elapsed ? size * 1000000 / elapsed : 0) << " bytes/sec)" << std::endl;
+  }
+}
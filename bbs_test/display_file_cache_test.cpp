@@ -0,0 +1,147 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "bbs/display_file_cache.h"
+#include "core/file.h"
+#include "core/strings.h"
+#include "core_test/file_helper.h"
+
+using std::string;
+using namespace wwiv::bbs;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+class DisplayFileCacheTest : public ::testing::Test {
+protected:
+  string CreateFile(const string& name, const string& contents) {
+    const auto path = FilePath(helper_.TempDir(), name);
+    File f(path);
+    f.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite | File::modeTruncate);
+    f.Write(contents);
+    return path;
+  }
+
+  // Make the file and directory look old so entries are not considered racy.
+  void MakeOld(const string& path) {
+    File(path).set_last_write_time(time(nullptr) - 60);
+    File(helper_.TempDir()).set_last_write_time(time(nullptr) - 60);
+  }
+
+  FileHelper helper_;
+};
+
+TEST_F(DisplayFileCacheTest, Load) {
+  const auto path = CreateFile("logon.msg", "|#1Hello\r\nWorld\r\n\x1b[0m\r\n");
+  auto f = DisplayFile::Load(path);
+  ASSERT_TRUE(f != nullptr);
+  ASSERT_EQ(3u, f->lines().size());
+
+  const auto& first = f->lines()[0];
+  ASSERT_EQ(2u, first.tokens.size());
+  EXPECT_EQ(pipe_token_type_t::user_color, first.tokens[0].type);
+  EXPECT_EQ("Hello\r\n", first.tokens[1].text);
+  EXPECT_FALSE(first.has_ansi);
+  EXPECT_EQ("World\r\n", f->lines()[1].tokens[0].text);
+  EXPECT_TRUE(f->lines()[2].has_ansi);
+}
+
+TEST_F(DisplayFileCacheTest, Load_StopsAtControlZ) {
+  const auto path = CreateFile("logon.ans", "one\r\ntwo\x1aSAUCE\r\nthree\r\n");
+  auto f = DisplayFile::Load(path);
+  ASSERT_TRUE(f != nullptr);
+  ASSERT_EQ(2u, f->lines().size());
+  EXPECT_EQ("two\x1aSAUCE\r\n", f->lines()[1].tokens[0].text);
+}
+
+TEST_F(DisplayFileCacheTest, Load_Empty) {
+  const auto path = CreateFile("empty.msg", "");
+  auto f = DisplayFile::Load(path);
+  ASSERT_TRUE(f != nullptr);
+  EXPECT_TRUE(f->empty());
+}
+
+TEST_F(DisplayFileCacheTest, Get_Missing) {
+  DisplayFileCache cache;
+  EXPECT_TRUE(cache.Get(FilePath(helper_.TempDir(), "missing.msg")) == nullptr);
+  EXPECT_TRUE(cache.Get(helper_.TempDir()) == nullptr);
+}
+
+TEST_F(DisplayFileCacheTest, Get_Cached) {
+  const auto path = CreateFile("logon.msg", "Hello\r\n");
+  MakeOld(path);
+
+  DisplayFileCache cache;
+  auto f = cache.Get(path);
+  ASSERT_TRUE(f != nullptr);
+  EXPECT_EQ(f, cache.Get(path));
+  EXPECT_EQ(1, cache.loads());
+}
+
+TEST_F(DisplayFileCacheTest, Get_ReloadsOnChange) {
+  const auto path = CreateFile("logon.msg", "Hello\r\n");
+  MakeOld(path);
+  DisplayFileCache cache;
+  auto f = cache.Get(path);
+  ASSERT_TRUE(f != nullptr);
+
+  CreateFile("logon.msg", "Hello\r\nWorld\r\n");
+  auto f2 = cache.Get(path);
+  ASSERT_TRUE(f2 != nullptr);
+  EXPECT_EQ(2u, f2->lines().size());
+  // The old copy is still usable by whoever holds it.
+  EXPECT_EQ(1u, f->lines().size());
+  EXPECT_EQ(2, cache.loads());
+
+  File::Remove(path);
+  EXPECT_TRUE(cache.Get(path) == nullptr);
+}
+
+TEST_F(DisplayFileCacheTest, Resolve) {
+  const std::vector<string> candidates{FilePath(helper_.TempDir(), "one.ans"),
+                                       FilePath(helper_.TempDir(), "one.msg")};
+  DisplayFileCache cache;
+  EXPECT_EQ("", cache.Resolve(candidates));
+
+  const auto msg = CreateFile("one.msg", "msg");
+  EXPECT_EQ(msg, cache.Resolve(candidates));
+  const auto ans = CreateFile("one.ans", "ans");
+  EXPECT_EQ(ans, cache.Resolve(candidates));
+}
+
+TEST_F(DisplayFileCacheTest, Resolve_Cached) {
+  const auto msg = CreateFile("one.msg", "msg");
+  MakeOld(msg);
+  const std::vector<string> candidates{FilePath(helper_.TempDir(), "one.ans"), msg};
+
+  DisplayFileCache cache;
+  EXPECT_EQ(msg, cache.Resolve(candidates));
+  EXPECT_EQ(msg, cache.Resolve(candidates));
+  EXPECT_EQ(1, cache.probes());
+
+  // Adding a file changes the directory, so the candidates are checked again.
+  const auto ans = CreateFile("one.ans", "ans");
+  File(helper_.TempDir()).set_last_write_time(time(nullptr) - 30);
+  EXPECT_EQ(ans, cache.Resolve(candidates));
+  EXPECT_EQ(2, cache.probes());
+}
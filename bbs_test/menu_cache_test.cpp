@@ -0,0 +1,146 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bbs/menu_cache.h"
+#include "core/file.h"
+#include "core/strings.h"
+#include "core_test/file_helper.h"
+
+using std::string;
+using namespace wwiv::core;
+using namespace wwiv::menus;
+using namespace wwiv::strings;
+
+class MenuCacheTest : public ::testing::Test {
+protected:
+  string CreateMenu(const string& name, const std::vector<MenuRec>& items,
+                    const string& enter_script = "") {
+    MenuHeader h{};
+    to_char_array(h.szScript, enter_script);
+    string contents(reinterpret_cast<const char*>(&h), sizeof(MenuHeader));
+    for (const auto& m : items) {
+      contents.append(reinterpret_cast<const char*>(&m), sizeof(MenuRec));
+    }
+    const auto base = FilePath(helper_.TempDir(), name);
+    File f(StrCat(base, ".mnu"));
+    f.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite | File::modeTruncate);
+    f.Write(contents);
+    return base;
+  }
+
+  static MenuRec item(const string& key, const string& execute, uint8_t flags = 0) {
+    MenuRec m{};
+    to_char_array(m.szKey, key);
+    to_char_array(m.szExecute, execute);
+    m.nFlags = flags;
+    return m;
+  }
+
+  FileHelper helper_;
+};
+
+TEST_F(MenuCacheTest, Compile) {
+  const auto base = CreateMenu(
+      "main", {item("G", "LogOff"), item("R", "SetMsgReadDate~ReadMessages"),
+               item("R", "PrintFile R.MSG"), item("X", "Bye", MENU_FLAG_DELETED)},
+      "SetSubNumber 1");
+  auto m = CompiledMenu::Compile(base);
+  ASSERT_TRUE(m != nullptr);
+
+  ASSERT_EQ(1u, m->enter_script().size());
+  EXPECT_EQ("SetSubNumber", m->enter_script().front().cmd);
+  EXPECT_EQ("1", m->enter_script().front().param1);
+  EXPECT_TRUE(m->exit_script().empty());
+  EXPECT_EQ("|09Command? ", m->prompt());
+
+  auto r = m->items("R");
+  ASSERT_EQ(2u, r.size());
+  ASSERT_EQ(2u, r[0]->script.size());
+  EXPECT_EQ("SetMsgReadDate", r[0]->script[0].cmd);
+  EXPECT_EQ("ReadMessages", r[0]->script[1].cmd);
+  ASSERT_EQ(1u, r[1]->script.size());
+  EXPECT_EQ("PrintFile", r[1]->script[0].cmd);
+  EXPECT_EQ("R.MSG", r[1]->script[0].param1);
+  EXPECT_TRUE(m->items("Z").empty());
+
+  // Deleted items are not displayed, and a key is displayed using its first item.
+  auto d = m->display_items();
+  ASSERT_EQ(3u, d.size());
+  EXPECT_STREQ("G", d[0]->rec.szKey);
+  EXPECT_EQ(r[0], d[1]);
+  EXPECT_EQ(r[0], d[2]);
+}
+
+TEST_F(MenuCacheTest, PromptAndHelpFiles) {
+  const auto base = CreateMenu("main", {item("G", "LogOff")});
+  helper_.CreateTempFile("main.pro", "|#2Main: .end.ignored");
+  helper_.CreateTempFile("main.ans", "ansi");
+  auto m = CompiledMenu::Compile(base);
+  ASSERT_TRUE(m != nullptr);
+
+  EXPECT_EQ("|#2Main: ", m->prompt());
+  EXPECT_TRUE(m->has_help_file("ans"));
+  EXPECT_FALSE(m->has_help_file("b&w"));
+}
+
+TEST_F(MenuCacheTest, Missing) {
+  EXPECT_TRUE(CompiledMenu::Compile(FilePath(helper_.TempDir(), "missing")) == nullptr);
+  MenuCache cache;
+  EXPECT_TRUE(cache.Get(FilePath(helper_.TempDir(), "missing")) == nullptr);
+}
+
+TEST_F(MenuCacheTest, Get_ReloadsOnChange) {
+  const auto base = CreateMenu("main", {item("G", "LogOff")});
+  MenuCache cache;
+  auto m = cache.Get(base);
+  ASSERT_TRUE(m != nullptr);
+  ASSERT_EQ(1u, m->items("G").size());
+  EXPECT_EQ(1, cache.loads());
+
+  // Changing the size of the menu must always be noticed.
+  CreateMenu("main", {item("G", "LogOff"), item("A", "AutoMessage")});
+  auto m2 = cache.Get(base);
+  ASSERT_TRUE(m2 != nullptr);
+  EXPECT_EQ(1u, m2->items("A").size());
+  // The old copy is still usable by whoever holds it.
+  EXPECT_TRUE(m->items("A").empty());
+
+  cache.InvalidateAll();
+  cache.Get(base);
+  EXPECT_EQ(3, cache.loads());
+}
+
+TEST_F(MenuCacheTest, Get_Cached) {
+  const auto base = CreateMenu("main", {item("G", "LogOff")});
+  // Make the files look old so the entry is not considered racy.
+  File mnu(StrCat(base, ".mnu"));
+  mnu.set_last_write_time(time(nullptr) - 60);
+  File(helper_.TempDir()).set_last_write_time(time(nullptr) - 60);
+
+  MenuCache cache;
+  auto m = cache.Get(base);
+  auto m2 = cache.Get(base);
+  EXPECT_EQ(m, m2);
+  EXPECT_EQ(1, cache.loads());
+}
@@ -0,0 +1,118 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "bbs/pipe_codes.h"
+
+using std::string;
+using namespace wwiv::bbs;
+
+TEST(PipeCodesTest, Text) {
+  auto t = TokenizePipeCodes("Hello World\r\n");
+  ASSERT_EQ(1u, t.size());
+  EXPECT_EQ(pipe_token_type_t::text, t[0].type);
+  EXPECT_EQ("Hello World\r\n", t[0].text);
+}
+
+TEST(PipeCodesTest, Empty) {
+  EXPECT_TRUE(TokenizePipeCodes("").empty());
+}
+
+TEST(PipeCodesTest, PipeColors) {
+  auto t = TokenizePipeCodes("|09Hi|#2|17x|5");
+  ASSERT_EQ(6u, t.size());
+  EXPECT_EQ(pipe_token_type_t::pipe_color, t[0].type);
+  EXPECT_EQ(9, t[0].value);
+  EXPECT_EQ("Hi", t[1].text);
+  EXPECT_EQ(pipe_token_type_t::user_color, t[2].type);
+  EXPECT_EQ(2, t[2].value);
+  EXPECT_EQ(pipe_token_type_t::pipe_color, t[3].type);
+  EXPECT_EQ(17, t[3].value);
+  EXPECT_EQ("x", t[4].text);
+  // A single digit is still a pipe color.
+  EXPECT_EQ(pipe_token_type_t::pipe_color, t[5].type);
+  EXPECT_EQ(5, t[5].value);
+}
+
+TEST(PipeCodesTest, NotAPipeCode) {
+  auto t = TokenizePipeCodes("a|b|");
+  ASSERT_EQ(1u, t.size());
+  EXPECT_EQ("a|b|", t[0].text);
+}
+
+TEST(PipeCodesTest, Macros) {
+  auto t = TokenizePipeCodes("Hi |@N\x0fxU!");
+  ASSERT_EQ(4u, t.size());
+  EXPECT_EQ("Hi ", t[0].text);
+  EXPECT_EQ(pipe_token_type_t::macro, t[1].type);
+  EXPECT_EQ('N', t[1].value);
+  EXPECT_EQ(pipe_token_type_t::macro, t[2].type);
+  EXPECT_EQ('U', t[2].value);
+  EXPECT_EQ("!", t[3].text);
+}
+
+TEST(PipeCodesTest, HeartCodes) {
+  auto t = TokenizePipeCodes("\x03" "1a\x03\x01" "b\x03");
+  ASSERT_EQ(2u, t.size());
+  EXPECT_EQ(pipe_token_type_t::user_color, t[0].type);
+  EXPECT_EQ(1, t[0].value);
+  // Heart codes followed by a control character are dropped, and one at the
+  // end is displayed.
+  EXPECT_EQ("ab\x03", t[1].text);
+}
+
+TEST(PipeCodesTest, Compile) {
+  auto p = CompilePipeCodes("|#1Hello |15World|@N\x1b[0m");
+  EXPECT_EQ(6u, p.tokens.size());
+  EXPECT_EQ(static_cast<int>(string("Hello World|@N").size()), p.visible_length);
+}
+
+TEST(PipeProgramCacheTest, Get_Cached) {
+  PipeProgramCache cache;
+  auto first = cache.Get("|#1Hello");
+  auto second = cache.Get("|#1Hello");
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(1, cache.compiles());
+  EXPECT_EQ(1u, cache.size());
+
+  cache.Get("|#2Hello");
+  EXPECT_EQ(2, cache.compiles());
+  EXPECT_EQ(2u, cache.size());
+}
+
+TEST(PipeProgramCacheTest, Get_LongText) {
+  PipeProgramCache cache;
+  const string text = "|#1" + string(PipeProgramCache::kMaxTextLength, 'x');
+  auto p = cache.Get(text);
+  ASSERT_EQ(2u, p->tokens.size());
+  cache.Get(text);
+  EXPECT_EQ(2, cache.compiles());
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST(PipeProgramCacheTest, Get_Full) {
+  PipeProgramCache cache;
+  for (size_t i = 0; i <= PipeProgramCache::kMaxEntries; i++) {
+    cache.Get("|#1" + std::to_string(i));
+  }
+  EXPECT_EQ(1u, cache.size());
+}
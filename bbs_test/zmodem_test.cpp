@@ -0,0 +1,268 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "bbs/bbs.h"
+#include "bbs/remote_io.h"
+#include "bbs/prot/zmodem.h"
+#include "bbs_test/bbs_helper.h"
+#include "core/file.h"
+#include "core/strings.h"
+#include "core_test/file_helper.h"
+
+using std::string;
+using namespace std::chrono;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+/** One end of an in memory connection, writes go to the other end's input. */
+class LoopbackRemoteIO : public RemoteIO {
+public:
+  LoopbackRemoteIO() = default;
+  void connect(LoopbackRemoteIO* peer) { peer_ = peer; }
+
+  bool open() override { return true; }
+  void close(bool) override {}
+  unsigned char getW() override { return 0; }
+  bool disconnect() override { return true; }
+  void purgeIn() override { input_.clear(); }
+  unsigned int put(unsigned char ch) override {
+    peer_->input_.push_back(ch);
+    return 1;
+  }
+  unsigned int read(char* buffer, unsigned int count) override {
+    auto n = std::min<size_t>(count, input_.size() - pos_);
+    memcpy(buffer, input_.data() + pos_, n);
+    pos_ += n;
+    if (pos_ == input_.size()) {
+      input_.clear();
+      pos_ = 0;
+    }
+    return n;
+  }
+  unsigned int write(const char* buffer, unsigned int count, bool) override {
+    peer_->input_.append(buffer, count);
+    ++writes_;
+    return count;
+  }
+  bool connected() override { return true; }
+  bool incoming() override { return pos_ < input_.size(); }
+  unsigned int GetHandle() const override { return 0; }
+
+  int writes() const { return writes_; }
+
+private:
+  LoopbackRemoteIO* peer_{nullptr};
+  string input_;
+  size_t pos_{0};
+  int writes_{0};
+};
+
+class ZModemTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    helper.SetUp();
+    sender_io_.connect(&receiver_io_);
+    receiver_io_.connect(&sender_io_);
+    Init(&sender_, &sender_io_);
+    Init(&receiver_, &receiver_io_);
+    // Receiver can do full streaming with 32-bit crcs.
+    receiver_.zrinitflags = CANFDX | CANOVIO | CANFC32;
+  }
+
+  void TearDown() override {
+    free(sender_.buffer);
+    free(receiver_.buffer);
+  }
+
+  static void Init(ZModem* info, RemoteIO* remote) {
+    info->ifd = info->ofd = -1;
+    info->zrinitflags = 0;
+    info->zsinitflags = 0;
+    info->attn = nullptr;
+    info->packetsize = 0;
+    info->windowsize = 0;
+    info->bufsize = 0;
+    info->buffer = nullptr;
+    info->remote = remote;
+  }
+
+  // Feeds input to one end, or lets it send more if it is streaming.
+  static int Step(ZModem* info, LoopbackRemoteIO* io, bool* progress) {
+    char buffer[ZMaxPacket * 2];
+    if (io->incoming()) {
+      auto len = io->read(buffer, sizeof(buffer));
+      *progress = true;
+      return ZmodemRcv(reinterpret_cast<u_char*>(buffer), len, info);
+    }
+    if (info->timeout == 0) {
+      *progress = true;
+      return ZmodemTimeout(info);
+    }
+    return 0;
+  }
+
+  // Runs both ends until the sender finishes its current step.
+  int Pump(int done) {
+    for (int i = 0; i < 1000000 && !done; i++) {
+      bool progress = false;
+      if (!receiver_done_) {
+        receiver_done_ = Step(&receiver_, &receiver_io_, &progress);
+      }
+      done = Step(&sender_, &sender_io_, &progress);
+      if (!progress) {
+        // Both ends are waiting on each other.
+        ADD_FAILURE() << "ZModem stalled";
+        return ZmErrSndTo;
+      }
+    }
+    return done;
+  }
+
+  bool Send(const string& path, const string& remote_name) {
+    receiver_done_ = ZmodemRInit(&receiver_);
+    if (Pump(ZmodemTInit(&sender_)) != ZmDone) {
+      return false;
+    }
+    char file_name[255];
+    char rfile_name[255];
+    to_char_array(file_name, path);
+    to_char_array(rfile_name, remote_name);
+    auto done = ZmodemTFile(file_name, rfile_name, ZCBIN, 0, 0, 0, 0, 0, &sender_);
+    if (done == ZmDone) {
+      return true;
+    }
+    if (done != 0 || Pump(0) != ZmDone) {
+      return false;
+    }
+    return Pump(ZmodemTFinish(&sender_)) == ZmDone;
+  }
+
+  string CreateFile(const string& name, int size) {
+    // Use every byte value so escaping is exercised.
+    string contents;
+    contents.reserve(size);
+    unsigned int seed = 1;
+    for (int i = 0; i < size; i++) {
+      seed = seed * 1103515245 + 12345;
+      contents.push_back(static_cast<char>(seed >> 16));
+    }
+    const auto path = FilePath(helper.files().TempDir(), name);
+    File f(path);
+    f.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite | File::modeTruncate);
+    f.Write(contents);
+    return path;
+  }
+
+  static string ReadFile(const string& path) {
+    File f(path);
+    if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+      return {};
+    }
+    string s(static_cast<size_t>(f.length()), '\0');
+    f.Read(&s[0], s.size());
+    return s;
+  }
+
+  BbsHelper helper;
+  LoopbackRemoteIO sender_io_;
+  LoopbackRemoteIO receiver_io_;
+  ZModem sender_;
+  ZModem receiver_;
+  int receiver_done_{0};
+};
+
+TEST_F(ZModemTest, EscapeData) {
+  ZModem info;
+  info.escCtrl = 0;
+  const u_char data[] = {'a', ZDLE, 0x11, 0x91, '\r', 0x7f, 0xff, 0x01, 'b'};
+  u_char out[32];
+  int outlen = 0;
+  EXPECT_EQ(9, ZEscapeData(data, sizeof(data), out, &outlen, sizeof(out), &info));
+  const u_char expected[] = {'a',  ZDLE, ZDLE ^ 0100, ZDLE, 0x11 ^ 0100, ZDLE, 0x91 ^ 0100,
+                             ZDLE, '\r' ^ 0100, ZDLE, ZRUB0, ZDLE, ZRUB1, 0x01, 'b'};
+  ASSERT_EQ(static_cast<int>(sizeof(expected)), outlen);
+  EXPECT_EQ(0, memcmp(expected, out, outlen));
+
+  // Control characters are escaped when asked for.
+  info.escCtrl = 1;
+  const u_char ctrl[] = {0x01};
+  EXPECT_EQ(1, ZEscapeData(ctrl, 1, out, &outlen, sizeof(out), &info));
+  EXPECT_EQ(2, outlen);
+}
+
+TEST_F(ZModemTest, EscapeData_StopsWhenFull) {
+  ZModem info;
+  info.escCtrl = 0;
+  const u_char data[] = {'a', 'b', ZDLE, 'c'};
+  u_char out[32];
+  int outlen = 0;
+  // An escaped character may use one more byte than is left.
+  EXPECT_EQ(3, ZEscapeData(data, sizeof(data), out, &outlen, 3, &info));
+  EXPECT_EQ(4, outlen);
+  EXPECT_EQ(2, ZEscapeData(data, sizeof(data), out, &outlen, 2, &info));
+  EXPECT_EQ(2, outlen);
+}
+
+TEST_F(ZModemTest, Send) {
+  const auto path = CreateFile("send.dat", 100000);
+  ASSERT_TRUE(Send(path, "recv.dat"));
+  EXPECT_EQ(ReadFile(path), ReadFile(FilePath(helper.files().TempDir(), "recv.dat")));
+}
+
+TEST_F(ZModemTest, Send_Crc16) {
+  receiver_.zrinitflags = CANFDX | CANOVIO;
+  const auto path = CreateFile("send.dat", 100000);
+  ASSERT_TRUE(Send(path, "recv.dat"));
+  EXPECT_EQ(ReadFile(path), ReadFile(FilePath(helper.files().TempDir(), "recv.dat")));
+}
+
+TEST_F(ZModemTest, Send_EscapeControlCharacters) {
+  receiver_.zrinitflags = CANFDX | CANOVIO | CANFC32 | ESCCTL;
+  const auto path = CreateFile("send.dat", 100000);
+  ASSERT_TRUE(Send(path, "recv.dat"));
+  EXPECT_EQ(ReadFile(path), ReadFile(FilePath(helper.files().TempDir(), "recv.dat")));
+}
+
+TEST_F(ZModemTest, Send_Empty) {
+  const auto path = CreateFile("send.dat", 0);
+  ASSERT_TRUE(Send(path, "recv.dat"));
+  EXPECT_TRUE(File::Exists(FilePath(helper.files().TempDir(), "recv.dat")));
+}
+
+// Reports the loopback throughput of an 8MB transfer; Send above is the
+// correctness test.  Run with --gtest_also_run_disabled_tests.
+TEST_F(ZModemTest, DISABLED_Benchmark) {
+  const int size = 8 * 1024 * 1024;
+  const auto path = CreateFile("send.dat", size);
+  auto start = steady_clock::now();
+  ASSERT_TRUE(Send(path, "recv.dat"));
+  auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+  EXPECT_EQ(ReadFile(path), ReadFile(FilePath(helper.files().TempDir(), "recv.dat")));
+
+  const auto mb_per_sec = (size / (1024.0 * 1024.0)) / (std::max<long long>(elapsed, 1) / 1000000.0);
+  std::cout << "ZModem loopback: " << size << " bytes in " << elapsed << "us ("
+            << mb_per_sec << " MB/s, " << sender_io_.writes() << " writes)" << std::endl;
+}
@@ -476,9 +476,14 @@ std::unique_ptr<wwiv::core::FileLock> File::lock(wwiv::core::FileLockType lock_t
     LOG(ERROR) << "Error Locking file: " << full_path_name_;
   }
 #else
-
-  // TODO: unlock here
-
+  // Blocks until the lock is granted rather than polling for it.
+  const int op = (lock_type == wwiv::core::FileLockType::write_lock) ? LOCK_EX : LOCK_SH;
+  int ret;
+  while ((ret = flock(handle_, op)) == -1 && errno == EINTR) {
+  }
+  if (ret == -1) {
+    LOG(ERROR) << "Error Locking file: " << full_path_name_ << "; errno: " << errno;
+  }
 #endif // _WIN32
   return std::make_unique<wwiv::core::FileLock>(handle_, full_path_name_, lock_type);
 }
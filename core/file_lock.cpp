@@ -72,9 +72,9 @@ FileLock::~FileLock() {
     LOG(ERROR) << "Error Unlocking file: " << filename_;
   }
 #else
-
-  // TODO: unlock here
-
+  if (flock(fd_, LOCK_UN) == -1) {
+    LOG(ERROR) << "Error Unlocking file: " << filename_ << "; errno: " << errno;
+  }
 #endif  // _WIN32
 }
 
@@ -8,7 +8,7 @@
 #include <string>
 #include <list>
 #include <limits> 
-#include <set>
+#include <queue>
 #include <utility>
 #include <algorithm> 
 #include <iterator>
@@ -24,8 +24,8 @@ using std::vector;
 static constexpr uint16_t NO_NODE = 0;
 static constexpr float max_cost = numeric_limits<float>::infinity();
 
-Graph::Graph(uint16_t node, uint16_t max_size) 
-  : node_(node), max_size_(max_size), adjacency_list_(max_size), cost_() {
+Graph::Graph(uint16_t node, uint16_t max_size)
+  : node_(node), max_size_(max_size), degree_(max_size, 0), cost_() {
     cost_.clear();
     cost_.resize(max_size, max_cost);
     cost_[node] = 0;
@@ -36,43 +36,81 @@ Graph::Graph(uint16_t node, uint16_t max_size)
 Graph::~Graph() {}
 
 bool Graph::add_edge(uint16_t source, uint16_t dest, float cost) {
-  if (computed_) {
+  if (computed_ || source >= max_size_ || dest >= max_size_) {
     return false;
   }
 
   //VLOG(3) << "adding edge: " << source << " " << dest << " " << cost << " " << std::boolalpha << computed_ << std::endl;
-  adjacency_list_[source].emplace_back(dest, cost);
+  raw_edges_.push_back({source, dest, cost});
+  ++degree_[source];
   return true;
 }
 
 bool Graph::has_node(uint16_t source) {
-  return !adjacency_list_[source].empty();
+  return source < max_size_ && degree_[source] > 0;
 }
 
-
 void Graph::Compute() {
   computed_ = true;
-  std::set<std::pair<float, uint16_t>> queue;
-  queue.insert(std::make_pair(cost_[node_], node_));
+
+  // Pack the edges into a compact adjacency array (CSR) so that the edges
+  // for each node are contiguous.
+  offsets_.assign(max_size_ + 1, 0);
+  for (uint32_t n = 0; n < max_size_; n++) {
+    offsets_[n + 1] = offsets_[n] + degree_[n];
+  }
+  edges_.assign(raw_edges_.size(), edge(NO_NODE, 0));
+  vector<uint32_t> pos(offsets_.begin(), offsets_.end() - 1);
+  for (const auto& e : raw_edges_) {
+    edges_[pos[e.source]++] = edge(e.dest, e.cost);
+  }
+  raw_edges_.clear();
+  raw_edges_.shrink_to_fit();
+
+  // Dijkstra using a binary heap. Stale heap entries are skipped when popped
+  // instead of being removed when a node's cost is lowered.
+  typedef std::pair<float, uint16_t> entry_t;
+  std::priority_queue<entry_t, vector<entry_t>, std::greater<entry_t>> queue;
+  vector<uint16_t> settled;
+  vector<bool> done(max_size_, false);
+  queue.emplace(cost_[node_], node_);
 
   while (!queue.empty()) {
-    float dist = queue.begin()->first;
-    uint16_t u = queue.begin()->second;
-    queue.erase(queue.begin());
+    const auto dist = queue.top().first;
+    const auto u = queue.top().second;
+    queue.pop();
+    if (done[u]) {
+      continue;
+    }
+    done[u] = true;
+    settled.push_back(u);
 
     // Visit each edge exiting u
-    const std::vector<edge> &edges = adjacency_list_[u];
-    for (const auto& e : edges) {
+    for (auto i = offsets_[u]; i < offsets_[u + 1]; i++) {
+      const auto& e = edges_[i];
       uint16_t v = e.node_;
       float cost_through_u = dist + e.cost_;
       if (cost_through_u < cost_[v]) {
-        queue.erase(std::make_pair(cost_[v], v));
         cost_[v] = cost_through_u;
         previous_[v] = u;
-        queue.insert(std::make_pair(cost_[v], v));
+        queue.emplace(cost_[v], v);
       }
     }
   }
+
+  // Nodes are settled in order of cost, so a node's predecessor always has
+  // its next hop and hop count filled in before the node itself.
+  next_hop_.assign(max_size_, NO_NODE);
+  hops_.assign(max_size_, 0);
+  next_hop_[node_] = node_;
+  for (const auto v : settled) {
+    if (v == node_) {
+      continue;
+    }
+    const auto p = previous_[v];
+    next_hop_[v] = (p == node_) ? v : next_hop_[p];
+    hops_[v] = static_cast<uint16_t>(hops_[p] + 1);
+  }
   //DumpCosts();
 }
 
@@ -83,11 +121,24 @@ float Graph::cost_to(uint16_t destination) {
   return cost_[destination];
 }
 
+uint16_t Graph::next_hop_to(uint16_t destination) {
+  if (!computed_) {
+    Compute();
+  }
+  return next_hop_[destination];
+}
+
+int Graph::num_hops_to(uint16_t destination) {
+  if (!computed_) {
+    Compute();
+  }
+  return hops_[destination];
+}
 
 std::string Graph::DumpCosts() const {
   std::ostringstream ss;
   ss << "costs_: ";
-  for (int i = 0; i < std::numeric_limits<uint16_t>::max(); i++) {
+  for (int i = 0; i < max_size_; i++) {
     float cost = cost_[i];
     if (std::isfinite(cost)) {
       ss << i << "[" << cost_[i] << "] ";
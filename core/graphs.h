@@ -48,6 +48,10 @@ typedef std::vector<std::vector<edge>> adjacency_list_t;
  net.add_edge(3, 2, 0);
 
  list<uint16_t> path = net.shortest_path_to(3);
+
+ The shortest paths are computed once (on the first query) into flat
+ next-hop and hop-count tables, so next_hop_to, num_hops_to and cost_to
+ are constant time lookups after that.
  */
 class Graph {
 public:
@@ -59,21 +63,34 @@ public:
   std::list<uint16_t> shortest_path_to(uint16_t destination);
   float cost_to(uint16_t destination);
   std::string DumpCosts() const;
-  int num_hops_to(uint16_t destination) { 
-    std::list<uint16_t> path = shortest_path_to(destination);
-    if (path.empty()) {
-      return 0;
-    }
-    return path.size() - 1;
-  }
+  /**
+   * Returns the first node on the shortest path from node to destination,
+   * destination if it is node, or 0 if destination is not reachable.
+   */
+  uint16_t next_hop_to(uint16_t destination);
+  /** Returns the number of hops to destination, or 0 if it is not reachable. */
+  int num_hops_to(uint16_t destination);
 
 private:
+  struct raw_edge {
+    uint16_t source;
+    uint16_t dest;
+    float cost;
+  };
+
   uint16_t node_;
   uint16_t max_size_;
-  adjacency_list_t adjacency_list_;
   bool computed_ = false;
+  // Edges as added, these are packed into offsets_/edges_ by Compute.
+  std::vector<raw_edge> raw_edges_;
+  std::vector<uint32_t> degree_;
+  // Compact (CSR) adjacency: edges for node n are [offsets_[n], offsets_[n+1]).
+  std::vector<uint32_t> offsets_;
+  std::vector<edge> edges_;
   std::vector<float> cost_;
   std::vector<uint16_t> previous_;
+  std::vector<uint16_t> next_hop_;
+  std::vector<uint16_t> hops_;
 
   void Compute();
 };
@@ -18,10 +18,14 @@
 /**************************************************************************/
 #include "core/http_server.h"
 
+#include <algorithm>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "core/crc32.h"
 #include "core/datetime.h"
+#include "core/log.h"
 #include "core/strings.h"
 #include "core/version.h"
 
@@ -31,84 +35,259 @@ using namespace wwiv::strings;
 namespace wwiv {
 namespace core {
 
-HttpServer::HttpServer(std::unique_ptr<SocketConnection> conn) : conn_(std::move(conn)) {}
+static const std::map<string, HttpMethod>& http_methods() {
+  static const std::map<string, HttpMethod> m = {
+      {"OPTIONS", HttpMethod::OPTIONS}, {"GET", HttpMethod::GET},     {"HEAD", HttpMethod::HEAD},
+      {"POST", HttpMethod::POST},       {"PUT", HttpMethod::PUT},     {"DELETE", HttpMethod::DELETE},
+      {"TRACE", HttpMethod::TRACE},     {"CONNECT", HttpMethod::CONNECT}};
+  return m;
+}
+
+string HttpRequest::header(const string& name) const {
+  for (const auto& h : headers) {
+    const auto idx = h.find(':');
+    if (idx == string::npos) {
+      continue;
+    }
+    if (iequals(StringTrim(h.substr(0, idx)), name)) {
+      return StringTrim(h.substr(idx + 1));
+    }
+  }
+  return {};
+}
+
+bool HttpRequest::keep_alive() const {
+  const auto connection = ToStringLowerCase(header("Connection"));
+  if (connection.find("close") != string::npos) {
+    return false;
+  }
+  if (connection.find("keep-alive") != string::npos) {
+    return true;
+  }
+  // Only HTTP/1.1 keeps connections alive by default.
+  return version == "HTTP/1.1";
+}
+
+bool HttpRequestParser::Next(HttpRequest& r) {
+  if (error_) {
+    return false;
+  }
+  // Find the blank line ending the headers, skipping any blank lines
+  // before the request line.
+  std::vector<string> lines;
+  auto pos = pos_;
+  for (;;) {
+    const auto eol = buf_.find('\n', pos);
+    if (eol == string::npos) {
+      if (buffered() > max_header_bytes_) {
+        error_ = true;
+      }
+      return false;
+    }
+    auto line = buf_.substr(pos, eol - pos);
+    pos = eol + 1;
+    StringTrimCRLF(&line);
+    if (!line.empty()) {
+      lines.push_back(line);
+    } else if (!lines.empty()) {
+      break;
+    }
+    if (pos - pos_ > max_header_bytes_) {
+      error_ = true;
+      return false;
+    }
+  }
+
+  const auto parts = SplitString(lines.front(), " ");
+  if (parts.size() != 3) {
+    error_ = true;
+    return false;
+  }
+  HttpRequest req{};
+  req.method_name = parts.at(0);
+  req.path = parts.at(1);
+  req.version = parts.at(2);
+  req.headers.assign(std::begin(lines) + 1, std::end(lines));
+  const auto it = http_methods().find(req.method_name);
+  if (it == std::end(http_methods())) {
+    error_ = true;
+    return false;
+  }
+  req.method = it->second;
+
+  // Skip over any body, we only need to know where the next request starts.
+  const auto content_length = to_number<int64_t>(req.header("Content-Length"));
+  if (content_length < 0) {
+    error_ = true;
+    return false;
+  }
+  if (buf_.size() - pos < static_cast<std::size_t>(content_length)) {
+    return false;
+  }
+  pos_ = pos + static_cast<std::size_t>(content_length);
+  if (pos_ == buf_.size() || pos_ > buf_.size() / 2) {
+    buf_.erase(0, pos_);
+    pos_ = 0;
+  }
+  r = std::move(req);
+  return true;
+}
+
+HttpServer::HttpServer(std::unique_ptr<SocketConnection> conn)
+    : HttpServer(std::move(conn), http_server_options_t{}) {}
+
+HttpServer::HttpServer(std::unique_ptr<SocketConnection> conn,
+                       const http_server_options_t& options)
+    : conn_(std::move(conn)), options_(options) {}
+
 HttpServer::~HttpServer() {}
 
 bool HttpServer::add(HttpMethod method, const std::string& root, HttpHandler* handler) {
   if (method != HttpMethod::GET) {
     return false;
   }
-  get_.emplace(root, handler);
+  get_[root] = handler;
   return true;
 }
 
+HttpHandler* HttpServer::FindHandler(const std::string& path) const {
+  HttpHandler* handler = nullptr;
+  std::size_t longest = 0;
+  for (const auto& e : get_) {
+    if (starts_with(path, e.first) && (handler == nullptr || e.first.size() > longest)) {
+      handler = e.second;
+      longest = e.first.size();
+    }
+  }
+  return handler;
+}
 
 static string current_time_as_string() {
   auto dt = DateTime::now();
   return dt.to_string();
 };
 
-void HttpServer::SendResponse(const HttpResponse& r) {
+string HttpServer::FormatResponse(const HttpResponse& r, bool keep_alive,
+                                  bool include_body) const {
   static const auto statuses = CreateHttpStatusMap();
-  const auto d = std::chrono::seconds(1);
-  conn_->send_line(StrCat("HTTP/1.1 ", r.status, " ", statuses.at(r.status)), d);
-  conn_->send_line(StrCat("Date: ", current_time_as_string()), d);
-  conn_->send_line(StrCat("Server: wwivd/", wwiv_version, beta_version), d);
-  if (!r.text.empty()) {
-    auto content_length = r.text.size();
-    conn_->send_line(StrCat("Content-Length: ", content_length), d);
-    conn_->send("\r\n", d);
-    conn_->send(r.text, d);
-  }
-  else {
-    conn_->send_line("Connection: close", d);
-    conn_->send("\r\n", d);
+  const auto status = statuses.find(r.status);
+  std::ostringstream ss;
+  ss << "HTTP/1.1 " << r.status << " "
+     << (status != std::end(statuses) ? status->second : "Unknown") << "\r\n";
+  ss << "Date: " << current_time_as_string() << "\r\n";
+  ss << "Server: " << options_.server_name << "/" << wwiv_version << beta_version << "\r\n";
+  for (const auto& h : r.headers) {
+    ss << h.first << ": " << h.second << "\r\n";
+  }
+  if (r.status != 304 && r.status != 204) {
+    // Every response has a length so the connection may be kept alive.
+    ss << "Content-Length: " << r.text.size() << "\r\n";
+  }
+  if (!keep_alive) {
+    ss << "Connection: close\r\n";
+  }
+  ss << "\r\n";
+  if (include_body) {
+    ss << r.text;
   }
+  return ss.str();
 }
 
-static std::vector<std::string> read_lines(SocketConnection* conn) {
-  std::vector<std::string> lines;
-  while (true) {
-    auto s = conn->read_line(1024, std::chrono::milliseconds(10));
-    if (!s.empty()) {
-      lines.push_back(s);
-    }
-    else {
-      break;
+void HttpServer::SendResponse(const HttpResponse& r) {
+  conn_->send(FormatResponse(r, false, true), std::chrono::seconds(1));
+}
+
+string HttpServer::Respond(const HttpRequest& r, bool keep_alive) {
+  if (r.method != HttpMethod::GET && r.method != HttpMethod::HEAD) {
+    return FormatResponse(HttpResponse(405), keep_alive, true);
+  }
+  auto* handler = FindHandler(r.path);
+  if (handler == nullptr) {
+    return FormatResponse(HttpResponse(404), keep_alive, true);
+  }
+  // HEAD is answered by the GET handler, without the body.
+  auto response = handler->Handle(HttpMethod::GET, r.path, r.headers);
+  if (response.status == 200 && response.headers.find("ETag") == std::end(response.headers)) {
+    response.headers.emplace("ETag", StringPrintf("\"%08x\"", crc32string(response.text)));
+  }
+  const auto etag = response.headers.find("ETag");
+  if (response.status == 200 && etag != std::end(response.headers)) {
+    const auto if_none_match = r.header("If-None-Match");
+    if (if_none_match == "*" || if_none_match.find(etag->second) != string::npos) {
+      HttpResponse not_modified(304);
+      not_modified.headers.emplace("ETag", etag->second);
+      return FormatResponse(not_modified, keep_alive, false);
     }
   }
-  return lines;
+  return FormatResponse(response, keep_alive, r.method != HttpMethod::HEAD);
 }
 
 bool HttpServer::Run() {
-  const auto d = std::chrono::seconds(1);
-  auto inital_requestline = conn_->read_line(1024, std::chrono::milliseconds(10));
-  if (inital_requestline.empty()) {
-    return false;
-  }
-  auto cmd_parts = SplitString(inital_requestline, " ");
-  if (cmd_parts.size() < 3) {
-    return false;
-  }
-  const auto& path = cmd_parts.at(1);
-  const auto headers = read_lines(conn_.get());
-  const auto& cmd = cmd_parts.at(0);
-  if (cmd == "GET") {
-    for (const auto& e : get_) {
-      if (starts_with(path, e.first)) {
-        auto r = e.second->Handle(HttpMethod::GET, path, headers);
-        SendResponse(r);
-        return true;
+  using std::chrono::milliseconds;
+  using std::chrono::steady_clock;
+  HttpRequestParser parser(options_.max_header_bytes);
+  int num_requests = 0;
+  const auto connected = steady_clock::now();
+  const auto connection_deadline = connected + options_.max_connection_time;
+  // When the request being read has to be complete.
+  auto request_deadline = connected + options_.request_timeout;
+  // When a kept-alive connection without a request started is closed.
+  auto idle_deadline = connection_deadline;
+  for (;;) {
+    // Answer every request that has already been read before waiting for
+    // more, and send all of the responses at once.
+    string out;
+    auto keep_alive = true;
+    HttpRequest r;
+    while (keep_alive && parser.Next(r)) {
+      ++num_requests;
+      keep_alive = r.keep_alive() && num_requests < options_.max_requests;
+      out.append(Respond(r, keep_alive));
+    }
+    if (parser.error()) {
+      out.append(FormatResponse(HttpResponse(400), false, true));
+      keep_alive = false;
+    }
+    if (!out.empty()) {
+      conn_->send(out, std::chrono::seconds(10));
+      const auto now = steady_clock::now();
+      idle_deadline = now + options_.keep_alive_timeout;
+      request_deadline = now + options_.request_timeout;
+    }
+    if (!keep_alive || !conn_->is_open()) {
+      break;
+    }
+    const auto idle = num_requests > 0 && parser.buffered() == 0;
+    if (idle && options_.close_idle && options_.close_idle()) {
+      VLOG(1) << "Closing idle HTTP connection, others are waiting.";
+      break;
+    }
+    const auto deadline = std::min(connection_deadline, idle ? idle_deadline : request_deadline);
+    const auto now = steady_clock::now();
+    if (now >= deadline) {
+      // Idle or sending the request for too long.
+      break;
+    }
+    auto wait = std::chrono::duration_cast<milliseconds>(deadline - now);
+    if (idle && options_.close_idle) {
+      // Check now and then whether the connection is needed elsewhere.
+      wait = std::min(wait, milliseconds(500));
+    }
+    const auto data = conn_->receive_upto(4096, wait);
+    if (data.empty()) {
+      if (!conn_->is_open()) {
+        break;
       }
+      continue;
     }
-    SendResponse(HttpResponse(404));
-    return true;
+    if (idle) {
+      // The start of the next request.
+      request_deadline = steady_clock::now() + options_.request_timeout;
+    }
+    parser.Append(data);
   }
-  SendResponse(HttpResponse(405));
-  return false;
+  return num_requests > 0 && !parser.error();
 }
 
-
-
 }
 }
@@ -20,6 +20,8 @@
 #define __INCLUDED_WWIV_CORE_HTTP_SERVER_H__
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <memory>
@@ -82,6 +84,7 @@ public:
   HttpResponse(int s, std::map<std::string, std::string>& h, const std::string& t) : status(s), headers(h), text(t) {};
 
   int status;
+  /** Header names to values, i.e. {"Content-Type", "text/plain"} */
   std::map<std::string, std::string> headers;
   std::string text;
 };
@@ -91,12 +94,84 @@ public:
   virtual HttpResponse Handle(HttpMethod method, const std::string& path, std::vector<std::string> headers) = 0;
 };
 
+/** A request read from the client. */
+struct HttpRequest {
+  HttpMethod method{HttpMethod::GET};
+  /** The method as sent, i.e. "GET" */
+  std::string method_name;
+  std::string path;
+  /** i.e. "HTTP/1.1" */
+  std::string version;
+  /** Each header line as sent, without the trailing CRLF. */
+  std::vector<std::string> headers;
+
+  /** Returns the value of the header named name (any case), or empty. */
+  std::string header(const std::string& name) const;
+  /** True if the client may send another request on this connection. */
+  bool keep_alive() const;
+};
+
 /**
- * Simple HTTP 1.1 Server that can handle GET requests. 
+ * Splits buffered bytes from a connection into requests, so that many
+ * pipelined requests may be read with a single receive.
+ */
+class HttpRequestParser {
+public:
+  explicit HttpRequestParser(std::size_t max_header_bytes = 16384)
+      : max_header_bytes_(max_header_bytes) {}
+
+  /** Adds data read from the connection. */
+  void Append(const std::string& data) { buf_.append(data); }
+  /**
+   * Removes the next complete request into r. Returns false if more data is
+   * needed or the request is malformed (see error()).
+   */
+  bool Next(HttpRequest& r);
+  bool error() const noexcept { return error_; }
+  /** Number of bytes not yet returned as part of a request. */
+  std::size_t buffered() const noexcept { return buf_.size() - pos_; }
+
+private:
+  const std::size_t max_header_bytes_;
+  std::string buf_;
+  std::size_t pos_{0};
+  bool error_{false};
+};
+
+struct http_server_options_t {
+  /** How long to wait for the next request on a kept-alive connection. */
+  std::chrono::seconds keep_alive_timeout{5};
+  /**
+   * How long a client has to send the whole of a request, from when the
+   * connection is opened or the first byte of the request arrives.
+   */
+  std::chrono::seconds request_timeout{10};
+  /** Longest that a single connection is kept open. */
+  std::chrono::seconds max_connection_time{60};
+  /**
+   * If set, and it returns true while the connection is idle between
+   * requests, the connection is closed so that someone else may be served.
+   */
+  std::function<bool()> close_idle;
+  /** Most requests to answer on one connection before closing it. */
+  int max_requests{100};
+  std::size_t max_header_bytes{16384};
+  /** Sent in the Server header, followed by the WWIV version. */
+  std::string server_name{"wwivd"};
+};
+
+/**
+ * Simple HTTP 1.1 Server that can handle GET and HEAD requests.
+ *
+ * Connections are kept alive and pipelined requests are answered in order.
+ * Each request is routed to the handler added with the longest matching
+ * path prefix. Responses to GET get an ETag (unless the handler set one),
+ * and a request whose If-None-Match matches it gets 304 Not Modified.
  */
 class HttpServer {
 public:
   HttpServer(std::unique_ptr<SocketConnection> conn);
+  HttpServer(std::unique_ptr<SocketConnection> conn, const http_server_options_t& options);
   virtual ~HttpServer();
   /** Adds a handler (handler) for method method and URL path root {root). */
   bool add(HttpMethod method, const std::string& root, HttpHandler* handler);
@@ -105,8 +180,18 @@ public:
   /** Runs the Http Server. It must already have all of the handlers needed added to it. */
   bool Run();
 
+  /**
+   * Returns the response to send for request r, including headers, without
+   * sending it. keep_alive is false if the connection will be closed after.
+   */
+  std::string Respond(const HttpRequest& r, bool keep_alive);
+
 private:
+  HttpHandler* FindHandler(const std::string& path) const;
+  std::string FormatResponse(const HttpResponse& r, bool keep_alive, bool include_body) const;
+
   std::unique_ptr<SocketConnection> conn_;
+  const http_server_options_t options_;
   std::map<std::string, HttpHandler*> get_;
 };
 
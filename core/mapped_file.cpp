@@ -0,0 +1,164 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "core/mapped_file.h"
+#ifdef _WIN32
+// Always declare wwiv_windows.h first to avoid collisions on defines.
+#include "core/wwiv_windows.h"
+#endif  // _WIN32
+
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include "core/log.h"
+
+namespace wwiv {
+namespace core {
+
+MappedFile::MappedFile(const std::string& path, Mode mode) : path_(path), mode_(mode) {
+  open_ = Open();
+  if (!open_) {
+    Close();
+  }
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+#ifdef _WIN32
+
+bool MappedFile::Open() {
+  const auto rw = mode_ == Mode::read_write;
+  auto h = ::CreateFileA(path_.c_str(), rw ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  file_handle_ = h;
+  LARGE_INTEGER size{};
+  if (!::GetFileSizeEx(h, &size)) {
+    return false;
+  }
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  if (size_ == 0) {
+    return true;
+  }
+  mapping_handle_ =
+      ::CreateFileMappingA(h, nullptr, rw ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_handle_ == nullptr) {
+    return false;
+  }
+  data_ = static_cast<uint8_t*>(
+      ::MapViewOfFile(mapping_handle_, rw ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size_));
+  return data_ != nullptr;
+}
+
+bool MappedFile::Flush(std::size_t offset, std::size_t len) {
+  if (data_ == nullptr || mode_ != Mode::read_write) {
+    return data_ != nullptr || size_ == 0;
+  }
+  if (offset >= size_) {
+    return true;
+  }
+  if (offset + len > size_) {
+    len = size_ - offset;
+  }
+  return ::FlushViewOfFile(data_ + offset, len) != FALSE;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    ::UnmapViewOfFile(data_);
+    data_ = nullptr;
+  }
+  if (mapping_handle_ != nullptr) {
+    ::CloseHandle(mapping_handle_);
+    mapping_handle_ = nullptr;
+  }
+  if (file_handle_ != nullptr) {
+    ::CloseHandle(file_handle_);
+    file_handle_ = nullptr;
+  }
+  size_ = 0;
+  open_ = false;
+}
+
+#else  // _WIN32
+
+bool MappedFile::Open() {
+  const auto rw = mode_ == Mode::read_write;
+  fd_ = ::open(path_.c_str(), rw ? O_RDWR : O_RDONLY);
+  if (fd_ < 0) {
+    return false;
+  }
+  struct stat st {};
+  if (::fstat(fd_, &st) != 0) {
+    return false;
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ == 0) {
+    return true;
+  }
+  auto* p = ::mmap(nullptr, size_, rw ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd_, 0);
+  if (p == MAP_FAILED) {
+    LOG(ERROR) << "Unable to map file: " << path_;
+    return false;
+  }
+  data_ = static_cast<uint8_t*>(p);
+  return true;
+}
+
+bool MappedFile::Flush(std::size_t offset, std::size_t len) {
+  if (data_ == nullptr || mode_ != Mode::read_write) {
+    return data_ != nullptr || size_ == 0;
+  }
+  if (offset >= size_) {
+    return true;
+  }
+  if (offset + len > size_) {
+    len = size_ - offset;
+  }
+  // msync requires a page aligned address.
+  static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  const auto aligned = offset - (offset % page_size);
+  return ::msync(data_ + aligned, len + (offset - aligned), MS_SYNC) == 0;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    ::munmap(data_, size_);
+    data_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  size_ = 0;
+  open_ = false;
+}
+
+#endif  // _WIN32
+
+}  // namespace core
+}  // namespace wwiv
@@ -0,0 +1,83 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_CORE_MAPPED_FILE_H__
+#define __INCLUDED_CORE_MAPPED_FILE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace wwiv {
+namespace core {
+
+/**
+ * Maps an entire file into memory.  The mapping is shared, so with
+ * MappedFile::Mode::read_write changes made through mutable_data() are
+ * visible to every other process mapping (or reading) the same file.
+ *
+ * Usage:
+ *   MappedFile m(FilePath(dir, "nodelist_idx.dat"));
+ *   if (!m) { LOG(ERROR) << "Unable to map: " << m.path(); }
+ *   const auto* header = reinterpret_cast<const header_t*>(m.data());
+ *
+ * A zero length file is opened successfully with a nullptr data().
+ */
+class MappedFile final {
+public:
+  enum class Mode { read_only, read_write };
+
+  explicit MappedFile(const std::string& path, Mode mode = Mode::read_only);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  bool IsOpen() const noexcept { return open_; }
+  explicit operator bool() const noexcept { return open_; }
+
+  const uint8_t* data() const noexcept { return data_; }
+  uint8_t* mutable_data() noexcept { return mode_ == Mode::read_write ? data_ : nullptr; }
+  std::size_t size() const noexcept { return size_; }
+  const std::string& path() const noexcept { return path_; }
+
+  /** Writes modified pages in [offset, offset + len) back to the file. */
+  bool Flush(std::size_t offset, std::size_t len);
+  /** Writes all modified pages back to the file. */
+  bool Flush() { return Flush(0, size_); }
+  void Close();
+
+private:
+  bool Open();
+
+  const std::string path_;
+  const Mode mode_;
+  bool open_{false};
+  uint8_t* data_{nullptr};
+  std::size_t size_{0};
+#ifdef _WIN32
+  void* file_handle_{nullptr};
+  void* mapping_handle_{nullptr};
+#else
+  int fd_{-1};
+#endif  // _WIN32
+};
+
+}  // namespace core
+}  // namespace wwiv
+
+#endif // __INCLUDED_CORE_MAPPED_FILE_H__
@@ -0,0 +1,226 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace wwiv {
+namespace core {
+
+static std::size_t this_thread_shard() {
+  static thread_local const std::size_t shard =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % Counter::kShards;
+  return shard;
+}
+
+void Counter::Increment(int64_t n) noexcept {
+  shards_[this_thread_shard()].v.fetch_add(n, std::memory_order_relaxed);
+}
+
+int64_t Counter::value() const noexcept {
+  int64_t total = 0;
+  for (const auto& s : shards_) {
+    total += s.v.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)), counts_(new std::atomic<int64_t>[bounds_.size() + 1]) {
+  for (std::size_t i = 0; i <= bounds_.size(); i++) {
+    counts_[i].store(0);
+  }
+}
+
+void Histogram::Observe(double v) noexcept {
+  const auto it = std::lower_bound(std::begin(bounds_), std::end(bounds_), v);
+  counts_[std::distance(std::begin(bounds_), it)].fetch_add(1, std::memory_order_relaxed);
+  auto sum = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(sum, sum + v, std::memory_order_relaxed)) {
+  }
+}
+
+histogram_snapshot_t Histogram::snapshot() const {
+  histogram_snapshot_t s{};
+  s.bounds = bounds_;
+  for (std::size_t i = 0; i <= bounds_.size(); i++) {
+    const auto c = counts_[i].load(std::memory_order_relaxed);
+    s.counts.push_back(c);
+    s.count += c;
+  }
+  s.sum = sum_.load(std::memory_order_relaxed);
+  return s;
+}
+
+std::vector<double> exponential_buckets(double start, double factor, int count) {
+  std::vector<double> v;
+  for (auto b = start; count > 0; count--, b *= factor) {
+    v.push_back(b);
+  }
+  return v;
+}
+
+static std::string escape_label_value(const std::string& s) {
+  std::string out;
+  for (const auto c : s) {
+    switch (c) {
+    case '\\':
+      out.append("\\\\");
+      break;
+    case '"':
+      out.append("\\\"");
+      break;
+    case '\n':
+      out.append("\\n");
+      break;
+    default:
+      out.push_back(c);
+    }
+  }
+  return out;
+}
+
+// Returns the labels as they appear between the braces, i.e. a="1",b="2"
+static std::string format_labels(const metric_labels_t& labels) {
+  std::string s;
+  for (const auto& l : labels) {
+    if (!s.empty()) {
+      s.push_back(',');
+    }
+    s.append(l.first).append("=\"").append(escape_label_value(l.second)).append("\"");
+  }
+  return s;
+}
+
+static std::string format_value(double v) {
+  std::ostringstream ss;
+  ss.precision(15);
+  ss << v;
+  return ss.str();
+}
+
+static std::string series(const std::string& name, const std::string& labels) {
+  if (labels.empty()) {
+    return name;
+  }
+  return name + "{" + labels + "}";
+}
+
+static std::string with_label(const std::string& labels, const std::string& label) {
+  return labels.empty() ? label : labels + "," + label;
+}
+
+MetricsRegistry::family_t& MetricsRegistry::family(const std::string& name, const std::string& help,
+                                                   Type type) {
+  auto it = families_.find(name);
+  if (it == std::end(families_)) {
+    family_t f{};
+    f.type = type;
+    f.help = help;
+    it = families_.emplace(name, std::move(f)).first;
+  } else if (it->second.type != type) {
+    throw std::invalid_argument("Metric registered with a different type: " + name);
+  }
+  return it->second;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const metric_labels_t& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& m = family(name, help, Type::counter).counters[format_labels(labels)];
+  if (!m) {
+    m.reset(new Counter());
+  }
+  return *m;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const metric_labels_t& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& m = family(name, help, Type::gauge).gauges[format_labels(labels)];
+  if (!m) {
+    m.reset(new Gauge());
+  }
+  return *m;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::vector<double>& bounds,
+                                      const metric_labels_t& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& m = family(name, help, Type::histogram).histograms[format_labels(labels)];
+  if (!m) {
+    m.reset(new Histogram(bounds));
+  }
+  return *m;
+}
+
+std::string MetricsRegistry::Exposition() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  std::ostringstream ss;
+  for (const auto& kv : families_) {
+    const auto& name = kv.first;
+    const auto& f = kv.second;
+    ss << "# HELP " << name << " " << f.help << "\n";
+    switch (f.type) {
+    case Type::counter:
+      ss << "# TYPE " << name << " counter\n";
+      for (const auto& m : f.counters) {
+        ss << series(name, m.first) << " " << m.second->value() << "\n";
+      }
+      break;
+    case Type::gauge:
+      ss << "# TYPE " << name << " gauge\n";
+      for (const auto& m : f.gauges) {
+        ss << series(name, m.first) << " " << m.second->value() << "\n";
+      }
+      break;
+    case Type::histogram:
+      ss << "# TYPE " << name << " histogram\n";
+      for (const auto& m : f.histograms) {
+        const auto s = m.second->snapshot();
+        int64_t cumulative = 0;
+        for (std::size_t i = 0; i < s.bounds.size(); i++) {
+          cumulative += s.counts[i];
+          const auto le = "le=\"" + format_value(s.bounds[i]) + "\"";
+          ss << series(name + "_bucket", with_label(m.first, le)) << " " << cumulative << "\n";
+        }
+        ss << series(name + "_bucket", with_label(m.first, "le=\"+Inf\"")) << " " << s.count
+           << "\n";
+        ss << series(name + "_sum", m.first) << " " << format_value(s.sum) << "\n";
+        ss << series(name + "_count", m.first) << " " << s.count << "\n";
+      }
+      break;
+    }
+  }
+  return ss.str();
+}
+
+MetricsRegistry& global_metrics() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+}  // namespace core
+}  // namespace wwiv
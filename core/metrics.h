@@ -0,0 +1,156 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_CORE_METRICS_H__
+#define __INCLUDED_CORE_METRICS_H__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wwiv {
+namespace core {
+
+/** Label names to values, i.e. {{"type", "telnet"}}. */
+typedef std::map<std::string, std::string> metric_labels_t;
+
+/**
+ * A monotonically increasing count. Increments from different threads go
+ * to different cache lines, so counting is lock-free and rarely contended.
+ */
+class Counter final {
+public:
+  Counter() = default;
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  void Increment(int64_t n = 1) noexcept;
+  int64_t value() const noexcept;
+
+  static constexpr std::size_t kShards = 16;
+
+private:
+  struct alignas(64) shard_t {
+    std::atomic<int64_t> v{0};
+  };
+  std::array<shard_t, kShards> shards_;
+};
+
+/** A value that may go up and down, such as the number of nodes in use. */
+class Gauge final {
+public:
+  Gauge() = default;
+  Gauge(const Gauge&) = delete;
+  Gauge& operator=(const Gauge&) = delete;
+
+  void Set(int64_t v) noexcept { v_.store(v, std::memory_order_relaxed); }
+  void Add(int64_t n) noexcept { v_.fetch_add(n, std::memory_order_relaxed); }
+  void Increment() noexcept { Add(1); }
+  void Decrement() noexcept { Add(-1); }
+  int64_t value() const noexcept { return v_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<int64_t> v_{0};
+};
+
+struct histogram_snapshot_t {
+  /** Upper bound of each bucket, the last bucket (+Inf) is implied. */
+  std::vector<double> bounds;
+  /** Number of observations in each bucket (not cumulative), size is bounds.size() + 1 */
+  std::vector<int64_t> counts;
+  double sum{0};
+  int64_t count{0};
+};
+
+/** Counts observations (i.e. session lengths in seconds) into fixed buckets. */
+class Histogram final {
+public:
+  /** bounds are the upper bounds of each bucket, in increasing order. */
+  explicit Histogram(std::vector<double> bounds);
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void Observe(double v) noexcept;
+  histogram_snapshot_t snapshot() const;
+
+private:
+  const std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<int64_t>[]> counts_;
+  std::atomic<double> sum_{0};
+};
+
+/** Returns count bucket bounds starting at start, each factor times the last. */
+std::vector<double> exponential_buckets(double start, double factor, int count);
+
+/**
+ * Holds every metric by name and labels, and writes them out in the
+ * Prometheus text exposition format.
+ *
+ * Looking up a metric takes a lock, so hot paths should look a metric up
+ * once and keep the reference, which remains valid for the life of the
+ * registry. Updating a metric never takes a lock.
+ *
+ * Asking for an existing name as a different kind of metric throws
+ * std::invalid_argument.
+ */
+class MetricsRegistry final {
+public:
+  MetricsRegistry() = default;
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  Counter& counter(const std::string& name, const std::string& help,
+                   const metric_labels_t& labels = {});
+  Gauge& gauge(const std::string& name, const std::string& help,
+               const metric_labels_t& labels = {});
+  /** bounds are only used when the histogram is first created. */
+  Histogram& histogram(const std::string& name, const std::string& help,
+                       const std::vector<double>& bounds, const metric_labels_t& labels = {});
+
+  /** Returns every metric in the Prometheus text exposition format (0.0.4). */
+  std::string Exposition() const;
+
+private:
+  enum class Type { counter, gauge, histogram };
+  struct family_t {
+    Type type;
+    std::string help;
+    // Keyed by the formatted labels.
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+  };
+  family_t& family(const std::string& name, const std::string& help, Type type);
+
+  mutable std::mutex mu_;
+  std::map<std::string, family_t> families_;
+};
+
+/** The registry shared by everything in this process. */
+MetricsRegistry& global_metrics();
+
+}  // namespace core
+}  // namespace wwiv
+
+#endif  // __INCLUDED_CORE_METRICS_H__
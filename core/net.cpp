@@ -31,9 +31,14 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif // __linux__
+
 #endif // _WIN32
 
 #include "core/log.h"
+#include "core/os.h"
 #include "core/scope_exit.h"
 #include "core/socket_exceptions.h"
 #include "core/strings.h"
@@ -123,7 +128,7 @@ SOCKET CreateListenSocket(int port) {
                "; errno: ", errno);
     throw socket_error(msg);
   }
-  if (listen(sock, 10) == -1) {
+  if (listen(sock, SOMAXCONN) == -1) {
     throw socket_error(StrCat("Error listening. errno: ", errno));
   }
 
@@ -193,13 +198,39 @@ SocketSet::SocketSet() : SocketSet(2) {};
 
 SocketSet::SocketSet(int timeout_seconds) : timeout_seconds_(timeout_seconds){};
 
-SocketSet::~SocketSet() = default;
+SocketSet::~SocketSet() {
+#ifdef __linux__
+  if (epoll_fd_ != -1) {
+    ::close(epoll_fd_);
+  }
+#endif // __linux__
+}
 
 bool SocketSet::add(int port, socketset_accept_fn fn, const std::string& description) {
   SOCKET s = CreateListenSocket(port);
   if (s == INVALID_SOCKET) {
     return false;
   }
+#ifdef __linux__
+  if (epoll_fd_ == -1) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) {
+      LOG(ERROR) << "Unable to create epoll instance; errno: " << errno;
+      closesocket(s);
+      return false;
+    }
+  }
+  // Non-blocking so that Accept can drain the backlog without stalling.
+  fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+  struct epoll_event ev {};
+  ev.events = EPOLLIN;
+  ev.data.fd = s;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, s, &ev) == -1) {
+    LOG(ERROR) << "Unable to add " << description << " to epoll; errno: " << errno;
+    closesocket(s);
+    return false;
+  }
+#endif // __linux__
   LOG(INFO) << "Listening to " << description << " on port: " << port;
   socket_fn_map_.emplace(s, fn);
   socket_port_map_.emplace(s, port);
@@ -217,6 +248,73 @@ bool SocketSet::Run(std::atomic<bool>& exit_signal) {
   }
 }
 
+bool SocketSet::Accept(SOCKET s) {
+  socklen_t addr_size = sizeof(sockaddr_in);
+  struct sockaddr_in saddr {};
+  auto client_sock = accept(s, reinterpret_cast<sockaddr*>(&saddr), &addr_size);
+  if (client_sock == INVALID_SOCKET) {
+    return false;
+  }
+
+#ifdef _WIN32
+  int newvalue = SO_SYNCHRONOUS_NONALERT;
+  setsockopt(client_sock, SOL_SOCKET, SO_OPENTYPE, reinterpret_cast<char*>(&newvalue),
+             sizeof(newvalue));
+#endif
+  socket_fn_map_.at(s)({client_sock, socket_port_map_.at(s)});
+  return true;
+}
+
+#ifdef __linux__
+
+bool SocketSet::RunOnce() {
+  if (epoll_fd_ == -1 || socket_fn_map_.empty()) {
+    LOG(ERROR) << "Nothing to do!";
+    return false;
+  }
+
+  constexpr int kMaxEvents = 16;
+  struct epoll_event events[kMaxEvents];
+  const auto timeout_ms = (timeout_seconds_ > 0) ? timeout_seconds_ * 1000 : -1;
+  VLOG(3) << "About to call epoll_wait.";
+  const auto status = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+  VLOG(2) << "After epoll_wait.";
+  if (status < 0 && errno == EINTR) {
+    VLOG(1) << "Caught signal calling epoll_wait";
+    // return true so we can check for exit signal.
+    return true;
+  }
+  if (status < 0) {
+    LOG(ERROR) << "Error calling epoll_wait; errno: " << errno;
+    return false;
+  }
+  if (status == 0) {
+    // Timeout expired.  Keep on trucking.
+    VLOG(4) << "timeout expired on epoll_wait";
+    return true;
+  }
+
+  for (int i = 0; i < status; i++) {
+    // Drain everything pending on this socket, the listen socket is
+    // non-blocking so accept fails with EAGAIN once the backlog is empty.
+    while (Accept(events[i].data.fd)) {
+    }
+    if (errno == EMFILE || errno == ENFILE) {
+      // The connection stays in the backlog, so the listen socket is still
+      // readable.  Wait for something to be closed rather than spinning.
+      LOG(ERROR) << "Out of file descriptors accepting connections; errno: " << errno;
+      wwiv::os::sleep_for(std::chrono::milliseconds(250));
+      return true;
+    }
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+      LOG(ERROR) << "Error calling accept; errno: " << errno;
+    }
+  }
+  return true;
+}
+
+#else  // __linux__
+
 bool SocketSet::RunOnce() {
   SOCKET max_fd = 0;
   fd_set fds{};
@@ -260,20 +358,13 @@ bool SocketSet::RunOnce() {
 
   for (const auto& e : socket_fn_map_) {
     if (FD_ISSET(e.first, &fds)) {
-      socklen_t addr_size = sizeof(sockaddr_in);
-      struct sockaddr_in saddr{};
-      auto client_sock = accept(e.first, reinterpret_cast<sockaddr*>(&saddr), &addr_size);
-
-#ifdef _WIN32
-      int newvalue = SO_SYNCHRONOUS_NONALERT;
-      setsockopt(client_sock, SOL_SOCKET, SO_OPENTYPE, reinterpret_cast<char*>(&newvalue),
-                 sizeof(newvalue));
-#endif
-      e.second({client_sock, socket_port_map_.at(e.first)});
+      Accept(e.first);
     }
   }
   return true;
 }
 
+#endif // __linux__
+
 } // namespace core
 } // namespace wwiv
@@ -85,7 +85,10 @@ struct accepted_socket_t {
 };
 
 /**
- * Handles select over a set of sockets.
+ * Handles accepting connections over a set of listening sockets.
+ *
+ * On Linux this uses epoll and drains every pending connection on a
+ * listening socket each time it becomes readable, elsewhere it uses select.
  */
 class SocketSet {
 public:
@@ -112,10 +115,15 @@ public:
 private:
   /** Runs the select/accept/execute loops once, returning false on error. */
   bool RunOnce();
+  /** Accepts and dispatches a single pending connection on listen socket s. */
+  bool Accept(SOCKET s);
 
   std::map<SOCKET, int> socket_port_map_;
   std::map<SOCKET, socketset_accept_fn> socket_fn_map_;
   const int timeout_seconds_;
+#ifdef __linux__
+  int epoll_fd_{-1};
+#endif
 };
 
 }  // namespace core
@@ -17,12 +17,19 @@
 /*                                                                        */
 /**************************************************************************/
 #include "core/semaphore_file.h"
+#ifdef _WIN32
+// Always declare wwiv_windows.h first to avoid collisions on defines.
+#include "core/wwiv_windows.h"
+#endif  // _WIN32
 
 #include <algorithm>
 #include <cerrno>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <fcntl.h>
 #include <iostream>
+#include <memory>
 #ifdef _WIN32
 #include <direct.h>
 #include <io.h>
@@ -33,19 +40,29 @@
 #include <sys/stat.h>
 
 #include "core/log.h"
+#include "core/metrics.h"
+#include "core/strings.h"
 
 #ifndef _WIN32
+#include <signal.h>
 #include <sys/file.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <utime.h>
 #endif  // _WIN32
 
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif  // __linux__
+
 #include "core/os.h"
 
 using std::string;
 using std::chrono::milliseconds;
+using namespace std::chrono;
 using namespace wwiv::os;
+using namespace wwiv::strings;
 
 namespace wwiv {
 namespace core {
@@ -56,6 +73,183 @@ namespace core {
 #endif  // O_TEMPORARY
 #endif  // _WIN32
 
+namespace {
+
+/**
+ * Wakes up a waiter when a file is removed from the directory holding a
+ * semaphore, which is what happens when one is released.  On platforms
+ * without a way to watch a directory this just sleeps.
+ */
+class ReleaseWatcher final {
+public:
+  explicit ReleaseWatcher(const std::string& filepath);
+  ReleaseWatcher(const ReleaseWatcher&) = delete;
+  ReleaseWatcher& operator=(const ReleaseWatcher&) = delete;
+  ~ReleaseWatcher();
+
+  /** Waits until a file may have been released, or until d has passed. */
+  void wait(milliseconds d);
+
+private:
+#if defined(_WIN32)
+  HANDLE handle_{INVALID_HANDLE_VALUE};
+#elif defined(__linux__)
+  int fd_{-1};
+#endif
+};
+
+static std::string directory_of(const std::string& filepath) {
+  const auto idx = filepath.find_last_of("/\\");
+  if (idx == std::string::npos) {
+    return ".";
+  }
+  return idx == 0 ? filepath.substr(0, 1) : filepath.substr(0, idx);
+}
+
+#if defined(_WIN32)
+
+ReleaseWatcher::ReleaseWatcher(const std::string& filepath) {
+  handle_ = FindFirstChangeNotificationA(directory_of(filepath).c_str(), FALSE,
+                                         FILE_NOTIFY_CHANGE_FILE_NAME);
+}
+
+ReleaseWatcher::~ReleaseWatcher() {
+  if (handle_ != INVALID_HANDLE_VALUE) {
+    FindCloseChangeNotification(handle_);
+  }
+}
+
+void ReleaseWatcher::wait(milliseconds d) {
+  if (handle_ == INVALID_HANDLE_VALUE) {
+    sleep_for(d);
+    return;
+  }
+  if (WaitForSingleObject(handle_, static_cast<DWORD>(d.count())) == WAIT_OBJECT_0) {
+    FindNextChangeNotification(handle_);
+  }
+}
+
+#elif defined(__linux__)
+
+ReleaseWatcher::ReleaseWatcher(const std::string& filepath) {
+  fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ < 0) {
+    return;
+  }
+  if (inotify_add_watch(fd_, directory_of(filepath).c_str(), IN_DELETE | IN_MOVED_FROM) < 0) {
+    VLOG(1) << "Unable to watch the directory of: " << filepath << "; errno: " << errno;
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+ReleaseWatcher::~ReleaseWatcher() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void ReleaseWatcher::wait(milliseconds d) {
+  if (fd_ < 0) {
+    sleep_for(d);
+    return;
+  }
+  pollfd p{};
+  p.fd = fd_;
+  p.events = POLLIN;
+  if (poll(&p, 1, static_cast<int>(d.count())) > 0) {
+    // Drain the events, all we care about is that something changed.
+    char buf[4096];
+    while (read(fd_, buf, sizeof(buf)) > 0) {
+    }
+  }
+}
+
+#else  // __linux__
+
+ReleaseWatcher::ReleaseWatcher(const std::string&) {}
+
+ReleaseWatcher::~ReleaseWatcher() {}
+
+void ReleaseWatcher::wait(milliseconds d) { sleep_for(d); }
+
+#endif  // _WIN32
+
+// Written at the start of every semaphore file, followed by the owner's pid.
+static const char kOwnerMarker[] = "WWIV-SEMAPHORE pid: ";
+
+#ifndef _WIN32
+/**
+ * Returns the pid written by the owner of the open semaphore file fd, or 0
+ * if it doesn't have one (e.g. it's from an older version, or the owner
+ * hasn't written it yet).
+ */
+static pid_t semaphore_owner(int fd) {
+  char buf[64]{};
+  const auto len = pread(fd, buf, sizeof(buf) - 1, 0);
+  const auto marker_len = sizeof(kOwnerMarker) - 1;
+  if (len <= static_cast<ssize_t>(marker_len) || strncmp(buf, kOwnerMarker, marker_len) != 0) {
+    return 0;
+  }
+  return static_cast<pid_t>(atoi(buf + marker_len));
+}
+#endif  // _WIN32
+
+/**
+ * On Windows the semaphore file is deleted by the OS when its owner exits
+ * (O_TEMPORARY), but elsewhere a crashed owner leaves it behind.  It is only
+ * removed when nobody holds the owner's flock on it and it names an owner
+ * that is no longer running.  Anything else waits for the timeout.
+ */
+static bool remove_if_stale(const std::string& filepath) {
+#ifdef _WIN32
+  return false;
+#else
+  const auto fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  auto stale = false;
+  struct stat by_fd {};
+  struct stat by_path {};
+  // Keep holding the lock while unlinking so that nobody else can decide
+  // the same file is stale and remove a new owner's semaphore.
+  if (flock(fd, LOCK_EX | LOCK_NB) == 0 && fstat(fd, &by_fd) == 0 &&
+      stat(filepath.c_str(), &by_path) == 0 && by_fd.st_dev == by_path.st_dev &&
+      by_fd.st_ino == by_path.st_ino) {
+    const auto owner = semaphore_owner(fd);
+    if (owner > 0 && kill(owner, 0) == -1 && errno == ESRCH) {
+      LOG(WARNING) << "Removing stale semaphore file: " << filepath << " from pid: " << owner;
+      stale = unlink(filepath.c_str()) == 0;
+    }
+  }
+  close(fd);
+  return stale;
+#endif  // _WIN32
+}
+
+static void record_wait(const std::string& filepath, steady_clock::duration waited,
+                        bool acquired) {
+  static auto& wait_seconds = global_metrics().histogram(
+      "wwiv_semaphore_wait_seconds", "Time spent waiting on semaphore files held by another process.",
+      exponential_buckets(0.001, 4, 10));
+  static auto& timeouts = global_metrics().counter(
+      "wwiv_semaphore_timeouts_total", "Semaphore files that could not be acquired in time.");
+  const auto secs = duration<double>(waited).count();
+  wait_seconds.Observe(secs);
+  if (!acquired) {
+    timeouts.Increment();
+  }
+  if (!acquired || waited > seconds(1)) {
+    LOG(INFO) << "Waited " << duration_cast<milliseconds>(waited).count() << "ms for: " << filepath
+              << (acquired ? "" : " (timed out)");
+  } else {
+    VLOG(1) << "Waited " << duration_cast<milliseconds>(waited).count() << "ms for: " << filepath;
+  }
+}
+
+}  // namespace
+
 // static 
 SemaphoreFile SemaphoreFile::try_acquire(const std::string& filepath, 
                                          const std::string& text,
@@ -63,22 +257,46 @@ SemaphoreFile SemaphoreFile::try_acquire(const std::string& filepath,
   VLOG(1) << "SemaphoreFile::try_acquire: '" << filepath << "'";
   int mode = O_CREAT | O_EXCL | O_TEMPORARY | O_RDWR;
   int pmode = S_IREAD | S_IWRITE;
-  auto step = timeout / 10;
-  if (step > std::chrono::seconds(1)) {
-    step = std::chrono::seconds(1);
-  }
-  auto start = std::chrono::steady_clock::now();
-  auto end = start + timeout;
+  const auto start = steady_clock::now();
+  // Only created once we have to wait.
+  std::unique_ptr<ReleaseWatcher> watcher;
   while (true) {
     int fd = open(filepath.c_str(), mode, pmode);
     if (fd >= 0) { 
-      write(fd, text.c_str(), text.size());
+#ifndef _WIN32
+      // Held for as long as the semaphore is, so waiters can tell a
+      // semaphore left behind by a crash from one that's in use.  If it
+      // can't be taken, the pid below still keeps waiters from removing it.
+      if (flock(fd, LOCK_EX) == -1) {
+        LOG(WARNING) << "Unable to lock semaphore file: " << filepath << "; errno: " << errno;
+      }
+#endif  // _WIN32
+      const auto contents = StrCat(kOwnerMarker, get_pid(), "\n", text);
+      write(fd, contents.c_str(), contents.size());
+      if (watcher) {
+        record_wait(filepath, steady_clock::now() - start, true);
+      }
       return { filepath, fd };
     }
-    if (std::chrono::steady_clock::now() > end) {
+    if (!watcher) {
+      // Start watching before trying again, so that a release between the
+      // last attempt and the watch being set up isn't missed.
+      watcher = std::make_unique<ReleaseWatcher>(filepath);
+      continue;
+    }
+    if (remove_if_stale(filepath)) {
+      continue;
+    }
+    const auto elapsed = steady_clock::now() - start;
+    if (elapsed > timeout) {
+      record_wait(filepath, elapsed, false);
       throw semaphore_not_acquired(filepath);
     }
-    sleep_for(step);
+    // Wake up at least once a second to look for a stale semaphore.
+    const auto remaining = timeout - elapsed;
+    const auto wait = remaining < seconds(1) ? duration_cast<milliseconds>(remaining) + milliseconds(1)
+                                             : milliseconds(1000);
+    watcher->wait(wait);
   }
 }
 
@@ -96,17 +314,18 @@ SemaphoreFile::~SemaphoreFile() {
     LOG(ERROR) << "Skipping closing since file already closed: " << filename_;
     return;
   }
-  if (close(fd_) == -1) {
-    LOG(ERROR) << "Failed to close file: " << filename_ << "; error: " << errno;
-  }
-  fd_ = -1;
 #ifndef _WIN32
-  // Since we don't have O_TEMPORARY on POSIX, we unlink the file
-  // which will delete it once the last file handle is closed.
+  // Since we don't have O_TEMPORARY on POSIX, we unlink the file.  This is
+  // done while still holding the lock so that no waiter can mistake it for
+  // a stale semaphore in between.
   if (::unlink(filename_.c_str()) == -1) {
     LOG(ERROR) << "Failed to unlink file: " << filename_ << "; error: " << errno;
   }
 #endif  // _WIN32
+  if (close(fd_) == -1) {
+    LOG(ERROR) << "Failed to close file: " << filename_ << "; error: " << errno;
+  }
+  fd_ = -1;
 }
 
 
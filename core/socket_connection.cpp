@@ -100,6 +100,16 @@ static bool WouldSocketBlock() {
 #endif // _WIN32
 }
 
+// True if the last socket error means the peer is gone.
+static bool WasSocketClosed() {
+#ifdef _WIN32
+  const auto e = WSAGetLastError();
+  return e == WSAECONNRESET || e == WSAECONNABORTED || e == WSAENOTCONN || e == WSAESHUTDOWN;
+#else  // _WIN32
+  return errno == ECONNRESET || errno == ENOTCONN || errno == EPIPE || errno == ETIMEDOUT;
+#endif // _WIN32
+}
+
 } // namespace
 
 SocketConnection::SocketConnection(SOCKET sock) : SocketConnection(sock, ExitMode::CLOSE_SOCKET) {}
@@ -192,9 +202,11 @@ SocketConnection::~SocketConnection() {
   }
 }
 
+// When closed is not null, this returns partial reads as soon as nothing more
+// is waiting, and sets closed (and returns) once the peer shuts down.
 template <typename TYPE, std::size_t SIZE = sizeof(TYPE)>
 static int read_TYPE(const SOCKET sock, TYPE* data, const duration<double> d, bool throw_on_timeout,
-                     std::size_t size = SIZE) {
+                     std::size_t size = SIZE, bool* closed = nullptr) {
   auto end = system_clock::now() + d;
   char* p = reinterpret_cast<char*>(data);
   std::size_t total_read = 0;
@@ -210,9 +222,20 @@ static int read_TYPE(const SOCKET sock, TYPE* data, const duration<double> d, bo
     int result = ::recv(sock, p, remaining, 0);
     if (result == SOCKET_ERROR) {
       if (WouldSocketBlock()) {
+        if (closed != nullptr && total_read > 0) {
+          return total_read;
+        }
         sleep_for(SLEEP_MS);
         continue;
       }
+      if (closed != nullptr && WasSocketClosed()) {
+        *closed = true;
+        return total_read;
+      }
+    }
+    if (result == 0 && closed != nullptr) {
+      *closed = true;
+      return total_read;
     }
     if (result <= 0 && total_read == 0) {
       VLOG(3) << "result == 0 && total_read == 0";
@@ -242,7 +265,11 @@ int SocketConnection::receive(void* data, const int size, duration<double> d) {
 }
 
 int SocketConnection::receive_upto(void* data, const int size, duration<double> d) {
-  int num_read = read_TYPE<void, 0>(sock_, data, d, false, size);
+  bool closed = false;
+  int num_read = read_TYPE<void, 0>(sock_, data, d, false, size, &closed);
+  if (closed) {
+    open_ = false;
+  }
   return num_read;
 }
 
@@ -57,7 +57,11 @@ public:
   int receive(void* data, int size, std::chrono::duration<double> d) override;
   std::string receive(int size, std::chrono::duration<double> d) override;
 
-  /** Receives up to size bytes and will return partial reads. */
+  /**
+   * Receives up to size bytes and will return partial reads as soon as no
+   * more data is waiting. If the peer closes the connection, is_open() will
+   * return false afterwards.
+   */
   int receive_upto(void* data, int size, std::chrono::duration<double> d);
   std::string receive_upto(int size, std::chrono::duration<double> d);
 
@@ -0,0 +1,317 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "core/zip.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include "core/crc32.h"
+#include "core/datetime.h"
+#include "core/log.h"
+#include "wwiv_infozip.h"
+
+using std::string;
+
+namespace wwiv {
+namespace core {
+
+static constexpr uint32_t kLocalHeaderSig = 0x04034b50;
+static constexpr uint32_t kCentralHeaderSig = 0x02014b50;
+static constexpr uint32_t kEndOfCentralDirSig = 0x06054b50;
+static constexpr int kLocalHeaderSize = 30;
+static constexpr int kCentralHeaderSize = 46;
+static constexpr int kEndOfCentralDirSize = 22;
+static constexpr uint16_t kMethodStored = 0;
+static constexpr uint16_t kMethodDeflated = 8;
+static constexpr uint16_t kFlagEncrypted = 0x0001;
+static constexpr uint16_t kVersion = 20;
+
+// The Info-ZIP engines keep their state in globals.
+static std::mutex infozip_mu;
+
+static uint16_t get16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void put16(string& s, uint16_t v) {
+  s.push_back(static_cast<char>(v & 0xff));
+  s.push_back(static_cast<char>((v >> 8) & 0xff));
+}
+
+static void put32(string& s, uint32_t v) {
+  put16(s, static_cast<uint16_t>(v & 0xffff));
+  put16(s, static_cast<uint16_t>(v >> 16));
+}
+
+static uint32_t to_dos_datetime(time_t t) {
+  const auto tm = DateTime::from_time_t(t).to_tm();
+  const auto year = std::max(tm.tm_year - 80, 0);
+  const uint32_t date = (year << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday;
+  const uint32_t time = (tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2);
+  return (date << 16) | time;
+}
+
+bool IsZipFile(const std::string& path) {
+  File f(path);
+  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+    return false;
+  }
+  uint8_t sig[4]{};
+  return f.Read(sig, sizeof(sig)) == sizeof(sig) && get32(sig) == kLocalHeaderSig;
+}
+
+ZipReader::ZipReader(const std::string& path) : path_(path) {
+  fp_ = std::fopen(path.c_str(), "rb");
+  if (fp_ == nullptr) {
+    return;
+  }
+  open_ = ReadCentralDirectory();
+}
+
+ZipReader::~ZipReader() {
+  if (fp_ != nullptr) {
+    std::fclose(fp_);
+  }
+}
+
+bool ZipReader::ReadCentralDirectory() {
+  if (std::fseek(fp_, 0, SEEK_END) != 0) {
+    return false;
+  }
+  const auto file_size = std::ftell(fp_);
+  if (file_size < kEndOfCentralDirSize) {
+    return false;
+  }
+  // The end of central directory record is followed by a comment of up to 64k.
+  const auto tail_size = std::min<long>(file_size, kEndOfCentralDirSize + 0xffff);
+  std::vector<uint8_t> tail(tail_size);
+  std::fseek(fp_, file_size - tail_size, SEEK_SET);
+  if (std::fread(&tail[0], 1, tail.size(), fp_) != tail.size()) {
+    return false;
+  }
+  const uint8_t* eocd = nullptr;
+  for (auto i = tail_size - kEndOfCentralDirSize; i >= 0; i--) {
+    if (get32(&tail[i]) == kEndOfCentralDirSig) {
+      eocd = &tail[i];
+      break;
+    }
+  }
+  if (eocd == nullptr) {
+    LOG(ERROR) << "No end of central directory record in: " << path_;
+    return false;
+  }
+
+  const auto num_entries = get16(eocd + 10);
+  const auto cd_size = get32(eocd + 12);
+  const auto cd_offset = get32(eocd + 16);
+  if (static_cast<long>(cd_offset) + static_cast<long>(cd_size) > file_size) {
+    LOG(ERROR) << "Central directory is past the end of: " << path_;
+    return false;
+  }
+  std::vector<uint8_t> cd(cd_size);
+  std::fseek(fp_, cd_offset, SEEK_SET);
+  if (cd_size > 0 && std::fread(&cd[0], 1, cd.size(), fp_) != cd.size()) {
+    return false;
+  }
+
+  size_t pos = 0;
+  for (int i = 0; i < num_entries; i++) {
+    if (pos + kCentralHeaderSize > cd.size() || get32(&cd[pos]) != kCentralHeaderSig) {
+      LOG(ERROR) << "Bad central directory header in: " << path_;
+      return false;
+    }
+    const auto* h = &cd[pos];
+    zip_entry_t e{};
+    e.flags = get16(h + 8);
+    e.method = get16(h + 10);
+    e.dos_datetime = get32(h + 12);
+    e.crc32 = get32(h + 16);
+    e.compressed_size = get32(h + 20);
+    e.size = get32(h + 24);
+    const auto name_len = get16(h + 28);
+    const auto extra_len = get16(h + 30);
+    const auto comment_len = get16(h + 32);
+    e.local_header_offset = get32(h + 42);
+    pos += kCentralHeaderSize;
+    if (pos + name_len > cd.size()) {
+      return false;
+    }
+    e.name.assign(reinterpret_cast<const char*>(&cd[pos]), name_len);
+    pos += name_len + extra_len + comment_len;
+    entries_.emplace_back(std::move(e));
+  }
+  return true;
+}
+
+static int append_to_string(void* context, const unsigned char* buf, unsigned long len) {
+  auto* s = static_cast<string*>(context);
+  s->append(reinterpret_cast<const char*>(buf), len);
+  return 0;
+}
+
+bool ZipReader::Extract(const zip_entry_t& e, std::string& contents) {
+  contents.clear();
+  if (!open_) {
+    return false;
+  }
+  if (e.flags & kFlagEncrypted) {
+    LOG(ERROR) << "Encrypted ZIP members are not supported: " << e.name;
+    return false;
+  }
+  uint8_t h[kLocalHeaderSize];
+  if (std::fseek(fp_, e.local_header_offset, SEEK_SET) != 0 ||
+      std::fread(h, 1, sizeof(h), fp_) != sizeof(h) || get32(h) != kLocalHeaderSig) {
+    LOG(ERROR) << "Bad local header for: " << e.name << " in: " << path_;
+    return false;
+  }
+  // The local extra field may differ from the one in the central directory.
+  const long data_offset = e.local_header_offset + kLocalHeaderSize + get16(h + 26) + get16(h + 28);
+  std::fseek(fp_, data_offset, SEEK_SET);
+
+  contents.reserve(e.size);
+  if (e.method == kMethodStored) {
+    contents.resize(e.compressed_size);
+    if (e.compressed_size > 0 &&
+        std::fread(&contents[0], 1, e.compressed_size, fp_) != e.compressed_size) {
+      return false;
+    }
+  } else if (e.method == kMethodDeflated) {
+    std::lock_guard<std::mutex> lock(infozip_mu);
+    if (wwiv_infozip_inflate(fp_, append_to_string, &contents) != 0) {
+      LOG(ERROR) << "Error inflating: " << e.name << " in: " << path_;
+      return false;
+    }
+  } else {
+    LOG(ERROR) << "Unsupported compression method: " << e.method << " for: " << e.name;
+    return false;
+  }
+
+  if (contents.size() != e.size || crc32string(contents) != e.crc32) {
+    LOG(ERROR) << "CRC or size mismatch for: " << e.name << " in: " << path_;
+    return false;
+  }
+  return true;
+}
+
+ZipWriter::ZipWriter(const std::string& path, int level) : file_(path), level_(level) {
+  file_.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite | File::modeTruncate);
+}
+
+ZipWriter::~ZipWriter() {
+  if (file_.IsOpen()) {
+    Close();
+  }
+}
+
+bool ZipWriter::Add(const std::string& name, const std::string& contents, time_t modified) {
+  if (!file_.IsOpen() || !ok_) {
+    return false;
+  }
+  zip_entry_t e{};
+  e.name = name;
+  e.dos_datetime = to_dos_datetime(modified);
+  e.crc32 = crc32string(contents);
+  e.size = static_cast<uint32_t>(contents.size());
+  e.local_header_offset = static_cast<uint32_t>(file_.current_position());
+
+  string deflated;
+  {
+    std::lock_guard<std::mutex> lock(infozip_mu);
+    if (wwiv_infozip_deflate(contents.data(), contents.size(), level_, append_to_string,
+                             &deflated) < 0) {
+      deflated.clear();
+    }
+  }
+  const bool store = deflated.empty() || deflated.size() >= contents.size();
+  const auto& data = store ? contents : deflated;
+  e.method = store ? kMethodStored : kMethodDeflated;
+  e.compressed_size = static_cast<uint32_t>(data.size());
+
+  string h;
+  put32(h, kLocalHeaderSig);
+  put16(h, kVersion);
+  put16(h, e.flags);
+  put16(h, e.method);
+  put32(h, e.dos_datetime);
+  put32(h, e.crc32);
+  put32(h, e.compressed_size);
+  put32(h, e.size);
+  put16(h, static_cast<uint16_t>(e.name.size()));
+  put16(h, 0);
+  h.append(e.name);
+  if (file_.Write(h) != static_cast<ssize_t>(h.size()) ||
+      file_.Write(data) != static_cast<ssize_t>(data.size())) {
+    LOG(ERROR) << "Error writing: " << name << " to: " << file_;
+    ok_ = false;
+    return false;
+  }
+  entries_.emplace_back(std::move(e));
+  return true;
+}
+
+bool ZipWriter::Close() {
+  if (!file_.IsOpen()) {
+    return false;
+  }
+  const auto cd_offset = static_cast<uint32_t>(file_.current_position());
+  string cd;
+  for (const auto& e : entries_) {
+    put32(cd, kCentralHeaderSig);
+    put16(cd, kVersion);
+    put16(cd, kVersion);
+    put16(cd, e.flags);
+    put16(cd, e.method);
+    put32(cd, e.dos_datetime);
+    put32(cd, e.crc32);
+    put32(cd, e.compressed_size);
+    put32(cd, e.size);
+    put16(cd, static_cast<uint16_t>(e.name.size()));
+    put16(cd, 0); // extra
+    put16(cd, 0); // comment
+    put16(cd, 0); // disk number start
+    put16(cd, 0); // internal attributes
+    put32(cd, 0); // external attributes
+    put32(cd, e.local_header_offset);
+    cd.append(e.name);
+  }
+  const auto cd_size = static_cast<uint32_t>(cd.size());
+  put32(cd, kEndOfCentralDirSig);
+  put16(cd, 0);
+  put16(cd, 0);
+  put16(cd, static_cast<uint16_t>(entries_.size()));
+  put16(cd, static_cast<uint16_t>(entries_.size()));
+  put32(cd, cd_size);
+  put32(cd, cd_offset);
+  put16(cd, 0);
+  if (file_.Write(cd) != static_cast<ssize_t>(cd.size())) {
+    ok_ = false;
+  }
+  file_.Close();
+  return ok_;
+}
+
+} // namespace core
+} // namespace wwiv
@@ -0,0 +1,112 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_CORE_ZIP_H__
+#define __INCLUDED_CORE_ZIP_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+
+namespace wwiv {
+namespace core {
+
+struct zip_entry_t {
+  std::string name;
+  uint16_t method{0};
+  uint16_t flags{0};
+  // MS-DOS time in the low 16 bits, date in the high 16 bits.
+  uint32_t dos_datetime{0};
+  uint32_t crc32{0};
+  uint32_t compressed_size{0};
+  uint32_t size{0};
+  uint32_t local_header_offset{0};
+};
+
+/** Returns true if the file at path starts with a ZIP local file header. */
+bool IsZipFile(const std::string& path);
+
+/**
+ * Reads members of a ZIP archive into memory using the Info-ZIP inflate
+ * engine from deps/infozip.  Only stored and deflated, unencrypted members
+ * are supported.
+ *
+ * Usage:
+ *   ZipReader zip(FilePath(dir, "00010001.su0"));
+ *   for (const auto& e : zip.entries()) {
+ *     std::string contents;
+ *     if (zip.Extract(e, contents)) { ... }
+ *   }
+ */
+class ZipReader final {
+public:
+  explicit ZipReader(const std::string& path);
+  ZipReader(const ZipReader&) = delete;
+  ZipReader& operator=(const ZipReader&) = delete;
+  ~ZipReader();
+
+  bool IsOpen() const noexcept { return open_; }
+  explicit operator bool() const noexcept { return open_; }
+  const std::vector<zip_entry_t>& entries() const noexcept { return entries_; }
+
+  /** Uncompresses entry e into contents, verifying the CRC. */
+  bool Extract(const zip_entry_t& e, std::string& contents);
+
+private:
+  bool ReadCentralDirectory();
+
+  const std::string path_;
+  std::FILE* fp_{nullptr};
+  bool open_{false};
+  std::vector<zip_entry_t> entries_;
+};
+
+/**
+ * Creates a new ZIP archive, deflating each member in memory and writing
+ * it directly to the archive.  Members that don't compress are stored.
+ */
+class ZipWriter final {
+public:
+  explicit ZipWriter(const std::string& path, int level = 6);
+  ZipWriter(const ZipWriter&) = delete;
+  ZipWriter& operator=(const ZipWriter&) = delete;
+  /** Closes the archive if Close() has not already been called. */
+  ~ZipWriter();
+
+  bool IsOpen() const { return file_.IsOpen(); }
+  explicit operator bool() const { return file_.IsOpen(); }
+
+  bool Add(const std::string& name, const std::string& contents, time_t modified);
+  /** Writes the central directory and closes the file. */
+  bool Close();
+
+private:
+  File file_;
+  const int level_;
+  bool ok_{true};
+  std::vector<zip_entry_t> entries_;
+};
+
+} // namespace core
+} // namespace wwiv
+
+#endif // __INCLUDED_CORE_ZIP_H__
@@ -24,6 +24,12 @@
 #include <iostream>
 #include <string>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 using std::string;
 using namespace wwiv::core;
 using namespace wwiv::strings;
@@ -386,3 +392,23 @@ TEST(FileTest, CurrentPosition) {
   EXPECT_EQ(static_cast<int>(kContents.size()), file.Seek(0, File::Whence::end));
   EXPECT_EQ(static_cast<int>(kContents.size()), file.current_position());
 }
+
+#ifndef _WIN32
+TEST(FileTest, Lock) {
+  FileHelper helper;
+  const auto path = helper.CreateTempFile(this->test_info_->name(), "0123456789");
+  File file(path);
+  ASSERT_TRUE(file.Open(File::modeBinary | File::modeReadWrite, File::shareDenyNone));
+
+  const auto other = open(path.c_str(), O_RDONLY);
+  ASSERT_GE(other, 0);
+  {
+    auto lock = file.lock(FileLockType::write_lock);
+    ASSERT_TRUE(lock);
+    EXPECT_EQ(-1, flock(other, LOCK_SH | LOCK_NB));
+  }
+  // Released when the FileLock goes away, even though file is still open.
+  EXPECT_EQ(0, flock(other, LOCK_SH | LOCK_NB));
+  close(other);
+}
+#endif  // _WIN32
@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+#include "core/graphs.h"
+
+#include <cmath>
+#include <cstdint>
+#include <list>
+
+using std::list;
+using namespace wwiv::graphs;
+
+class GraphsTest : public ::testing::Test {
+protected:
+  GraphsTest() : graph_(1, 200) {
+    // 1 - 2 - 3 - 4 with a more expensive shortcut from 1 to 4.
+    graph_.add_edge(1, 2, 1.0f);
+    graph_.add_edge(2, 1, 1.0f);
+    graph_.add_edge(2, 3, 1.0f);
+    graph_.add_edge(3, 2, 1.0f);
+    graph_.add_edge(3, 4, 1.0f);
+    graph_.add_edge(4, 3, 1.0f);
+    graph_.add_edge(1, 4, 5.0f);
+    graph_.add_edge(4, 1, 5.0f);
+    // 10 is only reachable from itself.
+    graph_.add_edge(10, 11, 1.0f);
+  }
+
+  Graph graph_;
+};
+
+TEST_F(GraphsTest, ShortestPath) {
+  const list<uint16_t> expected{1, 2, 3, 4};
+  EXPECT_EQ(expected, graph_.shortest_path_to(4));
+  EXPECT_FLOAT_EQ(3.0f, graph_.cost_to(4));
+}
+
+TEST_F(GraphsTest, NextHop) {
+  EXPECT_EQ(1, graph_.next_hop_to(1));
+  EXPECT_EQ(2, graph_.next_hop_to(2));
+  EXPECT_EQ(2, graph_.next_hop_to(3));
+  EXPECT_EQ(2, graph_.next_hop_to(4));
+}
+
+TEST_F(GraphsTest, NumHops) {
+  EXPECT_EQ(0, graph_.num_hops_to(1));
+  EXPECT_EQ(1, graph_.num_hops_to(2));
+  EXPECT_EQ(2, graph_.num_hops_to(3));
+  EXPECT_EQ(3, graph_.num_hops_to(4));
+}
+
+TEST_F(GraphsTest, Unreachable) {
+  EXPECT_TRUE(graph_.has_node(10));
+  EXPECT_EQ(0, graph_.next_hop_to(10));
+  EXPECT_EQ(0, graph_.num_hops_to(10));
+  EXPECT_FALSE(std::isfinite(graph_.cost_to(10)));
+}
+
+TEST_F(GraphsTest, HasNode) {
+  EXPECT_TRUE(graph_.has_node(1));
+  EXPECT_FALSE(graph_.has_node(11));
+  EXPECT_FALSE(graph_.has_node(100));
+}
+
+TEST_F(GraphsTest, AddEdgeAfterCompute) {
+  graph_.cost_to(4);
+  EXPECT_FALSE(graph_.add_edge(4, 5, 1.0f));
+}
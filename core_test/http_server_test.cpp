@@ -0,0 +1,237 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+#include "core/http_server.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+using std::string;
+using namespace std::chrono_literals;
+using namespace wwiv::core;
+
+namespace {
+
+class TextHandler : public HttpHandler {
+public:
+  explicit TextHandler(const string& text) : text_(text) {}
+  HttpResponse Handle(HttpMethod, const string& path, std::vector<string>) override {
+    ++calls;
+    return HttpResponse(200, StrCat(text_, ":", path));
+  }
+  int calls{0};
+
+private:
+  static string StrCat(const string& a, const string& b, const string& c) { return a + b + c; }
+  const string text_;
+};
+
+}  // namespace
+
+TEST(HttpRequestParserTest, Pipelined) {
+  HttpRequestParser p;
+  p.Append("GET /a HTTP/1.1\r\nHost: x\r\n\r\nHEAD /b HTTP/1.1\r\n");
+  HttpRequest r;
+  ASSERT_TRUE(p.Next(r));
+  EXPECT_EQ(HttpMethod::GET, r.method);
+  EXPECT_EQ("/a", r.path);
+  EXPECT_EQ("x", r.header("host"));
+  EXPECT_TRUE(r.keep_alive());
+  // The second request isn't complete yet.
+  EXPECT_FALSE(p.Next(r));
+  EXPECT_FALSE(p.error());
+  p.Append("Connection: close\r\n\r\n");
+  ASSERT_TRUE(p.Next(r));
+  EXPECT_EQ(HttpMethod::HEAD, r.method);
+  EXPECT_EQ("/b", r.path);
+  EXPECT_FALSE(r.keep_alive());
+  EXPECT_EQ(0u, p.buffered());
+}
+
+TEST(HttpRequestParserTest, SkipsBody) {
+  HttpRequestParser p;
+  p.Append("POST /a HTTP/1.1\r\nContent-Length: 5\r\n\r\nhel");
+  HttpRequest r;
+  EXPECT_FALSE(p.Next(r));
+  p.Append("loGET /b HTTP/1.0\r\n\r\n");
+  ASSERT_TRUE(p.Next(r));
+  EXPECT_EQ(HttpMethod::POST, r.method);
+  ASSERT_TRUE(p.Next(r));
+  EXPECT_EQ("/b", r.path);
+  EXPECT_FALSE(r.keep_alive());
+}
+
+TEST(HttpRequestParserTest, Malformed) {
+  HttpRequestParser p;
+  p.Append("GARBAGE\r\n\r\n");
+  HttpRequest r;
+  EXPECT_FALSE(p.Next(r));
+  EXPECT_TRUE(p.error());
+}
+
+TEST(HttpRequestParserTest, HeadersTooLong) {
+  HttpRequestParser p(64);
+  p.Append("GET / HTTP/1.1\r\n");
+  p.Append(string(100, 'x'));
+  HttpRequest r;
+  EXPECT_FALSE(p.Next(r));
+  EXPECT_TRUE(p.error());
+}
+
+#ifndef _WIN32
+
+class HttpServerTest : public ::testing::Test {
+protected:
+  void SetUp() override { ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_)); }
+  void TearDown() override {
+    if (server_thread_.joinable()) {
+      server_thread_.join();
+    }
+    close(fds_[1]);
+  }
+
+  void StartServer(std::function<void(http_server_options_t&)> options = nullptr) {
+    server_thread_ = std::thread([this, options] {
+      http_server_options_t o{};
+      o.keep_alive_timeout = 1s;
+      if (options) {
+        options(o);
+      }
+      HttpServer s(std::make_unique<SocketConnection>(fds_[0]), o);
+      s.add(HttpMethod::GET, "/", &root_);
+      s.add(HttpMethod::GET, "/status", &status_);
+      s.Run();
+    });
+  }
+
+  void Send(const string& s) { ASSERT_EQ(static_cast<ssize_t>(s.size()), write(fds_[1], s.data(), s.size())); }
+
+  // Reads until the server closes the connection.
+  string ReadAll() {
+    string out;
+    char buf[1024];
+    ssize_t n;
+    while ((n = read(fds_[1], buf, sizeof(buf))) > 0) {
+      out.append(buf, n);
+    }
+    return out;
+  }
+
+  static int count(const string& s, const string& what) {
+    int n = 0;
+    for (auto pos = s.find(what); pos != string::npos; pos = s.find(what, pos + 1)) {
+      ++n;
+    }
+    return n;
+  }
+
+  int fds_[2]{};
+  std::thread server_thread_;
+  TextHandler root_{"root"};
+  TextHandler status_{"status"};
+};
+
+TEST_F(HttpServerTest, KeepAliveAndPipelining) {
+  StartServer();
+  Send("GET /status HTTP/1.1\r\n\r\nGET /status/x HTTP/1.1\r\n\r\nGET /other HTTP/1.1\r\n"
+       "Connection: close\r\n\r\n");
+  const auto out = ReadAll();
+  EXPECT_EQ(3, count(out, "HTTP/1.1 200 OK"));
+  EXPECT_EQ(1, count(out, "Connection: close"));
+  // Longest prefix wins.
+  EXPECT_EQ(2, status_.calls);
+  EXPECT_EQ(1, root_.calls);
+  EXPECT_NE(string::npos, out.find("status:/status/x"));
+  EXPECT_NE(string::npos, out.find("root:/other"));
+}
+
+TEST_F(HttpServerTest, ConditionalGet) {
+  StartServer();
+  Send("GET /status HTTP/1.1\r\n\r\n");
+  string first;
+  char buf[1024];
+  while (first.find("status:/status") == string::npos) {
+    const auto n = read(fds_[1], buf, sizeof(buf));
+    ASSERT_GT(n, 0);
+    first.append(buf, n);
+  }
+  const auto start = first.find("ETag: ") + 6;
+  const auto etag = first.substr(start, first.find("\r\n", start) - start);
+  ASSERT_FALSE(etag.empty());
+
+  Send("GET /status HTTP/1.1\r\nIf-None-Match: " + etag + "\r\nConnection: close\r\n\r\n");
+  const auto second = ReadAll();
+  EXPECT_NE(string::npos, second.find("HTTP/1.1 304 Not Modified"));
+  EXPECT_EQ(string::npos, second.find("status:/status"));
+}
+
+TEST_F(HttpServerTest, RequestTimeout) {
+  StartServer([](http_server_options_t& o) {
+    o.keep_alive_timeout = 30s;
+    o.request_timeout = 1s;
+  });
+  // A client that keeps sending headers but never finishes the request.
+  std::atomic<bool> done{false};
+  std::thread dribble([&] {
+    Send("GET /status HTTP/1.1\r\n");
+    for (int i = 0; i < 50 && !done.load(); i++) {
+      std::this_thread::sleep_for(100ms);
+      static const string line = "X-Header: x\r\n";
+      if (send(fds_[1], line.data(), line.size(), MSG_NOSIGNAL) < 0) {
+        break;
+      }
+    }
+  });
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ("", ReadAll());
+  done.store(true);
+  dribble.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 4s);
+  EXPECT_EQ(0, status_.calls);
+}
+
+TEST_F(HttpServerTest, ClosesIdleWhenAsked) {
+  StartServer([](http_server_options_t& o) {
+    o.keep_alive_timeout = 30s;
+    o.close_idle = [] { return true; };
+  });
+  const auto start = std::chrono::steady_clock::now();
+  Send("GET /status HTTP/1.1\r\n\r\n");
+  const auto out = ReadAll();
+  EXPECT_EQ(1, count(out, "HTTP/1.1 200 OK"));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 4s);
+}
+
+TEST_F(HttpServerTest, BadRequest) {
+  StartServer();
+  Send("NONSENSE\r\n\r\n");
+  const auto out = ReadAll();
+  EXPECT_NE(string::npos, out.find("HTTP/1.1 400 Bad Request"));
+}
+
+#endif  // _WIN32
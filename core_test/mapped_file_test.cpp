@@ -0,0 +1,67 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+#include "core/file.h"
+#include "core/mapped_file.h"
+#include "core_test/file_helper.h"
+
+#include <cstring>
+#include <string>
+
+using std::string;
+using namespace wwiv::core;
+
+TEST(MappedFileTest, ReadOnly) {
+  FileHelper file;
+  const auto path = file.CreateTempFile("mapped.txt", "Hello World");
+
+  MappedFile m(path);
+  ASSERT_TRUE(m.IsOpen());
+  ASSERT_EQ(11u, m.size());
+  EXPECT_EQ("Hello World", string(reinterpret_cast<const char*>(m.data()), m.size()));
+  EXPECT_EQ(nullptr, m.mutable_data());
+}
+
+TEST(MappedFileTest, ReadWrite) {
+  FileHelper file;
+  const auto path = file.CreateTempFile("mapped.txt", "Hello World");
+  {
+    MappedFile m(path, MappedFile::Mode::read_write);
+    ASSERT_TRUE(m.IsOpen());
+    memcpy(m.mutable_data(), "J", 1);
+    EXPECT_TRUE(m.Flush());
+  }
+  EXPECT_EQ("Jello World", file.ReadFile(path));
+}
+
+TEST(MappedFileTest, Empty) {
+  FileHelper file;
+  const auto path = file.CreateTempFile("empty.txt", "");
+
+  MappedFile m(path);
+  ASSERT_TRUE(m.IsOpen());
+  EXPECT_EQ(0u, m.size());
+  EXPECT_EQ(nullptr, m.data());
+}
+
+TEST(MappedFileTest, DoesNotExist) {
+  FileHelper file;
+  MappedFile m(FilePath(file.TempDir(), "doesnotexist.txt"));
+  EXPECT_FALSE(m.IsOpen());
+}
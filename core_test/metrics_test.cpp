@@ -0,0 +1,110 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+#include "core/metrics.h"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using namespace wwiv::core;
+
+TEST(MetricsTest, Counter_ManyThreads) {
+  Counter c;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&c] {
+      for (int i = 0; i < 10000; i++) {
+        c.Increment();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(80000, c.value());
+}
+
+TEST(MetricsTest, Gauge) {
+  Gauge g;
+  g.Increment();
+  g.Increment();
+  g.Decrement();
+  EXPECT_EQ(1, g.value());
+  g.Set(10);
+  g.Add(-3);
+  EXPECT_EQ(7, g.value());
+}
+
+TEST(MetricsTest, Histogram) {
+  Histogram h({1, 5, 10});
+  h.Observe(0.5);
+  h.Observe(1);
+  h.Observe(7);
+  h.Observe(100);
+  const auto s = h.snapshot();
+  EXPECT_EQ(std::vector<int64_t>({2, 0, 1, 1}), s.counts);
+  EXPECT_EQ(4, s.count);
+  EXPECT_DOUBLE_EQ(108.5, s.sum);
+}
+
+TEST(MetricsTest, ExponentialBuckets) {
+  EXPECT_EQ(std::vector<double>({1, 2, 4, 8}), exponential_buckets(1, 2, 4));
+}
+
+TEST(MetricsTest, Registry_SameMetric) {
+  MetricsRegistry r;
+  auto& a = r.counter("x_total", "X.", {{"type", "a"}});
+  auto& b = r.counter("x_total", "X.", {{"type", "b"}});
+  EXPECT_NE(&a, &b);
+  EXPECT_EQ(&a, &r.counter("x_total", "X.", {{"type", "a"}}));
+  EXPECT_THROW(r.gauge("x_total", "X."), std::invalid_argument);
+}
+
+TEST(MetricsTest, Exposition) {
+  MetricsRegistry r;
+  r.counter("wwivd_accepted_total", "Connections accepted.", {{"type", "telnet"}}).Increment(3);
+  r.gauge("wwivd_nodes_in_use", "Nodes in use.").Set(2);
+  auto& h = r.histogram("wwivd_session_seconds", "Session length.", {1, 10});
+  h.Observe(0.5);
+  h.Observe(5);
+  const string expected =
+      "# HELP wwivd_accepted_total Connections accepted.\n"
+      "# TYPE wwivd_accepted_total counter\n"
+      "wwivd_accepted_total{type=\"telnet\"} 3\n"
+      "# HELP wwivd_nodes_in_use Nodes in use.\n"
+      "# TYPE wwivd_nodes_in_use gauge\n"
+      "wwivd_nodes_in_use 2\n"
+      "# HELP wwivd_session_seconds Session length.\n"
+      "# TYPE wwivd_session_seconds histogram\n"
+      "wwivd_session_seconds_bucket{le=\"1\"} 1\n"
+      "wwivd_session_seconds_bucket{le=\"10\"} 2\n"
+      "wwivd_session_seconds_bucket{le=\"+Inf\"} 2\n"
+      "wwivd_session_seconds_sum 5.5\n"
+      "wwivd_session_seconds_count 2\n";
+  EXPECT_EQ(expected, r.Exposition());
+}
+
+TEST(MetricsTest, Exposition_EscapesLabels) {
+  MetricsRegistry r;
+  r.counter("x_total", "X.", {{"peer", "a\"b\\c"}}).Increment();
+  EXPECT_NE(string::npos, r.Exposition().find("x_total{peer=\"a\\\"b\\\\c\"} 1\n"));
+}
@@ -16,8 +16,10 @@
 /*    language governing permissions and limitations under the License.   */
 /*                                                                        */
 /**************************************************************************/
+#include <atomic>
 #include <chrono>
 #include <string>
+#include <thread>
 
 #include "core/file.h"
 #include "core/log.h"
@@ -26,7 +28,13 @@
 #include "file_helper.h"
 #include "gtest/gtest.h"
 
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 using std::string;
+using namespace std::chrono;
 using namespace wwiv::core;
 using namespace wwiv::strings;
 
@@ -66,3 +74,62 @@ TEST(SemaphoreFileTest, Smoke) {
 
   EXPECT_TRUE(File::Exists(fn)) << fn;
 }
+
+TEST(SemaphoreFileTest, WakesOnRelease) {
+  FileHelper file;
+  const auto fn = FilePath(file.TempDir(), "x.sem");
+  std::atomic<bool> acquired{false};
+  std::thread holder([&] {
+    auto held = SemaphoreFile::try_acquire(fn, "", milliseconds(100));
+    acquired.store(true);
+    std::this_thread::sleep_for(milliseconds(100));
+  });
+  while (!acquired.load()) {
+    std::this_thread::yield();
+  }
+
+  const auto start = steady_clock::now();
+  auto ok = SemaphoreFile::try_acquire(fn, "", seconds(10));
+  holder.join();
+  // Polling used to take up to a second to notice the release.
+  EXPECT_LT(steady_clock::now() - start, milliseconds(900));
+}
+
+#ifndef _WIN32
+// Returns the pid of a process that has already exited.
+static pid_t dead_pid() {
+  const auto pid = fork();
+  if (pid == 0) {
+    _exit(0);
+  }
+  waitpid(pid, nullptr, 0);
+  return pid;
+}
+
+TEST(SemaphoreFileTest, RemovesStale) {
+  FileHelper file;
+  // Left behind by a process that exited without removing it.
+  const auto fn = file.CreateTempFile("x.sem", StrCat("WWIV-SEMAPHORE pid: ", dead_pid(), "\n"));
+
+  auto ok = SemaphoreFile::try_acquire(fn, "", seconds(5));
+  EXPECT_TRUE(File::Exists(fn));
+}
+
+TEST(SemaphoreFileTest, KeepsUnmarked) {
+  FileHelper file;
+  // Nothing says who owns this one, so it must be waited for.
+  const auto fn = file.CreateTempFile("x.sem", "Created by pid: 1");
+
+  EXPECT_THROW(SemaphoreFile::try_acquire(fn, "", milliseconds(100)), semaphore_not_acquired);
+  EXPECT_TRUE(File::Exists(fn));
+}
+
+TEST(SemaphoreFileTest, KeepsLiveOwner) {
+  FileHelper file;
+  // Not locked, but the owner is still running.
+  const auto fn = file.CreateTempFile("x.sem", StrCat("WWIV-SEMAPHORE pid: ", getpid(), "\n"));
+
+  EXPECT_THROW(SemaphoreFile::try_acquire(fn, "", milliseconds(100)), semaphore_not_acquired);
+  EXPECT_TRUE(File::Exists(fn));
+}
+#endif  // _WIN32
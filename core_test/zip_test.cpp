@@ -0,0 +1,108 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+#include "core/file.h"
+#include "core/zip.h"
+#include "core_test/file_helper.h"
+
+#include <string>
+
+using std::string;
+using namespace wwiv::core;
+
+// 0001abcd.pkt containing "Hello FidoNet. " * 20, deflated by another zip implementation.
+static const char kZip[] =
+      "\x50\x4b\x03\x04\x14\x00\x00\x00\x08\x00\x83\x18\x22\x4c\x36\xac\x61\x01\x16\x00\x00\x00\x2c\x01"
+      "\x00\x00\x0c\x00\x00\x00\x30\x30\x30\x31\x61\x62\x63\x64\x2e\x70\x6b\x74\xf3\x48\xcd\xc9\xc9\x57"
+      "\x70\xcb\x4c\xc9\xf7\x4b\x2d\xd1\x53\xf0\x18\xe5\xe2\xe6\x02\x00\x50\x4b\x01\x02\x14\x03\x14\x00"
+      "\x00\x00\x08\x00\x83\x18\x22\x4c\x36\xac\x61\x01\x16\x00\x00\x00\x2c\x01\x00\x00\x0c\x00\x00\x00"
+      "\x00\x00\x00\x00\x00\x00\x00\x00\x80\x01\x00\x00\x00\x00\x30\x30\x30\x31\x61\x62\x63\x64\x2e\x70"
+      "\x6b\x74\x50\x4b\x05\x06\x00\x00\x00\x00\x01\x00\x01\x00\x3a\x00\x00\x00\x40\x00\x00\x00\x00\x00";
+
+class ZipTest : public ::testing::Test {
+protected:
+  string CreateBinaryFile(const string& name, const string& contents) {
+    const auto path = helper_.CreateTempFilePath(name);
+    File f(path);
+    f.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite | File::modeTruncate);
+    f.Write(contents);
+    return path;
+  }
+
+  FileHelper helper_;
+};
+
+TEST_F(ZipTest, ReadsExternalZip) {
+  const auto path = CreateBinaryFile("test.su0", string(kZip, sizeof(kZip) - 1));
+  EXPECT_TRUE(IsZipFile(path));
+
+  ZipReader zip(path);
+  ASSERT_TRUE(zip.IsOpen());
+  ASSERT_EQ(1u, zip.entries().size());
+  const auto& e = zip.entries().front();
+  EXPECT_EQ("0001abcd.pkt", e.name);
+  EXPECT_EQ(8, e.method);
+
+  string contents;
+  ASSERT_TRUE(zip.Extract(e, contents));
+  string expected;
+  for (int i = 0; i < 20; i++) {
+    expected.append("Hello FidoNet. ");
+  }
+  EXPECT_EQ(expected, contents);
+}
+
+TEST_F(ZipTest, RoundTrip) {
+  const auto path = helper_.CreateTempFilePath("out.zip");
+  string compressible(64 * 1024, 'x');
+  string incompressible;
+  for (int i = 0; i < 256; i++) {
+    incompressible.push_back(static_cast<char>((i * 7919) & 0xff));
+  }
+  {
+    ZipWriter w(path);
+    ASSERT_TRUE(w.IsOpen());
+    EXPECT_TRUE(w.Add("a.pkt", compressible, time(nullptr)));
+    EXPECT_TRUE(w.Add("b.pkt", incompressible, time(nullptr)));
+    EXPECT_TRUE(w.Add("empty.pkt", "", time(nullptr)));
+    EXPECT_TRUE(w.Close());
+  }
+
+  ZipReader zip(path);
+  ASSERT_TRUE(zip.IsOpen());
+  ASSERT_EQ(3u, zip.entries().size());
+  EXPECT_EQ(8, zip.entries().at(0).method);
+  EXPECT_LT(zip.entries().at(0).compressed_size, compressible.size());
+  EXPECT_EQ(0, zip.entries().at(1).method);
+
+  string contents;
+  ASSERT_TRUE(zip.Extract(zip.entries().at(0), contents));
+  EXPECT_EQ(compressible, contents);
+  ASSERT_TRUE(zip.Extract(zip.entries().at(1), contents));
+  EXPECT_EQ(incompressible, contents);
+  ASSERT_TRUE(zip.Extract(zip.entries().at(2), contents));
+  EXPECT_TRUE(contents.empty());
+}
+
+TEST_F(ZipTest, NotAZip) {
+  const auto path = helper_.CreateTempFile("test.pkt", "This is not a zip file at all.");
+  EXPECT_FALSE(IsZipFile(path));
+  ZipReader zip(path);
+  EXPECT_FALSE(zip.IsOpen());
+}
@@ -0,0 +1,42 @@
+/*
+  wwiv_infozip.h - In-process deflate/inflate for WWIV built on Info-ZIP.
+
+  Only the compression engines from zip30 (deflate.c, trees.c) and
+  unzip60 (inflate.c) are compiled; wwiv_zip.c and wwiv_unzip.c replace the
+  zip and unzip front ends.  The Info-ZIP engines keep their state in
+  globals, so none of these functions are reentrant.  Callers must
+  serialize access.
+
+  See LICENSE in zip30 and unzip60 for the Info-ZIP license.
+*/
+#ifndef __INCLUDED_WWIV_INFOZIP_H__
+#define __INCLUDED_WWIV_INFOZIP_H__
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Receives len bytes of output.  Returns 0 on success. */
+typedef int (*wwiv_infozip_write_fn)(void* context, const unsigned char* buf, unsigned long len);
+
+/*
+  Inflates the raw deflate stream that starts at the current position of
+  in, calling write_fn with the uncompressed data.  Returns 0 on success.
+*/
+int wwiv_infozip_inflate(FILE* in, wwiv_infozip_write_fn write_fn, void* context);
+
+/*
+  Deflates len bytes of buf at the given level (1-9) into a raw deflate
+  stream, calling write_fn with the compressed data.  Returns the number of
+  compressed bytes, or -1 on error.
+*/
+long wwiv_infozip_deflate(const char* buf, unsigned long len, int level,
+                          wwiv_infozip_write_fn write_fn, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDED_WWIV_INFOZIP_H__ */
@@ -0,0 +1,45 @@
+/*
+  wwiv_unzip.c - Replaces the funzip front end so that unzip60/inflate.c
+  can inflate a single ZIP member in-process.  Compiled with FUNZIP, which
+  makes inflate.c read through getc(G.in) and write through flush().
+*/
+#ifndef FUNZIP
+#  define FUNZIP
+#endif
+#define UNZIP_INTERNAL
+#include "unzip.h"
+
+#include "../wwiv_infozip.h"
+
+Uz_Globs G;
+
+ZCONST unsigned near mask_bits[17] = {
+    0x0000,
+    0x0001, 0x0003, 0x0007, 0x000f, 0x001f, 0x003f, 0x007f, 0x00ff,
+    0x01ff, 0x03ff, 0x07ff, 0x0fff, 0x1fff, 0x3fff, 0x7fff, 0xffff
+};
+
+static wwiv_infozip_write_fn wwiv_write_fn;
+static void* wwiv_write_context;
+
+int flush(w)    /* used by inflate.c (FLUSH macro) */
+ulg w;          /* number of bytes to flush */
+{
+  return wwiv_write_fn(wwiv_write_context, slide, w) == 0 ? 0 : PK_DISK;
+}
+
+int wwiv_infozip_inflate(FILE* in, wwiv_infozip_write_fn write_fn, void* context)
+{
+  int r;
+
+  memzero(&G, sizeof(Uz_Globs));
+  G.in = in;
+  wwiv_write_fn = write_fn;
+  wwiv_write_context = context;
+
+  r = inflate(0);
+  inflate_free();
+  wwiv_write_fn = NULL;
+  wwiv_write_context = NULL;
+  return r;
+}
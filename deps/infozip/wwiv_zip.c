@@ -0,0 +1,107 @@
+/*
+  wwiv_zip.c - Replaces the zip front end (zip.c, zipup.c, globals.c) so
+  that zip30/deflate.c and zip30/trees.c can compress a buffer in-process.
+  Based on memcompress() in zipup.c.
+*/
+#include <setjmp.h>
+
+#include "zip.h"
+
+#include "wwiv_infozip.h"
+
+/* Globals referenced by deflate.c and trees.c */
+int level = 6;
+int verbose = 0;
+int noisy = 0;
+zoff_t dot_size = 0;
+zoff_t dot_count = 0;
+int display_globaldots = 0;
+int use_descriptors = 0;
+int mesg_line_started = 0;
+char *key = NULL;
+FILE *mesg = NULL;
+unsigned (*read_buf) OF((char *buf, unsigned size));
+
+/* Defined in deflate.c */
+extern ulg window_size;
+
+static const char* wwiv_in_buf;
+static ulg wwiv_in_size;
+static ulg wwiv_in_offset;
+static wwiv_infozip_write_fn wwiv_write_fn;
+static void* wwiv_write_context;
+static ulg wwiv_out_total;
+static jmp_buf wwiv_error_jmp;
+static char wwiv_out_buf[16384];
+
+void error(h)
+  ZCONST char *h;
+{
+  (void)h;
+  longjmp(wwiv_error_jmp, 1);
+}
+
+/* Never rewrite the local header to switch the method to STORE. */
+int seekable()
+{
+  return 0;
+}
+
+void flush_outbuf(o_buf, o_idx)
+  char *o_buf;
+  unsigned *o_idx;
+{
+  if (*o_idx != 0) {
+    if (wwiv_write_fn(wwiv_write_context, (const unsigned char*)o_buf, *o_idx) != 0) {
+      error("write error");
+    }
+    wwiv_out_total += *o_idx;
+  }
+  *o_idx = 0;
+}
+
+local unsigned mem_read(b, bsize)
+  char *b;
+  unsigned bsize;
+{
+  if (wwiv_in_offset < wwiv_in_size) {
+    ulg block_size = wwiv_in_size - wwiv_in_offset;
+    if (block_size > (ulg)bsize) block_size = (ulg)bsize;
+    memcpy(b, wwiv_in_buf + wwiv_in_offset, (unsigned)block_size);
+    wwiv_in_offset += block_size;
+    return (unsigned)block_size;
+  }
+  return 0; /* end of input */
+}
+
+long wwiv_infozip_deflate(const char* buf, unsigned long len, int lvl,
+                          wwiv_infozip_write_fn write_fn, void* context)
+{
+  ush att = (ush)UNKNOWN;
+  ush flags = 0;
+  int method = DEFLATE;
+
+  wwiv_in_buf = buf;
+  wwiv_in_size = len;
+  wwiv_in_offset = 0;
+  wwiv_write_fn = write_fn;
+  wwiv_write_context = context;
+  wwiv_out_total = 0;
+  level = (lvl < 1 || lvl > 9) ? 6 : lvl;
+
+  if (setjmp(wwiv_error_jmp) != 0) {
+    lm_free();
+    window_size = 0L;
+    return -1;
+  }
+
+  read_buf = mem_read;
+  window_size = 0L;
+  bi_init(wwiv_out_buf, sizeof(wwiv_out_buf), TRUE);
+  ct_init(&att, &method);
+  lm_init(level, &flags);
+  deflate();
+  lm_free();
+  window_size = 0L;
+  return (long)wwiv_out_total;
+}
@@ -17,6 +17,8 @@
 /**************************************************************************/
 
 // WWIV5 Network1
+#include "network1/network1.h"
+
 #include <cctype>
 #include <cstdlib>
 #include <iostream>
@@ -58,12 +60,6 @@ using namespace wwiv::sdk::net;
 using namespace wwiv::stl;
 using namespace wwiv::os;
 
-static void ShowHelp(const CommandLine& cmdline) {
-  cout << cmdline.GetHelp() << ".####      Network number (as defined in wwivconfig)" << endl
-       << endl;
-  exit(1);
-}
-
 static std::string wwivnet_packet_name(const net_networks_rec& net, uint16_t node) {
   return Packet::wwivnet_packet_name(net, node);
 }
@@ -184,23 +180,3 @@ int network1_main(const NetworkCommandLine& net_cmdline) {
   }
   return 2;
 }
-
-int main(int argc, char** argv) { 
-  Logger::Init(argc, argv);
-  ScopeExit at_exit(Logger::ExitLogger);
-  CommandLine cmdline(argc, argv, "net");
-  NetworkCommandLine net_cmdline(cmdline, '1');
-  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-    ShowHelp(net_cmdline.cmdline());
-    return 1;
-  }
-
-  try {
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_filename(),
-                                                net_cmdline.semaphore_timeout());
-    return network1_main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  }
-}
\ No newline at end of file
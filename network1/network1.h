@@ -0,0 +1,31 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*             Copyright (C)2016-2017, WWIV Software Services             */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef __INCLUDED_NETWORK1_NETWORK1_H__
+#define __INCLUDED_NETWORK1_NETWORK1_H__
+
+#include "networkb/net_util.h"
+
+/**
+ * network1: Routes pending packets (p*.net) into the outbound (s*.net) or local.net.
+ *
+ * Returns 0 on success. The caller is responsible for acquiring the network
+ * semaphore (see NetworkCommandLine::semaphore_filename).
+ */
+int network1_main(const wwiv::net::NetworkCommandLine& net_cmdline);
+
+#endif // __INCLUDED_NETWORK1_NETWORK1_H__
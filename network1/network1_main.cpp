@@ -0,0 +1,62 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*             Copyright (C)2016-2017, WWIV Software Services             */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+
+// WWIV5 Network1
+#include "network1/network1.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "core/command_line.h"
+#include "core/log.h"
+#include "core/scope_exit.h"
+#include "core/semaphore_file.h"
+#include "networkb/net_util.h"
+
+using std::cout;
+using std::endl;
+
+using namespace wwiv::core;
+using namespace wwiv::net;
+
+static void ShowHelp(const CommandLine& cmdline) {
+  cout << cmdline.GetHelp() << ".####      Network number (as defined in wwivconfig)" << endl
+       << endl;
+  exit(1);
+}
+
+int main(int argc, char** argv) {
+  Logger::Init(argc, argv);
+  ScopeExit at_exit(Logger::ExitLogger);
+  CommandLine cmdline(argc, argv, "net");
+  NetworkCommandLine net_cmdline(cmdline, '1');
+  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
+    ShowHelp(net_cmdline.cmdline());
+    return 1;
+  }
+
+  try {
+    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_filename(),
+                                                net_cmdline.semaphore_timeout());
+    return network1_main(net_cmdline);
+  } catch (const semaphore_not_acquired& e) {
+    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
+               << "]: Unable to Acquire Network Semaphore: " << e.what();
+  }
+}
@@ -21,6 +21,7 @@
 #include "sdk/config.h"
 #include "sdk/msgapi/message_api_wwiv.h"
 #include "sdk/msgapi/msgapi.h"
+#include "sdk/net/packets.h"
 #include "sdk/net.h"
 #include "sdk/networks.h"
 #include "sdk/subxtr.h"
@@ -63,6 +64,8 @@ public:
   const std::vector<net_networks_rec> networks_;
   bool verbose = false;
   bool subs_initialized = false;
+  // Outbound posts to subscribers, written once local.net has been processed.
+  wwiv::sdk::net::PacketFanout fanout;
 };
 
 } // namespace network2
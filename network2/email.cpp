@@ -84,17 +84,15 @@ namespace network2 {
 
 // Gets the user number or 0 if it is not found.
 static int GetUserNumber(const std::string name, UserManager& um) {
-  auto max = um.num_user_records();
-  for (int i = 0; i <= max; i++) {
-    User u;
-    if (!um.readuser_nocache(&u, i)) {
-      continue;
-    }
+  int user_number = 0;
+  um.for_each_user([&](int n, User& u) {
     if (iequals(name.c_str(), u.GetName())) {
-      return i;
+      user_number = n;
+      return false;
     }
-  }
-  return 0;
+    return true;
+  });
+  return user_number;
 }
 
 bool handle_email_byname(Context& context, Packet& p) {
@@ -17,6 +17,8 @@
 /**************************************************************************/
 
 // WWIV5 Network2
+#include "network2/network2.h"
+
 #include <cctype>
 #include <cstdlib>
 #include <cstring>
@@ -58,6 +60,7 @@
 #include "sdk/filenames.h"
 #include "sdk/networks.h"
 #include "sdk/ssm.h"
+#include "sdk/status.h"
 #include "sdk/subxtr.h"
 #include "sdk/vardec.h"
 #include "sdk/usermanager.h"
@@ -88,26 +91,13 @@ static bool email_changed = false;
 static bool posts_changed = false;
 
 static void update_filechange_status_dat(const string& datadir, bool email, bool posts) {
-  statusrec_t status{};
-  DataFile<statusrec_t> file(FilePath(datadir, STATUS_DAT), File::modeBinary | File::modeReadWrite);
-  if (file) {
-    if (file.Read(0, &status)) {
-      if (email) {
-        status.filechange[filechange_email]++;
-      }
-      if (posts) {
-        status.filechange[filechange_posts]++;
-      }
-      file.Write(0, &status);
-    }
+  StatusMgr sm(datadir, [](int) {});
+  if (email) {
+    sm.IncrementFileChangedFlag(filechange_email);
+  }
+  if (posts) {
+    sm.IncrementFileChangedFlag(filechange_posts);
   }
-}
-
-static void ShowHelp(const CommandLine& cmdline) {
-  cout << cmdline.GetHelp()
-       << ".####      Network number (as defined in wwivconfig)" << endl
-       << endl;
-  exit(1);
 }
 
 static bool handle_ssm(Context& context, Packet& p) {
@@ -292,6 +282,9 @@ static bool handle_file(Context& context, const string& name) {
 
 int network2_main(const NetworkCommandLine& net_cmdline) {
   try {
+    // We may be invoked more than once per process by networkc.
+    email_changed = false;
+    posts_changed = false;
     const auto& net = net_cmdline.network();
     if (!File::Exists(net.dir, LOCAL_NET)) {
       LOG(INFO) << "No local.net exists. exiting.";
@@ -319,7 +312,12 @@ int network2_main(const NetworkCommandLine& net_cmdline) {
     context.set_api(2, std::move(type2_api));
 
     LOG(INFO) << "Processing: " << net.dir << LOCAL_NET;
-    if (handle_file(context, LOCAL_NET)) {
+    const auto handled = handle_file(context, LOCAL_NET);
+    // Posts already imported must go out even if local.net was not fully read.
+    if (!context.fanout.Flush()) {
+      LOG(ERROR) << "ERROR: Unable to write all outbound posts.";
+    }
+    if (handled) {
       if (net_cmdline.skip_delete()) {
         backup_file(FilePath(net.dir, LOCAL_NET));
       }
@@ -339,23 +337,3 @@ int network2_main(const NetworkCommandLine& net_cmdline) {
 
   return 255;
 }
-
-int main(int argc, char** argv) {
-  Logger::Init(argc, argv);
-  ScopeExit at_exit(Logger::ExitLogger);
-  CommandLine cmdline(argc, argv, "net");
-  NetworkCommandLine net_cmdline(cmdline, '2');
-  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-    ShowHelp(net_cmdline.cmdline());
-    return 1;
-  }
-
-  try {
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_filename(),
-                                                net_cmdline.semaphore_timeout());
-    return network2_main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  }
-}
\ No newline at end of file
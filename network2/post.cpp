@@ -213,7 +213,7 @@ bool send_post_to_subscribers(Context& context, Packet& template_packet,
 
   return send_post_to_subscribers(context.networks(), context.network_number, original_subtype, sub,
                                   template_packet, subscribers_to_skip,
-                                  subscribers_send_to_t::hosted_and_gated_only);
+                                  subscribers_send_to_t::hosted_and_gated_only, context.fanout);
 }
 
 } // namespace network2
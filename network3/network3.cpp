@@ -17,6 +17,8 @@
 /**************************************************************************/
 
 // WWIV5 Network3
+#include "network3/network3.h"
+
 #include <cctype>
 #include <cstdlib>
 #include <ctime>
@@ -55,11 +57,13 @@
 #include "core/datetime.h"
 #include "sdk/filenames.h"
 #include "sdk/networks.h"
+#include "sdk/status.h"
 #include "sdk/subscribers.h"
 #include "sdk/subxtr.h"
 #include "sdk/fido/fido_address.h"
 #include "sdk/fido/fido_callout.h"
 #include "sdk/fido/nodelist.h"
+#include "sdk/fido/nodelist_index.h"
 #include "sdk/net/packets.h"
 
 using std::cout;
@@ -78,13 +82,6 @@ using namespace wwiv::sdk::net;
 using namespace wwiv::stl;
 using namespace wwiv::os;
 
-static void ShowHelp(const CommandLine& cmdline) {
-  cout << cmdline.GetHelp()
-       << ".####      Network number (as defined in wwivconfig)" << endl
-       << endl;
-  exit(1);
-}
-
 static bool check_wwivnet_host_networks(
   const wwiv::sdk::Config& config, 
   const wwiv::sdk::Networks& network,
@@ -305,7 +302,7 @@ static bool add_feedback_general_info(
   return true;
 }
 
-void update_timestamps(const string& dir) {
+static void update_timestamps(const string& dir) {
   // Update timestamps on {bbslist,connect,callout}.net
   File bbsdata_net_file(FilePath(dir, BBSDATA_NET));
   time_t t = bbsdata_net_file.last_write_time();
@@ -357,32 +354,20 @@ static void write_bbsdata_files(const vector<net_system_list_rec>& bbsdata_data,
 }
 
 static void update_net_ver_status_dat(const string& datadir) {
-  statusrec_t statusrec{};
-  DataFile<statusrec_t> file(FilePath(datadir, STATUS_DAT), File::modeBinary | File::modeReadWrite);
-  if (!file) {
-    return;
-  }
-  if (!file.Read(0, &statusrec)) {
+  StatusMgr sm(datadir, [](int) {});
+  if (sm.GetStatus()->GetNetworkVersion() == wwiv_net_version) {
     return;
   }
-  if (statusrec.net_version == wwiv_net_version) {
-    return;
-  }
-  statusrec.net_bias = 0;
-  statusrec.net_req_free = 0;
-  statusrec.net_version = static_cast<uint16_t>(wwiv_net_version);
-  file.Write(0, &statusrec);
+  sm.Run([](WStatus& s) {
+    s.SetNetworkBias(0);
+    s.SetNetworkRequestFree(0);
+    s.SetNetworkVersion(wwiv_net_version);
+  });
 }
 
 static void update_filechange_status_dat(const string& datadir) {
-  statusrec_t statusrec{};
-  DataFile<statusrec_t> file(FilePath(datadir, STATUS_DAT), File::modeBinary | File::modeReadWrite);
-  if (file) {
-    if (file.Read(0, &statusrec)) {
-      statusrec.filechange[filechange_net]++;
-      file.Write(0, &statusrec);
-    }
-  }
+  StatusMgr sm(datadir, [](int) {});
+  sm.IncrementFileChangedFlag(filechange_net);
 }
 
 static void rename_pending_files(const string& dir) {
@@ -507,17 +492,17 @@ static int network3_fido(const NetworkCommandLine& net_cmdline) {
     text << " ** Please fix it.\r\n\n";
   } else {
     text << " [" << time_t_to_wwivnet_time(nlfile.creation_time()) << "]\r\n";
-    auto nl_path = File::absolute(dirs.net_dir(), nodelist);
-    Nodelist nl(nl_path);
-    if (!nl.initialized()) {
+    // Compiles the nodelist index if it's missing or out of date.
+    auto nl = NodelistIndex::Open(dirs.net_dir(), net.fido.nodelist_base);
+    if (!nl) {
       text << " ** Unable to parse nodelist.\r\n";
       text << " ** Please fix it.\r\n\n";
     } else {
-      if (!nl.contains(address)) {
+      if (!nl->contains(address)) {
         text << " ** Your address: '" << address << "' does not exist in the nodelist: '" << nodelist << ".\r\n";
       }
       for (const auto& ncs : callout.node_configs_map()) {
-        if (!nl.contains(ncs.first)) {
+        if (!nl->contains(ncs.first)) {
           text << " ** Callout address: '" << ncs.first.as_string() << "' does not exist in the nodelist.\r\n";
         }
       }
@@ -607,25 +592,3 @@ int network3_main(const NetworkCommandLine& net_cmdline) {
   }
   return 2;
 }
-
-
-int main(int argc, char** argv) {
-  Logger::Init(argc, argv);
-  ScopeExit at_exit(Logger::ExitLogger);
-  CommandLine cmdline(argc, argv, "net");
-  cmdline.add_argument(BooleanCommandLineArgument("feedback", 'y', "Sends feedback.", false));
-  NetworkCommandLine net_cmdline(cmdline, '2');
-  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-    ShowHelp(net_cmdline.cmdline());
-    return 1;
-  }
-
-  try {
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_filename(),
-                                                net_cmdline.semaphore_timeout());
-    return network3_main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  }
-}
@@ -61,38 +61,60 @@ NetworkCommandLine::NetworkCommandLine(wwiv::core::CommandLine& cmdline, char ne
   if (!cmdline.Parse()) {
     initialized_ = false;
   }
-  network_number_ = cmdline.arg("net").as_int();
   // TODO(rushfan): Need to look to see if WWIV_CONFIG_FILE is set 1st.
-  config_.reset(new wwiv::sdk::Config(cmdline.bbsdir()));
-  networks_.reset(new wwiv::sdk::Networks(*config_.get()));
+  config_ = std::make_shared<wwiv::sdk::Config>(cmdline.bbsdir());
+  networks_ = std::make_shared<wwiv::sdk::Networks>(*config_.get());
+  if (!Initialize()) {
+    initialized_ = false;
+  }
+}
+
+NetworkCommandLine::NetworkCommandLine(wwiv::core::CommandLine& cmdline, char net_cmd,
+                                       const NetworkCommandLine& parent)
+    : config_(parent.config_), networks_(parent.networks_), cmdline_(cmdline),
+      net_cmd_(net_cmd) {
+  cmdline.set_no_args_allowed(true);
+  cmdline.AddStandardArgs();
+  AddStandardNetworkArgs(cmdline, File::current_directory());
+
+  if (!cmdline.Parse()) {
+    initialized_ = false;
+  }
+  if (!Initialize()) {
+    initialized_ = false;
+  }
+}
+
+bool NetworkCommandLine::Initialize() {
+  network_number_ = cmdline_.arg("net").as_int();
 
   if (!config_->IsInitialized()) {
     LOG(ERROR) << "Unable to load CONFIG.DAT.";
-    initialized_ = false;
+    return false;
   }
   if (!networks_->IsInitialized()) {
     LOG(ERROR) << "Unable to load networks.";
-    initialized_ = false;
+    return false;
   }
   const auto& nws = networks_->networks();
 
   if (network_number_ < 0 || network_number_ >= size_int(nws)) {
     LOG(ERROR) << "network number must be between 0 and " << nws.size() << ".";
-    initialized_ = false;
-    return;
+    return false;
   }
   network_ = nws[network_number_];
   network_name_ = ToStringLowerCase(network_.name);
-  LOG(STARTUP) << cmdline.program_name() << " [" << wwiv_version << beta_version << "]"
+  LOG(STARTUP) << cmdline_.program_name() << " [" << wwiv_version << beta_version << "]"
                << " for network: " << network_name_;
   if (!quiet()) {
-    std::cerr << cmdline.program_name() << " [" << wwiv_version << beta_version << "]"
+    std::cerr << cmdline_.program_name() << " [" << wwiv_version << beta_version << "]"
               << " for network: " << network_name_ << std::endl;
   }
 
   if (!LoadNetIni()) {
     LOG(ERROR) << "Error loading INI file for defaults";
   }
+  return true;
 }
 
 // Returns the name of the network command for the command character
@@ -42,6 +42,14 @@ void AddStandardNetworkArgs(wwiv::core::CommandLine& cmdline, const std::string&
 class NetworkCommandLine {
 public:
   NetworkCommandLine(wwiv::core::CommandLine& cmdline, char net_cmd);
+  /**
+   * Creates a NetworkCommandLine for the network command net_cmd that shares
+   * the already loaded Config and Networks from parent instead of reloading
+   * them from disk.  This is used by networkc to run the other network
+   * commands in-process.
+   */
+  NetworkCommandLine(wwiv::core::CommandLine& cmdline, char net_cmd,
+                     const NetworkCommandLine& parent);
 
   bool IsInitialized() const noexcept { return initialized_; }
   const wwiv::sdk::Config& config() const noexcept { return *config_.get(); }
@@ -61,8 +69,10 @@ public:
   std::chrono::duration<double> semaphore_timeout() const noexcept;
 
 private:
-  std::unique_ptr<wwiv::sdk::Config> config_;
-  std::unique_ptr<wwiv::sdk::Networks> networks_;
+  bool Initialize();
+
+  std::shared_ptr<wwiv::sdk::Config> config_;
+  std::shared_ptr<wwiv::sdk::Networks> networks_;
   std::string network_name_;
   int network_number_{0};
   bool initialized_{true};
@@ -38,7 +38,11 @@
 #include "core/stl.h"
 #include "core/strings.h"
 #include "core/version.h"
+#include "network1/network1.h"
+#include "network2/network2.h"
+#include "network3/network3.h"
 #include "networkb/net_util.h"
+#include "networkf/networkf.h"
 #include "sdk/fido/fido_util.h"
 
 #include "core/datetime.h"
@@ -85,32 +89,74 @@ static void rename_bbs_instance_files(const string& dir, int instance_number, bo
   }
 }
 
-string create_network_cmdline(const NetworkCommandLine& net_cmdline, char num, const string& cmd) {
-  const auto path = FilePath(net_cmdline.cmdline().bindir(), StrCat("network", num));
-
-  std::ostringstream ss;
-  ss << path;
-  ss << " --v=" << net_cmdline.cmdline().verbose();
+static std::vector<std::string> create_network_args(const NetworkCommandLine& net_cmdline,
+                                                    char num, const string& cmd) {
+  std::vector<std::string> args;
+  args.push_back(FilePath(net_cmdline.cmdline().bindir(), StrCat("network", num)));
+  args.push_back(StrCat("--v=", net_cmdline.cmdline().verbose()));
   if (net_cmdline.quiet()) {
-    ss << " --quiet";
+    args.push_back("--quiet");
   }
-  ss << " --bbsdir=" << net_cmdline.cmdline().bbsdir();
-  ss << " --bindir=" << net_cmdline.cmdline().bindir();
-  ss << " --configdir=" << net_cmdline.cmdline().configdir();
-  ss << " --logdir=" << net_cmdline.cmdline().logdir();
-  ss << " ." << net_cmdline.network_number();
+  args.push_back(StrCat("--bbsdir=", net_cmdline.cmdline().bbsdir()));
+  args.push_back(StrCat("--bindir=", net_cmdline.cmdline().bindir()));
+  args.push_back(StrCat("--configdir=", net_cmdline.cmdline().configdir()));
+  args.push_back(StrCat("--logdir=", net_cmdline.cmdline().logdir()));
+  args.push_back(StrCat(".", net_cmdline.network_number()));
   if (num == '3') {
-    ss << " Y";
+    args.push_back("Y");
   }
   if (!cmd.empty()) {
-    ss << " " << cmd;
+    args.push_back(cmd);
   }
-  return ss.str();
+  return args;
 }
 
-static int System(const string& cmd) {
-  VLOG(1) << "Command: " << cmd;
-  return system(cmd.c_str());
+/**
+ * Runs network{num} in-process, sharing the Config and Networks already
+ * loaded by networkc instead of spawning a new process which would reload
+ * them from disk.
+ */
+static int RunNetworkCommand(const NetworkCommandLine& net_cmdline, char num, const string& cmd) {
+  const auto args = create_network_args(net_cmdline, num, cmd);
+  VLOG(1) << "Command: " << JoinStrings(args, " ");
+
+  CommandLine cmdline(args, "net");
+  if (num == '3') {
+    cmdline.add_argument(BooleanCommandLineArgument("feedback", 'y', "Sends feedback.", false));
+  }
+  // network3 has always used the semaphore and net.ini section of network2.
+  const auto net_cmd = (num == '3') ? '2' : num;
+  NetworkCommandLine stage_cmdline(cmdline, net_cmd, net_cmdline);
+  if (!stage_cmdline.IsInitialized()) {
+    LOG(ERROR) << "ERROR: [network" << num << "]: Unable to initialize command line.";
+    return 1;
+  }
+
+  try {
+    auto semaphore = SemaphoreFile::try_acquire(stage_cmdline.semaphore_filename(),
+                                                stage_cmdline.semaphore_timeout());
+    switch (num) {
+    case '1':
+      return network1_main(stage_cmdline);
+    case '2':
+      return network2_main(stage_cmdline);
+    case '3':
+      return network3_main(stage_cmdline);
+    case 'f':
+      return networkf_main(stage_cmdline);
+    default:
+      LOG(ERROR) << "Unknown network command: network" << num;
+      return 1;
+    }
+  } catch (const semaphore_not_acquired& e) {
+    LOG(ERROR) << "ERROR: [network" << num
+               << "]: Unable to Acquire Network Semaphore: " << e.what();
+  } catch (const std::exception& e) {
+    // Used to be a separate process, so a failure here must not stop
+    // networkc from running the remaining stages.
+    LOG(ERROR) << "ERROR: [network" << num << "]: " << e.what();
+  }
+  return 2;
 }
 
 static bool checkup2(const time_t tFileTime, string dir, string filename) {
@@ -174,7 +220,7 @@ int networkc_main(const NetworkCommandLine& net_cmdline) {
       // Pending files, call network1 to put them into s* or local.net.
       if (File::ExistsWildcard(FilePath(net.dir, "p*.net"))) {
         VLOG(2) << "Found p*.net";
-        System(create_network_cmdline(net_cmdline, '1', ""));
+        RunNetworkCommand(net_cmdline, '1', "");
         found = true;
       }
 
@@ -184,33 +230,33 @@ int networkc_main(const NetworkCommandLine& net_cmdline) {
         // Import everything into local.net
         if (File::ExistsWildcard(FilePath(dirs.inbound_dir(), "*.*"))) {
           VLOG(2) << "Trying to FTN import";
-          System(create_network_cmdline(net_cmdline, 'f', "import"));
+          RunNetworkCommand(net_cmdline, 'f', "import");
         }
 
         if (exists_bundle(net_cmdline.config(), net)) {
           VLOG(2) << "Trying to FTN export";
-          System(create_network_cmdline(net_cmdline, 'f', "export"));
+          RunNetworkCommand(net_cmdline, 'f', "export");
         }
 
         // Export everything to FTN bundles
         const auto fido_out = StrCat("s", FTN_FAKE_OUTBOUND_NODE, ".net");
         if (File::Exists(net.dir, fido_out)) {
           VLOG(2) << "Found s" << FTN_FAKE_OUTBOUND_NODE << ".net; trying to export";
-          System(create_network_cmdline(net_cmdline, 'f', "export"));
+          RunNetworkCommand(net_cmdline, 'f', "export");
         }
       }
 
       // Process local mail with network2.
       if (File::Exists(FilePath(net.dir, LOCAL_NET))) {
         VLOG(2) << "Found: " << LOCAL_NET;
-        System(create_network_cmdline(net_cmdline, '2', ""));
+        RunNetworkCommand(net_cmdline, '2', "");
         found = true;
       }
 
       // If our network files have changed, run network3 and send feedback.
       if (need_network3(net.dir, status->GetNetworkVersion())) {
         VLOG(2) << "Need to run network3";
-        System(create_network_cmdline(net_cmdline, '3', ""));
+        RunNetworkCommand(net_cmdline, '3', "");
         found = true;
       }
     } while (found && ++num_tries < 3);
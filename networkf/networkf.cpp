@@ -15,6 +15,7 @@
 /*    either  express  or implied.  See  the  License for  the specific   */
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
+#include "networkf/networkf.h"
 
 #include <cctype>
 #include <cstdlib>
@@ -26,6 +27,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "core/command_line.h"
@@ -42,6 +44,7 @@
 #include "core/strings.h"
 #include "core/textfile.h"
 #include "core/version.h"
+#include "core/zip.h"
 #include "networkb/binkp.h"
 #include "networkb/binkp_config.h"
 #include "networkb/net_util.h"
@@ -164,18 +167,6 @@ static string arc_stuff_in(const string& command_line, const string& a1, const s
   return os.str();
 }
 
-static void ShowHelp(const CommandLine& cmdline) {
-  cout << cmdline.GetHelp() << ".####      Network number (as defined in wwivconfig)" << endl
-       << endl
-       << "commands: " << endl
-       << endl
-       << " import    Import messages from FTN Packet to WWIV (P*.net)" << endl
-       << " export    Export messages from WWIV (p*.net) to FTN packet" << endl
-       << endl;
-
-  exit(1);
-}
-
 static string get_echomail_areaname(const std::string& text) {
   auto lines = split_message(text);
   for (const auto& line : lines) {
@@ -186,25 +177,7 @@ static string get_echomail_areaname(const std::string& text) {
   return "";
 }
 
-static bool import_packet_file(const Config& config, FtnMessageDupe& dupe,
-                               const FidoCallout& callout, const net_networks_rec& net,
-                               const std::string& dir, const string& name) {
-  VLOG(1) << "import_packet_file: " << dir << name;
-
-  File f(FilePath(dir, name));
-  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
-    LOG(INFO) << "Unable to open file: " << dir << name;
-    return false;
-  }
-
-  bool done = false;
-  packet_header_2p_t header{};
-  auto num_header_read = f.Read(&header, sizeof(packet_header_2p_t));
-  if (num_header_read < sizeof(packet_header_2p_t)) {
-    LOG(ERROR) << "Read less than packet header";
-    return false;
-  }
-
+static bool check_packet_password(const FidoCallout& callout, const packet_header_2p_t& header) {
   FidoAddress address(header.orig_zone, header.orig_net, header.orig_node, header.orig_point, "");
   auto expected = callout.packet_config_for(address).packet_password;
   // Do this dance to ensure that if there's no trailing null
@@ -216,24 +189,40 @@ static bool import_packet_file(const Config& config, FtnMessageDupe& dupe,
   if (!iequals(expected, actual)) {
     LOG(ERROR) << "Unexpected packet password from node: " << address << "; actual: '" << actual
                << "'; expected: '" << expected << "'";
-    // Move to BADMSGS
-    f.Close();
-    wwiv::sdk::fido::FtnDirectories dirs(config.root_directory(), net);
-    const auto dest = FilePath(dirs.bad_packets_dir(), f.GetName());
-
-    if (!File::Move(f.full_pathname(), dest)) {
-      LOG(ERROR) << "Error moving file to BADMSGS; file: " << f;
-    }
     return false;
   }
+  return true;
+}
 
+enum class ImportPacketResult { OK, BAD_PASSWORD, ERROR };
+
+/**
+ * Imports the messages in a FTN packet that has been read into memory
+ * (either from a .pkt file or from a member of a bundle).
+ */
+static ImportPacketResult import_packet_contents(const Config& config, FtnMessageDupe& dupe,
+                                                 const FidoCallout& callout,
+                                                 const net_networks_rec& net,
+                                                 const string& contents) {
+  packet_header_2p_t header{};
+  if (contents.size() < sizeof(packet_header_2p_t)) {
+    LOG(ERROR) << "Read less than packet header";
+    return ImportPacketResult::ERROR;
+  }
+  memcpy(&header, contents.data(), sizeof(packet_header_2p_t));
+  if (!check_packet_password(callout, header)) {
+    return ImportPacketResult::BAD_PASSWORD;
+  }
+
+  bool done = false;
+  string::size_type pos = sizeof(packet_header_2p_t);
   while (!done) {
     FidoPackedMessage msg;
-    ReadPacketResponse response = read_packed_message(f, msg);
+    ReadPacketResponse response = read_packed_message(contents, pos, msg);
     if (response == ReadPacketResponse::END_OF_FILE) {
-      return true;
+      return ImportPacketResult::OK;
     } else if (response == ReadPacketResponse::ERROR) {
-      return false;
+      return ImportPacketResult::ERROR;
     }
 
     if (dupe.is_dupe(msg)) {
@@ -310,7 +299,37 @@ static bool import_packet_file(const Config& config, FtnMessageDupe& dupe,
     }
   }
 
-  return true;
+  return ImportPacketResult::OK;
+}
+
+static bool import_packet_file(const Config& config, FtnMessageDupe& dupe,
+                               const FidoCallout& callout, const net_networks_rec& net,
+                               const std::string& dir, const string& name) {
+  VLOG(1) << "import_packet_file: " << dir << name;
+
+  File f(FilePath(dir, name));
+  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+    LOG(INFO) << "Unable to open file: " << dir << name;
+    return false;
+  }
+  string contents;
+  contents.resize(static_cast<size_t>(f.length()));
+  if (!contents.empty()) {
+    contents.resize(std::max<ssize_t>(0, f.Read(&contents[0], contents.size())));
+  }
+  f.Close();
+
+  auto result = import_packet_contents(config, dupe, callout, net, contents);
+  if (result == ImportPacketResult::BAD_PASSWORD) {
+    // Move to BADMSGS
+    wwiv::sdk::fido::FtnDirectories dirs(config.root_directory(), net);
+    const auto dest = FilePath(dirs.bad_packets_dir(), f.GetName());
+
+    if (!File::Move(f.full_pathname(), dest)) {
+      LOG(ERROR) << "Error moving file to BADMSGS; file: " << f;
+    }
+  }
+  return result == ImportPacketResult::OK;
 }
 
 static bool import_packets(const Config& config, FtnMessageDupe& dupe, const FidoCallout& callout,
@@ -333,6 +352,88 @@ static bool import_packets(const Config& config, FtnMessageDupe& dupe, const Fid
   return true;
 }
 
+/**
+ * Returns the file name part of a ZIP member, or an empty string if it isn't
+ * safe to use as a file name in the BADMSGS directory.
+ */
+static std::string bundle_member_filename(const std::string& member) {
+  const auto idx = member.find_last_of("/\\");
+  auto fn = (idx == std::string::npos) ? member : member.substr(idx + 1);
+  if (fn.empty() || fn.find("..") != std::string::npos || fn.find(':') != std::string::npos) {
+    return {};
+  }
+  return fn;
+}
+
+static void save_bad_bundle_member(const wwiv::sdk::fido::FtnDirectories& dirs,
+                                   const std::string& bundle, const std::string& member,
+                                   const std::string& contents) {
+  const auto fn = bundle_member_filename(member);
+  if (fn.empty()) {
+    LOG(ERROR) << "Not saving packet with unsafe name: '" << member << "' from bundle: " << bundle;
+    return;
+  }
+  File bad(FilePath(dirs.bad_packets_dir(), fn));
+  if (!bad.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite |
+                File::modeTruncate) ||
+      bad.Write(contents) != static_cast<ssize_t>(contents.size())) {
+    LOG(ERROR) << "Error writing packet to BADMSGS; file: " << bad;
+  }
+}
+
+/**
+ * Imports the packets in a ZIP bundle directly from memory, without
+ * extracting them to the temp inbound directory.
+ *
+ * Every packet is extracted before any is imported, so a damaged bundle is
+ * left alone.  If a packet fails to import, it's saved to BADMSGS and the
+ * bundle is kept; the packets that were imported are caught by the dupe
+ * check when the bundle is tried again.
+ */
+static bool import_zip_bundle_file(const Config& config, FtnMessageDupe& dupe,
+                                   const FidoCallout& callout, const net_networks_rec& net,
+                                   const std::string& dir, const string& name) {
+  ZipReader zip(FilePath(dir, name));
+  if (!zip) {
+    LOG(ERROR) << "Unable to read ZIP bundle: " << FilePath(dir, name);
+    return false;
+  }
+  std::vector<std::pair<std::string, std::string>> packets;
+  for (const auto& e : zip.entries()) {
+    if (!ends_with(ToStringLowerCase(e.name), ".pkt")) {
+      LOG(INFO) << "Skipping non-packet member: " << e.name << " in bundle: " << name;
+      continue;
+    }
+    string contents;
+    if (!zip.Extract(e, contents)) {
+      LOG(ERROR) << "Unable to extract: " << e.name << " from bundle: " << name;
+      return false;
+    }
+    packets.emplace_back(e.name, std::move(contents));
+  }
+
+  wwiv::sdk::fido::FtnDirectories dirs(config.root_directory(), net);
+  bool ok = true;
+  for (const auto& p : packets) {
+    const auto& member = p.first;
+    const auto& contents = p.second;
+    auto result = import_packet_contents(config, dupe, callout, net, contents);
+    if (result == ImportPacketResult::OK) {
+      LOG(INFO) << "Successfully imported packet: " << member << " from bundle: " << name;
+      continue;
+    }
+    if (result == ImportPacketResult::BAD_PASSWORD) {
+      LOG(ERROR) << "Bad password in packet: " << member << " from bundle: " << name;
+    } else {
+      LOG(ERROR) << "Error importing packet: " << member << " from bundle: " << name;
+      ok = false;
+    }
+    // Save the packet to BADMSGS, just like import_packet_file does.
+    save_bad_bundle_member(dirs, name, member, contents);
+  }
+  return ok;
+}
+
 static bool import_bundle_file(const Config& config, FtnMessageDupe& dupe,
                                const FidoCallout& callout, const net_networks_rec& net,
                                const std::string& dir, const string& name, bool skip_delete) {
@@ -347,6 +448,11 @@ static bool import_bundle_file(const Config& config, FtnMessageDupe& dupe,
     }
   }
 
+  if (IsZipFile(FilePath(dir, name))) {
+    return import_zip_bundle_file(config, dupe, callout, net, dir, name);
+  }
+
+  // Not a ZIP, fall back to the external archiver from archiver.dat.
   const auto saved_dir = File::current_directory();
   ScopeExit at_exit([=] { File::set_current_directory(saved_dir); });
   wwiv::sdk::fido::FtnDirectories dirs(config.root_directory(), net);
@@ -441,6 +547,41 @@ static string rename_fido_packet(const string& dir, const string& origname) {
   return origname;
 }
 
+/**
+ * Writes the packet fido_packet_name from the temp outbound directory into
+ * a new ZIP bundle named bname in the outbound directory.
+ */
+static bool create_zip_bundle(const FtnDirectories& dirs, const string& fido_packet_name,
+                              const string& bname) {
+  File packet(FilePath(dirs.temp_outbound_dir(), fido_packet_name));
+  if (!packet.Open(File::modeBinary | File::modeReadOnly)) {
+    LOG(ERROR) << "Unable to open packet: " << packet;
+    return false;
+  }
+  string contents;
+  contents.resize(static_cast<size_t>(packet.length()));
+  if (!contents.empty() &&
+      packet.Read(&contents[0], contents.size()) != static_cast<ssize_t>(contents.size())) {
+    LOG(ERROR) << "Unable to read packet: " << packet;
+    return false;
+  }
+  const auto modified = packet.last_write_time();
+  packet.Close();
+
+  const auto bundle_path = FilePath(dirs.outbound_dir(), bname);
+  ZipWriter zip(bundle_path);
+  if (!zip || !zip.Add(fido_packet_name, contents, modified) || !zip.Close()) {
+    LOG(ERROR) << "Unable to create bundle: " << bundle_path;
+    File::Remove(bundle_path);
+    return false;
+  }
+  LOG(INFO) << "Created bundle: " << bundle_path;
+  if (!File::Remove(packet.full_pathname())) {
+    LOG(ERROR) << "Error removing packet: " << packet;
+  }
+  return true;
+}
+
 static bool create_ftn_bundle(const Config& config, const FidoCallout& fido_callout,
                               const FidoAddress& dest, const FidoAddress& route_to,
                               const net_networks_rec& net, const string& fido_packet_name,
@@ -487,8 +628,15 @@ static bool create_ftn_bundle(const Config& config, const FidoCallout& fido_call
       // Already exists.
       continue;
     }
-    // We should actually change to the temp outbound dir so that
-    // we won't add paths.
+    if (ctype == "ZIP") {
+      if (!create_zip_bundle(dirs, fido_packet_name, bname)) {
+        return false;
+      }
+      out_bundle_name = bname;
+      return true;
+    }
+    // Not a ZIP, use the external archiver from archiver.dat.  We should
+    // actually change to the temp outbound dir so that we won't add paths.
     File::set_current_directory(dirs.temp_outbound_dir());
     LOG(INFO) << "Changed directory to: " << dirs.temp_outbound_dir();
     const auto& arc = find_arc(arcs, ctype);
@@ -907,9 +1055,9 @@ static bool CreateFidoNetAttachNetMail(const FidoAddress& orig, const FidoAddres
   return true;
 }
 
-bool CreateFloFile(const NetworkCommandLine& net_cmdline, const FidoAddress& dest,
-                   const net_networks_rec& net, const string& bundlename,
-                   const fido_packet_config_t& packet_config) {
+static bool CreateFloFile(const NetworkCommandLine& net_cmdline, const FidoAddress& dest,
+                          const net_networks_rec& net, const string& bundlename,
+                          const fido_packet_config_t& packet_config) {
   FidoAddress orig(net.fido.fido_address);
   wwiv::sdk::fido::FtnDirectories dirs(net_cmdline.config().root_directory(), net);
 
@@ -934,9 +1082,9 @@ bool CreateFloFile(const NetworkCommandLine& net_cmdline, const FidoAddress& des
   return false;
 }
 
-bool CreateNetmailAttach(const NetworkCommandLine& net_cmdline, const FidoAddress& dest,
-                         const net_networks_rec& net, const string& bundlename,
-                         const fido_packet_config_t& packet_config) {
+static bool CreateNetmailAttach(const NetworkCommandLine& net_cmdline, const FidoAddress& dest,
+                                const net_networks_rec& net, const string& bundlename,
+                                const fido_packet_config_t& packet_config) {
   wwiv::sdk::fido::FtnDirectories dirs(net_cmdline.config().root_directory(), net);
   auto netmail_filepath = NextNetmailFilePath(dirs.netmail_dir());
 
@@ -1013,9 +1161,10 @@ static bool export_main_type_new_post(const NetworkCommandLine& net_cmdline,
   return true;
 }
 
-bool export_main_type_email_name(const NetworkCommandLine& net_cmdline, const net_networks_rec& net,
-                                 const FidoCallout& fido_callout, std::set<string>& bundles,
-                                 Packet& p) {
+static bool export_main_type_email_name(const NetworkCommandLine& net_cmdline,
+                                        const net_networks_rec& net,
+                                        const FidoCallout& fido_callout,
+                                        std::set<string>& bundles, Packet& p) {
   // Lame implementation that creates 1 file per message.
   LOG(INFO) << "Creating packet for netmail.";
 
@@ -1044,13 +1193,23 @@ bool export_main_type_email_name(const NetworkCommandLine& net_cmdline, const ne
   return true;
 }
 
-int Main(const NetworkCommandLine& net_cmdline) {
+void networkf_show_help(const CommandLine& cmdline) {
+  cout << cmdline.GetHelp() << ".####      Network number (as defined in wwivconfig)" << endl
+       << endl
+       << "commands: " << endl
+       << endl
+       << " import    Import messages from FTN Packet to WWIV (P*.net)" << endl
+       << " export    Export messages from WWIV (p*.net) to FTN packet" << endl
+       << endl;
+}
+
+int networkf_main(const NetworkCommandLine& net_cmdline) {
   int num_packets_processed = 0;
 
   const auto& net = net_cmdline.network();
   if (net.type != network_type_t::ftn) {
     LOG(ERROR) << "NETWORKF is only for use on FTN type networks.";
-    ShowHelp(net_cmdline.cmdline());
+    networkf_show_help(net_cmdline.cmdline());
     return 1;
   }
 
@@ -1078,7 +1237,7 @@ int Main(const NetworkCommandLine& net_cmdline) {
   auto cmds = net_cmdline.cmdline().remaining();
   if (cmds.empty()) {
     LOG(ERROR) << "No command specified. Exiting.";
-    ShowHelp(net_cmdline.cmdline());
+    networkf_show_help(net_cmdline.cmdline());
     return 1;
   }
 
@@ -1156,31 +1315,8 @@ int Main(const NetworkCommandLine& net_cmdline) {
 
   } else {
     LOG(ERROR) << "Unknown command: " << cmd;
-    ShowHelp(net_cmdline.cmdline());
+    networkf_show_help(net_cmdline.cmdline());
     return 1;
   }
   return (num_packets_processed > 0) ? 0 : 1;
 }
-
-
-int main(int argc, char** argv) { 
-  Logger::Init(argc, argv);
-  CommandLine cmdline(argc, argv, "net");
-  NetworkCommandLine net_cmdline(cmdline, 'f');
-  try {
-    ScopeExit at_exit(Logger::ExitLogger);
-    if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-      ShowHelp(net_cmdline.cmdline());
-      return 1;
-    }
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_filename(),
-                                                net_cmdline.semaphore_timeout());
-    return Main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  } catch (const std::exception& e) {
-    LOG(ERROR) << "ERROR: [networkf]: " << e.what();
-  }
-  return 2;
-}
@@ -76,6 +76,12 @@ public:
   inline int x() const noexcept override { return pos_ % cols_; }
   inline int y() const noexcept override { return pos_ / cols_; }
 
+  /** The cell at x,y, or a default cell if nothing was ever written there. */
+  FrameBufferCell cell(int x, int y) const {
+    const auto pos = (y * cols_) + x;
+    return (pos < static_cast<int>(b_.size())) ? b_[pos] : FrameBufferCell();
+  }
+
   // Mostly used for debugging and tests.
 
   // Number of total rows after the framebuffer has been closed.
@@ -0,0 +1,206 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "sdk/ansi/screen_renderer.h"
+
+#include <string>
+
+#include "sdk/ansi/makeansi.h"
+
+namespace wwiv {
+namespace sdk {
+namespace ansi {
+
+static char visible(char c) { return c == 0 ? ' ' : c; }
+
+// Blanks only need to match in background color.
+static bool same(const FrameBufferCell& l, const FrameBufferCell& r) {
+  const auto lc = visible(l.c());
+  if (lc != visible(r.c())) {
+    return false;
+  }
+  if (lc == ' ') {
+    return (l.a() & 0x70) == (r.a() & 0x70);
+  }
+  return l.a() == r.a();
+}
+
+// Length of the sequence to move the cursor n columns to the right.
+static int cursor_forward_len(int n) {
+  return n == 1 ? 3 : 3 + static_cast<int>(std::to_string(n).size());
+}
+
+ScreenRenderer::ScreenRenderer(int cols, int rows, int top)
+    : cols_(cols), rows_(rows), top_(top), frame_(cols),
+      sent_(static_cast<size_t>(cols * rows)) {}
+
+void ScreenRenderer::MarkCleared() {
+  sent_.assign(static_cast<size_t>(cols_ * rows_), FrameBufferCell(' ', 7));
+  valid_ = true;
+}
+
+bool ScreenRenderer::changed(int x, int y) const {
+  return !valid_ || !same(sent_[y * cols_ + x], frame_.cell(x, y));
+}
+
+void ScreenRenderer::MoveTo(int x, int y, std::string& out) {
+  if (x == x_ && y == y_) {
+    return;
+  }
+  const auto row = std::to_string(top_ + y + 1);
+  std::string best = (x == 0) ? "\x1b[" + row + "H"
+                              : "\x1b[" + row + ";" + std::to_string(x + 1) + "H";
+  if (y == y_ && x_ >= 0) {
+    std::string s;
+    if (x > x_) {
+      const auto n = x - x_;
+      s = (n == 1) ? "\x1b[C" : "\x1b[" + std::to_string(n) + "C";
+    } else if (x == 0) {
+      s = "\r";
+    } else {
+      const auto n = x_ - x;
+      s = (n == 1) ? "\x1b[D" : "\x1b[" + std::to_string(n) + "D";
+    }
+    if (s.size() < best.size()) {
+      best = s;
+    }
+  }
+  out.append(best);
+  x_ = x;
+  y_ = y;
+}
+
+void ScreenRenderer::SetAttr(uint8_t a, std::string& out) {
+  if (attr_ == a) {
+    return;
+  }
+  if (attr_ < 0) {
+    // Start from a known state.
+    out.append("\x1b[0m");
+    attr_ = 7;
+  }
+  out.append(makeansi(a, attr_));
+  attr_ = a;
+}
+
+void ScreenRenderer::Put(int x, int y, std::string& out) {
+  const auto cell = frame_.cell(x, y);
+  const auto c = visible(cell.c());
+  SetAttr(cell.a(), out);
+  out.push_back(c);
+  sent_[y * cols_ + x] = FrameBufferCell(c, cell.a());
+  if (++x_ >= cols_) {
+    // Terminals differ on where the cursor is after writing the last column.
+    x_ = y_ = -1;
+  }
+}
+
+std::string ScreenRenderer::Render(int current_attr) {
+  std::string out;
+  x_ = y_ = -1;
+  attr_ = current_attr;
+
+  // Uses clear to end of line when the rest of row y from x is blank with a
+  // black background, and that is shorter than writing the changed cells.
+  auto clear_eol = [&](int x, int y) -> bool {
+    int num_changed = 0;
+    for (int i = x; i < cols_; i++) {
+      const auto cell = frame_.cell(i, y);
+      if (visible(cell.c()) != ' ' || (cell.a() & 0x70) != 0) {
+        return false;
+      }
+      if (changed(i, y)) {
+        ++num_changed;
+      }
+    }
+    if (num_changed <= 3) {
+      return false;
+    }
+    MoveTo(x, y, out);
+    if (attr_ < 0 || (attr_ & 0x70) != 0) {
+      SetAttr(frame_.cell(x, y).a(), out);
+    }
+    out.append("\x1b[K");
+    for (int i = x; i < cols_; i++) {
+      sent_[y * cols_ + i] = FrameBufferCell(' ', static_cast<uint8_t>(attr_));
+    }
+    return true;
+  };
+
+  // Bytes needed to rewrite the unchanged cells [from, to) on row y rather
+  // than moving the cursor over them.
+  auto rewrite_len = [&](int from, int to, int y) -> int {
+    int len = 0;
+    int a = attr_;
+    for (int i = from; i < to; i++) {
+      const auto na = frame_.cell(i, y).a();
+      len += static_cast<int>(makeansi(na, a).size()) + 1;
+      a = na;
+    }
+    const auto next = frame_.cell(to, y).a();
+    len += static_cast<int>(makeansi(next, a).size());
+    len -= static_cast<int>(makeansi(next, attr_).size());
+    return len;
+  };
+
+  for (int y = 0; y < rows_; y++) {
+    int x = 0;
+    while (x < cols_) {
+      if (!changed(x, y)) {
+        ++x;
+        continue;
+      }
+      if (clear_eol(x, y)) {
+        break;
+      }
+      MoveTo(x, y, out);
+      Put(x++, y, out);
+      while (x < cols_) {
+        if (changed(x, y)) {
+          if (clear_eol(x, y)) {
+            x = cols_;
+            break;
+          }
+          Put(x++, y, out);
+          continue;
+        }
+        int gap_end = x;
+        while (gap_end < cols_ && !changed(gap_end, y)) {
+          ++gap_end;
+        }
+        if (gap_end == cols_ || x_ < 0 ||
+            rewrite_len(x, gap_end, y) > cursor_forward_len(gap_end - x)) {
+          break;
+        }
+        while (x < gap_end) {
+          Put(x++, y, out);
+        }
+      }
+    }
+  }
+
+  if (cursor_x_ >= 0 && cursor_y_ >= 0) {
+    MoveTo(cursor_x_, cursor_y_, out);
+  }
+  valid_ = true;
+  return out;
+}
+
+} // namespace ansi
+} // namespace sdk
+} // namespace wwiv
@@ -0,0 +1,92 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_SDK_ANSI_SCREEN_RENDERER_H__
+#define __INCLUDED_SDK_ANSI_SCREEN_RENDERER_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sdk/ansi/framebuffer.h"
+
+namespace wwiv {
+namespace sdk {
+namespace ansi {
+
+/**
+ * Keeps a copy of what was last sent to the remote terminal for a region of
+ * the screen and computes the minimal ANSI needed to update it.
+ *
+ * Callers draw the complete desired contents into frame() and then send the
+ * result of Render(), which only contains the cells that changed along with
+ * the fewest cursor movements and attribute changes needed.
+ *
+ * The region starts at the left edge of the terminal on row top (0 based)
+ * and must extend to its right edge, since clearing to the end of a line
+ * is used for trailing blanks.
+ */
+class ScreenRenderer {
+public:
+  ScreenRenderer(int cols, int rows, int top = 0);
+
+  /** The desired contents of the region. */
+  FrameBuffer& frame() noexcept { return frame_; }
+  /** Moves the cursor to x, y (0 based within the region) after rendering. */
+  void cursor(int x, int y) { cursor_x_ = x; cursor_y_ = y; }
+
+  /**
+   * Returns the bytes needed to update the remote terminal to match frame().
+   * current_attr is the attribute in use on the terminal, or -1 if unknown.
+   */
+  std::string Render(int current_attr = -1);
+
+  /** The region was cleared to blanks using attribute 7. */
+  void MarkCleared();
+  /** The contents of the region are unknown, the next Render redraws it. */
+  void Invalidate() { valid_ = false; }
+
+  int cols() const noexcept { return cols_; }
+  int rows() const noexcept { return rows_; }
+
+private:
+  bool changed(int x, int y) const;
+  void MoveTo(int x, int y, std::string& out);
+  void SetAttr(uint8_t a, std::string& out);
+  void Put(int x, int y, std::string& out);
+
+  const int cols_;
+  const int rows_;
+  const int top_;
+  FrameBuffer frame_;
+  // What the remote terminal is showing.
+  std::vector<FrameBufferCell> sent_;
+  bool valid_{false};
+  int cursor_x_{-1};
+  int cursor_y_{-1};
+  // Remote cursor and attribute, -1 when unknown.
+  int x_{-1};
+  int y_{-1};
+  int attr_{-1};
+};
+
+} // namespace ansi
+} // namespace sdk
+} // namespace wwiv
+
+#endif // __INCLUDED_SDK_ANSI_SCREEN_RENDERER_H__
@@ -27,6 +27,7 @@
 #include <sstream>
 #include <string>
 
+#include "core/crc32.h"
 #include "core/strings.h"
 #include "core/inifile.h"
 #include "core/datafile.h"
@@ -152,9 +153,7 @@ bool ParseBbsListNetLine(const string& ss, net_system_list_rec* con, int32_t* re
 static bool ParseBbsListNetFile(
   std::map<uint16_t, net_system_list_rec>* node_config_map,
   std::map<uint16_t, int32_t>* reg_number_map,
-  const string network_dir,
-  wwiv::graphs::Graph& graph,
-  uint16_t net_node_number) {
+  const string network_dir) {
   TextFile bbs_list_file(FilePath(network_dir, BBSLIST_NET), "rt");
   if (!bbs_list_file.IsOpen()) {
     return false;
@@ -168,35 +167,6 @@ static bool ParseBbsListNetFile(
     int32_t reg_number;
     if (ParseBbsListNetLine(line, &node_config, &reg_number)) {
       // Parsed a line correctly.
-      std::list<uint16_t> path = graph.shortest_path_to(node_config.sysnum);
-      float cost = graph.cost_to(node_config.sysnum);
-      if (!std::isfinite(cost)) {
-        if(VLOG_IS_ON(2)) {
-          std::ostringstream ss; 
-          VLOG(2) << "high cost " << cost << " to " << node_config.sysnum;
-          ss << "Path to " << node_config.sysnum << ": ";
-          std::copy(path.begin(), path.end(), std::ostream_iterator<uint16_t>(ss, " "));
-          VLOG(2) << ss.str();
-          VLOG(2) << graph.DumpCosts();
-        }
-      }
-      if (graph.has_node(node_config.sysnum) && path.front() == net_node_number) {
-        path.pop_front();
-        // We have a path...
-        //std::copy(path.begin(), path.end(), std::ostream_iterator<uint16_t>(std::cout, " "));
-        node_config.numhops = static_cast<int16_t>(path.size());
-        node_config.xx.cost = cost;
-        if (!path.empty()) {
-          node_config.forsys = path.front();
-        } else {
-          node_config.forsys = node_config.sysnum;
-        }
-      } else {
-        VLOG(2) << "no path to " << node_config.sysnum;
-        node_config.numhops = 10000;
-        node_config.xx.cost = 10000;
-        node_config.forsys = std::numeric_limits<uint16_t>::max();
-      }
       node_config_map->emplace(node_config.sysnum, node_config);
       reg_number_map->emplace(node_config.sysnum, reg_number);
     }
@@ -204,11 +174,8 @@ static bool ParseBbsListNetFile(
   return true;
 }
 
-// static 
-BbsListNet BbsListNet::ParseBbsListNet(uint16_t net_node_number, const std::string& network_dir) {
-  BbsListNet b;
-
-  VLOG(3) << "Processing " << network_dir;
+static void ComputeRoutes(std::map<uint16_t, net_system_list_rec>* node_config_map,
+                          const string network_dir, uint16_t net_node_number) {
   // We now need to add in cost and routing information.
   Connect connect(network_dir);
 
@@ -224,7 +191,152 @@ BbsListNet BbsListNet::ParseBbsListNet(uint16_t net_node_number, const std::stri
     }
   }
 
-  ParseBbsListNetFile(&b.node_config_, &b.reg_number_, network_dir, graph, net_node_number);
+  for (auto& e : *node_config_map) {
+    auto& node_config = e.second;
+    const auto sysnum = node_config.sysnum;
+    const auto next_hop = graph.next_hop_to(sysnum);
+    float cost = graph.cost_to(sysnum);
+    if (!std::isfinite(cost)) {
+      if(VLOG_IS_ON(2)) {
+        std::ostringstream ss; 
+        VLOG(2) << "high cost " << cost << " to " << sysnum;
+        const auto path = graph.shortest_path_to(sysnum);
+        ss << "Path to " << sysnum << ": ";
+        std::copy(path.begin(), path.end(), std::ostream_iterator<uint16_t>(ss, " "));
+        VLOG(2) << ss.str();
+        VLOG(2) << graph.DumpCosts();
+      }
+    }
+    if (graph.has_node(sysnum) && next_hop != 0) {
+      // We have a path...
+      node_config.numhops = static_cast<int16_t>(graph.num_hops_to(sysnum));
+      node_config.xx.cost = cost;
+      node_config.forsys = next_hop;
+    } else {
+      VLOG(2) << "no path to " << sysnum;
+      node_config.numhops = 10000;
+      node_config.xx.cost = 10000;
+      node_config.forsys = std::numeric_limits<uint16_t>::max();
+    }
+  }
+}
+
+// Routing table cache (bbsdata.rtc).  This lets ParseBbsListNet skip
+// building the graph and computing the routes when neither connect.net nor
+// bbslist.net have changed since the routes were last computed.
+static constexpr uint32_t routing_cache_version = 1;
+
+struct routing_cache_header_t {
+  char signature[4];
+  uint32_t version;
+  uint32_t connect_crc;
+  uint32_t bbslist_crc;
+  uint16_t sysnum;
+  uint16_t pad;
+  uint32_t num_entries;
+};
+
+struct routing_cache_entry_t {
+  uint16_t sysnum;
+  uint16_t forsys;
+  int16_t numhops;
+  uint16_t pad;
+  float cost;
+};
+
+static routing_cache_header_t CreateRoutingCacheHeader(const string& network_dir,
+                                                       uint16_t net_node_number) {
+  routing_cache_header_t h{};
+  memcpy(h.signature, "WRTC", sizeof(h.signature));
+  h.version = routing_cache_version;
+  h.connect_crc = crc32file(FilePath(network_dir, CONNECT_NET));
+  h.bbslist_crc = crc32file(FilePath(network_dir, BBSLIST_NET));
+  h.sysnum = net_node_number;
+  return h;
+}
+
+static bool ApplyCachedRoutes(std::map<uint16_t, net_system_list_rec>* node_config_map,
+                              const string& network_dir,
+                              const routing_cache_header_t& expected) {
+  File file(FilePath(network_dir, BBSDATA_RTC));
+  if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+    return false;
+  }
+  routing_cache_header_t h{};
+  if (file.Read(&h, sizeof(h)) != sizeof(h)) {
+    return false;
+  }
+  if (memcmp(h.signature, expected.signature, sizeof(h.signature)) != 0 ||
+      h.version != expected.version || h.connect_crc != expected.connect_crc ||
+      h.bbslist_crc != expected.bbslist_crc || h.sysnum != expected.sysnum ||
+      h.num_entries != node_config_map->size()) {
+    return false;
+  }
+  vector<routing_cache_entry_t> entries(h.num_entries);
+  if (!entries.empty()) {
+    const auto num_bytes = static_cast<int>(entries.size() * sizeof(routing_cache_entry_t));
+    if (file.Read(&entries[0], num_bytes) != num_bytes) {
+      return false;
+    }
+  }
+  // Make sure every node has a route before touching any of them.
+  for (const auto& e : entries) {
+    if (node_config_map->find(e.sysnum) == node_config_map->end()) {
+      return false;
+    }
+  }
+  for (const auto& e : entries) {
+    auto& n = node_config_map->at(e.sysnum);
+    n.forsys = e.forsys;
+    n.numhops = e.numhops;
+    n.xx.cost = e.cost;
+  }
+  return true;
+}
+
+static bool WriteRoutingCache(const std::map<uint16_t, net_system_list_rec>& node_config_map,
+                              const string& network_dir, routing_cache_header_t h) {
+  vector<routing_cache_entry_t> entries;
+  entries.reserve(node_config_map.size());
+  for (const auto& kv : node_config_map) {
+    const auto& n = kv.second;
+    entries.push_back({n.sysnum, n.forsys, n.numhops, 0, n.xx.cost});
+  }
+  h.num_entries = static_cast<uint32_t>(entries.size());
+
+  File file(FilePath(network_dir, BBSDATA_RTC));
+  if (!file.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                 File::modeTruncate)) {
+    LOG(ERROR) << "Unable to write routing cache: " << file;
+    return false;
+  }
+  if (file.Write(&h, sizeof(h)) != sizeof(h)) {
+    return false;
+  }
+  if (entries.empty()) {
+    return true;
+  }
+  const auto num_bytes = static_cast<int>(entries.size() * sizeof(routing_cache_entry_t));
+  return file.Write(&entries[0], num_bytes) == num_bytes;
+}
+
+// static 
+BbsListNet BbsListNet::ParseBbsListNet(uint16_t net_node_number, const std::string& network_dir) {
+  BbsListNet b;
+
+  VLOG(3) << "Processing " << network_dir;
+  if (!ParseBbsListNetFile(&b.node_config_, &b.reg_number_, network_dir)) {
+    return b;
+  }
+
+  const auto header = CreateRoutingCacheHeader(network_dir, net_node_number);
+  if (ApplyCachedRoutes(&b.node_config_, network_dir, header)) {
+    VLOG(1) << "Using cached routes from: " << FilePath(network_dir, BBSDATA_RTC);
+    return b;
+  }
+
+  ComputeRoutes(&b.node_config_, network_dir, net_node_number);
+  WriteRoutingCache(b.node_config_, network_dir, header);
   return b;
 }
 
@@ -131,6 +131,7 @@ public:
   void max_subs(uint16_t n) { config_.max_subs = n; }
   // Max Users.
   uint16_t max_users() const { return config_.maxusers; }
+  void max_users(uint16_t n) { config_.maxusers = n; }
   // Sysop Low Time.
   uint16_t sysop_high_time() const { return config_.sysophightime; }
   // Sysop Low Time.
@@ -0,0 +1,351 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "sdk/config_snapshot.h"
+
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "core/datafile.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "core/mapped_file.h"
+#include "core/strings.h"
+#include "sdk/filenames.h"
+#include "sdk/networks.h"
+
+using std::string;
+using std::vector;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace sdk {
+
+namespace {
+
+static const char kMagic[4] = {'W', 'C', 'S', 'N'};
+
+// Every file the tables are loaded from, relative to the data directory.
+// networks.* is here since the legacy subs format needs the networks.
+static const char* kSourceFiles[] = {SUBS_JSON,    SUBS_DAT,      SUBS_XTR,    NETWORKS_JSON,
+                                     NETWORKS_DAT, DIRS_DAT,      CHAINS_DAT,  CHAINS_REG,
+                                     GFILE_DAT,    ARCHIVER_DAT,  EDITORS_DAT, NEXTERN_DAT,
+                                     NINTERN_DAT};
+
+struct source_stamp_t {
+  int64_t size;
+  int64_t mtime;
+};
+
+static source_stamp_t stamp_for(const string& path) {
+  File f(path);
+  if (!f.Exists()) {
+    return {-1, 0};
+  }
+  return {static_cast<int64_t>(f.length()), static_cast<int64_t>(f.last_write_time())};
+}
+
+class SnapshotWriter {
+public:
+  template <typename T> void put(const T& v) {
+    buf_.append(reinterpret_cast<const char*>(&v), sizeof(T));
+  }
+  void put_string(const string& s) {
+    put(static_cast<uint32_t>(s.size()));
+    buf_.append(s);
+  }
+  template <typename T> void put_table(const vector<T>& v) {
+    put(static_cast<uint32_t>(sizeof(T)));
+    put(static_cast<uint32_t>(v.size()));
+    if (!v.empty()) {
+      buf_.append(reinterpret_cast<const char*>(&v[0]), v.size() * sizeof(T));
+    }
+  }
+  const string& buffer() const noexcept { return buf_; }
+
+private:
+  string buf_;
+};
+
+class SnapshotReader {
+public:
+  SnapshotReader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+  template <typename T> bool get(T& v) {
+    if (static_cast<size_t>(end_ - p_) < sizeof(T)) {
+      return false;
+    }
+    memcpy(&v, p_, sizeof(T));
+    p_ += sizeof(T);
+    return true;
+  }
+  bool get_string(string& s) {
+    uint32_t len;
+    if (!get(len) || static_cast<size_t>(end_ - p_) < len) {
+      return false;
+    }
+    s.assign(reinterpret_cast<const char*>(p_), len);
+    p_ += len;
+    return true;
+  }
+  template <typename T> bool get_table(vector<T>& v) {
+    uint32_t rec_size, count;
+    if (!get(rec_size) || !get(count)) {
+      return false;
+    }
+    if (rec_size != sizeof(T) || static_cast<size_t>(end_ - p_) / sizeof(T) < count) {
+      return false;
+    }
+    v.resize(count);
+    if (count > 0) {
+      memcpy(&v[0], p_, count * sizeof(T));
+    }
+    p_ += count * sizeof(T);
+    return true;
+  }
+
+private:
+  const uint8_t* p_;
+  const uint8_t* end_;
+};
+
+static void put_subs(SnapshotWriter& w, const vector<subboard_t>& subs) {
+  w.put(static_cast<uint32_t>(subs.size()));
+  for (const auto& s : subs) {
+    w.put_string(s.name);
+    w.put_string(s.desc);
+    w.put_string(s.filename);
+    w.put(s.key);
+    w.put(s.readsl);
+    w.put(s.postsl);
+    w.put(s.anony);
+    w.put(s.age);
+    w.put(s.maxmsgs);
+    w.put(s.ar);
+    w.put(s.storage_type);
+    w.put(static_cast<uint32_t>(s.nets.size()));
+    for (const auto& n : s.nets) {
+      w.put_string(n.stype);
+      w.put(n.flags);
+      w.put(n.net_num);
+      w.put(n.host);
+      w.put(n.category);
+    }
+  }
+}
+
+static bool get_subs(SnapshotReader& r, vector<subboard_t>& subs) {
+  uint32_t count;
+  if (!r.get(count)) {
+    return false;
+  }
+  subs.clear();
+  subs.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    subboard_t s{};
+    uint32_t num_nets;
+    if (!r.get_string(s.name) || !r.get_string(s.desc) || !r.get_string(s.filename) ||
+        !r.get(s.key) || !r.get(s.readsl) || !r.get(s.postsl) || !r.get(s.anony) ||
+        !r.get(s.age) || !r.get(s.maxmsgs) || !r.get(s.ar) || !r.get(s.storage_type) ||
+        !r.get(num_nets)) {
+      return false;
+    }
+    for (uint32_t j = 0; j < num_nets; j++) {
+      subboard_network_data_t n{};
+      if (!r.get_string(n.stype) || !r.get(n.flags) || !r.get(n.net_num) || !r.get(n.host) ||
+          !r.get(n.category)) {
+        return false;
+      }
+      s.nets.emplace_back(std::move(n));
+    }
+    subs.emplace_back(std::move(s));
+  }
+  return true;
+}
+
+// Reads the header and source list, leaving r at the first table.
+static bool read_header(SnapshotReader& r, const string& datadir) {
+  char magic[4];
+  uint32_t version;
+  int64_t loaded_at;
+  uint32_t num_sources;
+  if (!r.get(magic) || memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !r.get(version) ||
+      version != ConfigSnapshot::kVersion || !r.get(loaded_at) || !r.get(num_sources)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < num_sources; i++) {
+    string name;
+    source_stamp_t expected{};
+    if (!r.get_string(name) || !r.get(expected)) {
+      return false;
+    }
+    const auto actual = stamp_for(FilePath(datadir, name));
+    if (actual.size != expected.size || actual.mtime != expected.mtime) {
+      VLOG(1) << "Config snapshot is stale, " << name << " has changed.";
+      return false;
+    }
+    // A change made later in the same second would not change the mtime.
+    if (actual.mtime >= loaded_at) {
+      VLOG(1) << "Config snapshot may be stale, " << name << " changed while loading.";
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+static void read_all(const string& datadir, const string& filename, vector<T>& v) {
+  v.clear();
+  DataFile<T> file(FilePath(datadir, filename));
+  if (file) {
+    file.ReadVector(v);
+  }
+}
+
+}  // namespace
+
+bool LoadConfigTables(const Config& config, config_tables_t& t) {
+  const auto& datadir = config.datadir();
+  vector<net_networks_rec> net_networks;
+  {
+    Networks networks(config);
+    if (networks.IsInitialized()) {
+      net_networks = networks.networks();
+    }
+  }
+  Subs subs(datadir, net_networks);
+  if (!subs.Load()) {
+    return false;
+  }
+  t.subs = subs.subs();
+  if (!File::Exists(FilePath(datadir, DIRS_DAT))) {
+    // The BBS will not start without it.
+    LOG(ERROR) << DIRS_DAT << " NOT FOUND.";
+    return false;
+  }
+  read_all(datadir, DIRS_DAT, t.dirs);
+  read_all(datadir, CHAINS_DAT, t.chains);
+  read_all(datadir, CHAINS_REG, t.chains_reg);
+  read_all(datadir, GFILE_DAT, t.gfiles);
+  read_all(datadir, ARCHIVER_DAT, t.arcs);
+  read_all(datadir, EDITORS_DAT, t.editors);
+  read_all(datadir, NEXTERN_DAT, t.externs);
+  read_all(datadir, NINTERN_DAT, t.over_intern);
+  return true;
+}
+
+ConfigSnapshot::ConfigSnapshot(const std::string& datadir)
+    : datadir_(datadir), path_(FilePath(datadir, CONFIG_SNP)) {}
+
+bool ConfigSnapshot::Save(const config_tables_t& t, time_t loaded_at) const {
+  SnapshotWriter w;
+  w.put(kMagic);
+  w.put(kVersion);
+  w.put(static_cast<int64_t>(loaded_at));
+  w.put(static_cast<uint32_t>(sizeof(kSourceFiles) / sizeof(kSourceFiles[0])));
+  for (const auto& name : kSourceFiles) {
+    w.put_string(name);
+    w.put(stamp_for(FilePath(datadir_, name)));
+  }
+  put_subs(w, t.subs);
+  w.put_table(t.dirs);
+  w.put_table(t.chains);
+  w.put_table(t.chains_reg);
+  w.put_table(t.gfiles);
+  w.put_table(t.arcs);
+  w.put_table(t.editors);
+  w.put_table(t.externs);
+  w.put_table(t.over_intern);
+
+  // Write a new file and rename it over the old one, so nodes that have
+  // the old snapshot mapped are not affected.
+  const auto tempname = StrCat(path_, ".new");
+  {
+    File file(tempname);
+    if (!file.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                   File::modeTruncate)) {
+      LOG(ERROR) << "Unable to create config snapshot: " << tempname;
+      return false;
+    }
+    const auto& buf = w.buffer();
+    if (file.Write(buf.data(), buf.size()) != static_cast<ssize_t>(buf.size())) {
+      LOG(ERROR) << "Unable to write config snapshot: " << tempname;
+      file.Close();
+      File::Remove(tempname);
+      return false;
+    }
+  }
+#ifdef _WIN32
+  File::Remove(path_);
+#endif  // _WIN32
+  return File::Rename(tempname, path_);
+}
+
+bool ConfigSnapshot::Load(config_tables_t& t) const {
+  if (!File::Exists(path_)) {
+    return false;
+  }
+  MappedFile mapped(path_);
+  if (!mapped || mapped.data() == nullptr) {
+    return false;
+  }
+  SnapshotReader r(mapped.data(), mapped.size());
+  if (!read_header(r, datadir_)) {
+    return false;
+  }
+  config_tables_t result;
+  if (!get_subs(r, result.subs) || !r.get_table(result.dirs) || !r.get_table(result.chains) ||
+      !r.get_table(result.chains_reg) || !r.get_table(result.gfiles) ||
+      !r.get_table(result.arcs) || !r.get_table(result.editors) ||
+      !r.get_table(result.externs) || !r.get_table(result.over_intern)) {
+    LOG(ERROR) << "Config snapshot is corrupt: " << path_;
+    return false;
+  }
+  t = std::move(result);
+  return true;
+}
+
+bool ConfigSnapshot::IsCurrent() const {
+  if (!File::Exists(path_)) {
+    return false;
+  }
+  MappedFile mapped(path_);
+  if (!mapped || mapped.data() == nullptr) {
+    return false;
+  }
+  SnapshotReader r(mapped.data(), mapped.size());
+  return read_header(r, datadir_);
+}
+
+// static
+bool ConfigSnapshot::Compile(const Config& config) {
+  const auto loaded_at = time(nullptr);
+  config_tables_t t;
+  if (!LoadConfigTables(config, t)) {
+    LOG(ERROR) << "Unable to load the configuration to create a config snapshot.";
+    return false;
+  }
+  ConfigSnapshot snapshot(config.datadir());
+  return snapshot.Save(t, loaded_at);
+}
+
+}  // namespace sdk
+}  // namespace wwiv
@@ -0,0 +1,98 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_SDK_CONFIG_SNAPSHOT_H__
+#define __INCLUDED_SDK_CONFIG_SNAPSHOT_H__
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "sdk/config.h"
+#include "sdk/subxtr.h"
+#include "sdk/vardec.h"
+
+namespace wwiv {
+namespace sdk {
+
+/**
+ * The configuration tables the BBS loads when a node starts.  Each table
+ * holds every record found on disk; callers apply their own limits.
+ */
+struct config_tables_t {
+  std::vector<subboard_t> subs;
+  std::vector<directoryrec> dirs;
+  std::vector<chainfilerec> chains;
+  std::vector<chainregrec> chains_reg;
+  std::vector<gfiledirrec> gfiles;
+  std::vector<arcrec> arcs;
+  std::vector<editorrec> editors;
+  std::vector<newexternalrec> externs;
+  std::vector<newexternalrec> over_intern;
+};
+
+/** Loads the configuration tables from their individual files. */
+bool LoadConfigTables(const Config& config, config_tables_t& t);
+
+/**
+ * A single binary file (config.snp in the data directory) holding all of the
+ * config_tables_t, so a node can load them with one mapped read instead of
+ * parsing subs.json and reading each .dat file.
+ *
+ * The snapshot records the size and modification time of every file it was
+ * built from and is considered stale as soon as any of those change, in
+ * which case callers must fall back to LoadConfigTables.
+ *
+ * Usage:
+ *   ConfigSnapshot snapshot(config.datadir());
+ *   config_tables_t t;
+ *   if (!snapshot.Load(t)) {
+ *     LoadConfigTables(config, t);
+ *   }
+ */
+class ConfigSnapshot {
+public:
+  explicit ConfigSnapshot(const std::string& datadir);
+
+  /**
+   * Writes t as the new snapshot. loaded_at must be the time before t was
+   * loaded, any source modified since then makes the snapshot stale.
+   */
+  bool Save(const config_tables_t& t, time_t loaded_at) const;
+  /** Loads the snapshot into t. Returns false if missing, invalid or stale. */
+  bool Load(config_tables_t& t) const;
+  /** Returns true if the snapshot exists and none of its sources changed. */
+  bool IsCurrent() const;
+  const std::string& path() const noexcept { return path_; }
+
+  /** Loads the tables using LoadConfigTables and saves a new snapshot. */
+  static bool Compile(const Config& config);
+
+  /** Version of the snapshot format, bump when config_tables_t changes. */
+  static constexpr uint32_t kVersion = 1;
+
+private:
+  const std::string datadir_;
+  const std::string path_;
+};
+
+}  // namespace sdk
+}  // namespace wwiv
+
+#endif  // __INCLUDED_SDK_CONFIG_SNAPSHOT_H__
@@ -18,6 +18,7 @@
 #include "sdk/fido/fido_packets.h"
 
 #include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "core/file.h"
@@ -167,6 +168,64 @@ ReadPacketResponse read_packed_message(File& f, FidoPackedMessage& packet) {
   return ReadPacketResponse::OK;
 }
 
+/**
+ * Reads a null-terminated field of up to length {len} or the first null
+ * character from data at pos.
+ */
+static std::string ReadVariableLengthField(const std::string& data, std::string::size_type& pos,
+                                           int max_len) {
+  const auto end = std::min(data.size(), pos + max_len);
+  auto i = pos;
+  while (i < end && data[i] != '\0') {
+    ++i;
+  }
+  string s = data.substr(pos, i - pos);
+  // Skip over the null (if we found it before max_len).
+  pos = (i < end) ? i + 1 : i;
+  return s;
+}
+
+ReadPacketResponse read_packed_message(const std::string& data, std::string::size_type& pos,
+                                       FidoPackedMessage& packet) {
+  const auto remaining = (pos < data.size()) ? data.size() - pos : 0;
+  if (remaining == 0) {
+    // at the end of the packet.
+    return ReadPacketResponse::END_OF_FILE;
+  }
+  const auto num_read = std::min(remaining, sizeof(fido_packed_message_t));
+  memset(&packet.nh, 0, sizeof(fido_packed_message_t));
+  memcpy(&packet.nh, &data[pos], num_read);
+  if (num_read == 2) {
+    // FIDO packets have 2 bytes of NULL at the end;
+    if (packet.nh.message_type == 0) {
+      return ReadPacketResponse::END_OF_FILE;
+    }
+  }
+
+  if (num_read != sizeof(fido_packed_message_t)) {
+    LOG(INFO) << "error reading header, got short read of size: " << num_read
+              << "; expected: " << sizeof(fido_packed_message_t);
+    return ReadPacketResponse::ERROR;
+  }
+  pos += num_read;
+
+  if (packet.nh.message_type != 2) {
+    LOG(INFO) << "invalid message_type: " << packet.nh.message_type << "; expected: 2";
+  }
+  const auto date_len = std::min<std::string::size_type>(20, data.size() - pos);
+  packet.vh.date_time = data.substr(pos, date_len);
+  pos += date_len;
+  while (!packet.vh.date_time.empty() && packet.vh.date_time.back() == '\0') {
+    // Remove trailing null characters.
+    packet.vh.date_time.pop_back();
+  }
+  packet.vh.to_user_name = ReadVariableLengthField(data, pos, 36);
+  packet.vh.from_user_name = ReadVariableLengthField(data, pos, 36);
+  packet.vh.subject = ReadVariableLengthField(data, pos, 72);
+  packet.vh.text = ReadVariableLengthField(data, pos, 256 * 1024);
+  return ReadPacketResponse::OK;
+}
+
 ReadPacketResponse read_stored_message(File& f, FidoStoredMessage& packet) {
   auto num_read = f.Read(&packet.nh, sizeof(fido_stored_message_t));
   if (num_read == 0) {
@@ -272,6 +272,14 @@ wwiv::sdk::net::ReadPacketResponse read_packed_message(wwiv::core::File& file,
                                                        FidoPackedMessage& packet);
 wwiv::sdk::net::ReadPacketResponse read_stored_message(wwiv::core::File& file,
                                                        FidoStoredMessage& packet);
+/**
+ * Reads a packed message from a packet already in memory (such as a member
+ * extracted from a bundle), starting at pos.  On success pos is advanced
+ * past the message.
+ */
+wwiv::sdk::net::ReadPacketResponse read_packed_message(const std::string& data,
+                                                       std::string::size_type& pos,
+                                                       FidoPackedMessage& packet);
 
 
 }  // namespace fido
@@ -97,6 +97,22 @@ static bool bool_flag(const std::string& value, const std::string& flag_name, bo
   return false;
 }
 
+// Sets the Bark and WaZOO file request capabilities from an X? flag (FTS-5001).
+static bool x_flag(const std::string& value, NodelistEntry& e) {
+  if (value.size() != 2 || value.front() != 'X') return false;
+  switch (value.back()) {
+  case 'A': e.bark_file_ = e.bark_update_ = e.wazoo_file_ = e.wazoo_update_ = true; break;
+  case 'B': e.bark_file_ = e.bark_update_ = e.wazoo_file_ = true; break;
+  case 'C': e.bark_file_ = e.wazoo_file_ = e.wazoo_update_ = true; break;
+  case 'P': e.bark_file_ = e.bark_update_ = true; break;
+  case 'R': e.bark_file_ = e.wazoo_file_ = true; break;
+  case 'W': e.wazoo_file_ = true; break;
+  case 'X': e.wazoo_file_ = e.wazoo_update_ = true; break;
+  default: return false;
+  }
+  return true;
+}
+
 static string ToSpaces(const std::string& orig) {
   string s(orig);
   std::replace(std::begin(s), std::end(s), '_', ' ');
@@ -143,8 +159,7 @@ bool NodelistEntry::ParseDataLine(const std::string& data_line, NodelistEntry& e
     if (internet_flag(f, "IBN", e.binkp_, e.binkp_hostname_, e.binkp_port_)) continue;
     if (internet_flag(f, "ITN", e.telnet_, e.telnet_hostname_, e.telnet_port_)) continue;
     if (internet_flag(f, "IVN", e.vmodem_, e.vmodem_hostname_, e.vmodem_port_)) continue;
-
-    // TODO(rushfan): Handle X? flags.
+    if (x_flag(f, e)) continue;
   }
   if (e.binkp_) {
     if (e.binkp_port_ == 0) e.binkp_port_ = 24554;
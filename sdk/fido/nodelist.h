@@ -117,7 +117,7 @@ public:
 
   const NodelistEntry& entry(const FidoAddress& a) const { return entries_.at(a); }
   bool contains(const FidoAddress& a) const { return wwiv::stl::contains(entries_, a); }
-  const std::map<FidoAddress, NodelistEntry> entries() const { return entries_; }
+  const std::map<FidoAddress, NodelistEntry>& entries() const { return entries_; }
   const std::vector<NodelistEntry> entries(uint16_t zone, uint16_t net) const;
   const std::vector<NodelistEntry> entries(uint16_t zone) const;
   const std::vector<uint16_t> zones() const;
@@ -0,0 +1,314 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "sdk/fido/nodelist_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+
+using std::string;
+using std::vector;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace sdk {
+namespace fido {
+
+static constexpr char nodelist_index_signature[] = "WNLX";
+static constexpr uint32_t nodelist_index_version = 2;
+
+static constexpr uint8_t flag_cm = 0x01;
+static constexpr uint8_t flag_icm = 0x02;
+static constexpr uint8_t flag_mo = 0x04;
+static constexpr uint8_t flag_lo = 0x08;
+static constexpr uint8_t flag_mn = 0x10;
+static constexpr uint8_t flag_binkp = 0x20;
+static constexpr uint8_t flag_telnet = 0x40;
+static constexpr uint8_t flag_vmodem = 0x80;
+
+static constexpr uint8_t capability_bark_file = 0x01;
+static constexpr uint8_t capability_bark_update = 0x02;
+static constexpr uint8_t capability_wazoo_file = 0x04;
+static constexpr uint8_t capability_wazoo_update = 0x08;
+
+static bool key_less(const nodelist_index_entry_t& e, uint16_t zone, uint16_t net,
+                     uint16_t node) {
+  if (e.zone != zone) {
+    return e.zone < zone;
+  }
+  if (e.net != net) {
+    return e.net < net;
+  }
+  return e.node < node;
+}
+
+NodelistIndex::NodelistIndex(const std::string& index_path) : file_(index_path) {
+  if (!file_ || file_.size() < sizeof(nodelist_index_header_t)) {
+    return;
+  }
+  header_ = reinterpret_cast<const nodelist_index_header_t*>(file_.data());
+  if (memcmp(header_->signature, nodelist_index_signature, sizeof(header_->signature)) != 0 ||
+      header_->version != nodelist_index_version) {
+    VLOG(1) << "Unknown nodelist index format: " << index_path;
+    return;
+  }
+  num_entries_ = header_->num_entries;
+  string_pool_size_ = header_->string_pool_size;
+  const auto expected_size = sizeof(nodelist_index_header_t) +
+                             num_entries_ * sizeof(nodelist_index_entry_t) + string_pool_size_;
+  if (file_.size() != expected_size) {
+    LOG(ERROR) << "Truncated nodelist index: " << index_path;
+    return;
+  }
+  entries_ = reinterpret_cast<const nodelist_index_entry_t*>(file_.data() +
+                                                             sizeof(nodelist_index_header_t));
+  strings_ = reinterpret_cast<const char*>(entries_ + num_entries_);
+  initialized_ = true;
+}
+
+NodelistIndex::~NodelistIndex() {}
+
+const nodelist_index_entry_t* NodelistIndex::find(uint16_t zone, uint16_t net,
+                                                  uint16_t node) const {
+  if (!initialized_) {
+    return nullptr;
+  }
+  const auto* end = entries_ + num_entries_;
+  const auto* it = std::lower_bound(entries_, end, 0,
+                                    [=](const nodelist_index_entry_t& e, int) {
+                                      return key_less(e, zone, net, node);
+                                    });
+  if (it == end || it->zone != zone || it->net != net || it->node != node) {
+    return nullptr;
+  }
+  return it;
+}
+
+std::string NodelistIndex::str(uint32_t offset) const {
+  if (offset >= string_pool_size_) {
+    return {};
+  }
+  const auto* s = strings_ + offset;
+  return string(s, strnlen(s, string_pool_size_ - offset));
+}
+
+std::string NodelistIndex::nodelist_name() const {
+  if (!initialized_) {
+    return {};
+  }
+  return string(header_->nodelist_name,
+                strnlen(header_->nodelist_name, sizeof(header_->nodelist_name)));
+}
+
+time_t NodelistIndex::nodelist_time() const {
+  return initialized_ ? static_cast<time_t>(header_->nodelist_time) : 0;
+}
+
+bool NodelistIndex::entry(const FidoAddress& a, NodelistEntry& e) const {
+  const auto* r = find(a.zone(), a.net(), a.node());
+  if (r == nullptr) {
+    return false;
+  }
+  e.address_ = FidoAddress(r->zone, r->net, r->node, 0, "");
+  e.keyword_ = static_cast<NodelistKeyword>(r->keyword);
+  e.number_ = r->node;
+  e.name_ = str(r->name);
+  e.location_ = str(r->location);
+  e.sysop_name_ = str(r->sysop_name);
+  e.phone_number_ = str(r->phone_number);
+  e.baud_rate_ = r->baud_rate;
+  e.cm_ = (r->flags & flag_cm) != 0;
+  e.icm_ = (r->flags & flag_icm) != 0;
+  e.mo_ = (r->flags & flag_mo) != 0;
+  e.lo_ = (r->flags & flag_lo) != 0;
+  e.mn_ = (r->flags & flag_mn) != 0;
+  e.bark_file_ = (r->capabilities & capability_bark_file) != 0;
+  e.bark_update_ = (r->capabilities & capability_bark_update) != 0;
+  e.wazoo_file_ = (r->capabilities & capability_wazoo_file) != 0;
+  e.wazoo_update_ = (r->capabilities & capability_wazoo_update) != 0;
+  e.hostname_ = str(r->hostname);
+  e.binkp_ = (r->flags & flag_binkp) != 0;
+  e.binkp_port_ = r->binkp_port;
+  e.binkp_hostname_ = str(r->binkp_hostname);
+  e.telnet_ = (r->flags & flag_telnet) != 0;
+  e.telnet_port_ = r->telnet_port;
+  e.telnet_hostname_ = str(r->telnet_hostname);
+  e.vmodem_ = (r->flags & flag_vmodem) != 0;
+  e.vmodem_port_ = r->vmodem_port;
+  e.vmodem_hostname_ = str(r->vmodem_hostname);
+  return true;
+}
+
+namespace {
+/** Builds the string pool, storing each distinct string once. */
+class StringPool {
+public:
+  StringPool() { add(""); }
+  uint32_t add(const std::string& s) {
+    auto it = offsets_.find(s);
+    if (it != offsets_.end()) {
+      return it->second;
+    }
+    const auto offset = static_cast<uint32_t>(pool_.size());
+    pool_.insert(pool_.end(), s.begin(), s.end());
+    pool_.push_back('\0');
+    offsets_.emplace(s, offset);
+    return offset;
+  }
+  const std::vector<char>& pool() const { return pool_; }
+
+private:
+  std::vector<char> pool_;
+  std::map<std::string, uint32_t> offsets_;
+};
+}  // namespace
+
+// static
+bool NodelistIndex::Compile(const Nodelist& nodelist, const std::string& nodelist_name,
+                            time_t nodelist_time, const std::string& index_path) {
+  StringPool strings;
+  vector<nodelist_index_entry_t> entries;
+  entries.reserve(nodelist.entries().size());
+  for (const auto& kv : nodelist.entries()) {
+    const auto& a = kv.first;
+    const auto& n = kv.second;
+    nodelist_index_entry_t e{};
+    e.zone = static_cast<uint16_t>(a.zone());
+    e.net = static_cast<uint16_t>(a.net());
+    e.node = static_cast<uint16_t>(a.node());
+    e.keyword = static_cast<uint8_t>(n.keyword_);
+    e.flags = (n.cm_ ? flag_cm : 0) | (n.icm_ ? flag_icm : 0) | (n.mo_ ? flag_mo : 0) |
+              (n.lo_ ? flag_lo : 0) | (n.mn_ ? flag_mn : 0) | (n.binkp_ ? flag_binkp : 0) |
+              (n.telnet_ ? flag_telnet : 0) | (n.vmodem_ ? flag_vmodem : 0);
+    e.capabilities = (n.bark_file_ ? capability_bark_file : 0) |
+                     (n.bark_update_ ? capability_bark_update : 0) |
+                     (n.wazoo_file_ ? capability_wazoo_file : 0) |
+                     (n.wazoo_update_ ? capability_wazoo_update : 0);
+    e.baud_rate = n.baud_rate_;
+    e.binkp_port = n.binkp_port_;
+    e.telnet_port = n.telnet_port_;
+    e.vmodem_port = n.vmodem_port_;
+    e.name = strings.add(n.name_);
+    e.location = strings.add(n.location_);
+    e.sysop_name = strings.add(n.sysop_name_);
+    e.phone_number = strings.add(n.phone_number_);
+    e.hostname = strings.add(n.hostname_);
+    e.binkp_hostname = strings.add(n.binkp_hostname_);
+    e.telnet_hostname = strings.add(n.telnet_hostname_);
+    e.vmodem_hostname = strings.add(n.vmodem_hostname_);
+    entries.push_back(e);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const nodelist_index_entry_t& l, const nodelist_index_entry_t& r) {
+              return key_less(l, r.zone, r.net, r.node);
+            });
+
+  nodelist_index_header_t h{};
+  memcpy(h.signature, nodelist_index_signature, sizeof(h.signature));
+  h.version = nodelist_index_version;
+  to_char_array(h.nodelist_name, nodelist_name);
+  h.nodelist_time = static_cast<int64_t>(nodelist_time);
+  h.num_entries = static_cast<uint32_t>(entries.size());
+  h.string_pool_size = static_cast<uint32_t>(strings.pool().size());
+
+  // Write to a temporary file and rename it into place so that anyone with
+  // the old index mapped never sees a partially written one.
+  const auto tmp_path = StrCat(index_path, ".tmp");
+  {
+    File f(tmp_path);
+    if (!f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                File::modeTruncate)) {
+      LOG(ERROR) << "Unable to create nodelist index: " << tmp_path;
+      return false;
+    }
+    const auto entries_size = entries.size() * sizeof(nodelist_index_entry_t);
+    if (f.Write(&h, sizeof(h)) != sizeof(h) ||
+        (!entries.empty() &&
+         f.Write(&entries[0], entries_size) != static_cast<ssize_t>(entries_size)) ||
+        f.Write(&strings.pool()[0], strings.pool().size()) !=
+            static_cast<ssize_t>(strings.pool().size())) {
+      LOG(ERROR) << "Unable to write nodelist index: " << tmp_path;
+      f.Close();
+      File::Remove(tmp_path);
+      return false;
+    }
+  }
+#ifdef _WIN32
+  File::Remove(index_path);
+#endif  // _WIN32
+  if (!File::Rename(tmp_path, index_path)) {
+    LOG(ERROR) << "Unable to rename " << tmp_path << " to " << index_path;
+    File::Remove(tmp_path);
+    return false;
+  }
+  return true;
+}
+
+// static
+std::string NodelistIndex::IndexFileName(const std::string& base) {
+  // Don't use base.* since that would be found by FindLatestNodelist.
+  return StrCat(base, "_idx.dat");
+}
+
+// static
+std::unique_ptr<NodelistIndex> NodelistIndex::Open(const std::string& dir,
+                                                   const std::string& base) {
+  const auto nodelist_name = Nodelist::FindLatestNodelist(dir, base);
+  File nodelist_file(FilePath(dir, nodelist_name));
+  if (!nodelist_file.Exists()) {
+    LOG(ERROR) << "Nodelist does not exist: " << nodelist_file;
+    return {};
+  }
+  const auto nodelist_time = nodelist_file.last_write_time();
+  const auto index_path = FilePath(dir, IndexFileName(base));
+
+  {
+    auto index = std::make_unique<NodelistIndex>(index_path);
+    if (index->initialized() && index->nodelist_name() == nodelist_name &&
+        index->nodelist_time() == nodelist_time) {
+      return index;
+    }
+  }
+
+  LOG(INFO) << "Compiling nodelist index for: " << nodelist_file;
+  Nodelist nodelist(nodelist_file.full_pathname());
+  if (!nodelist.initialized()) {
+    LOG(ERROR) << "Unable to parse nodelist: " << nodelist_file;
+    return {};
+  }
+  if (!Compile(nodelist, nodelist_name, nodelist_time, index_path)) {
+    return {};
+  }
+  auto index = std::make_unique<NodelistIndex>(index_path);
+  if (!index->initialized()) {
+    return {};
+  }
+  return index;
+}
+
+}  // namespace fido
+}  // namespace sdk
+}  // namespace wwiv
@@ -0,0 +1,132 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_SDK_FIDO_NODELIST_INDEX_H__
+#define __INCLUDED_SDK_FIDO_NODELIST_INDEX_H__
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include "core/mapped_file.h"
+#include "sdk/fido/fido_address.h"
+#include "sdk/fido/nodelist.h"
+
+namespace wwiv {
+namespace sdk {
+namespace fido {
+
+#pragma pack(push, 1)
+
+/**
+ * Header of a compiled nodelist index.  It is followed by num_entries
+ * nodelist_index_entry_t records sorted by zone, net and node, and then
+ * by the string pool (string_pool_size bytes of NUL terminated strings).
+ */
+struct nodelist_index_header_t {
+  char signature[4];
+  uint32_t version;
+  // Name (not path) and last write time of the nodelist that was compiled.
+  char nodelist_name[64];
+  int64_t nodelist_time;
+  uint32_t num_entries;
+  uint32_t string_pool_size;
+};
+
+/** Offsets are into the string pool. */
+struct nodelist_index_entry_t {
+  uint16_t zone;
+  uint16_t net;
+  uint16_t node;
+  uint8_t keyword;
+  uint8_t flags;
+  uint32_t baud_rate;
+  uint16_t binkp_port;
+  uint16_t telnet_port;
+  uint16_t vmodem_port;
+  // The bark and wazoo file request flags.
+  uint8_t capabilities;
+  uint8_t reserved;
+  uint32_t name;
+  uint32_t location;
+  uint32_t sysop_name;
+  uint32_t phone_number;
+  uint32_t hostname;
+  uint32_t binkp_hostname;
+  uint32_t telnet_hostname;
+  uint32_t vmodem_hostname;
+};
+
+#pragma pack(pop)
+
+/**
+ * A compact, memory mapped, binary index of a FidoNet nodelist.
+ *
+ * The index is compiled from NODELIST.nnn into nodelist_idx.dat (using the
+ * nodelist base name) and is only rebuilt when a newer nodelist is found.
+ * Lookups are a binary search over fixed size records, so there's no need to
+ * parse the text nodelist on each use.
+ */
+class NodelistIndex {
+public:
+  /** Opens an existing compiled index. */
+  explicit NodelistIndex(const std::string& index_path);
+  virtual ~NodelistIndex();
+
+  bool initialized() const { return initialized_; }
+  explicit operator bool() const { return initialized_; }
+
+  std::size_t size() const { return num_entries_; }
+  bool contains(const FidoAddress& a) const { return find(a.zone(), a.net(), a.node()) != nullptr; }
+  /** Returns the entry or nullptr if it does not exist. */
+  const nodelist_index_entry_t* find(uint16_t zone, uint16_t net, uint16_t node) const;
+  /** Fills in e with the entry for a, returns false if it does not exist. */
+  bool entry(const FidoAddress& a, NodelistEntry& e) const;
+  /** Returns the string at offset in the string pool. */
+  std::string str(uint32_t offset) const;
+  /** Name and last write time of the nodelist this index was compiled from. */
+  std::string nodelist_name() const;
+  time_t nodelist_time() const;
+
+  /** Compiles nodelist into the index file index_path. */
+  static bool Compile(const Nodelist& nodelist, const std::string& nodelist_name,
+                      time_t nodelist_time, const std::string& index_path);
+
+  /**
+   * Opens the index for the latest nodelist named base in dir, (re)compiling
+   * it from the text nodelist if it does not exist or is out of date.
+   */
+  static std::unique_ptr<NodelistIndex> Open(const std::string& dir, const std::string& base);
+  static std::string IndexFileName(const std::string& base);
+
+private:
+  wwiv::core::MappedFile file_;
+  const nodelist_index_header_t* header_{nullptr};
+  const nodelist_index_entry_t* entries_{nullptr};
+  const char* strings_{nullptr};
+  std::size_t num_entries_{0};
+  std::size_t string_pool_size_{0};
+  bool initialized_{false};
+};
+
+}  // namespace fido
+}  // namespace sdk
+}  // namespace wwiv
+
+#endif  // __INCLUDED_SDK_FIDO_NODELIST_INDEX_H__
@@ -34,6 +34,7 @@
 #define BBSDATA_IND "bbsdata.ind"
 #define BBSDATA_REG "bbsdata.reg"
 #define BBSDATA_ROU "bbsdata.rou"
+#define BBSDATA_RTC "bbsdata.rtc"
 #define BBSLIST_NET "bbslist.net"
 
 #define BBSLIST_MSG "bbslist.msg"
@@ -56,6 +57,7 @@
 #define CMDPARAM_NOEXT "cmdparam"
 
 #define CONFIG_DAT "config.dat"
+#define CONFIG_SNP "config.snp"
 #define CONFIG_OVR "config.ovr"
 
 #define COMMENT_TXT "comment.txt"
@@ -169,6 +171,7 @@
 #define SONLINE_NOEXT "sonline"
 #define SRESTRCT_NOEXT "srestrct"
 #define STATUS_DAT "status.dat"
+#define STATUS_SHM "status.shm"
 #define SUEDIT_NOEXT "suedit"
 #define SUBS_CNF "subs.cnf"
 #define SUBS_DAT "subs.dat"
@@ -194,6 +197,7 @@
 #define USER_LOG "user.log"
 #define USER_LST "user.lst"
 #define USER_QSC "user.qsc"
+#define USER_SEQ "user.seq"
 
 #define VOTING_DAT "voting.dat"
 #define VOTING_TXT "voting.txt"
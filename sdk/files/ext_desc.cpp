@@ -0,0 +1,369 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "sdk/files/ext_desc.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+
+using std::map;
+using std::string;
+using std::vector;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace sdk {
+namespace files {
+
+// Header of the .exi file.
+struct ext_index_header_t {
+  char signature[4];
+  uint32_t version;
+  // Size and modification time of the .ext file this index describes.
+  uint32_t ext_size;
+  uint32_t ext_mtime;
+  uint32_t num_entries;
+};
+
+static constexpr char kIndexSignature[4] = {'W', 'X', 'D', 'I'};
+static constexpr uint32_t kIndexVersion = 1;
+// Descriptions at most this far apart are read together by the batch Read.
+static constexpr off_t kMaxReadGap = 64 * 1024;
+static constexpr off_t kMaxReadSize = 1024 * 1024;
+
+static string index_filename_for(const string& ext_filename) {
+  auto dot = ext_filename.find_last_of('.');
+  auto sep = ext_filename.find_last_of(File::pathSeparatorChar);
+  if (dot == string::npos || (sep != string::npos && dot < sep)) {
+    return StrCat(ext_filename, ".exi");
+  }
+  return StrCat(ext_filename.substr(0, dot), ".exi");
+}
+
+static string name_of(const char* name) {
+  return string(name, strnlen(name, 13));
+}
+
+ExtendedDescriptions::ExtendedDescriptions(const string& ext_filename)
+    : ext_filename_(ext_filename), index_filename_(index_filename_for(ext_filename)) {}
+
+ExtendedDescriptions::~ExtendedDescriptions() = default;
+
+void ExtendedDescriptions::UpdateStat() {
+  File f(ext_filename_);
+  ext_size_ = f.Exists() ? f.length() : 0;
+  ext_mtime_ = ext_size_ ? f.last_write_time() : 0;
+}
+
+bool ExtendedDescriptions::Refresh(File* ext_file) {
+  File f(ext_filename_);
+  const auto size = f.Exists() ? f.length() : 0;
+  const auto mtime = size ? f.last_write_time() : 0;
+  if (loaded_ && size == ext_size_ && mtime == ext_mtime_) {
+    return true;
+  }
+  index_.clear();
+  loaded_ = false;
+  if (size == 0) {
+    ext_size_ = 0;
+    ext_mtime_ = 0;
+    loaded_ = true;
+    return true;
+  }
+  if (LoadIndex(size, mtime)) {
+    return true;
+  }
+  return ext_file ? Rebuild(*ext_file) : Rebuild();
+}
+
+bool ExtendedDescriptions::LoadIndex(off_t ext_size, time_t ext_mtime) {
+  File f(index_filename_);
+  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+    return false;
+  }
+  ext_index_header_t h{};
+  if (f.Read(&h, sizeof(h)) != sizeof(h) || memcmp(h.signature, kIndexSignature, 4) != 0 ||
+      h.version != kIndexVersion || h.ext_size != static_cast<uint32_t>(ext_size) ||
+      h.ext_mtime != static_cast<uint32_t>(ext_mtime)) {
+    return false;
+  }
+  vector<ext_desc_rec> entries(h.num_entries);
+  const auto len = entries.size() * sizeof(ext_desc_rec);
+  if (len > 0 && f.Read(&entries[0], len) != static_cast<ssize_t>(len)) {
+    return false;
+  }
+  index_.clear();
+  for (const auto& e : entries) {
+    index_.emplace(name_of(e.name), e);
+  }
+  ext_size_ = ext_size;
+  ext_mtime_ = ext_mtime;
+  loaded_ = true;
+  return true;
+}
+
+bool ExtendedDescriptions::Rebuild(const vector<char>& data) {
+  index_.clear();
+  size_t pos = 0;
+  while (pos + sizeof(ext_desc_type) <= data.size()) {
+    ext_desc_type ed{};
+    memcpy(&ed, &data[pos], sizeof(ext_desc_type));
+    if (ed.len < 0) {
+      LOG(ERROR) << "Invalid extended description in: " << ext_filename_ << " at: " << pos;
+      break;
+    }
+    ext_desc_rec r{};
+    memcpy(r.name, ed.name, sizeof(r.name));
+    r.name[sizeof(r.name) - 1] = '\0';
+    r.offset = static_cast<int32_t>(pos);
+    index_.emplace(name_of(r.name), r);
+    pos += sizeof(ext_desc_type) + ed.len;
+  }
+  ++rebuilds_;
+  loaded_ = true;
+  return true;
+}
+
+bool ExtendedDescriptions::Rebuild() {
+  File f(ext_filename_);
+  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+    Rebuild(vector<char>());
+    UpdateStat();
+    return SaveIndex();
+  }
+  return Rebuild(f);
+}
+
+bool ExtendedDescriptions::Rebuild(File& ext_file) {
+  vector<char> data(static_cast<size_t>(ext_file.length()));
+  ext_file.Seek(0, File::Whence::begin);
+  if (!data.empty() &&
+      ext_file.Read(&data[0], data.size()) != static_cast<ssize_t>(data.size())) {
+    LOG(ERROR) << "Short read on: " << ext_filename_;
+    return false;
+  }
+  Rebuild(data);
+  UpdateStat();
+  return SaveIndex();
+}
+
+bool ExtendedDescriptions::SaveIndex() {
+  vector<ext_desc_rec> entries;
+  entries.reserve(index_.size());
+  for (const auto& e : index_) {
+    entries.push_back(e.second);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const ext_desc_rec& l, const ext_desc_rec& r) { return l.offset < r.offset; });
+
+  ext_index_header_t h{};
+  memcpy(h.signature, kIndexSignature, 4);
+  h.version = kIndexVersion;
+  h.ext_size = static_cast<uint32_t>(ext_size_);
+  h.ext_mtime = static_cast<uint32_t>(ext_mtime_);
+  h.num_entries = static_cast<uint32_t>(entries.size());
+
+  File f(index_filename_);
+  if (!f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+              File::modeTruncate)) {
+    LOG(ERROR) << "Unable to write: " << index_filename_;
+    return false;
+  }
+  f.Write(&h, sizeof(h));
+  if (!entries.empty()) {
+    f.Write(&entries[0], entries.size() * sizeof(ext_desc_rec));
+  }
+  return true;
+}
+
+bool ExtendedDescriptions::Add(const string& name, const string& description) {
+  ext_desc_type ed{};
+  to_char_array(ed.name, name);
+  ed.len = static_cast<int16_t>(description.size());
+
+  // The .ext file stays locked until the index is saved, and the index is
+  // reloaded under the lock, so that descriptions appended by other nodes
+  // since we last looked aren't left out of the saved index.
+  File file(ext_filename_);
+  if (!file.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
+    return false;
+  }
+  auto lock = file.lock(FileLockType::write_lock);
+  Refresh(&file);
+  const auto offset = file.Seek(0L, File::Whence::end);
+  file.Write(&ed, sizeof(ext_desc_type));
+  file.Write(description.c_str(), ed.len);
+
+  ext_desc_rec r{};
+  memcpy(r.name, ed.name, sizeof(r.name));
+  r.offset = static_cast<int32_t>(offset);
+  index_.emplace(name_of(r.name), r);
+  UpdateStat();
+  return SaveIndex();
+}
+
+bool ExtendedDescriptions::Remove(const string& name) {
+  File file(ext_filename_);
+  if (!file.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite)) {
+    return false;
+  }
+  auto lock = file.lock(FileLockType::write_lock);
+  vector<char> data(static_cast<size_t>(file.length()));
+  if (!data.empty() && file.Read(&data[0], data.size()) != static_cast<ssize_t>(data.size())) {
+    return false;
+  }
+
+  vector<char> out;
+  out.reserve(data.size());
+  size_t pos = 0;
+  while (pos + sizeof(ext_desc_type) <= data.size()) {
+    ext_desc_type ed{};
+    memcpy(&ed, &data[pos], sizeof(ext_desc_type));
+    if (ed.len < 0) {
+      break;
+    }
+    const auto end = std::min(data.size(), pos + sizeof(ext_desc_type) + ed.len);
+    if (ed.len < 10000 && name != name_of(ed.name)) {
+      out.insert(out.end(), data.begin() + pos, data.begin() + end);
+    }
+    pos = end;
+  }
+  if (out.size() != data.size()) {
+    file.Seek(0, File::Whence::begin);
+    if (!out.empty()) {
+      file.Write(&out[0], out.size());
+    }
+    file.set_length(static_cast<off_t>(out.size()));
+  }
+
+  Rebuild(out);
+  UpdateStat();
+  return SaveIndex();
+}
+
+bool ExtendedDescriptions::Read(const string& name, string* description) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (!Refresh()) {
+      return false;
+    }
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+      return false;
+    }
+    File file(ext_filename_);
+    if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+      return false;
+    }
+    file.Seek(it->second.offset, File::Whence::begin);
+    ext_desc_type ed{};
+    if (file.Read(&ed, sizeof(ext_desc_type)) == sizeof(ext_desc_type) &&
+        name == name_of(ed.name) && ed.len >= 0) {
+      description->resize(ed.len);
+      if (ed.len > 0) {
+        file.Read(&(*description)[0], ed.len);
+      }
+      return true;
+    }
+    // The .ext file changed underneath the index.
+    file.Close();
+    Rebuild();
+  }
+  return false;
+}
+
+map<string, string> ExtendedDescriptions::Read(const vector<string>& names) {
+  map<string, string> result;
+  if (!Refresh()) {
+    return result;
+  }
+  vector<std::pair<off_t, string>> wanted;
+  for (const auto& n : names) {
+    auto it = index_.find(n);
+    if (it != index_.end()) {
+      wanted.emplace_back(it->second.offset, n);
+    }
+  }
+  if (wanted.empty()) {
+    return result;
+  }
+  std::sort(wanted.begin(), wanted.end());
+
+  File file(ext_filename_);
+  if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+    return result;
+  }
+  const auto file_size = file.length();
+  vector<string> missed;
+  size_t i = 0;
+  while (i < wanted.size()) {
+    // Read a run of nearby descriptions at once.  Descriptions are shorter
+    // than kMaxReadGap, so that much past the last one in the run is enough.
+    const auto start = wanted[i].first;
+    auto j = i + 1;
+    while (j < wanted.size() && wanted[j].first - wanted[j - 1].first <= kMaxReadGap &&
+           wanted[j].first - start <= kMaxReadSize) {
+      ++j;
+    }
+    const auto end = std::min<off_t>(file_size, wanted[j - 1].first + kMaxReadGap);
+    vector<char> buf(static_cast<size_t>(std::max<off_t>(0, end - start)));
+    file.Seek(start, File::Whence::begin);
+    const auto num_read = buf.empty() ? 0 : file.Read(&buf[0], buf.size());
+    for (; i < j; i++) {
+      const auto rel = static_cast<size_t>(wanted[i].first - start);
+      ext_desc_type ed{};
+      if (num_read < 0 || rel + sizeof(ext_desc_type) > static_cast<size_t>(num_read)) {
+        missed.push_back(wanted[i].second);
+        continue;
+      }
+      memcpy(&ed, &buf[rel], sizeof(ext_desc_type));
+      const auto text = rel + sizeof(ext_desc_type);
+      if (ed.len < 0 || wanted[i].second != name_of(ed.name) ||
+          text + ed.len > static_cast<size_t>(num_read)) {
+        missed.push_back(wanted[i].second);
+        continue;
+      }
+      result[wanted[i].second] = string(&buf[text], ed.len);
+    }
+  }
+  file.Close();
+
+  // Anything that didn't line up goes through the single lookup, which
+  // rebuilds the index if needed.
+  for (const auto& n : missed) {
+    string s;
+    if (Read(n, &s)) {
+      result[n] = s;
+    }
+  }
+  return result;
+}
+
+int ExtendedDescriptions::size() {
+  Refresh();
+  return static_cast<int>(index_.size());
+}
+
+}  // namespace files
+}  // namespace sdk
+}  // namespace wwiv
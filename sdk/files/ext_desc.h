@@ -0,0 +1,101 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_SDK_FILES_EXT_DESC_H__
+#define __INCLUDED_SDK_FILES_EXT_DESC_H__
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/file.h"
+#include "sdk/vardec.h"
+
+namespace wwiv {
+namespace sdk {
+namespace files {
+
+/**
+ * Extended file descriptions (the .ext file of a file area) along with a
+ * persistent index from filename to offset stored next to it in a .exi file.
+ *
+ * The index file holds a header recording the size and modification time of
+ * the .ext file it describes, followed by one ext_desc_rec per description.
+ * If the .ext file was changed without updating the index (by an older
+ * version of WWIV for example), the index is rebuilt with a single
+ * sequential read of the .ext file.
+ *
+ * When a filename appears more than once, the first description wins, as it
+ * always has.
+ */
+class ExtendedDescriptions {
+public:
+  explicit ExtendedDescriptions(const std::string& ext_filename);
+  ExtendedDescriptions(const ExtendedDescriptions&) = delete;
+  ExtendedDescriptions& operator=(const ExtendedDescriptions&) = delete;
+  ~ExtendedDescriptions();
+
+  const std::string& filename() const noexcept { return ext_filename_; }
+  const std::string& index_filename() const noexcept { return index_filename_; }
+
+  /** Appends the description for name. */
+  bool Add(const std::string& name, const std::string& description);
+  /** Removes every description for name. */
+  bool Remove(const std::string& name);
+
+  /** Reads the description for name, returns false if there is none. */
+  bool Read(const std::string& name, std::string* description);
+  /**
+   * Reads the descriptions for all of names, which are returned keyed by
+   * name.  Names without a description are omitted.  Nearby descriptions are
+   * loaded with one sequential read.
+   */
+  std::map<std::string, std::string> Read(const std::vector<std::string>& names);
+
+  /** Number of files with a description. */
+  int size();
+  /** Number of times the index has been rebuilt from the .ext file. */
+  int rebuilds() const noexcept { return rebuilds_; }
+
+private:
+  // Loads the index if the .ext file changed.  ext_file is the .ext file
+  // when the caller already has it open (and locked).
+  bool Refresh(wwiv::core::File* ext_file = nullptr);
+  bool LoadIndex(off_t ext_size, time_t ext_mtime);
+  bool Rebuild();
+  bool Rebuild(wwiv::core::File& ext_file);
+  bool Rebuild(const std::vector<char>& data);
+  bool SaveIndex();
+  void UpdateStat();
+
+  const std::string ext_filename_;
+  const std::string index_filename_;
+  std::unordered_map<std::string, ext_desc_rec> index_;
+  bool loaded_{false};
+  off_t ext_size_{0};
+  time_t ext_mtime_{0};
+  int rebuilds_{0};
+};
+
+}  // namespace files
+}  // namespace sdk
+}  // namespace wwiv
+
+#endif  // __INCLUDED_SDK_FILES_EXT_DESC_H__
@@ -0,0 +1,205 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "sdk/files/file_catalog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <thread>
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+
+using std::string;
+using std::vector;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace sdk {
+namespace files {
+
+// Mask used by the bbs to mean "all files".
+static const char kAllFilesMask[] = "        .   ";
+
+bool aligned_wildcard_match(const char* mask, const char* filename) {
+  for (int i = 0; i < 12; i++) {
+    if (mask[i] != filename[i] && mask[i] != '?' && filename[i] != '?') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool icontains(const char* haystack, const string& needle) {
+  auto it = std::search(haystack, haystack + strlen(haystack), needle.begin(), needle.end(),
+                        [](char a, char b) {
+                          return std::toupper(static_cast<unsigned char>(a)) ==
+                                 std::toupper(static_cast<unsigned char>(b));
+                        });
+  return *it != '\0' || needle.empty();
+}
+
+bool catalog_query_t::matches(const uploadsrec& u) const {
+  if (filemask.size() >= 12 && filemask != kAllFilesMask &&
+      !aligned_wildcard_match(filemask.c_str(), u.filename)) {
+    return false;
+  }
+  if (since && u.daten < since) {
+    return false;
+  }
+  if (!text.empty() && !icontains(u.filename, text) && !icontains(u.description, text)) {
+    return false;
+  }
+  return true;
+}
+
+FileCatalog::FileCatalog(const string& datadir) : datadir_(datadir) {}
+
+FileCatalog::~FileCatalog() = default;
+
+std::shared_ptr<const catalog_area_t> FileCatalog::area(const string& filename) {
+  File file(FilePath(datadir_, StrCat(filename, ".dir")));
+  const auto size = file.Exists() ? file.length() : 0;
+  const auto mtime = size ? file.last_write_time() : 0;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = areas_.find(filename);
+    if (it != areas_.end() && !it->second.racy && it->second.size == size &&
+        it->second.mtime == mtime) {
+      return it->second.files;
+    }
+  }
+
+  // Read the whole .dir file at once, outside of the lock.
+  const auto now = time(nullptr);
+  auto files = std::make_shared<catalog_area_t>();
+  const auto num_records = static_cast<size_t>(size) / sizeof(uploadsrec);
+  if (num_records > 1 && file.Open(File::modeBinary | File::modeReadOnly)) {
+    vector<uploadsrec> records(num_records);
+    const auto len = num_records * sizeof(uploadsrec);
+    const auto num_read = file.Read(&records[0], len);
+    file.Close();
+    if (num_read == static_cast<ssize_t>(len)) {
+      // The first record holds the number of files in the area.
+      const auto numf = std::min<size_t>(records[0].numbytes, num_records - 1);
+      files->assign(records.begin() + 1, records.begin() + 1 + numf);
+    } else {
+      LOG(ERROR) << "Short read on: " << file;
+    }
+  }
+  ++loads_;
+
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& c = areas_[filename];
+  c.files = files;
+  c.size = size;
+  c.mtime = mtime;
+  // A change made later in the same second would not change mtime, so
+  // check the file again next time.
+  c.racy = mtime >= now;
+  return files;
+}
+
+void FileCatalog::Invalidate(const string& filename) {
+  std::lock_guard<std::mutex> lock(mu_);
+  areas_.erase(filename);
+}
+
+void FileCatalog::InvalidateAll() {
+  std::lock_guard<std::mutex> lock(mu_);
+  areas_.clear();
+}
+
+void FileCatalog::ForEachArea(int num_areas, int num_threads,
+                              const std::function<void(int)>& fn) {
+  if (num_threads <= 0) {
+    num_threads = std::max<int>(1, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min(num_threads, num_areas);
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_areas; i++) {
+      fn(i);
+    }
+    return;
+  }
+  std::atomic<int> next{0};
+  vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&]() {
+      for (int i = next++; i < num_areas; i = next++) {
+        fn(i);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+vector<catalog_match_t> FileCatalog::Search(const vector<string>& areas,
+                                            const std::function<bool(const uploadsrec&)>& pred,
+                                            int num_threads) {
+  vector<vector<catalog_match_t>> results(areas.size());
+  ForEachArea(static_cast<int>(areas.size()), num_threads, [&](int i) {
+    const auto files = area(areas[i]);
+    int record = 0;
+    for (const auto& u : *files) {
+      ++record;
+      if (pred(u)) {
+        results[i].push_back({i, record, u});
+      }
+    }
+  });
+
+  vector<catalog_match_t> matches;
+  for (auto& r : results) {
+    matches.insert(matches.end(), r.begin(), r.end());
+  }
+  return matches;
+}
+
+vector<catalog_match_t> FileCatalog::Search(const vector<string>& areas,
+                                            const catalog_query_t& query, int num_threads) {
+  return Search(areas, [&query](const uploadsrec& u) { return query.matches(u); }, num_threads);
+}
+
+vector<int> FileCatalog::AreasWithMatches(const vector<string>& areas,
+                                          const std::function<bool(const uploadsrec&)>& pred,
+                                          int num_threads) {
+  vector<char> found(areas.size());
+  ForEachArea(static_cast<int>(areas.size()), num_threads, [&](int i) {
+    const auto files = area(areas[i]);
+    found[i] = std::any_of(files->begin(), files->end(), pred) ? 1 : 0;
+  });
+
+  vector<int> result;
+  for (size_t i = 0; i < found.size(); i++) {
+    if (found[i]) {
+      result.push_back(static_cast<int>(i));
+    }
+  }
+  return result;
+}
+
+}  // namespace files
+}  // namespace sdk
+}  // namespace wwiv
@@ -0,0 +1,136 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_SDK_FILES_FILE_CATALOG_H__
+#define __INCLUDED_SDK_FILES_FILE_CATALOG_H__
+
+#include <atomic>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sdk/vardec.h"
+
+namespace wwiv {
+namespace sdk {
+namespace files {
+
+/** The file records of one area, excluding the |MARKER| header record. */
+typedef std::vector<uploadsrec> catalog_area_t;
+
+/** A single file found by FileCatalog::Search. */
+struct catalog_match_t {
+  // Index into the areas passed to Search.
+  int area;
+  // Record number in the area's .dir file (the first file is record 1).
+  int record;
+  uploadsrec u;
+};
+
+/**
+ * Common search criteria.  Empty (or zero) fields match everything.
+ */
+struct catalog_query_t {
+  // Aligned file mask ("NAME????.EXT"), as produced by align() in the bbs.
+  std::string filemask;
+  // Only files uploaded on or after this date.
+  daten_t since{0};
+  // Case insensitive text found in the filename or description.
+  std::string text;
+
+  bool matches(const uploadsrec& u) const;
+};
+
+/**
+ * Returns true if the aligned filename matches the aligned mask, where '?'
+ * in either matches any character.
+ */
+bool aligned_wildcard_match(const char* mask, const char* filename);
+
+/**
+ * In-memory catalog of the file areas (the .dir files in the data directory).
+ *
+ * Each area is loaded with a single sequential read the first time it is
+ * used, and loaded again only when the size or modification time of its
+ * .dir file changes, so uploads, deletes and moves made by any node are
+ * picked up on the next query.  Invalidate() drops an area right away.
+ *
+ * The catalog is safe to use from multiple threads.
+ */
+class FileCatalog {
+public:
+  explicit FileCatalog(const std::string& datadir);
+  FileCatalog(const FileCatalog&) = delete;
+  FileCatalog& operator=(const FileCatalog&) = delete;
+  ~FileCatalog();
+
+  /**
+   * Returns the files in the area whose .dir file is named filename (without
+   * the .dir extension).  Never returns nullptr.
+   */
+  std::shared_ptr<const catalog_area_t> area(const std::string& filename);
+
+  /** Forgets any cached copy of filename. */
+  void Invalidate(const std::string& filename);
+  void InvalidateAll();
+
+  /**
+   * Returns every file in areas for which pred returns true, ordered by area
+   * and then record number.  Areas are searched in parallel using up to
+   * num_threads threads (0 uses one per core), so pred must be thread safe.
+   */
+  std::vector<catalog_match_t> Search(const std::vector<std::string>& areas,
+                                      const std::function<bool(const uploadsrec&)>& pred,
+                                      int num_threads = 0);
+  std::vector<catalog_match_t> Search(const std::vector<std::string>& areas,
+                                      const catalog_query_t& query, int num_threads = 0);
+
+  /** Returns the index of each area containing at least one match for pred. */
+  std::vector<int> AreasWithMatches(const std::vector<std::string>& areas,
+                                    const std::function<bool(const uploadsrec&)>& pred,
+                                    int num_threads = 0);
+
+  /** Number of times a .dir file has been read.  Useful in tests. */
+  int loads() const { return loads_; }
+
+private:
+  struct cached_area_t {
+    std::shared_ptr<const catalog_area_t> files;
+    off_t size{0};
+    time_t mtime{0};
+    // True if the file was modified within the second it was loaded.
+    bool racy{false};
+  };
+
+  void ForEachArea(int num_areas, int num_threads, const std::function<void(int)>& fn);
+
+  const std::string datadir_;
+  std::mutex mu_;
+  std::map<std::string, cached_area_t> areas_;
+  std::atomic<int> loads_{0};
+};
+
+}  // namespace files
+}  // namespace sdk
+}  // namespace wwiv
+
+#endif  // __INCLUDED_SDK_FILES_FILE_CATALOG_H__
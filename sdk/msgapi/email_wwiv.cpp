@@ -30,6 +30,7 @@
 #include "bbs/subacc.h"
 #include "sdk/config.h"
 #include "sdk/filenames.h"
+#include "sdk/status.h"
 #include "core/datetime.h"
 #include "sdk/user.h"
 #include "sdk/usermanager.h"
@@ -84,22 +85,11 @@ static bool modify_email_waiting(const Config& config, uint16_t email_usernum, i
 }
 
 static bool increment_email_counters(const Config& config, uint16_t email_usernum) {
-  statusrec_t statusrec{};
-  DataFile<statusrec_t> file(FilePath(config.datadir(), STATUS_DAT),
-                             File::modeBinary | File::modeReadWrite);
-  if (!file) {
-    return false;
-  }
-  if (!file.Read(0, &statusrec)) {
-    return false;
-  }
+  StatusMgr sm(config.datadir(), [](int) {});
   if (email_usernum == 1) {
-    ++statusrec.fbacktoday;
+    sm.Increment(StatusCounter::feedback_today);
   } else {
-    ++statusrec.emailtoday;
-  }
-  if (!file.Write(0, &statusrec)) {
-    return false;
+    sm.Increment(StatusCounter::email_today);
   }
 
   return modify_email_waiting(config, email_usernum, 1);
@@ -35,6 +35,7 @@
 #include "sdk/msgapi/message_api_wwiv.h"
 #include "sdk/net/packets.h"
 #include "sdk/ssm.h"
+#include "sdk/status.h"
 #include "sdk/usermanager.h"
 #include "sdk/vardec.h"
 
@@ -317,27 +318,15 @@ unique_ptr<MessageText> WWIVMessageArea::ReadMessageText(int message_number) {
 }
 
 static uint32_t next_qscan_value_and_increment_post(const string& bbsdir) {
-  statusrec_t statusrec{};
-  uint32_t next_qscan = 0;
   Config config(bbsdir);
   if (!config.IsInitialized()) {
     LOG(ERROR) << "Unable to load CONFIG.DAT.";
     return 1;
   }
-  DataFile<statusrec_t> file(FilePath(config.datadir(), STATUS_DAT),
-                             File::modeBinary | File::modeReadWrite);
-  if (!file) {
-    return 0;
-  }
-  if (!file.Read(0, &statusrec)) {
-    return 0;
-  }
-  next_qscan = statusrec.qscanptr++;
-  ++statusrec.msgposttoday;
-  if (!file.Write(0, &statusrec)) {
-    return 0;
-  }
-  return next_qscan;
+  // Shares the qscan pointer with the BBS nodes through STATUS.SHM.
+  StatusMgr sm(config.datadir(), [](int) {});
+  sm.Increment(StatusCounter::posts_today);
+  return sm.Increment(StatusCounter::qscan_pointer);
 }
 
 /**
@@ -55,6 +55,7 @@ Type2Text::Type2Text(const std::string& text_filename)
 // Implementation Details
 
 bool Type2Text::remove_link(messagerec& msg) {
+  close_read_file();
   unique_ptr<File> file(OpenMessageFile());
   if (!file->IsOpen()) {
     return false;
@@ -126,21 +127,49 @@ void Type2Text::save_gat(File& file, size_t section, const std::vector<gati_t>&
   // a()->status_manager()->CommitTransaction(status);
 }
 
-bool Type2Text::readfile(const messagerec* msg, string* out) {
-  out->clear();
-  unique_ptr<File> file(OpenMessageFile());
-  if (!file) {
-    // TODO(rushfan): set error code,
+bool Type2Text::keep_open_for_read() {
+  if (read_file_) {
+    return true;
+  }
+  auto file = std::make_unique<File>(filename_);
+  if (!file->Open(File::modeReadOnly | File::modeBinary)) {
     return false;
   }
-  const size_t gat_section = msg->stored_as / GAT_NUMBER_ELEMENTS;
-  vector<gati_t> gat = load_gat(*file, gat_section);
+  read_file_ = std::move(file);
+  return true;
+}
+
+void Type2Text::close_read_file() {
+  read_file_.reset();
+  gat_cache_.clear();
+}
+
+const std::vector<gati_t>& Type2Text::cached_gat(size_t section) {
+  auto it = gat_cache_.find(section);
+  if (it != gat_cache_.end()) {
+    return it->second;
+  }
+  // The file is read only here, so a missing section is left empty rather
+  // than being created the way load_gat does.
+  vector<gati_t> gat(GAT_NUMBER_ELEMENTS);
+  const auto section_pos = section * GATSECLEN;
+  if (read_file_->length() >= static_cast<long>(section_pos + GAT_SECTION_SIZE)) {
+    read_file_->Seek(section_pos, File::Whence::begin);
+    read_file_->Read(&gat[0], GAT_SECTION_SIZE);
+  }
+  return gat_cache_.emplace(section, std::move(gat)).first->second;
+}
 
+// Reads the chain of blocks for msg from file into out.
+static void read_blocks(File& file, const vector<gati_t>& gat, const messagerec* msg, string* out) {
+  const size_t gat_section = msg->stored_as / GAT_NUMBER_ELEMENTS;
   uint32_t current_section = msg->stored_as % GAT_NUMBER_ELEMENTS;
   while (current_section > 0 && current_section < GAT_NUMBER_ELEMENTS) {
-    file->Seek(MSG_STARTING(gat_section) + MSG_BLOCK_SIZE * static_cast<uint32_t>(current_section), File::Whence::begin);
+    file.Seek(MSG_STARTING(gat_section) + MSG_BLOCK_SIZE * static_cast<uint32_t>(current_section), File::Whence::begin);
     char b[MSG_BLOCK_SIZE + 1];
-    file->Read(b, MSG_BLOCK_SIZE);
+    if (file.Read(b, MSG_BLOCK_SIZE) != MSG_BLOCK_SIZE) {
+      break;
+    }
     b[MSG_BLOCK_SIZE] = 0;
     out->append(b);
     current_section = gat[current_section];
@@ -152,10 +181,26 @@ bool Type2Text::readfile(const messagerec* msg, string* out) {
     // last block has a Control-Z in it.  Make sure we add a 0 after it.
     out->resize(last_cz);
   }
+}
+
+bool Type2Text::readfile(const messagerec* msg, string* out) {
+  out->clear();
+  const size_t gat_section = msg->stored_as / GAT_NUMBER_ELEMENTS;
+  if (read_file_) {
+    read_blocks(*read_file_, cached_gat(gat_section), msg, out);
+    return true;
+  }
+  unique_ptr<File> file(OpenMessageFile());
+  if (!file) {
+    // TODO(rushfan): set error code,
+    return false;
+  }
+  read_blocks(*file, load_gat(*file, gat_section), msg, out);
   return true;
 }
 
 bool Type2Text::savefile(const string& text, messagerec* msg) {
+  close_read_file();
   vector<gati_t> gati;
   unique_ptr<File> msgfile(OpenMessageFile());
   if (!msgfile->IsOpen()) {
@@ -19,6 +19,8 @@
 #define __INCLUDED_SDK_TYPE2_TEXT_H__
 
 #include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -47,9 +49,20 @@ public:
   bool savefile(const std::string& text, messagerec* message_record);
   bool remove_link(messagerec& msg);
 
+  /**
+   * Keeps the message file open (read only) and the GAT sections cached
+   * across calls to readfile, for callers reading many messages in a row.
+   * The cache is dropped and the file closed by savefile and remove_link.
+   */
+  bool keep_open_for_read();
+
 private:
   std::unique_ptr<wwiv::core::File> OpenMessageFile();
+  const std::vector<gati_t>& cached_gat(size_t section);
+  void close_read_file();
   const std::string filename_;
+  std::unique_ptr<wwiv::core::File> read_file_;
+  std::map<size_t, std::vector<gati_t>> gat_cache_;
 };
 
 }  // namespace msgapi
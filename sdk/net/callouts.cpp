@@ -72,6 +72,24 @@ bool allowed_to_call(const net_call_out_rec& con, const DateTime& dt) {
   }
 }
 
+time_t next_allowed_to_call(const net_call_out_rec& con, const DateTime& dt) {
+  if (allowed_to_call(con, dt)) {
+    return dt.to_time_t();
+  }
+  if (con.options & options_no_call) {
+    return 0;
+  }
+  // The allowed hours start on the hour, so try each of the next 24.
+  auto t = dt.to_time_t() - dt.minute() * 60 - dt.second();
+  for (int i = 0; i < 24; i++) {
+    t += 60 * 60;
+    if (allowed_to_call(con, DateTime::from_time_t(t))) {
+      return t;
+    }
+  }
+  return 0;
+}
+
 /**
  * Checks the net_contact_rec and net_call_out_rec to ensure the node specified
  * is ok to call and does not violate any constraints.
@@ -586,6 +586,75 @@ bool write_wwivnet_packet_or_log(const net_networks_rec& net, const net_header_r
   }
 }
 
+static SubscriberCache& subscriber_cache() {
+  static SubscriberCache cache;
+  return cache;
+}
+
+PacketFanout::~PacketFanout() {
+  if (pending_ > 0) {
+    Flush();
+  }
+}
+
+bool PacketFanout::Add(const net_networks_rec& net, const net_header_rec& h,
+                       const std::vector<uint16_t>& list, const std::string& text) {
+  if (h.length != text.size()) {
+    LOG(ERROR) << "Error adding packet for: " << net.dir;
+    LOG(ERROR) << "Mismatched text and h.length.  text =" << text.size()
+               << " h.length = " << h.length;
+    return false;
+  }
+  if (h.list_len != list.size()) {
+    LOG(ERROR) << "Error adding packet for: " << net.dir;
+    LOG(ERROR) << "h.list_len [" << h.list_len << "] != list.size() [" << list.size() << "]";
+    return false;
+  }
+  auto& o = outbound_[net.dir];
+  if (o.count == 0) {
+    o.net = net;
+  }
+  o.data.append(reinterpret_cast<const char*>(&h), sizeof(net_header_rec));
+  if (!list.empty()) {
+    o.data.append(reinterpret_cast<const char*>(&list[0]), sizeof(uint16_t) * list.size());
+  }
+  o.data.append(text);
+  ++o.count;
+  ++pending_;
+  return true;
+}
+
+bool PacketFanout::Flush() {
+  bool result = true;
+  for (auto& e : outbound_) {
+    auto& o = e.second;
+    if (o.count == 0) {
+      continue;
+    }
+    const auto fn = create_pend(o.net.dir, false, network_app_id_);
+    File file(FilePath(o.net.dir, fn));
+    if (fn.empty() || !file.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
+      LOG(ERROR) << "Error writing packets: " << o.net.dir << " " << fn;
+      result = false;
+    } else {
+      file.Seek(0L, File::Whence::end);
+      const auto num = file.Write(o.data.data(), o.data.size());
+      if (num != static_cast<ssize_t>(o.data.size())) {
+        LOG(ERROR) << "Error writing packets: " << o.net.dir << " " << fn << " num written ("
+                   << num << ") != " << o.data.size();
+        result = false;
+      } else {
+        VLOG(1) << "Wrote " << o.count << " packets to: " << fn;
+      }
+    }
+    // Keep the buffer's capacity around for the next batch.
+    o.data.clear();
+    o.count = 0;
+  }
+  pending_ = 0;
+  return result;
+}
+
 /**
  * Sends the post out via wwivnet or other networks to the other parties if needed.
  *
@@ -595,8 +664,21 @@ bool send_post_to_subscribers(const std::vector<net_networks_rec>& nets, int ori
                               const std::string& original_subtype, const subboard_t& sub,
                               Packet& template_packet, std::set<uint16_t> subscribers_to_skip,
                               const subscribers_send_to_t& send_to) {
+  PacketFanout fanout;
+  auto result = send_post_to_subscribers(nets, original_net_num, original_subtype, sub,
+                                         template_packet, subscribers_to_skip, send_to, fanout);
+  return fanout.Flush() && result;
+}
+
+bool send_post_to_subscribers(const std::vector<net_networks_rec>& nets, int original_net_num,
+                              const std::string& original_subtype, const subboard_t& sub,
+                              Packet& template_packet, const std::set<uint16_t>& subscribers_to_skip,
+                              const subscribers_send_to_t& send_to, PacketFanout& fanout) {
   VLOG(1) << "DEBUG: send_post_to_subscribers; original subtype: " << original_subtype;
 
+  std::string changed_text;
+  std::vector<uint16_t> list;
+  bool result = true;
   for (const auto& subnet : sub.nets) {
     auto h = template_packet.nh;
     VLOG(1) << "DEBUG: Current network subtype: " << subnet.stype;
@@ -622,11 +704,11 @@ bool send_post_to_subscribers(const std::vector<net_networks_rec>& nets, int ori
       h.fromuser = 0;
     }
     // If the subtype has changed, then change the subtype in the
-    // packet text.
-    const auto text = (subnet.stype == original_subtype)
-                          ? template_packet.text()
-                          : change_subtype_to(template_packet.text(), subnet.stype);
+    // packet text.  The text is shared by every subscriber of this subnet.
+    const std::string* text = &template_packet.text();
     if (subnet.stype != original_subtype) {
+      changed_text = change_subtype_to(template_packet.text(), subnet.stype);
+      text = &changed_text;
       // we also have to update the nh.length to reflect this change.
       // TODO(rushfan): Really need higher level interface to manipulating
       // WWIVnet packets...
@@ -637,35 +719,34 @@ bool send_post_to_subscribers(const std::vector<net_networks_rec>& nets, int ori
       h.tosys = FTN_FAKE_OUTBOUND_NODE;
       VLOG(1) << "current network is FTN";
       h.list_len = 0;
-      write_wwivnet_packet_or_log(current_net, h, {}, text);
+      result &= fanout.Add(current_net, h, {}, *text);
     } else if (current_net.type == network_type_t::wwivnet) {
       if (subnet.host == 0) {
         // We are the host.
-        std::set<uint16_t> subscribers;
-        bool subscribers_read =
-            ReadSubcriberFile(current_net.dir, StrCat("n", subnet.stype, ".net"), subscribers);
-        if (subscribers_read) {
-          // Remove the original sender from the set of systems
-          // that we will resend this to.
-          subscribers.erase(template_packet.nh.fromsys);
-          for (const auto& skip : subscribers_to_skip) {
-            // Skip the subscribers to skip too.
-            subscribers.erase(skip);
+        auto subscribers =
+            subscriber_cache().Get(current_net.dir, StrCat("n", subnet.stype, ".net"));
+        if (subscribers) {
+          // Remove the original sender and the subscribers to skip from the
+          // set of systems that we will resend this to.
+          list.clear();
+          for (const auto s : *subscribers) {
+            if (s != template_packet.nh.fromsys && subscribers_to_skip.count(s) == 0) {
+              list.push_back(s);
+            }
           }
           VLOG(1) << "Removing subscriber (sender): " << template_packet.nh.fromsys;
-          VLOG(1) << "Read subscribers #: " << subscribers.size();
+          VLOG(1) << "Read subscribers #: " << subscribers->size();
           VLOG(1) << "Creating wwivnet packet to: ";
-          for (const auto x : subscribers) {
+          for (const auto x : list) {
             VLOG(1) << "        @" << x;
           }
 
-          if (subscribers.empty()) {
+          if (list.empty()) {
             VLOG(1) << "No subscribers left, skipping sending this packet";
           }
-          h.list_len = static_cast<uint16_t>(subscribers.size());
+          h.list_len = static_cast<uint16_t>(list.size());
           h.tosys = 0;
-          write_wwivnet_packet_or_log(
-              current_net, h, std::vector<uint16_t>(subscribers.begin(), subscribers.end()), text);
+          result &= fanout.Add(current_net, h, list, *text);
         } else {
           LOG(ERROR) << "Unable to read subscribers for " << current_net.dir << " " << subnet.stype;
         }
@@ -673,13 +754,13 @@ bool send_post_to_subscribers(const std::vector<net_networks_rec>& nets, int ori
         // We are not the host.  Send message to host.
         h.tosys = subnet.host;
         h.list_len = 0;
-        write_wwivnet_packet_or_log(current_net, h, {}, text);
+        result &= fanout.Add(current_net, h, {}, *text);
       }
     }
   }
   LOG(INFO) << "DEBUG: send_post_to_subscribers"
-            << "exiting with true";
-  return true;
+            << "exiting with " << std::boolalpha << result;
+  return result;
 }
 
 } // namespace net
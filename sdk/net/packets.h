@@ -19,6 +19,7 @@
 #define __INCLUDED_SDK_NET_PACKETS_H__
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -200,12 +201,53 @@ Packet create_packet_from_wwiv_message(const wwiv::sdk::msgapi::WWIVMessage& m,
 bool write_wwivnet_packet_or_log(const net_networks_rec& net, const net_header_rec& h,
                                  std::vector<uint16_t> list, const std::string& text);
 
+/**
+ * Collects outbound packets and writes all of the packets for each network
+ * to a single pending file when flushed, instead of creating and opening a
+ * new pending file for every packet.  Packets are written in the order they
+ * were added.  Any packets not yet written are flushed on destruction.
+ */
+class PacketFanout final {
+public:
+  explicit PacketFanout(char network_app_id = '2') : network_app_id_(network_app_id) {}
+  ~PacketFanout();
+
+  /** Adds a packet for net. Returns false if h does not match list and text. */
+  bool Add(const net_networks_rec& net, const net_header_rec& h,
+           const std::vector<uint16_t>& list, const std::string& text);
+  /** Writes all pending packets. Returns false if any could not be written. */
+  bool Flush();
+
+  /** Number of packets added but not yet written. */
+  int pending() const noexcept { return pending_; }
+
+private:
+  struct outbound_t {
+    net_networks_rec net{};
+    std::string data;
+    int count{0};
+  };
+  const char network_app_id_;
+  // Keyed by network directory.
+  std::map<std::string, outbound_t> outbound_;
+  int pending_{0};
+};
+
 enum class subscribers_send_to_t { hosted_and_gated_only, all_subscribers };
 bool send_post_to_subscribers(const std::vector<net_networks_rec>& nets, int original_net_num,
                               const std::string& original_subtype, const subboard_t& sub,
                               Packet& template_packet, std::set<uint16_t> subscribers_to_skip,
                               const subscribers_send_to_t& send_to);
 
+/**
+ * Same as above, but adds the packets to fanout instead of writing them, so
+ * that many posts may be sent with one pending file per network.
+ */
+bool send_post_to_subscribers(const std::vector<net_networks_rec>& nets, int original_net_num,
+                              const std::string& original_subtype, const subboard_t& sub,
+                              Packet& template_packet, const std::set<uint16_t>& subscribers_to_skip,
+                              const subscribers_send_to_t& send_to, PacketFanout& fanout);
+
 } // namespace net
 } // namespace sdk
 } // namespace wwiv
@@ -17,13 +17,17 @@
 /**************************************************************************/
 #include "sdk/qscan.h"
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include "core/log.h"
+#include "core/strings.h"
 
 namespace wwiv {
 namespace sdk {
 
 using namespace wwiv::core;
+using namespace wwiv::strings;
 
 /** Calculates the qscan_len field based on max_subs and max_dirs */
 size_t calculate_qscan_length(size_t max_subs, size_t max_dirs) {
@@ -69,22 +73,23 @@ size_t qscan_bitset::max_size() const { return max_size_; }
 // ReSharper restore CppMemberFunctionMayBeConst
 
 
-RawUserQScan::RawUserQScan(uint32_t* q, int qscan_length, int max_subs, int max_dirs)
-  : qscan_(std::make_unique<uint32_t[]>(qscan_length)),
-    newscan_dir_(qscan_.get() + 1),
+RawUserQScan::RawUserQScan(uint32_t* q, int qscan_length, int max_subs, int max_dirs, bool copy)
+  : owned_(copy || q == nullptr ? std::make_unique<uint32_t[]>(qscan_length) : nullptr),
+    qscan_(owned_ ? owned_.get() : q),
+    newscan_dir_(qscan_ + 1),
     newscan_sub_(newscan_dir_ + (max_dirs + 31) / 32),
     lastread_pointer_(newscan_sub_ + (max_subs + 31) / 32),
     dirs_(newscan_dir_, max_dirs),
     subs_(newscan_sub_, max_subs) {
-  if (q != nullptr) {
-    memcpy(qscan_.get(), q, qscan_length);
-  } else {
+  if (q == nullptr) {
     VLOG(1) << "Creating empty QScan Record";
     // Create new empty qscan record.
-    memset(qscan_.get(), 0, qscan_length);
-    *qscan_.get() = 999;
-    memset(qscan_.get() + 1, 0xff, ((max_dirs + 31) / 32) * 4);
-    memset(qscan_.get() + 1 + (max_subs + 31) / 32, 0xff, ((max_subs + 31) / 32) * 4);
+    memset(qscan_, 0, qscan_length);
+    *qscan_ = 999;
+    memset(qscan_ + 1, 0xff, ((max_dirs + 31) / 32) * 4);
+    memset(qscan_ + 1 + (max_dirs + 31) / 32, 0xff, ((max_subs + 31) / 32) * 4);
+  } else if (owned_) {
+    memcpy(qscan_, q, qscan_length);
   }
 }
 
@@ -116,5 +121,231 @@ bool UserQScan::clear() {
   return false;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// AllUserQScan
+
+// Granularity used when tracking which parts of USER.QSC were modified.
+static constexpr size_t kQScanPageSize = 4096;
+
+AllUserQScan::AllUserQScan(const std::string& filename, int qscan_length, int max_subs,
+                           int max_dirs)
+    : filename_(filename), qscan_length_(qscan_length), max_subs_(max_subs),
+      max_dirs_(max_dirs) {
+  File f(filename_);
+  if (!f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile)) {
+    LOG(ERROR) << "Unable to open: " << filename_;
+    return;
+  }
+  f.Close();
+  Remap();
+}
+
+AllUserQScan::~AllUserQScan() { flush(); }
+
+bool AllUserQScan::Remap() {
+  if (map_) {
+    // Views from user() may still point into the old mapping.
+    retired_.push_back(std::move(map_));
+  }
+  map_ = std::make_unique<MappedFile>(filename_, MappedFile::Mode::read_write);
+  return IsOpen();
+}
+
+int AllUserQScan::num_records() {
+  if (!IsOpen()) {
+    return 0;
+  }
+  const auto len = static_cast<size_t>(File(filename_).length());
+  if (len != map_->size()) {
+    // Another node has added users.
+    Remap();
+  }
+  return static_cast<int>(map_->size() / qscan_length_);
+}
+
+bool AllUserQScan::exists(int user_number) { return record(user_number, false) != nullptr; }
+
+uint32_t* AllUserQScan::record(int user_number, bool grow) {
+  if (!IsOpen() || user_number < 0) {
+    return nullptr;
+  }
+  const auto offset = static_cast<size_t>(user_number) * qscan_length_;
+  const auto end = offset + qscan_length_;
+  if (end > map_->size()) {
+    if (static_cast<size_t>(File(filename_).length()) < end) {
+      if (!grow) {
+        return nullptr;
+      }
+      File f(filename_);
+      if (!f.Open(File::modeBinary | File::modeReadWrite)) {
+        return nullptr;
+      }
+      f.set_length(static_cast<off_t>(end));
+      f.Close();
+    }
+    if (!Remap() || end > map_->size()) {
+      return nullptr;
+    }
+  }
+  return reinterpret_cast<uint32_t*>(map_->mutable_data() + offset);
+}
+
+void AllUserQScan::mark_dirty(size_t offset, size_t len) {
+  for (auto page = offset / kQScanPageSize; page * kQScanPageSize < offset + len; page++) {
+    dirty_pages_.insert(page);
+  }
+}
+
+void AllUserQScan::dirty(int user_number) {
+  mark_dirty(static_cast<size_t>(user_number) * qscan_length_, qscan_length_);
+}
+
+bool AllUserQScan::read(int user_number, uint32_t* q) {
+  const auto* r = record(user_number, false);
+  if (r == nullptr) {
+    return false;
+  }
+  memcpy(q, r, qscan_length_);
+  return true;
+}
+
+bool AllUserQScan::write(int user_number, const uint32_t* q) {
+  auto* r = reinterpret_cast<uint8_t*>(record(user_number, true));
+  if (r == nullptr) {
+    return false;
+  }
+  // Only copy (and so only dirty) the pages that changed.
+  const auto base = static_cast<size_t>(user_number) * qscan_length_;
+  const auto* src = reinterpret_cast<const uint8_t*>(q);
+  size_t pos = 0;
+  while (pos < static_cast<size_t>(qscan_length_)) {
+    const auto page_end = ((base + pos) / kQScanPageSize + 1) * kQScanPageSize - base;
+    const auto len = std::min(page_end, static_cast<size_t>(qscan_length_)) - pos;
+    if (memcmp(r + pos, src + pos, len) != 0) {
+      memcpy(r + pos, src + pos, len);
+      mark_dirty(base + pos, len);
+    }
+    pos += len;
+  }
+  return true;
+}
+
+std::unique_ptr<RawUserQScan> AllUserQScan::user(int user_number) {
+  auto* r = record(user_number, true);
+  if (r == nullptr) {
+    return {};
+  }
+  return std::make_unique<RawUserQScan>(r, qscan_length_, max_subs_, max_dirs_, false);
+}
+
+bool AllUserQScan::flush() {
+  if (!IsOpen()) {
+    return false;
+  }
+  bool result = true;
+  // Write back each run of contiguous dirty pages.
+  auto it = dirty_pages_.begin();
+  while (it != dirty_pages_.end()) {
+    const auto first = *it;
+    auto last = first;
+    while (++it != dirty_pages_.end() && *it == last + 1) {
+      last = *it;
+    }
+    result &= map_->Flush(first * kQScanPageSize, (last - first + 1) * kQScanPageSize);
+  }
+  dirty_pages_.clear();
+  // Views into earlier mappings are no longer valid.
+  retired_.clear();
+  return result;
+}
+
+bool rewrite_qscan_file(
+    const std::string& filename, int old_max_subs, int old_max_dirs, int new_max_subs,
+    int new_max_dirs,
+    const std::function<void(int user_number, RawUserQScan& o, RawUserQScan& n)>& fn) {
+  const auto old_len = static_cast<int>(calculate_qscan_length(old_max_subs, old_max_dirs));
+  const auto new_len = static_cast<int>(calculate_qscan_length(new_max_subs, new_max_dirs));
+
+  MappedFile oqf(filename);
+  if (!oqf) {
+    LOG(ERROR) << "Unable to open: " << filename;
+    return false;
+  }
+  const auto tempname = StrCat(filename, ".new");
+  File nqf(tempname);
+  if (!nqf.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                File::modeTruncate)) {
+    LOG(ERROR) << "Unable to create: " << tempname;
+    return false;
+  }
+
+  const auto dir_words = std::min((old_max_dirs + 31) / 32, (new_max_dirs + 31) / 32);
+  const auto sub_words = std::min((old_max_subs + 31) / 32, (new_max_subs + 31) / 32);
+  const auto subs = std::min(old_max_subs, new_max_subs);
+
+  // Write the new file in large chunks rather than one record at a time.
+  static constexpr size_t kBufferSize = 1 << 20;
+  std::vector<uint8_t> buffer;
+  buffer.reserve(kBufferSize + new_len);
+  const auto nu = static_cast<int>(oqf.size() / static_cast<size_t>(old_len));
+  for (int i = 0; i < nu; i++) {
+    // The old file is only ever read.
+    const auto offset = static_cast<size_t>(i) * static_cast<size_t>(old_len);
+    auto* src = const_cast<uint32_t*>(reinterpret_cast<const uint32_t*>(oqf.data() + offset));
+    RawUserQScan o(src, old_len, old_max_subs, old_max_dirs, false);
+    RawUserQScan n(new_len, new_max_subs, new_max_dirs);
+    auto* oq = o.qsc();
+    auto* nq = n.qsc();
+    *nq = *oq;
+    memcpy(nq + 1, oq + 1, dir_words * sizeof(uint32_t));
+    memcpy(nq + 1 + (new_max_dirs + 31) / 32, oq + 1 + (old_max_dirs + 31) / 32,
+           sub_words * sizeof(uint32_t));
+    for (int s = 0; s < subs; s++) {
+      n.lastread_pointer(s, o.lastread_pointer(s));
+    }
+    if (fn) {
+      fn(i, o, n);
+    }
+    const auto* p = reinterpret_cast<const uint8_t*>(nq);
+    buffer.insert(buffer.end(), p, p + new_len);
+    if (buffer.size() >= kBufferSize) {
+      if (nqf.Write(&buffer[0], buffer.size()) != static_cast<ssize_t>(buffer.size())) {
+        return false;
+      }
+      buffer.clear();
+    }
+  }
+  if (!buffer.empty() &&
+      nqf.Write(&buffer[0], buffer.size()) != static_cast<ssize_t>(buffer.size())) {
+    return false;
+  }
+  nqf.Close();
+  oqf.Close();
+#ifdef _WIN32
+  // rename won't replace an existing file here, so move the old one aside
+  // and keep it until the new one is in place.
+  const auto backup = StrCat(filename, ".bak");
+  File::Remove(backup);
+  if (!File::Rename(filename, backup)) {
+    LOG(ERROR) << "Unable to rename: " << filename << " to: " << backup;
+    return false;
+  }
+  if (!File::Rename(tempname, filename)) {
+    LOG(ERROR) << "Unable to rename: " << tempname << " to: " << filename;
+    File::Rename(backup, filename);
+    return false;
+  }
+  File::Remove(backup);
+  return true;
+#else
+  // rename atomically replaces filename, so it's never missing.
+  if (!File::Rename(tempname, filename)) {
+    LOG(ERROR) << "Unable to rename: " << tempname << " to: " << filename;
+    return false;
+  }
+  return true;
+#endif  // _WIN32
+}
+
 }
 }
@@ -18,9 +18,13 @@
 #ifndef __INCLUDED_SDK_QSCAN_H__
 #define __INCLUDED_SDK_QSCAN_H__
 
+#include <functional>
 #include <memory>
+#include <set>
 #include <stdexcept>
+#include <vector>
 #include "core/file.h"
+#include "core/mapped_file.h"
 
 namespace wwiv {
 namespace sdk {
@@ -55,9 +59,13 @@ private:
 // ReSharper restore CppMemberFunctionMayBeConst
 
 
+/**
+ * A single user's qscan record.  When copy is false, this is a view onto q
+ * (which must outlive it) rather than a copy of it.
+ */
 class RawUserQScan {
 public:
-  RawUserQScan(uint32_t* q, int qscan_length, int max_subs, int max_dirs);
+  RawUserQScan(uint32_t* q, int qscan_length, int max_subs, int max_dirs, bool copy = true);
   RawUserQScan(int qscan_length, int max_subs, int max_dirs);
   RawUserQScan() = delete;
   ~RawUserQScan() = default;
@@ -67,10 +75,11 @@ public:
 
   uint32_t lastread_pointer(int n) const { return lastread_pointer_[n]; }
   void lastread_pointer(int n, uint32_t val) { lastread_pointer_[n] = val; }
-  uint32_t* qsc() const { return qscan_.get(); }
+  uint32_t* qsc() const { return qscan_; }
 
 private:
-  std::unique_ptr<uint32_t[]> qscan_;
+  std::unique_ptr<uint32_t[]> owned_;
+  uint32_t* qscan_{};
   uint32_t* newscan_dir_{};
   uint32_t* newscan_sub_{};
   uint32_t* lastread_pointer_{};
@@ -96,16 +105,75 @@ private:
 
 };
 
+/**
+ * The qscan records for all users, with USER.QSC mapped into memory.
+ *
+ * Only the pages for users that are actually touched are faulted in.  write()
+ * only copies the pages of a record that changed, and flush() only writes
+ * those pages back to disk.  Records for new users grow the file as needed,
+ * earlier mappings are kept until the next flush() so that views returned by
+ * user() remain valid until then.
+ */
 class AllUserQScan {
 public:
-  AllUserQScan(const std::string& filename, int max_users) {}
-  void swap_dir(int num);
-  void swap_sub(int num);
-  bool insert(int pos);
-  bool remove(int pos);
+  AllUserQScan(const std::string& filename, int qscan_length, int max_subs, int max_dirs);
+  AllUserQScan() = delete;
+  AllUserQScan(const AllUserQScan&) = delete;
+  AllUserQScan& operator=(const AllUserQScan&) = delete;
+  ~AllUserQScan();
+
+  bool IsOpen() const noexcept { return map_ && *map_; }
+  explicit operator bool() const noexcept { return IsOpen(); }
+
+  /** Number of records in the file, including user 0. */
+  int num_records();
+  /** Returns true if a record for user_number exists. */
+  bool exists(int user_number);
+
+  /** Copies the record for user_number into q.  Returns false if none exists. */
+  bool read(int user_number, uint32_t* q);
+  /** Copies q into the record for user_number, growing the file if needed. */
+  bool write(int user_number, const uint32_t* q);
+
+  /**
+   * Returns a view of the record for user_number in the mapping, growing the
+   * file if needed.  Call dirty() after modifying it.  The view is valid
+   * until the next call to flush().
+   */
+  std::unique_ptr<RawUserQScan> user(int user_number);
+  /** Marks the record for user_number as modified. */
+  void dirty(int user_number);
+
+  /** Writes modified pages back to USER.QSC, and releases earlier mappings. */
+  bool flush();
 
+private:
+  uint32_t* record(int user_number, bool grow);
+  void mark_dirty(size_t offset, size_t len);
+  bool Remap();
+
+  const std::string filename_;
+  const int qscan_length_;
+  const int max_subs_;
+  const int max_dirs_;
+  std::unique_ptr<wwiv::core::MappedFile> map_;
+  std::vector<std::unique_ptr<wwiv::core::MappedFile>> retired_;
+  std::set<size_t> dirty_pages_;
 };
 
+/**
+ * Rewrites every record in the qscan file named filename from the layout for
+ * old_max_subs/old_max_dirs to the one for new_max_subs/new_max_dirs.
+ *
+ * If fn is provided, it is called with the old and new records for each user
+ * after the common subs and dirs have been copied.  The file is written to a
+ * temporary file and renamed over filename when complete.
+ */
+bool rewrite_qscan_file(
+    const std::string& filename, int old_max_subs, int old_max_dirs, int new_max_subs,
+    int new_max_dirs,
+    const std::function<void(int user_number, RawUserQScan& o, RawUserQScan& n)>& fn = nullptr);
+
 } // namespace sdk
 } // namespace wwiv
 
@@ -0,0 +1,228 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "sdk/qwk/qwk_packet.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "core/datetime.h"
+#include "core/strings.h"
+#include "sdk/ansi/makeansi.h"
+
+using std::string;
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace sdk {
+namespace qwk {
+
+// Required header at the start of MESSAGES.DAT
+static constexpr char qwk_messages_dat_header[] =
+    "Produced by Qmail...Copyright (c) 1987 by Sparkware.  All Rights Reserved "
+    "(For Compatibility with Qmail)";
+
+// All of the text fields before conf_num.
+static constexpr std::size_t qwk_record_text_size = offsetof(qwk_record, conf_num);
+
+float ieee_to_msbin(float f) {
+  auto ieee = reinterpret_cast<const unsigned char*>(&f);
+  float result = 0;
+  auto msbin = reinterpret_cast<unsigned char*>(&result);
+
+  uint8_t msbin_exp = static_cast<uint8_t>(ieee[3] << 1);
+  msbin_exp |= ieee[2] >> 7;
+  // An ieee exponent of 0xfe overflows in MBF
+  if (msbin_exp == 0xfe) {
+    return 0;
+  }
+  // actually, -127 + 128 + 1
+  msbin_exp += 2;
+  msbin[3] = msbin_exp;
+  msbin[2] = (ieee[3] & 0x80) | (ieee[2] & 0x7f);
+  msbin[1] = ieee[1];
+  msbin[0] = ieee[0];
+  return result;
+}
+
+// Left justifies value into a space padded field of size len.
+static void set_field(char* field, std::size_t len, const string& value) {
+  memset(field, ' ', len);
+  memcpy(field, value.data(), std::min(len, value.size()));
+}
+
+// Reads the line starting at pos, leaving pos after its \r.
+static string next_line(const string& raw, string::size_type& pos, string::size_type max_len) {
+  const auto start = pos;
+  while (pos < raw.size() && raw[pos] != '\r' && pos - start < max_len) {
+    ++pos;
+  }
+  string line = raw.substr(start, pos - start);
+  ++pos;
+  return line;
+}
+
+// Converts WWIV text to QWK text: \r becomes 0xE3, \n and other control
+// codes are removed and heart codes and routing lines are handled as per
+// options.
+static string to_qwk_text(const string& body, const qwk_text_options_t& options) {
+  string out;
+  out.reserve(body.size());
+  string::size_type pos = 0;
+  while (pos < body.size()) {
+    const auto x = static_cast<unsigned char>(body[pos]);
+    const auto next = pos + 1 < body.size() ? body[pos + 1] : '\0';
+    if (x == 0) {
+      break;
+    } else if (x == 13) {
+      out.push_back('\xE3');
+      ++pos;
+    } else if (x == 10 || x < 3) {
+      // Strip out Newlines, NULLS, 1's and 2's
+      ++pos;
+    } else if (options.remove_color && x == 3) {
+      pos += 2;
+    } else if (options.convert_color && x == 3) {
+      out.append(wwiv::sdk::ansi::makeansi(next, 255));
+      pos += 2;
+    } else if (!options.keep_routing && x == 4 && next == '0') {
+      while (pos < body.size() && body[pos] != '\xE3' && body[pos] != '\r' && body[pos] != 0) {
+        ++pos;
+      }
+      ++pos;
+      if (pos < body.size() && body[pos] == '\n') {
+        ++pos;
+      }
+    } else if (x == 4 && next != '0') {
+      pos += 2;
+    } else {
+      out.push_back(static_cast<char>(x));
+      ++pos;
+    }
+  }
+  return out;
+}
+
+// Inserts line after the ^D0 routing lines at the start of text.
+static void insert_after_routing(string& text, const string& line) {
+  string::size_type pos = 0;
+  while (pos + 1 < text.size() && text[pos] == 4 && text[pos + 1] == '0') {
+    pos = text.find('\xE3', pos);
+    if (pos == string::npos) {
+      return;
+    }
+    ++pos;
+  }
+  if (pos < text.size()) {
+    text.insert(pos, StrCat(line, "\xE3\xE3"));
+  }
+}
+
+bool ToQwkMessage(const string& raw_text, const qwk_message_info_t& info,
+                  const qwk_text_options_t& options, qwk_record& rec, string& text) {
+  string::size_type pos = 0;
+  const auto from = next_line(raw_text, pos, 200);
+  if (pos < raw_text.size() && raw_text[pos] == '\n') {
+    ++pos;
+  }
+  next_line(raw_text, pos, 60);
+  if (pos >= raw_text.size()) {
+    return false;
+  }
+
+  string address = StrCat(QWK_FROM, from);
+  if (address.find('@') == string::npos) {
+    address += StrCat("@", info.ownersys);
+  }
+  text = to_qwk_text(raw_text.substr(pos), options);
+  // Only add the address if it does not yet exist.  Don't search for the
+  // ^D0, just the text after it.
+  if (text.find(QWK_FROM + 2) == string::npos) {
+    insert_after_routing(text, stripcolors(address));
+  }
+
+  memset(&rec, ' ', sizeof(qwk_record));
+  const auto dt = DateTime::from_daten(info.daten);
+  set_field(rec.msgnum, sizeof(rec.msgnum), std::to_string(info.msgnum));
+  set_field(rec.date, sizeof(rec.date), dt.to_string("%m-%d-%y"));
+  set_field(rec.time, sizeof(rec.time), dt.to_string("%H:%M"));
+  set_field(rec.to, sizeof(rec.to), ToStringUpperCase(info.to));
+  set_field(rec.from, sizeof(rec.from), ToStringUpperCase(stripcolors(from)));
+  set_field(rec.subject, sizeof(rec.subject), stripcolors(info.subject));
+  rec.conf_num = info.conf_num;
+  rec.logical_num = 0;
+  return true;
+}
+
+QwkMessagesWriter::QwkMessagesWriter(sink_fn sink, std::size_t buffer_size)
+    : sink_(sink), buffer_size_(std::max<std::size_t>(buffer_size, QWK_BLOCK_SIZE)) {
+  buffer_.reserve(buffer_size_ + QWK_BLOCK_SIZE);
+  string header(qwk_messages_dat_header);
+  header.resize(QWK_BLOCK_SIZE, ' ');
+  buffer_.append(header);
+}
+
+QwkMessagesWriter::~QwkMessagesWriter() { Flush(); }
+
+bool QwkMessagesWriter::Append(qwk_record rec, const string& text,
+                               const std::vector<string>& ndx_names) {
+  const auto num_text_blocks = std::max<std::size_t>(1, (text.size() + QWK_BLOCK_SIZE - 1) / QWK_BLOCK_SIZE);
+  const auto amount_blocks = num_text_blocks + 1;
+
+  set_field(rec.amount_blocks, sizeof(rec.amount_blocks), std::to_string(amount_blocks));
+  rec.logical_num = logical_num_;
+  auto raw = reinterpret_cast<char*>(&rec);
+  std::replace(raw, raw + qwk_record_text_size, '\0', ' ');
+
+  qwk_index ndx{};
+  ndx.pos = ieee_to_msbin(static_cast<float>(block_pos_));
+  ndx.nouse = 0;
+  for (const auto& name : ndx_names) {
+    indexes_[name].append(reinterpret_cast<const char*>(&ndx), sizeof(qwk_index));
+  }
+
+  buffer_.append(raw, sizeof(qwk_record));
+  buffer_.append(text);
+  buffer_.append(num_text_blocks * QWK_BLOCK_SIZE - text.size(), ' ');
+
+  block_pos_ += static_cast<uint32_t>(amount_blocks);
+  ++logical_num_;
+  if (buffer_.size() >= buffer_size_) {
+    return Flush();
+  }
+  return ok_;
+}
+
+bool QwkMessagesWriter::Flush() {
+  if (buffer_.empty()) {
+    return ok_;
+  }
+  if (ok_ && !sink_(buffer_.data(), buffer_.size())) {
+    ok_ = false;
+  }
+  bytes_written_ += buffer_.size();
+  buffer_.clear();
+  return ok_;
+}
+
+}  // namespace qwk
+}  // namespace sdk
+}  // namespace wwiv
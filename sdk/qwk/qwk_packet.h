@@ -0,0 +1,162 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_SDK_QWK_QWK_PACKET_H__
+#define __INCLUDED_SDK_QWK_QWK_PACKET_H__
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace wwiv {
+namespace sdk {
+namespace qwk {
+
+#pragma pack(push, 1)
+struct qwk_record {
+  char status;   // ' ' for public
+
+  char msgnum[7]; // all strings are space padded
+  char date[8];
+  char time[5];
+
+  char to[25]; // Uppercase, left justified
+  char from[25]; // Uppercase left justified
+  char subject[25];
+  char password[12];
+  char reference[8];
+
+  char amount_blocks[6];
+  char flag;
+
+  uint16_t conf_num;
+  uint16_t logical_num;
+  char tagline;
+};
+
+struct qwk_index {
+  float pos;
+  char nouse;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(qwk_record) == 128, "qwk_record == 128");
+static_assert(sizeof(qwk_index) == 5, "qwk_index == 5");
+
+static constexpr std::size_t QWK_BLOCK_SIZE = sizeof(qwk_record);
+
+/** Converts an IEEE float into the Microsoft Binary Format used by *.NDX */
+float ieee_to_msbin(float f);
+
+/** Routing line added to each message naming its WWIV sender. */
+static constexpr char QWK_FROM[] = "\x04" "0QWKFrom:";
+
+/** How message text is converted, from the user's QWK settings. */
+struct qwk_text_options_t {
+  // Removes the heart color codes.
+  bool remove_color{false};
+  // Converts the heart color codes to ANSI (ignored if remove_color is set).
+  bool convert_color{false};
+  // Keeps the ^D0 routing lines.
+  bool keep_routing{false};
+};
+
+/** Header fields for a message that don't come from its text. */
+struct qwk_message_info_t {
+  int msgnum{0};
+  uint32_t daten{0};
+  // Node the message came from, added to the QWKFrom: line.
+  uint16_t ownersys{0};
+  std::string to;
+  std::string subject;
+  uint16_t conf_num{0};
+};
+
+/**
+ * Converts a WWIV message into a QWK header and text for
+ * QwkMessagesWriter::Append.  raw_text is the message as stored: the sender
+ * line, the date line and then the body.  The body has its line endings
+ * converted to 0xE3 and a QWKFrom: line added after any routing lines.
+ *
+ * Returns false if the message has no body.
+ */
+bool ToQwkMessage(const std::string& raw_text, const qwk_message_info_t& info,
+                  const qwk_text_options_t& options, qwk_record& rec, std::string& text);
+
+/**
+ * Writes MESSAGES.DAT and the *.NDX files for a QWK packet.
+ *
+ * MESSAGES.DAT is accumulated in a buffer of buffer_size bytes and handed to
+ * sink in large writes rather than one 128 byte block at a time.  The index
+ * files are small, so they are kept in memory until the packet is complete
+ * and are available from indexes().
+ *
+ * Example:
+ *   QwkMessagesWriter w([&](const char* d, size_t n) { return f.Write(d, n) == n; });
+ *   w.Append(rec, text, {"001.NDX"});
+ *   w.Flush();
+ */
+class QwkMessagesWriter {
+public:
+  typedef std::function<bool(const char* data, std::size_t size)> sink_fn;
+  static constexpr std::size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+  /** Creates the writer and emits the required MESSAGES.DAT header block. */
+  explicit QwkMessagesWriter(sink_fn sink, std::size_t buffer_size = DEFAULT_BUFFER_SIZE);
+  QwkMessagesWriter(const QwkMessagesWriter&) = delete;
+  QwkMessagesWriter& operator=(const QwkMessagesWriter&) = delete;
+  /** Flushes any buffered data. */
+  ~QwkMessagesWriter();
+
+  /**
+   * Appends a message to MESSAGES.DAT.  text must already be in QWK form
+   * (lines terminated by 0xE3).  The amount_blocks and logical_num fields of
+   * rec are filled in, and an index entry is added to each of ndx_names.
+   */
+  bool Append(qwk_record rec, const std::string& text, const std::vector<std::string>& ndx_names);
+  /** Writes all buffered data to the sink. */
+  bool Flush();
+
+  /** Logical number of the next message (starts at 1). */
+  uint16_t next_logical_num() const noexcept { return logical_num_; }
+  /** Block number where the next message header will be written. */
+  uint32_t next_block() const noexcept { return block_pos_; }
+  /** Total bytes of MESSAGES.DAT produced so far. */
+  uint64_t bytes_written() const noexcept { return bytes_written_; }
+  bool ok() const noexcept { return ok_; }
+  /** Contents of the *.NDX files, keyed by file name. */
+  const std::map<std::string, std::string>& indexes() const noexcept { return indexes_; }
+
+private:
+  sink_fn sink_;
+  const std::size_t buffer_size_;
+  std::string buffer_;
+  std::map<std::string, std::string> indexes_;
+  uint16_t logical_num_{1};
+  uint32_t block_pos_{2};
+  uint64_t bytes_written_{0};
+  bool ok_{true};
+};
+
+}  // namespace qwk
+}  // namespace sdk
+}  // namespace wwiv
+
+#endif  // __INCLUDED_SDK_QWK_QWK_PACKET_H__
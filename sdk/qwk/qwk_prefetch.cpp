@@ -0,0 +1,160 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "sdk/qwk/qwk_prefetch.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+#include "sdk/msgapi/type2_text.h"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using namespace wwiv::core;
+using namespace wwiv::sdk::msgapi;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace sdk {
+namespace qwk {
+
+const string* qwk_prefetched_sub_t::text(uint32_t q) const {
+  auto it = by_qscan_.find(q);
+  if (it == by_qscan_.end()) {
+    return nullptr;
+  }
+  return &messages.at(it->second).text;
+}
+
+// static
+unique_ptr<qwk_prefetched_sub_t> QwkSubPrefetcher::Read(const string& datadir,
+                                                         const string& msgsdir,
+                                                         const qwk_prefetch_request_t& request) {
+  auto result = std::make_unique<qwk_prefetched_sub_t>();
+  result->request = request;
+
+  File sub_file(FilePath(datadir, StrCat(request.filename, ".sub")));
+  if (!sub_file.Open(File::modeBinary | File::modeReadOnly)) {
+    VLOG(1) << "Unable to open sub: " << sub_file;
+    return result;
+  }
+  const auto num_records = static_cast<std::size_t>(sub_file.length()) / sizeof(postrec);
+  vector<postrec> headers(num_records);
+  if (num_records == 0 ||
+      sub_file.Read(&headers[0], num_records * sizeof(postrec)) !=
+          static_cast<ssize_t>(num_records * sizeof(postrec))) {
+    return result;
+  }
+  sub_file.Close();
+
+  // Record 0 holds the sub header, owneruser is the active message count.
+  const auto active = static_cast<std::size_t>(headers[0].owneruser);
+  const auto num_messages = std::min(active, num_records - 1);
+  result->ok = true;
+  result->num_messages = static_cast<int>(num_messages);
+
+  Type2Text text(FilePath(msgsdir, StrCat(request.filename, ".dat")));
+  if (!text.keep_open_for_read()) {
+    return result;
+  }
+  for (std::size_t i = 1; i <= num_messages; i++) {
+    const auto& h = headers[i];
+    if (h.qscan <= request.qscan || h.msg.storage_type != 2) {
+      continue;
+    }
+    qwk_prefetch_message_t m{};
+    m.msgnum = static_cast<int>(i);
+    m.header = h;
+    if (!text.readfile(&h.msg, &m.text)) {
+      continue;
+    }
+    result->by_qscan_.emplace(h.qscan, result->messages.size());
+    result->messages.emplace_back(std::move(m));
+    if (request.max_messages > 0 &&
+        result->messages.size() >= static_cast<std::size_t>(request.max_messages)) {
+      break;
+    }
+  }
+  return result;
+}
+
+QwkSubPrefetcher::QwkSubPrefetcher(const string& datadir, const string& msgsdir,
+                                   vector<qwk_prefetch_request_t> requests, int lookahead)
+    : datadir_(datadir), msgsdir_(msgsdir), requests_(std::move(requests)),
+      lookahead_(std::max(1, lookahead)) {
+  worker_ = std::thread(&QwkSubPrefetcher::Run, this);
+}
+
+QwkSubPrefetcher::~QwkSubPrefetcher() {
+  Cancel();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void QwkSubPrefetcher::Cancel() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    cancelled_ = true;
+  }
+  cv_.notify_all();
+}
+
+void QwkSubPrefetcher::Run() {
+  for (const auto& request : requests_) {
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this] { return cancelled_ || ready_.size() < lookahead_; });
+      if (cancelled_) {
+        return;
+      }
+    }
+    auto sub = Read(datadir_, msgsdir_, request);
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      ready_.emplace_back(std::move(sub));
+    }
+    cv_.notify_all();
+  }
+}
+
+unique_ptr<qwk_prefetched_sub_t> QwkSubPrefetcher::Next() {
+  std::unique_lock<std::mutex> lock(mu_);
+  if (returned_ >= requests_.size()) {
+    return {};
+  }
+  cv_.wait(lock, [this] { return cancelled_ || !ready_.empty(); });
+  if (ready_.empty()) {
+    return {};
+  }
+  auto sub = std::move(ready_.front());
+  ready_.pop_front();
+  ++returned_;
+  lock.unlock();
+  cv_.notify_all();
+  return sub;
+}
+
+}  // namespace qwk
+}  // namespace sdk
+}  // namespace wwiv
@@ -0,0 +1,120 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_SDK_QWK_QWK_PREFETCH_H__
+#define __INCLUDED_SDK_QWK_QWK_PREFETCH_H__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "sdk/vardec.h"
+
+namespace wwiv {
+namespace sdk {
+namespace qwk {
+
+/** A sub to be read ahead of the QWK packet builder. */
+struct qwk_prefetch_request_t {
+  // Sub filename (without extension).
+  std::string filename;
+  // Only messages with a qscan pointer greater than this are read.
+  uint32_t qscan{0};
+  // Maximum number of messages to read, 0 for all of them.
+  int max_messages{0};
+};
+
+struct qwk_prefetch_message_t {
+  // 1 based message number within the sub.
+  int msgnum{0};
+  postrec header{};
+  std::string text;
+};
+
+struct qwk_prefetched_sub_t {
+  qwk_prefetch_request_t request;
+  // false if the sub could not be opened.
+  bool ok{false};
+  // Number of messages in the sub.
+  int num_messages{0};
+  std::vector<qwk_prefetch_message_t> messages;
+
+  /** Returns the text of the message with qscan pointer q or nullptr. */
+  const std::string* text(uint32_t q) const;
+
+private:
+  friend class QwkSubPrefetcher;
+  std::unordered_map<uint32_t, std::size_t> by_qscan_;
+};
+
+/**
+ * Reads the headers and message text for a list of subs on a worker thread,
+ * staying up to lookahead subs ahead of the caller, so that the next subs are
+ * loaded while the current one is being written into the QWK packet.
+ *
+ * Subs are returned by Next() in the order they were requested.
+ */
+class QwkSubPrefetcher {
+public:
+  QwkSubPrefetcher(const std::string& datadir, const std::string& msgsdir,
+                   std::vector<qwk_prefetch_request_t> requests, int lookahead = 4);
+  QwkSubPrefetcher(const QwkSubPrefetcher&) = delete;
+  QwkSubPrefetcher& operator=(const QwkSubPrefetcher&) = delete;
+  /** Stops and joins the worker thread. */
+  ~QwkSubPrefetcher();
+
+  /**
+   * Returns the next sub in request order, waiting for it to be read if
+   * needed, or nullptr once all of the requested subs have been returned.
+   */
+  std::unique_ptr<qwk_prefetched_sub_t> Next();
+  /** Stops reading ahead. Subs not yet returned by Next() are discarded. */
+  void Cancel();
+
+  /** Reads a single sub on the calling thread. */
+  static std::unique_ptr<qwk_prefetched_sub_t> Read(const std::string& datadir,
+                                                    const std::string& msgsdir,
+                                                    const qwk_prefetch_request_t& request);
+
+private:
+  void Run();
+
+  const std::string datadir_;
+  const std::string msgsdir_;
+  const std::vector<qwk_prefetch_request_t> requests_;
+  const std::size_t lookahead_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<qwk_prefetched_sub_t>> ready_;
+  std::size_t returned_{0};
+  bool cancelled_{false};
+  std::thread worker_;
+};
+
+}  // namespace qwk
+}  // namespace sdk
+}  // namespace wwiv
+
+#endif  // __INCLUDED_SDK_QWK_QWK_PREFETCH_H__
@@ -16,12 +16,16 @@
 /*    language governing permissions and limitations under the License.   */
 /*                                                                        */
 /**************************************************************************/
+#include <atomic>
+#include <cstring>
+#include <map>
 #include <memory>
 #include <string>
 
 #include "sdk/status.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/os.h"
 #include "core/strings.h"
 #include "core/wwivassert.h"
 #include "core/datetime.h"
@@ -30,6 +34,7 @@
 using std::string;
 using std::unique_ptr;
 using namespace wwiv::core;
+using namespace wwiv::os;
 using namespace wwiv::sdk;
 using namespace wwiv::strings;
 
@@ -37,7 +42,107 @@ namespace wwiv {
 namespace sdk {
 
 namespace {
-static statusrec_t statusrec;
+static constexpr uint32_t shared_status_magic = 0x54535757; // "WWST"
+static constexpr uint32_t shared_status_version = 3;
+static constexpr int num_counters = static_cast<int>(StatusCounter::qscan_pointer) + 1;
+static constexpr int num_filechange_flags = sizeof(statusrec_t::filechange);
+
+// Number of StatusMgr::Lock calls held by this thread, by datadir.
+thread_local std::map<std::string, int> locks_held;
+}
+
+/**
+ * Layout of STATUS.SHM.
+ *
+ * The counters and file change flags are only ever changed with atomic
+ * adds, so nodes posting at the same time never wait on each other.  rec
+ * holds the rest of STATUS.DAT (its counter fields are stale) and is only
+ * written while holding a lock on STATUS.SHM itself, which the OS releases
+ * if the holder dies.  rec_seq is odd while rec is being written so that
+ * readers can retry instead of taking the lock.
+ */
+struct shared_status_t {
+  uint32_t magic;
+  uint32_t version;
+  std::atomic<uint32_t> rec_seq;
+  // Bumped on every change, compared to checkpointed_changes to see if
+  // STATUS.DAT needs to be written.
+  std::atomic<uint32_t> changes;
+  uint32_t checkpointed_changes;
+  // STATUS.DAT's last write time as of the last checkpoint, used to notice
+  // when something other than StatusMgr has rewritten it.
+  int64_t status_dat_time;
+  std::atomic<uint32_t> counters[num_counters];
+  std::atomic<uint32_t> filechange[num_filechange_flags];
+  // Counters and flags as last written to STATUS.DAT, so that anything
+  // added since can be carried over when STATUS.DAT is reloaded.
+  uint32_t checkpointed_counters[num_counters];
+  uint32_t checkpointed_filechange[num_filechange_flags];
+  statusrec_t rec;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "STATUS.SHM needs lock free atomics to be shared between processes.");
+
+static uint32_t get_counter(const statusrec_t& s, StatusCounter c) {
+  switch (c) {
+  case StatusCounter::local_posts:
+    return s.localposts;
+  case StatusCounter::users:
+    return s.users;
+  case StatusCounter::caller_number:
+    return s.callernum1;
+  case StatusCounter::calls_today:
+    return s.callstoday;
+  case StatusCounter::posts_today:
+    return s.msgposttoday;
+  case StatusCounter::email_today:
+    return s.emailtoday;
+  case StatusCounter::feedback_today:
+    return s.fbacktoday;
+  case StatusCounter::uploads_today:
+    return s.uptoday;
+  case StatusCounter::minutes_active_today:
+    return s.activetoday;
+  case StatusCounter::qscan_pointer:
+    return s.qscanptr;
+  }
+  return 0;
+}
+
+static void set_counter(statusrec_t& s, StatusCounter c, uint32_t v) {
+  switch (c) {
+  case StatusCounter::local_posts:
+    s.localposts = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::users:
+    s.users = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::caller_number:
+    s.callernum1 = v;
+    break;
+  case StatusCounter::calls_today:
+    s.callstoday = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::posts_today:
+    s.msgposttoday = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::email_today:
+    s.emailtoday = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::feedback_today:
+    s.fbacktoday = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::uploads_today:
+    s.uptoday = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::minutes_active_today:
+    s.activetoday = static_cast<uint16_t>(v);
+    break;
+  case StatusCounter::qscan_pointer:
+    s.qscanptr = v;
+    break;
+  }
 }
 
 
@@ -82,6 +187,35 @@ std::string WStatus::GetLogFileName(int nDaysAgo) const {
   }
 }
 
+void WStatus::SetLastDate(int days_ago, const std::string& s) {
+  DCHECK_GE(days_ago, 0);
+  DCHECK_LE(days_ago, 2);
+  switch (days_ago) {
+  case 0:
+    to_char_array(status_->date1, s);
+    break;
+  case 1:
+    to_char_array(status_->date2, s);
+    break;
+  case 2:
+    to_char_array(status_->date3, s);
+    break;
+  }
+}
+
+void WStatus::SetLogFileName(int days_ago, const std::string& s) {
+  DCHECK_GE(days_ago, 1);
+  DCHECK_LE(days_ago, 2);
+  switch (days_ago) {
+  case 1:
+    to_char_array(status_->log1, s);
+    break;
+  case 2:
+    to_char_array(status_->log2, s);
+    break;
+  }
+}
+
 void WStatus::EnsureCallerNumberIsValid() {
   if (status_->callernum != 65535) {
     this->SetCallerNumber(status_->callernum);
@@ -144,32 +278,66 @@ bool WStatus::NewDay() {
 }
 
 // StatusMgr
+StatusMgr::StatusMgr(const std::string& datadir, status_callabck_fn callback)
+    : datadir_(datadir), callback_(callback) {}
+
+StatusMgr::~StatusMgr() {
+  if (shm_ == nullptr) {
+    return;
+  }
+  if (!in_transaction_) {
+    Lock();
+  }
+  CheckpointLocked();
+  Unlock();
+}
+
 bool StatusMgr::Get(bool bLockFile) {
-  if (!status_file_) {
-    status_file_.reset(new File(FilePath(datadir_, STATUS_DAT)));
-    int nLockMode = (bLockFile) ? (File::modeReadWrite | File::modeBinary) : (File::modeReadOnly | File::modeBinary);
-    status_file_->Open(nLockMode);
-  } else {
-    status_file_->Seek(0L, File::Whence::begin);
+  char oldFileChangeFlags[7];
+  for (int nFcIndex = 0; nFcIndex < 7; nFcIndex++) {
+    oldFileChangeFlags[nFcIndex] = status_rec_.filechange[nFcIndex];
   }
-  if (!status_file_->IsOpen()) {
-    return false;
+  if (Attach()) {
+    if (bLockFile) {
+      Lock();
+      in_transaction_ = true;
+    }
+    if (StatusDatChanged()) {
+      // Rewritten by something other than StatusMgr since the last
+      // checkpoint, pick it up now rather than at the next one.
+      if (!bLockFile) {
+        Lock();
+      }
+      if (StatusDatChanged()) {
+        LoadSharedLocked();
+      }
+      if (!bLockFile) {
+        Unlock();
+      }
+    }
+    ReadShared(&status_rec_);
   } else {
-    char oldFileChangeFlags[7];
-    for (int nFcIndex = 0; nFcIndex < 7; nFcIndex++) {
-      oldFileChangeFlags[nFcIndex] = statusrec.filechange[nFcIndex];
+    if (!status_file_) {
+      status_file_.reset(new File(FilePath(datadir_, STATUS_DAT)));
+      int nLockMode = (bLockFile) ? (File::modeReadWrite | File::modeBinary) : (File::modeReadOnly | File::modeBinary);
+      status_file_->Open(nLockMode);
+    } else {
+      status_file_->Seek(0L, File::Whence::begin);
     }
-    status_file_->Read(&statusrec, sizeof(statusrec_t));
+    if (!status_file_->IsOpen()) {
+      return false;
+    }
+    status_file_->Read(&status_rec_, sizeof(statusrec_t));
 
     if (!bLockFile) {
       status_file_.reset();
     }
+  }
 
-    for (int i = 0; i < 7; i++) {
-      if (oldFileChangeFlags[i] != statusrec.filechange[i]) {
-        // Invoke callback on changes.
-        callback_(i);
-      }
+  for (int i = 0; i < 7; i++) {
+    if (oldFileChangeFlags[i] != status_rec_.filechange[i]) {
+      // Invoke callback on changes.
+      callback_(i);
     }
   }
   return true;
@@ -181,20 +349,38 @@ bool StatusMgr::RefreshStatusCache() {
 
 std::unique_ptr<WStatus> StatusMgr::GetStatus() {
   this->Get(false);
-  return std::make_unique<WStatus>(datadir_, &statusrec);
+  return std::make_unique<WStatus>(datadir_, &status_rec_);
 }
 
 void StatusMgr::AbortTransaction(std::unique_ptr<WStatus> pStatus) {
   status_file_.reset();
+  if (in_transaction_) {
+    in_transaction_ = false;
+    Unlock();
+  }
 }
 
 std::unique_ptr<WStatus> StatusMgr::BeginTransaction() {
   this->Get(true);
-  return std::make_unique<WStatus>(datadir_, &statusrec);
+  transaction_start_ = status_rec_;
+  return std::make_unique<WStatus>(datadir_, &status_rec_);
 }
 
 bool StatusMgr::CommitTransaction(std::unique_ptr<WStatus> pStatus) {
-  return this->Write(pStatus->status_);
+  if (!Attach()) {
+    return this->Write(pStatus->status_);
+  }
+  if (!in_transaction_) {
+    // Committing a status from GetStatus, the changes are relative to
+    // whatever is current.
+    Lock();
+    ReadShared(&transaction_start_);
+  }
+  in_transaction_ = false;
+  WriteSharedLocked(transaction_start_, *pStatus->status_);
+  const auto result = CheckpointLocked();
+  Unlock();
+  return result;
 }
 
 bool StatusMgr::Write(statusrec_t *pStatus) {
@@ -213,6 +399,285 @@ bool StatusMgr::Write(statusrec_t *pStatus) {
   return true;
 }
 
+uint32_t StatusMgr::Increment(StatusCounter counter, int amount) {
+  if (!Attach()) {
+    uint32_t previous = 0;
+    Run([&](WStatus& s) {
+      previous = get_counter(*s.status_, counter);
+      set_counter(*s.status_, counter, previous + amount);
+    });
+    return previous;
+  }
+  const auto idx = static_cast<int>(counter);
+  const auto previous = shm_->counters[idx].fetch_add(static_cast<uint32_t>(amount));
+  shm_->changes.fetch_add(1, std::memory_order_release);
+  // Truncate to the width of the field in STATUS.DAT.
+  statusrec_t s{};
+  set_counter(s, counter, previous);
+  return get_counter(s, counter);
+}
+
+void StatusMgr::IncrementFileChangedFlag(int flag) {
+  if (!Attach()) {
+    Run([=](WStatus& s) { s.IncrementFileChangedFlag(flag); });
+    return;
+  }
+  shm_->filechange[flag].fetch_add(1);
+  shm_->changes.fetch_add(1, std::memory_order_release);
+}
+
+bool StatusMgr::Checkpoint() {
+  if (!Attach()) {
+    return true;
+  }
+  Lock();
+  const auto result = CheckpointLocked();
+  Unlock();
+  return result;
+}
+
+bool StatusMgr::shared() { return Attach(); }
+
+bool StatusMgr::Attach() {
+  if (attach_tried_) {
+    return shm_ != nullptr;
+  }
+  attach_tried_ = true;
+  if (!File::Exists(FilePath(datadir_, STATUS_DAT))) {
+    // Nothing to share yet, the BBS hasn't been initialized.
+    return false;
+  }
+  const auto path = FilePath(datadir_, STATUS_SHM);
+  if (File(path).length() < static_cast<off_t>(sizeof(shared_status_t))) {
+    // Only created or grown while holding the lock.  A new file is all
+    // zeros, which is an uninitialized status.
+    const auto size = static_cast<off_t>(sizeof(shared_status_t));
+    auto sized = false;
+    Lock();
+    if (lock_file_) {
+      if (lock_file_->length() < size) {
+        lock_file_->set_length(size);
+      }
+      sized = lock_file_->length() >= size;
+    }
+    Unlock();
+    if (!sized) {
+      LOG(WARNING) << "Unable to open " << path << "; using STATUS.DAT directly.";
+      return false;
+    }
+  }
+  shm_file_ = std::make_unique<MappedFile>(path, MappedFile::Mode::read_write);
+  if (!*shm_file_ || shm_file_->size() < sizeof(shared_status_t)) {
+    LOG(WARNING) << "Unable to map " << path << "; using STATUS.DAT directly.";
+    shm_file_.reset();
+    return false;
+  }
+  shm_ = reinterpret_cast<shared_status_t*>(shm_file_->mutable_data());
+
+  auto needs_load = [&] {
+    return shm_->magic != shared_status_magic || shm_->version != shared_status_version ||
+           StatusDatChanged();
+  };
+  if (!needs_load()) {
+    // Usual case, another node already loaded it; no need to wait on
+    // whoever may be in a transaction.
+    return true;
+  }
+  Lock();
+  if (needs_load()) {
+    if (!LoadSharedLocked()) {
+      LOG(WARNING) << "Unable to read STATUS.DAT into " << path;
+      Unlock();
+      shm_ = nullptr;
+      shm_file_.reset();
+      return false;
+    }
+  }
+  Unlock();
+  return true;
+}
+
+void StatusMgr::Lock() {
+  auto& held = locks_held[datadir_];
+  if (held++ > 0) {
+    // Another StatusMgr on this thread is in a transaction, waiting on it
+    // would never finish.  Both transactions apply their counters as
+    // deltas, so only the other fields may be overwritten by whichever
+    // commits last.
+    LOG(ERROR) << "Nested STATUS.DAT transaction in: " << datadir_;
+    return;
+  }
+  // Blocks until any other process is done, and is released by the OS if
+  // the holder dies.  (On POSIX, opening the File already waits for it.)
+  lock_file_ = std::make_unique<File>(FilePath(datadir_, STATUS_SHM));
+  if (!lock_file_->Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile,
+                        File::shareDenyNone)) {
+    LOG(ERROR) << "Unable to lock: " << lock_file_->full_pathname();
+    lock_file_.reset();
+  } else {
+    file_lock_ = lock_file_->lock(FileLockType::write_lock);
+  }
+  if (shm_ != nullptr && (shm_->rec_seq.load() & 1)) {
+    LOG(WARNING) << "Repairing STATUS.SHM after an interrupted transaction.";
+    statusrec_t s{};
+    if (ReadStatusDat(&s)) {
+      memcpy(&shm_->rec, &s, sizeof(statusrec_t));
+    }
+    shm_->rec_seq.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void StatusMgr::Unlock() {
+  auto& held = locks_held[datadir_];
+  if (held > 0) {
+    --held;
+  }
+  // Only set if this StatusMgr took the lock, not when it was nested.
+  file_lock_.reset();
+  lock_file_.reset();
+}
+
+bool StatusMgr::ReadStatusDat(statusrec_t* s) const {
+  File f(FilePath(datadir_, STATUS_DAT));
+  if (!f.Open(File::modeReadOnly | File::modeBinary)) {
+    return false;
+  }
+  return f.Read(s, sizeof(statusrec_t)) == sizeof(statusrec_t);
+}
+
+bool StatusMgr::StatusDatChanged() const {
+  return File(FilePath(datadir_, STATUS_DAT)).last_write_time() != shm_->status_dat_time;
+}
+
+bool StatusMgr::LoadSharedLocked() {
+  statusrec_t s{};
+  if (!ReadStatusDat(&s)) {
+    return false;
+  }
+  // When reloading over a mapping that is in use, anything added since the
+  // last checkpoint is added on top of the new STATUS.DAT rather than lost,
+  // so that no counter (qscanptr above all) goes backwards.  The counters
+  // wrap at the width of the field like in WriteSharedLocked.
+  const auto merge = shm_->magic == shared_status_magic && shm_->version == shared_status_version;
+  auto pending = false;
+  shm_->magic = shared_status_magic;
+  shm_->version = shared_status_version;
+  shm_->rec_seq.fetch_add(1, std::memory_order_acq_rel);
+  memcpy(&shm_->rec, &s, sizeof(statusrec_t));
+  for (int i = 0; i < num_counters; i++) {
+    const auto c = static_cast<StatusCounter>(i);
+    const auto value = get_counter(s, c);
+    const auto delta = merge ? shm_->counters[i].load() - shm_->checkpointed_counters[i] : 0;
+    set_counter(s, c, value + delta);
+    shm_->counters[i].store(get_counter(s, c));
+    shm_->checkpointed_counters[i] = value;
+    pending |= delta != 0;
+  }
+  for (int i = 0; i < num_filechange_flags; i++) {
+    const uint32_t value = static_cast<uint8_t>(s.filechange[i]);
+    const auto delta = merge ? shm_->filechange[i].load() - shm_->checkpointed_filechange[i] : 0;
+    shm_->filechange[i].store(static_cast<uint8_t>(value + delta));
+    shm_->checkpointed_filechange[i] = value;
+    pending |= delta != 0;
+  }
+  shm_->rec_seq.fetch_add(1, std::memory_order_release);
+  const auto changes = shm_->changes.load();
+  // Leave it looking changed when carrying anything over, so that the next
+  // checkpoint writes it.
+  shm_->checkpointed_changes = pending ? changes - 1 : changes;
+  shm_->status_dat_time = File(FilePath(datadir_, STATUS_DAT)).last_write_time();
+  return true;
+}
+
+void StatusMgr::ReadShared(statusrec_t* s) const {
+  bool clean = false;
+  for (int tries = 0; !clean && tries < 1000; tries++) {
+    const auto seq = shm_->rec_seq.load(std::memory_order_acquire);
+    if ((seq & 1) == 0) {
+      memcpy(s, &shm_->rec, sizeof(statusrec_t));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      clean = shm_->rec_seq.load(std::memory_order_relaxed) == seq;
+    }
+    if (!clean) {
+      yield();
+    }
+  }
+  if (!clean) {
+    // A writer died while writing rec (the next Lock repairs it) or is very
+    // slow; use the last checkpoint rather than a torn copy.
+    LOG(WARNING) << "Unable to read STATUS.SHM cleanly; using STATUS.DAT.";
+    if (!ReadStatusDat(s)) {
+      memcpy(s, &shm_->rec, sizeof(statusrec_t));
+    }
+  }
+  for (int i = 0; i < num_counters; i++) {
+    set_counter(*s, static_cast<StatusCounter>(i), shm_->counters[i].load());
+  }
+  for (int i = 0; i < num_filechange_flags; i++) {
+    s->filechange[i] = static_cast<char>(shm_->filechange[i].load());
+  }
+}
+
+void StatusMgr::WriteSharedLocked(const statusrec_t& before, const statusrec_t& after) {
+  shm_->rec_seq.fetch_add(1, std::memory_order_acq_rel);
+  memcpy(&shm_->rec, &after, sizeof(statusrec_t));
+  shm_->rec_seq.fetch_add(1, std::memory_order_release);
+
+  // Apply the counters as deltas so that any Increment made by another node
+  // during the transaction isn't lost.  Everything wraps around at the
+  // width of the field, so unsigned arithmetic does the right thing even
+  // when a counter is reset.
+  for (int i = 0; i < num_counters; i++) {
+    const auto c = static_cast<StatusCounter>(i);
+    const auto delta = get_counter(after, c) - get_counter(before, c);
+    if (delta != 0) {
+      shm_->counters[i].fetch_add(delta);
+    }
+  }
+  for (int i = 0; i < num_filechange_flags; i++) {
+    const uint32_t delta =
+        static_cast<uint8_t>(after.filechange[i]) - static_cast<uint8_t>(before.filechange[i]);
+    if (delta != 0) {
+      shm_->filechange[i].fetch_add(delta);
+    }
+  }
+  shm_->changes.fetch_add(1, std::memory_order_release);
+}
+
+bool StatusMgr::CheckpointLocked() {
+  const auto path = FilePath(datadir_, STATUS_DAT);
+  if (File(path).last_write_time() != shm_->status_dat_time) {
+    // Someone rewrote STATUS.DAT without going through StatusMgr, their
+    // copy wins over the other fields not yet checkpointed.
+    LOG(INFO) << "STATUS.DAT was changed outside of STATUS.SHM; reloading it.";
+    if (!LoadSharedLocked()) {
+      return false;
+    }
+  }
+  const auto changes = shm_->changes.load(std::memory_order_acquire);
+  if (changes == shm_->checkpointed_changes) {
+    return true;
+  }
+  statusrec_t s{};
+  ReadShared(&s);
+  File f(path);
+  if (!f.Open(File::modeReadWrite | File::modeBinary)) {
+    LOG(ERROR) << "Unable to write: " << path;
+    return false;
+  }
+  f.Write(&s, sizeof(statusrec_t));
+  f.Close();
+  for (int i = 0; i < num_counters; i++) {
+    shm_->checkpointed_counters[i] = get_counter(s, static_cast<StatusCounter>(i));
+  }
+  for (int i = 0; i < num_filechange_flags; i++) {
+    shm_->checkpointed_filechange[i] = static_cast<uint8_t>(s.filechange[i]);
+  }
+  shm_->checkpointed_changes = changes;
+  shm_->status_dat_time = f.last_write_time();
+  return true;
+}
+
 const int StatusMgr::GetUserCount() {
   unique_ptr<WStatus>pStatus(GetStatus());
   return pStatus->GetNumUsers();
@@ -19,17 +19,39 @@
 #ifndef __INCLUDED_SDK_STATUS_H__
 #define __INCLUDED_SDK_STATUS_H__
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 
 #include "core/file.h"
+#include "core/mapped_file.h"
 #include "core/strings.h"
 #include "sdk/vardec.h"
 
 namespace wwiv {
 namespace sdk {
 
+/**
+ * The fields of STATUS.DAT which are bumped often enough (on every post,
+ * call, email or upload) to be updated with StatusMgr::Increment instead
+ * of a full transaction.
+ */
+enum class StatusCounter : int {
+  local_posts = 0,
+  users,
+  caller_number,
+  calls_today,
+  posts_today,
+  email_today,
+  feedback_today,
+  uploads_today,
+  minutes_active_today,
+  qscan_pointer
+};
+
+struct shared_status_t;
+
 class WStatus {
   friend class StatusMgr;
 
@@ -59,6 +81,9 @@ public:
 
   std::string GetLastDate(int nDaysAgo = 0) const;
   std::string GetLogFileName(int nDaysAgo = 0) const;
+  void SetLastDate(int nDaysAgo, const std::string& s);
+  /** Sets the log file name of 1 or 2 days ago, today's is always computed. */
+  void SetLogFileName(int nDaysAgo, const std::string& s);
   std::string GetGFileDate() const { return status_->gfiledate; }
   void SetGFileDate(const std::string& s) { wwiv::strings::to_char_array(status_->gfiledate, s); }
   const char GetFileChangedFlag(int nFlag) const { return status_->filechange[nFlag]; }
@@ -117,6 +142,9 @@ public:
   void SetWWIVVersion(int n) { status_->wwiv_version = static_cast<uint16_t>(n); }
 
   const int GetNetworkVersion() const { return status_->net_version; }
+  void SetNetworkVersion(int n) { status_->net_version = static_cast<uint16_t>(n); }
+  void SetNetworkBias(float f) { status_->net_bias = f; }
+  void SetNetworkRequestFree(float f) { status_->net_req_free = f; }
   const int GetDays() const { return status_->days; }
   void SetDays(int n) { status_->days = static_cast<uint16_t>(n); }
 
@@ -126,6 +154,18 @@ private:
 
 /*!
  * @class StatusMgr Manages STATUS.DAT
+ *
+ * When STATUS.DAT exists, every StatusMgr using the same datadir shares
+ * its contents through a memory mapped STATUS.SHM.  Counters are updated
+ * in place with atomic adds, GetStatus reads the mapping without touching
+ * STATUS.DAT, and the contents are written back to STATUS.DAT by
+ * transactions, by Checkpoint (called periodically by wwivd) and when the
+ * StatusMgr is destroyed.
+ *
+ * Everything that changes STATUS.DAT once it exists should go through a
+ * StatusMgr.  A direct write is noticed by its modification time and
+ * reloaded (keeping anything added since the last checkpoint), but that
+ * only has a resolution of one second.
  */
 class StatusMgr {
 public:
@@ -135,9 +175,10 @@ public:
   /*!
    * @function StatusMgr Constructor
    */
-  StatusMgr(const std::string& datadir, status_callabck_fn callback)
-      : datadir_(datadir), callback_(callback) {}
-  virtual ~StatusMgr() {}
+  StatusMgr(const std::string& datadir, status_callabck_fn callback);
+  StatusMgr(const StatusMgr&) = delete;
+  StatusMgr& operator=(const StatusMgr&) = delete;
+  virtual ~StatusMgr();
   /*!
    * @function Read Loads the contents of STATUS.DAT
    */
@@ -164,6 +205,24 @@ public:
 
   bool Run(status_txn_fn fn);
 
+  /**
+   * Adds amount to counter without a transaction, returning the value it
+   * had before (like the WStatus::IncrementXXX methods).
+   */
+  uint32_t Increment(StatusCounter counter, int amount = 1);
+
+  /** Same as WStatus::IncrementFileChangedFlag, without a transaction. */
+  void IncrementFileChangedFlag(int flag);
+
+  /**
+   * Writes the shared status back to STATUS.DAT if it has changed since it
+   * was last written.  Does nothing when STATUS.SHM is not in use.
+   */
+  bool Checkpoint();
+
+  /** True if this StatusMgr is using STATUS.SHM. */
+  bool shared();
+
 private:
   std::unique_ptr<wwiv::core::File> status_file_;
   const std::string datadir_;
@@ -176,6 +235,29 @@ private:
    * @return true on success
    */
   bool Get(bool bLockFile);
+
+  // STATUS.SHM
+  bool Attach();
+  void Lock();
+  void Unlock();
+  /** True if STATUS.DAT was written since STATUS.SHM last loaded or saved it. */
+  bool StatusDatChanged() const;
+  bool LoadSharedLocked();
+  bool ReadStatusDat(statusrec_t* s) const;
+  void ReadShared(statusrec_t* s) const;
+  void WriteSharedLocked(const statusrec_t& before, const statusrec_t& after);
+  bool CheckpointLocked();
+
+  std::unique_ptr<wwiv::core::MappedFile> shm_file_;
+  shared_status_t* shm_{nullptr};
+  std::unique_ptr<wwiv::core::File> lock_file_;
+  std::unique_ptr<wwiv::core::FileLock> file_lock_;
+  // What GetStatus and BeginTransaction hand out.  Each StatusMgr has its
+  // own so that one transaction can't clobber another's.
+  statusrec_t status_rec_{};
+  bool attach_tried_{false};
+  bool in_transaction_{false};
+  statusrec_t transaction_start_{};
 };
 
 } // namespace sdk
@@ -115,7 +115,52 @@ bool WriteSubcriberFile(const std::string& dir, const std::string& filename, con
   return true;
 }
 
+std::shared_ptr<const std::set<uint16_t>> SubscriberCache::Get(const std::string& dir,
+                                                               const std::string& filename) {
+  return Get(FilePath(dir, filename));
+}
+
+std::shared_ptr<const std::set<uint16_t>> SubscriberCache::Get(const std::string& path) {
+  File f(path);
+  if (!f.Exists()) {
+    std::lock_guard<std::mutex> lock(mu_);
+    entries_.erase(path);
+    return {};
+  }
+  const auto size = f.length();
+  const auto mtime = f.last_write_time();
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = entries_.find(path);
+    if (it != entries_.end() && !it->second.racy && it->second.size == size &&
+        it->second.mtime == mtime) {
+      return it->second.subscribers;
+    }
+  }
 
+  const auto now = time(nullptr);
+  auto subscribers = std::make_shared<std::set<uint16_t>>();
+  const auto read = ReadSubcriberFile(path, *subscribers);
+  std::lock_guard<std::mutex> lock(mu_);
+  ++loads_;
+  if (!read) {
+    entries_.erase(path);
+    return {};
+  }
+  auto& e = entries_[path];
+  e.subscribers = subscribers;
+  e.size = size;
+  e.mtime = mtime;
+  // A change made later in the same second would not change the mtime, so
+  // don't trust this entry until the clock has moved past it.
+  e.racy = mtime >= now;
+  return subscribers;
+}
+
+void SubscriberCache::InvalidateAll() {
+  std::lock_guard<std::mutex> lock(mu_);
+  entries_.clear();
+}
 
 }
 }
@@ -18,8 +18,12 @@
 #ifndef __INCLUDED_SDK_SUBSCRIBERS_H__
 #define __INCLUDED_SDK_SUBSCRIBERS_H__
 
+#include <ctime>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include "sdk/fido/fido_address.h"
 
 namespace wwiv {
@@ -35,6 +39,37 @@ bool ReadSubcriberFile(const std::string& filename,
 bool WriteSubcriberFile(const std::string& dir, const std::string& filename,
                         const std::set<uint16_t>& subscribers);
 
+/**
+ * Cache of WWIVnet subscriber files (n<subtype>.net) keyed by their full
+ * path. A file is read again once its size or mtime changes, so edits made
+ * by WriteSubcriberFile or by hand are picked up on the next Get.
+ */
+class SubscriberCache {
+public:
+  SubscriberCache() = default;
+
+  /** Returns the subscribers in filename, or nullptr if it can not be read. */
+  std::shared_ptr<const std::set<uint16_t>> Get(const std::string& dir,
+                                                const std::string& filename);
+  std::shared_ptr<const std::set<uint16_t>> Get(const std::string& path);
+  void InvalidateAll();
+
+  /** Number of times a subscriber file was read from disk. */
+  int loads() const noexcept { return loads_; }
+
+private:
+  struct entry_t {
+    std::shared_ptr<const std::set<uint16_t>> subscribers;
+    off_t size{0};
+    time_t mtime{0};
+    bool racy{false};
+  };
+
+  std::mutex mu_;
+  std::unordered_map<std::string, entry_t> entries_;
+  int loads_{0};
+};
+
 }  // namespace sdk
 }  // namespace wwiv
 
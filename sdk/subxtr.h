@@ -95,6 +95,7 @@ public:
 
   void set_sub(std::size_t n, subboard_t s) { subs_[n] = s; }
   const std::vector<subboard_t> subs() const { return subs_; }
+  void set_subs(std::vector<subboard_t> subs) { subs_ = std::move(subs); }
   bool insert(std::size_t n, subboard_t r);
   bool erase(std::size_t n);
   std::vector<net_networks_rec>::size_type size() const { return subs_.size(); }
@@ -18,17 +18,22 @@
 /**************************************************************************/
 #include "sdk/usermanager.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "core/strings.h"
 #include "core/datafile.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/mapped_file.h"
 #include "sdk/config.h"
 #include "sdk/names.h"
 #include "sdk/filenames.h"
@@ -46,9 +51,169 @@ using namespace wwiv::sdk::msgapi;
 namespace wwiv {
 namespace sdk {
 
+/////////////////////////////////////////////////////////////////////////////
+// class UserManager::MappedUsers
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "USER.SEQ entries must be plain 32-bit values");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "USER.SEQ entries are shared between processes");
+
+// How many times to wait for another node to finish writing a record before
+// giving up and reading it from USER.LST instead.
+static constexpr int kMaxSeqSpins = 10000;
+
+/**
+ * USER.LST mapped into memory along with USER.SEQ, which holds a version
+ * number for each user record.  The version is odd while a record is being
+ * written, readers retry until they see the same even version before and
+ * after copying the record.  Writers are serialized by a lock on USER.SEQ,
+ * which the OS releases if a node dies in the middle of a write.
+ */
+class UserManager::MappedUsers {
+public:
+  MappedUsers(const std::string& datadir, int max_users)
+      : users_path_(FilePath(datadir, USER_LST)), seq_path_(FilePath(datadir, USER_SEQ)),
+        max_users_(max_users) {
+    MapSeq(max_users_);
+    File users(users_path_);
+    if (users.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile)) {
+      users.Close();
+    }
+    Remap();
+  }
+
+  bool initialized() const { return seq_ && users_ && *users_; }
+
+  bool Read(int user_number, userrec& u) {
+    const auto* src = record(user_number, true);
+    if (src == nullptr) {
+      return false;
+    }
+    auto* v = version(user_number);
+    for (int tries = 0; tries < kMaxSeqSpins; tries++) {
+      const auto before = v->load(std::memory_order_acquire);
+      if (!(before & 1)) {
+        memcpy(&u, src, sizeof(userrec));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (v->load(std::memory_order_relaxed) == before) {
+          return true;
+        }
+      }
+      std::this_thread::yield();
+    }
+    // Either a slow writer or one that died mid-write, the caller will read
+    // it from the file.
+    return false;
+  }
+
+  bool Write(int user_number, const userrec& u) {
+    // Before taking the lock, since this may need to grow USER.SEQ.
+    auto* dest = const_cast<uint8_t*>(record(user_number, false));
+    if (dest == nullptr) {
+      return false;
+    }
+    File lock_file(seq_path_);
+    if (!lock_file.Open(File::modeBinary | File::modeReadWrite)) {
+      LOG(ERROR) << "Unable to lock: " << seq_path_;
+      return false;
+    }
+    auto lock = lock_file.lock(FileLockType::write_lock);
+    auto* v = version(user_number);
+    const auto current = v->load(std::memory_order_relaxed);
+    if (current & 1) {
+      // Nobody else can be writing while we hold the lock.
+      LOG(WARNING) << "Repairing interrupted write of user record #" << user_number;
+    }
+    v->store(current | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(dest, &u, sizeof(userrec));
+    v->store((current | 1) + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** Maps USER.LST again if its size has changed. */
+  void Remap() {
+    const auto size = static_cast<size_t>(File(users_path_).length());
+    if (users_ && *users_ && users_->size() == size) {
+      return;
+    }
+    users_ = std::make_unique<MappedFile>(users_path_, MappedFile::Mode::read_write);
+  }
+
+  int num_records() const {
+    return users_ ? static_cast<int>(users_->size() / sizeof(userrec)) - 1 : 0;
+  }
+
+private:
+  // Returns the record for user_number, or nullptr if it or its version
+  // isn't mapped.
+  const uint8_t* record(int user_number, bool remap) {
+    if (user_number < 0 || user_number > max_users_ || !seq_) {
+      return nullptr;
+    }
+    if (static_cast<size_t>(user_number + 1) * sizeof(uint32_t) > seq_->size()) {
+      MapSeq(user_number);
+      if (!seq_) {
+        return nullptr;
+      }
+    }
+    const auto offset = static_cast<size_t>(user_number) * sizeof(userrec);
+    if (remap && (!users_ || offset + sizeof(userrec) > users_->size())) {
+      Remap();
+    }
+    if (!users_ || users_->data() == nullptr || offset + sizeof(userrec) > users_->size()) {
+      return nullptr;
+    }
+    return users_->mutable_data() + offset;
+  }
+
+  // Maps USER.SEQ, first growing it to hold versions up to max_user_number.
+  void MapSeq(int max_user_number) {
+    const auto seq_size = static_cast<off_t>((max_user_number + 1) * sizeof(uint32_t));
+    File seq(seq_path_);
+    if (seq.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile)) {
+      auto lock = seq.lock(FileLockType::write_lock);
+      if (seq.length() < seq_size) {
+        seq.set_length(seq_size);
+      }
+    }
+    seq_ = std::make_unique<MappedFile>(seq_path_, MappedFile::Mode::read_write);
+    if (!*seq_ || seq_->size() < static_cast<size_t>(seq_size)) {
+      LOG(ERROR) << "Unable to map: " << seq_path_;
+      seq_.reset();
+    }
+  }
+
+  std::atomic<uint32_t>* version(int user_number) {
+    return reinterpret_cast<std::atomic<uint32_t>*>(seq_->mutable_data()) + user_number;
+  }
+
+  const std::string users_path_;
+  const std::string seq_path_;
+  const int max_users_;
+  std::unique_ptr<MappedFile> users_;
+  std::unique_ptr<MappedFile> seq_;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 // class UserManager
 
+UserManager::UserManager(const wwiv::sdk::Config& config, bool mapped)
+  : UserManager(config) {
+  if (!mapped) {
+    return;
+  }
+  if (userrec_length_ != static_cast<int>(sizeof(userrec))) {
+    LOG(ERROR) << "Not mapping USER.LST, userreclen is: " << userrec_length_;
+    return;
+  }
+  auto m = std::make_unique<MappedUsers>(data_directory_, max_number_users_);
+  if (m->initialized()) {
+    mapped_users_ = std::move(m);
+  }
+}
+
 UserManager::UserManager(const wwiv::sdk::Config& config)
   : config_(config),
     data_directory_(config.datadir()), 
@@ -101,18 +266,53 @@ bool UserManager::readuser_nocache(User *pUser, int user_number) {
 }
 
 bool UserManager::readuser(User *pUser, int user_number) {
+  if (mapped_users_ && mapped_users_->Read(user_number, pUser->data)) {
+    pUser->FixUp();
+    return true;
+  }
   return this->readuser_nocache(pUser, user_number);
 }
 
-bool UserManager::writeuser_nocache(User *pUser, int user_number) {
-  File userList(FilePath(data_directory_, USER_LST));
-  if (userList.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
-    auto pos = static_cast<long>(userrec_length_) * static_cast<long>(user_number);
-    userList.Seek(pos, File::Whence::begin);
-    userList.Write(&pUser->data, userrec_length_);
-    return true;
+// Runs write, which updates user_number through USER.LST, while holding the
+// USER.SEQ lock with the user's version odd, so nodes that have USER.LST
+// mapped never copy a partially written record.  There is nothing to bump
+// when no node has created USER.SEQ yet.
+static bool write_versioned(const std::string& seq_path, int user_number,
+                            const std::function<bool()>& write) {
+  File seq(seq_path);
+  if (!File::Exists(seq_path) || !seq.Open(File::modeBinary | File::modeReadWrite)) {
+    return write();
+  }
+  auto lock = seq.lock(FileLockType::write_lock);
+  const auto seq_size = static_cast<size_t>(user_number + 1) * sizeof(uint32_t);
+  if (static_cast<size_t>(seq.length()) < seq_size) {
+    seq.set_length(static_cast<off_t>(seq_size));
+  }
+  MappedFile versions(seq_path, MappedFile::Mode::read_write);
+  if (!versions || versions.size() < seq_size) {
+    LOG(ERROR) << "Unable to map: " << seq_path;
+    return write();
   }
-  return false;
+  auto* v = reinterpret_cast<std::atomic<uint32_t>*>(versions.mutable_data()) + user_number;
+  const auto current = v->load(std::memory_order_relaxed);
+  v->store(current | 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  const auto result = write();
+  v->store((current | 1) + 1, std::memory_order_release);
+  return result;
+}
+
+bool UserManager::writeuser_nocache(User *pUser, int user_number) {
+  return write_versioned(FilePath(data_directory_, USER_SEQ), user_number, [&]() {
+    File userList(FilePath(data_directory_, USER_LST));
+    if (userList.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
+      auto pos = static_cast<long>(userrec_length_) * static_cast<long>(user_number);
+      userList.Seek(pos, File::Whence::begin);
+      userList.Write(&pUser->data, userrec_length_);
+      return true;
+    }
+    return false;
+  });
 }
 
 bool UserManager::writeuser(User *pUser, int user_number) {
@@ -120,9 +320,62 @@ bool UserManager::writeuser(User *pUser, int user_number) {
     return true;
   }
 
+  if (mapped_users_) {
+    if (mapped_users_->Write(user_number, pUser->data)) {
+      return true;
+    }
+    // New records are appended to the file, then USER.LST is mapped again.
+    auto result = this->writeuser_nocache(pUser, user_number);
+    mapped_users_->Remap();
+    return result;
+  }
   return this->writeuser_nocache(pUser, user_number);
 }
 
+void UserManager::for_each_user(const std::function<bool(int, User&)>& fn) {
+  User user;
+  if (mapped_users_) {
+    mapped_users_->Remap();
+    const auto num_records = mapped_users_->num_records();
+    for (int i = 1; i <= num_records; i++) {
+      if (!mapped_users_->Read(i, user.data) && !readuser_nocache(&user, i)) {
+        return;
+      }
+      user.FixUp();
+      if (!fn(i, user)) {
+        return;
+      }
+    }
+    return;
+  }
+
+  File userList(FilePath(data_directory_, USER_LST));
+  if (!userList.Open(File::modeReadOnly | File::modeBinary)) {
+    return;
+  }
+  const auto num_records = static_cast<int>(userList.length() / userrec_length_) - 1;
+  // Read the users in large chunks rather than one record at a time.
+  static constexpr int kUsersPerRead = 64;
+  std::vector<char> buffer(static_cast<size_t>(userrec_length_) * kUsersPerRead);
+  userList.Seek(userrec_length_, File::Whence::begin);
+  for (int i = 1; i <= num_records;) {
+    const auto count = std::min(kUsersPerRead, num_records - i + 1);
+    const auto len = static_cast<size_t>(userrec_length_) * count;
+    if (userList.Read(&buffer[0], len) != static_cast<ssize_t>(len)) {
+      return;
+    }
+    for (int n = 0; n < count; n++, i++) {
+      memset(&user.data, 0, sizeof(userrec));
+      memcpy(&user.data, &buffer[static_cast<size_t>(userrec_length_) * n],
+             std::min(sizeof(userrec), static_cast<size_t>(userrec_length_)));
+      user.FixUp();
+      if (!fn(i, user)) {
+        return;
+      }
+    }
+  }
+}
+
 // Deletes a record from NAMES.LST (DeleteSmallRec)
 static void DeleteSmallRecord(StatusMgr& sm, Names& names, const char *name) {
   int found_user = names.FindUser(name);
@@ -22,6 +22,8 @@
 
 #include <sstream>
 #include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
 #include "sdk/config.h"
 #include "sdk/user.h"
@@ -34,11 +36,20 @@ namespace sdk {
  * WWIV User Manager.
  * 
  * Responsible for loading and saving users.
+ *
+ * When created with mapped set to true, USER.LST is memory mapped and shared
+ * between every node using it, so readuser and writeuser become a copy to or
+ * from the mapping.  Each record has a version number in USER.SEQ which a
+ * writer makes odd while it updates the record, so readers on other nodes
+ * never see a partially written user.  The *_nocache methods always go
+ * through the file, and writes through the file (as every UserManager that
+ * isn't mapped does) still bump the version once USER.SEQ exists.
  */
 class UserManager {
  public:
    UserManager() = delete;
    UserManager(const wwiv::sdk::Config& config);
+   UserManager(const wwiv::sdk::Config& config, bool mapped);
    virtual ~UserManager();
    int num_user_records() const;
    bool readuser_nocache(User *pUser, int user_number);
@@ -46,6 +57,15 @@ class UserManager {
    bool writeuser_nocache(User *pUser, int user_number);
    bool writeuser(User *pUser, int user_number);
 
+   /** True if USER.LST is memory mapped. */
+   bool mapped() const noexcept { return mapped_users_ != nullptr; }
+
+   /**
+    * Calls fn for users 1 through num_user_records() in a single pass over
+    * USER.LST.  Iteration stops early if fn returns false.
+    */
+   void for_each_user(const std::function<bool(int user_number, User& user)>& fn);
+
    bool delete_user(int user_number);
    bool restore_user(int user_number);
 
@@ -61,6 +81,7 @@ class UserManager {
   }
 
 private:
+  class MappedUsers;
 
   // ICK.
   const wwiv::sdk::Config& config_;
@@ -68,6 +89,7 @@ private:
   int userrec_length_;
   int max_number_users_;
   bool allow_writes_ = false;
+  std::unique_ptr<MappedUsers> mapped_users_;
 };
 
 }  // namespace sdk
@@ -93,6 +93,8 @@ void serialize(Archive & ar, wwivd_config_t &a) {
   ar(cereal::make_nvp("binkp_cmd", a.binkp_cmd));
   SERIALIZE(a, do_network_callouts);
   SERIALIZE(a, network_callout_cmd);
+  SERIALIZE(a, max_concurrent_callouts);
+  SERIALIZE(a, callout_timeout_minutes);
   SERIALIZE(a, do_beginday_event);
   SERIALIZE(a, beginday_cmd);
 
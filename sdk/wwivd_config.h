@@ -78,6 +78,10 @@ public:
   std::string binkp_cmd;
   bool do_network_callouts{false};
   std::string network_callout_cmd;
+  /** Maximum number of network callouts to run at the same time. */
+  int max_concurrent_callouts{4};
+  /** Callouts running longer than this are killed. */
+  int callout_timeout_minutes{30};
   bool do_beginday_event{true};
   std::string beginday_cmd;
 
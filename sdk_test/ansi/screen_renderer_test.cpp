@@ -0,0 +1,178 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "sdk/ansi/ansi.h"
+#include "sdk/ansi/framebuffer.h"
+#include "sdk/ansi/screen_renderer.h"
+
+using namespace wwiv::sdk::ansi;
+
+class ScreenRendererTest : public testing::Test {
+public:
+  ScreenRendererTest() : term_(kCols), ansi_(&term_, AnsiCallbacks{}, 7), r_(kCols, kRows, kTop) {}
+
+  void Write(int x, int y, const std::string& s, uint8_t a) {
+    for (const auto c : s) {
+      r_.frame().put(y * kCols + x++, c, a);
+    }
+  }
+
+  // Sends the update to the terminal emulator, returning it.
+  std::string Render() {
+    const auto s = r_.Render(term_.curatr());
+    ansi_.write(s);
+    return s;
+  }
+
+  // Checks that the terminal shows what is in the frame.
+  void ExpectTerminalMatches() {
+    for (int y = 0; y < kRows; y++) {
+      for (int x = 0; x < kCols; x++) {
+        const auto want = r_.frame().cell(x, y);
+        const auto got = term_.cell(x, y + kTop);
+        const char wc = want.c() ? want.c() : ' ';
+        const char gc = got.c() ? got.c() : ' ';
+        ASSERT_EQ(wc, gc) << "x: " << x << " y: " << y;
+        if (wc == ' ') {
+          ASSERT_EQ(want.a() & 0x70, got.a() & 0x70) << "x: " << x << " y: " << y;
+        } else {
+          ASSERT_EQ(want.a(), got.a()) << "x: " << x << " y: " << y;
+        }
+      }
+    }
+  }
+
+  static constexpr int kCols = 40;
+  static constexpr int kRows = 10;
+  static constexpr int kTop = 2;
+  FrameBuffer term_;
+  Ansi ansi_;
+  ScreenRenderer r_;
+};
+
+TEST_F(ScreenRendererTest, FirstRender) {
+  Write(0, 0, "Hello", 0x0e);
+  Write(5, 3, "World", 0x1f);
+  Render();
+  ExpectTerminalMatches();
+}
+
+TEST_F(ScreenRendererTest, NothingChanged) {
+  Write(0, 0, "Hello", 0x0e);
+  Render();
+  EXPECT_EQ("", Render());
+}
+
+TEST_F(ScreenRendererTest, OneCell) {
+  r_.MarkCleared();
+  Write(0, 0, "Hello", 7);
+  Render();
+
+  Write(4, 0, "!", 7);
+  EXPECT_EQ("\x1b[3;5H!", Render());
+  ExpectTerminalMatches();
+}
+
+TEST_F(ScreenRendererTest, ShortGapIsRewritten) {
+  r_.MarkCleared();
+  Write(0, 1, "abcdefgh", 7);
+  Render();
+
+  Write(0, 1, "Xbcdefgh", 7);
+  Write(2, 1, "Y", 7);
+  EXPECT_EQ("\x1b[4HXbY", Render());
+  ExpectTerminalMatches();
+}
+
+TEST_F(ScreenRendererTest, LongGapIsSkipped) {
+  r_.MarkCleared();
+  Write(0, 1, "abcdefghijklmnop", 7);
+  Render();
+
+  Write(0, 1, "X", 7);
+  Write(15, 1, "Y", 7);
+  EXPECT_EQ("\x1b[4HX\x1b[14CY", Render());
+  ExpectTerminalMatches();
+}
+
+TEST_F(ScreenRendererTest, ClearToEndOfLine) {
+  r_.MarkCleared();
+  Write(0, 0, std::string(kCols, '#'), 7);
+  Render();
+
+  Write(2, 0, std::string(kCols - 2, ' '), 7);
+  EXPECT_EQ("\x1b[3;3H\x1b[K", Render());
+  ExpectTerminalMatches();
+}
+
+TEST_F(ScreenRendererTest, MovingSelection) {
+  r_.MarkCleared();
+  for (int y = 0; y < kRows; y++) {
+    Write(0, y, std::string(kCols, ' '), 0x07);
+    Write(1, y, "Message title #" + std::to_string(y), y == 2 ? 0x1f : 0x07);
+  }
+  const auto full = Render();
+  ExpectTerminalMatches();
+
+  Write(0, 2, std::string(kCols, ' '), 0x07);
+  Write(1, 2, "Message title #2", 0x07);
+  Write(0, 3, std::string(kCols, ' '), 0x1f);
+  Write(1, 3, "Message title #3", 0x1f);
+  const auto update = Render();
+  ExpectTerminalMatches();
+  EXPECT_LT(update.size(), full.size() / 2);
+}
+
+TEST_F(ScreenRendererTest, Invalidate) {
+  Write(0, 0, "Hello", 0x0e);
+  Render();
+  // Something else drew over the screen.
+  ansi_.write("\x1b[3;1HXXXXXXXX");
+  r_.Invalidate();
+  Render();
+  ExpectTerminalMatches();
+}
+
+TEST_F(ScreenRendererTest, Cursor) {
+  r_.MarkCleared();
+  Write(0, 0, "Hello", 7);
+  r_.cursor(0, 5);
+  Render();
+  EXPECT_EQ(0, term_.x());
+  EXPECT_EQ(5 + kTop, term_.y());
+}
+
+TEST_F(ScreenRendererTest, Random) {
+  const uint8_t attrs[] = {0x07, 0x0f, 0x1f, 0x0e, 0x47, 0x02};
+  srand(1);
+  Render();
+  for (int i = 0; i < 200; i++) {
+    const int num = rand() % 20;
+    for (int j = 0; j < num; j++) {
+      const char c = (rand() % 4 == 0) ? ' ' : static_cast<char>('a' + rand() % 26);
+      r_.frame().put(rand() % (kCols * kRows), c, attrs[rand() % sizeof(attrs)]);
+    }
+    Render();
+    ExpectTerminalMatches();
+  }
+}
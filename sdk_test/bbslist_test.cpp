@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "core/file.h"
+#include "core_test/file_helper.h"
+#include "sdk/bbslist.h"
+#include "sdk/filenames.h"
+
+using std::string;
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+
+class BbsListNetTest : public testing::Test {
+protected:
+  void SetUp() override {
+    helper_.CreateTempFile(BBSLIST_NET, "@1 *111-111-1111 \"One\"\n"
+                                        "@2 *222-222-2222 \"Two\"\n"
+                                        "@3 *333-333-3333 \"Three\"\n");
+    helper_.CreateTempFile(CONNECT_NET, "@1 2=1.0 3=5.0\n"
+                                        "@2 1=1.0 3=1.0\n"
+                                        "@3 1=5.0 2=1.0\n");
+  }
+
+  FileHelper helper_;
+};
+
+TEST_F(BbsListNetTest, Routes) {
+  auto b = BbsListNet::ParseBbsListNet(1, helper_.TempDir());
+  ASSERT_EQ(3u, b.node_config().size());
+
+  const auto* n3 = b.node_config_for(3);
+  ASSERT_NE(nullptr, n3);
+  EXPECT_EQ(2, n3->forsys);
+  EXPECT_EQ(2, n3->numhops);
+  EXPECT_FLOAT_EQ(2.0f, n3->xx.cost);
+  EXPECT_STREQ("Three", n3->name);
+
+  const auto* n1 = b.node_config_for(1);
+  ASSERT_NE(nullptr, n1);
+  EXPECT_EQ(1, n1->forsys);
+  EXPECT_EQ(0, n1->numhops);
+}
+
+TEST_F(BbsListNetTest, RoutingCache) {
+  auto b = BbsListNet::ParseBbsListNet(1, helper_.TempDir());
+  EXPECT_TRUE(File::Exists(helper_.TempDir(), BBSDATA_RTC));
+
+  // Unchanged inputs use the cached routes.
+  auto cached = BbsListNet::ParseBbsListNet(1, helper_.TempDir());
+  ASSERT_EQ(3u, cached.node_config().size());
+  EXPECT_EQ(2, cached.node_config_for(3)->forsys);
+  EXPECT_EQ(2, cached.node_config_for(3)->numhops);
+  EXPECT_STREQ("Three", cached.node_config_for(3)->name);
+
+  // Changing connect.net invalidates the cache.
+  helper_.CreateTempFile(CONNECT_NET, "@1 2=1.0 3=1.0\n"
+                                      "@2 1=1.0 3=1.0\n"
+                                      "@3 1=1.0 2=1.0\n");
+  auto changed = BbsListNet::ParseBbsListNet(1, helper_.TempDir());
+  EXPECT_EQ(3, changed.node_config_for(3)->forsys);
+  EXPECT_EQ(1, changed.node_config_for(3)->numhops);
+}
+
+TEST_F(BbsListNetTest, RoutingCache_DifferentNode) {
+  BbsListNet::ParseBbsListNet(1, helper_.TempDir());
+  auto b = BbsListNet::ParseBbsListNet(3, helper_.TempDir());
+  EXPECT_EQ(2, b.node_config_for(1)->forsys);
+  EXPECT_EQ(3, b.node_config_for(3)->forsys);
+}
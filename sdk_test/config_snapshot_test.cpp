@@ -0,0 +1,214 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/datafile.h"
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/config.h"
+#include "sdk/config_snapshot.h"
+#include "sdk/filenames.h"
+#include "sdk_test/sdk_helper.h"
+
+using namespace std;
+using namespace std::chrono;
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::strings;
+
+class ConfigSnapshotTest : public testing::Test {
+public:
+  ConfigSnapshotTest() : config_(helper.root()) { EXPECT_TRUE(config_.IsInitialized()); }
+
+  template <typename T> void Write(const string& filename, const vector<T>& v) {
+    DataFile<T> file(FilePath(helper.data(), filename),
+                     File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                         File::modeTruncate);
+    ASSERT_TRUE(file);
+    ASSERT_TRUE(file.WriteVector(v));
+  }
+
+  void CreateConfig(int num_subs, int num_dirs) {
+    vector<subboardrec_422_t> subs;
+    for (int i = 0; i < num_subs; i++) {
+      subboardrec_422_t s{};
+      to_char_array(s.name, StrCat("Sub #", i));
+      to_char_array(s.filename, StrCat("SUB", i));
+      s.maxmsgs = static_cast<uint16_t>(50 + i);
+      subs.push_back(s);
+    }
+    Write(SUBS_DAT, subs);
+
+    vector<directoryrec> dirs;
+    for (int i = 0; i < num_dirs; i++) {
+      directoryrec d{};
+      to_char_array(d.name, StrCat("Dir #", i));
+      to_char_array(d.filename, StrCat("DIR", i));
+      d.maxfiles = static_cast<uint16_t>(100 + i);
+      dirs.push_back(d);
+    }
+    Write(DIRS_DAT, dirs);
+
+    chainfilerec c{};
+    to_char_array(c.filename, "chain.exe");
+    Write(CHAINS_DAT, vector<chainfilerec>{c});
+  }
+
+  // The snapshot does not trust files modified in the same second it was
+  // built, so make the files look older.
+  void Age() {
+    for (const auto& name : {SUBS_DAT, DIRS_DAT, CHAINS_DAT}) {
+      File f(FilePath(helper.data(), name));
+      f.set_last_write_time(time(nullptr) - 60);
+    }
+  }
+
+  SdkHelper helper;
+  Config config_;
+};
+
+TEST_F(ConfigSnapshotTest, CompileAndLoad) {
+  CreateConfig(2, 3);
+  Age();
+  ASSERT_TRUE(ConfigSnapshot::Compile(config_));
+
+  ConfigSnapshot snapshot(config_.datadir());
+  EXPECT_TRUE(snapshot.IsCurrent());
+  config_tables_t t;
+  ASSERT_TRUE(snapshot.Load(t));
+
+  ASSERT_EQ(2u, t.subs.size());
+  EXPECT_EQ("Sub #1", t.subs[1].name);
+  EXPECT_EQ("SUB1", t.subs[1].filename);
+  EXPECT_EQ(51, t.subs[1].maxmsgs);
+  ASSERT_EQ(3u, t.dirs.size());
+  EXPECT_STREQ("Dir #2", t.dirs[2].name);
+  EXPECT_EQ(102, t.dirs[2].maxfiles);
+  ASSERT_EQ(1u, t.chains.size());
+  EXPECT_STREQ("chain.exe", t.chains[0].filename);
+  EXPECT_TRUE(t.gfiles.empty());
+  EXPECT_TRUE(t.arcs.empty());
+}
+
+TEST_F(ConfigSnapshotTest, SubsWithNetworks) {
+  CreateConfig(0, 1);
+  Age();
+  config_tables_t t;
+  subboard_t s{};
+  s.name = "Networked";
+  s.filename = "NETSUB";
+  s.nets.push_back({"1234", 1, 2, 3, 4});
+  t.subs.push_back(s);
+  ConfigSnapshot snapshot(config_.datadir());
+  ASSERT_TRUE(snapshot.Save(t, time(nullptr)));
+
+  config_tables_t actual;
+  ASSERT_TRUE(snapshot.Load(actual));
+  ASSERT_EQ(1u, actual.subs.size());
+  ASSERT_EQ(1u, actual.subs[0].nets.size());
+  const auto& n = actual.subs[0].nets[0];
+  EXPECT_EQ("1234", n.stype);
+  EXPECT_EQ(1, n.flags);
+  EXPECT_EQ(2, n.net_num);
+  EXPECT_EQ(3, n.host);
+  EXPECT_EQ(4, n.category);
+}
+
+TEST_F(ConfigSnapshotTest, Stale) {
+  CreateConfig(2, 3);
+  Age();
+  ASSERT_TRUE(ConfigSnapshot::Compile(config_));
+  ConfigSnapshot snapshot(config_.datadir());
+  ASSERT_TRUE(snapshot.IsCurrent());
+
+  // Adding a directory changes the size of dirs.dat.
+  CreateConfig(2, 4);
+  EXPECT_FALSE(snapshot.IsCurrent());
+  config_tables_t t;
+  EXPECT_FALSE(snapshot.Load(t));
+
+  Age();
+  ASSERT_TRUE(ConfigSnapshot::Compile(config_));
+  ASSERT_TRUE(snapshot.Load(t));
+  EXPECT_EQ(4u, t.dirs.size());
+}
+
+TEST_F(ConfigSnapshotTest, ModifiedWhileLoading) {
+  CreateConfig(2, 3);
+  ConfigSnapshot snapshot(config_.datadir());
+  config_tables_t t;
+  ASSERT_TRUE(LoadConfigTables(config_, t));
+  // Sources written in the same second as (or after) loaded_at can't be trusted.
+  ASSERT_TRUE(snapshot.Save(t, time(nullptr) - 1));
+  EXPECT_FALSE(snapshot.IsCurrent());
+}
+
+TEST_F(ConfigSnapshotTest, MissingOrCorrupt) {
+  ConfigSnapshot snapshot(config_.datadir());
+  config_tables_t t;
+  EXPECT_FALSE(snapshot.IsCurrent());
+  EXPECT_FALSE(snapshot.Load(t));
+
+  {
+    File f(snapshot.path());
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile));
+    f.Write("WCSN garbage");
+  }
+  EXPECT_FALSE(snapshot.IsCurrent());
+  EXPECT_FALSE(snapshot.Load(t));
+}
+
+// Compares node startup time for a large configuration with and without the
+// snapshot. This is a benchmark, the times are only reported.
+TEST_F(ConfigSnapshotTest, DISABLED_Benchmark_LargeConfig) {
+  const int kNumSubs = 4000;
+  const int kNumDirs = 4000;
+  const int kIterations = 20;
+  CreateConfig(kNumSubs, kNumDirs);
+  Age();
+  ASSERT_TRUE(ConfigSnapshot::Compile(config_));
+  ConfigSnapshot snapshot(config_.datadir());
+
+  auto start = steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    config_tables_t t;
+    ASSERT_TRUE(LoadConfigTables(config_, t));
+    ASSERT_EQ(static_cast<size_t>(kNumSubs), t.subs.size());
+  }
+  const auto legacy = duration_cast<microseconds>(steady_clock::now() - start) / kIterations;
+
+  start = steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    config_tables_t t;
+    ASSERT_TRUE(snapshot.Load(t));
+    ASSERT_EQ(static_cast<size_t>(kNumSubs), t.subs.size());
+    ASSERT_EQ(static_cast<size_t>(kNumDirs), t.dirs.size());
+  }
+  const auto snap = duration_cast<microseconds>(steady_clock::now() - start) / kIterations;
+
+  cout << "[ BENCHMARK] " << kNumSubs << " subs, " << kNumDirs << " dirs: files "
+       << legacy.count() << "us, snapshot " << snap.count() << "us" << endl;
+}
@@ -0,0 +1,112 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "core_test/file_helper.h"
+#include "sdk/fido/nodelist.h"
+#include "sdk/fido/nodelist_index.h"
+
+using std::string;
+using namespace wwiv::core;
+using namespace wwiv::sdk::fido;
+
+static const char nodelist_text[] = R"(;
+Zone,1,North_America,Slaterville_Springs_NY,Sysop_Name1,1-607-555-1212,9600,CM,INA:filegate.net,IBN
+;
+Host,261,Maryland_Central_Net,NC,Sysop_Name261,-Unpublished-,300,CM,XX,INA:bbs.weather-station.org,IBN:24555
+,1,Weather_Station_Hub,Bel_Air_MD,Sysop_Name261_1,-Unpublished-,300,CM,XX,INA:bbs.weather-station.org,IBN:24555
+,1300,Weather_Station_BBS_(Mystic),Bel_Air_MD,Sysop_Name261_1300,-Unpublished-,300,CM,XX,INA:bbs.weather-station.org,IBN:24557
+,1301,Bark_BBS,Bel_Air_MD,Sysop_Name261_1301,-Unpublished-,300,CM,XB,INA:bark.example.com,IBN
+)";
+
+class NodelistIndexTest : public testing::Test {
+protected:
+  FileHelper helper_;
+};
+
+TEST_F(NodelistIndexTest, Smoke) {
+  helper_.CreateTempFile("NODELIST.123", nodelist_text);
+  auto index = NodelistIndex::Open(helper_.TempDir(), "NODELIST");
+  ASSERT_TRUE(index);
+  ASSERT_TRUE(index->initialized());
+  EXPECT_EQ(3u, index->size());
+  EXPECT_EQ("NODELIST.123", index->nodelist_name());
+  EXPECT_TRUE(File::Exists(helper_.TempDir(), NodelistIndex::IndexFileName("NODELIST")));
+
+  EXPECT_TRUE(index->contains(FidoAddress("1:261/1")));
+  EXPECT_TRUE(index->contains(FidoAddress("1:261/1300")));
+  EXPECT_FALSE(index->contains(FidoAddress("1:261/2")));
+  EXPECT_EQ(nullptr, index->find(2, 261, 1));
+
+  NodelistEntry e{};
+  ASSERT_TRUE(index->entry(FidoAddress("1:261/1300"), e));
+  EXPECT_EQ("Weather Station BBS (Mystic)", e.name_);
+  EXPECT_EQ("Sysop Name261 1300", e.sysop_name_);
+  EXPECT_EQ("Bel Air MD", e.location_);
+  EXPECT_TRUE(e.binkp_);
+  EXPECT_TRUE(e.cm_);
+  EXPECT_FALSE(e.vmodem_);
+  EXPECT_EQ("bbs.weather-station.org", e.binkp_hostname_);
+  EXPECT_EQ(24557, e.binkp_port_);
+  EXPECT_FALSE(e.bark_file_);
+  EXPECT_TRUE(e.wazoo_file_);
+  EXPECT_TRUE(e.wazoo_update_);
+}
+
+TEST_F(NodelistIndexTest, MatchesNodelist) {
+  const auto path = helper_.CreateTempFile("NODELIST.123", nodelist_text);
+  Nodelist nl(path);
+  ASSERT_TRUE(nl);
+  auto index = NodelistIndex::Open(helper_.TempDir(), "NODELIST");
+  ASSERT_TRUE(index);
+
+  ASSERT_EQ(nl.entries().size(), index->size());
+  for (const auto& kv : nl.entries()) {
+    NodelistEntry e{};
+    ASSERT_TRUE(index->entry(kv.first, e)) << kv.first;
+    EXPECT_EQ(kv.second.name_, e.name_);
+    EXPECT_EQ(kv.second.hostname_, e.hostname_);
+    EXPECT_EQ(kv.second.binkp_port_, e.binkp_port_);
+    EXPECT_EQ(kv.second.bark_file_, e.bark_file_);
+    EXPECT_EQ(kv.second.bark_update_, e.bark_update_);
+    EXPECT_EQ(kv.second.wazoo_file_, e.wazoo_file_);
+    EXPECT_EQ(kv.second.wazoo_update_, e.wazoo_update_);
+  }
+}
+
+TEST_F(NodelistIndexTest, RebuildsForNewNodelist) {
+  helper_.CreateTempFile("NODELIST.123", nodelist_text);
+  {
+    auto index = NodelistIndex::Open(helper_.TempDir(), "NODELIST");
+    ASSERT_TRUE(index);
+    EXPECT_FALSE(index->contains(FidoAddress("1:261/2")));
+  }
+
+  helper_.CreateTempFile("NODELIST.130",
+                         wwiv::strings::StrCat(nodelist_text,
+                           ",2,New_Node,Somewhere,Sysop,-Unpublished-,300,CM\n"));
+  auto index = NodelistIndex::Open(helper_.TempDir(), "NODELIST");
+  ASSERT_TRUE(index);
+  EXPECT_EQ("NODELIST.130", index->nodelist_name());
+  EXPECT_TRUE(index->contains(FidoAddress("1:261/2")));
+}
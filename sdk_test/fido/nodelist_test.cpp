@@ -72,6 +72,23 @@ TEST(NodelistTest, Zone) {
   EXPECT_EQ(e.keyword_, NodelistKeyword::zone);
 }
 
+TEST(NodelistTest, XFlags) {
+  NodelistEntry xa{};
+  ASSERT_TRUE(NodelistEntry::ParseDataLine(",1,name,location,sysop,phone,300,CM,XA", xa));
+  EXPECT_TRUE(xa.bark_file_);
+  EXPECT_TRUE(xa.bark_update_);
+  EXPECT_TRUE(xa.wazoo_file_);
+  EXPECT_TRUE(xa.wazoo_update_);
+
+  NodelistEntry xr{};
+  ASSERT_TRUE(NodelistEntry::ParseDataLine(",1,name,location,sysop,phone,300,XR,CM", xr));
+  EXPECT_TRUE(xr.bark_file_);
+  EXPECT_FALSE(xr.bark_update_);
+  EXPECT_TRUE(xr.wazoo_file_);
+  EXPECT_FALSE(xr.wazoo_update_);
+  EXPECT_TRUE(xr.cm_);
+}
+
 TEST(NodelistTest, Smoke) {
   std::vector<std::string> lines = SplitString(raw, "\n");
 
@@ -0,0 +1,130 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/files/ext_desc.h"
+#include "sdk_test/sdk_helper.h"
+
+using namespace std;
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::files;
+using namespace wwiv::strings;
+
+class ExtendedDescriptionsTest : public testing::Test {
+public:
+  ExtendedDescriptionsTest() : path_(FilePath(helper.data(), "dloads.ext")) {}
+
+  SdkHelper helper;
+  const string path_;
+};
+
+TEST_F(ExtendedDescriptionsTest, AddRead) {
+  ExtendedDescriptions ed(path_);
+  EXPECT_EQ(FilePath(helper.data(), "dloads.exi"), ed.index_filename());
+  ASSERT_TRUE(ed.Add("FOO     .ZIP", "foo desc"));
+  ASSERT_TRUE(ed.Add("BAR     .ZIP", "bar desc"));
+  EXPECT_TRUE(File::Exists(ed.index_filename()));
+
+  string s;
+  ASSERT_TRUE(ed.Read("BAR     .ZIP", &s));
+  EXPECT_EQ("bar desc", s);
+  EXPECT_FALSE(ed.Read("NONE    .ZIP", &s));
+  EXPECT_EQ(2, ed.size());
+  EXPECT_EQ(0, ed.rebuilds());
+}
+
+TEST_F(ExtendedDescriptionsTest, UsesSavedIndex) {
+  {
+    ExtendedDescriptions ed(path_);
+    ASSERT_TRUE(ed.Add("FOO     .ZIP", "foo desc"));
+  }
+  ExtendedDescriptions ed(path_);
+  string s;
+  ASSERT_TRUE(ed.Read("FOO     .ZIP", &s));
+  EXPECT_EQ("foo desc", s);
+  EXPECT_EQ(0, ed.rebuilds());
+}
+
+TEST_F(ExtendedDescriptionsTest, AddKeepsOtherNodesDescriptions) {
+  ExtendedDescriptions a(path_);
+  ExtendedDescriptions b(path_);
+  ASSERT_TRUE(a.Add("FOO     .ZIP", "foo desc"));
+  ASSERT_TRUE(b.Add("BAR     .ZIP", "bar desc"));
+  ASSERT_TRUE(a.Add("BAZ     .ZIP", "baz desc"));
+
+  ExtendedDescriptions ed(path_);
+  string s;
+  ASSERT_TRUE(ed.Read("BAR     .ZIP", &s));
+  EXPECT_EQ("bar desc", s);
+  EXPECT_EQ(3, ed.size());
+  EXPECT_EQ(0, ed.rebuilds());
+}
+
+TEST_F(ExtendedDescriptionsTest, RebuildsMissingIndex) {
+  {
+    ExtendedDescriptions ed(path_);
+    ASSERT_TRUE(ed.Add("FOO     .ZIP", "foo desc"));
+    ASSERT_TRUE(ed.Add("FOO     .ZIP", "second"));
+    File::Remove(ed.index_filename());
+  }
+  ExtendedDescriptions ed(path_);
+  string s;
+  ASSERT_TRUE(ed.Read("FOO     .ZIP", &s));
+  // The first description wins.
+  EXPECT_EQ("foo desc", s);
+  EXPECT_EQ(1, ed.rebuilds());
+  EXPECT_TRUE(File::Exists(ed.index_filename()));
+}
+
+TEST_F(ExtendedDescriptionsTest, Remove) {
+  ExtendedDescriptions ed(path_);
+  ASSERT_TRUE(ed.Add("A       .ZIP", "a"));
+  ASSERT_TRUE(ed.Add("B       .ZIP", "b"));
+  ASSERT_TRUE(ed.Add("C       .ZIP", "c"));
+  ASSERT_TRUE(ed.Remove("B       .ZIP"));
+
+  string s;
+  EXPECT_FALSE(ed.Read("B       .ZIP", &s));
+  ASSERT_TRUE(ed.Read("C       .ZIP", &s));
+  EXPECT_EQ("c", s);
+  EXPECT_EQ(2, ed.size());
+
+  ExtendedDescriptions other(path_);
+  ASSERT_TRUE(other.Read("C       .ZIP", &s));
+  EXPECT_EQ("c", s);
+}
+
+TEST_F(ExtendedDescriptionsTest, BatchRead) {
+  ExtendedDescriptions ed(path_);
+  for (int i = 0; i < 50; i++) {
+    ASSERT_TRUE(ed.Add(StrCat("F", i, ".ZIP"), StrCat("desc ", i)));
+  }
+  auto m = ed.Read(vector<string>{"F3.ZIP", "F40.ZIP", "MISSING", "F17.ZIP"});
+  ASSERT_EQ(3u, m.size());
+  EXPECT_EQ("desc 3", m["F3.ZIP"]);
+  EXPECT_EQ("desc 17", m["F17.ZIP"]);
+  EXPECT_EQ("desc 40", m["F40.ZIP"]);
+}
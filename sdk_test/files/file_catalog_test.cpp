@@ -0,0 +1,119 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/files/file_catalog.h"
+#include "sdk/vardec.h"
+#include "sdk_test/sdk_helper.h"
+
+using namespace std;
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::files;
+using namespace wwiv::strings;
+
+class FileCatalogTest : public testing::Test {
+public:
+  static uploadsrec file(const string& name, const string& desc, daten_t daten) {
+    uploadsrec u{};
+    to_char_array(u.filename, name);
+    to_char_array(u.description, desc);
+    u.daten = daten;
+    return u;
+  }
+
+  void WriteArea(const string& area, const vector<uploadsrec>& files) {
+    uploadsrec marker{};
+    to_char_array(marker.filename, "|MARKER|");
+    marker.numbytes = static_cast<daten_t>(files.size());
+    File f(FilePath(helper.data(), StrCat(area, ".dir")));
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite |
+                       File::modeTruncate));
+    f.Write(&marker, sizeof(uploadsrec));
+    for (const auto& u : files) {
+      f.Write(&u, sizeof(uploadsrec));
+    }
+  }
+
+  SdkHelper helper;
+};
+
+TEST_F(FileCatalogTest, WildcardMatch) {
+  EXPECT_TRUE(aligned_wildcard_match("FOO     .ZIP", "FOO     .ZIP"));
+  EXPECT_TRUE(aligned_wildcard_match("F???????.ZIP", "FOO     .ZIP"));
+  EXPECT_TRUE(aligned_wildcard_match("????????.???", "BAR     .TXT"));
+  EXPECT_FALSE(aligned_wildcard_match("F???????.ZIP", "BAR     .ZIP"));
+}
+
+TEST_F(FileCatalogTest, Area) {
+  WriteArea("one", {file("A       .ZIP", "first", 1), file("B       .ZIP", "second", 2)});
+  FileCatalog catalog(helper.data());
+
+  auto files = catalog.area("one");
+  ASSERT_EQ(2u, files->size());
+  EXPECT_STREQ("B       .ZIP", files->at(1).filename);
+  EXPECT_TRUE(catalog.area("missing")->empty());
+}
+
+TEST_F(FileCatalogTest, ReloadsChangedArea) {
+  WriteArea("one", {file("A       .ZIP", "first", 1)});
+  FileCatalog catalog(helper.data());
+  ASSERT_EQ(1u, catalog.area("one")->size());
+
+  WriteArea("one", {file("A       .ZIP", "first", 1), file("B       .ZIP", "second", 2)});
+  EXPECT_EQ(2u, catalog.area("one")->size());
+
+  catalog.Invalidate("one");
+  const auto loads = catalog.loads();
+  EXPECT_EQ(2u, catalog.area("one")->size());
+  EXPECT_EQ(loads + 1, catalog.loads());
+}
+
+TEST_F(FileCatalogTest, Search) {
+  WriteArea("one", {file("A       .ZIP", "Door game", 10), file("B       .TXT", "Readme", 20)});
+  WriteArea("two", {file("C       .ZIP", "Another door", 30)});
+  WriteArea("three", {});
+  FileCatalog catalog(helper.data());
+  const vector<string> areas{"one", "two", "three"};
+
+  catalog_query_t zips;
+  zips.filemask = "????????.ZIP";
+  auto m = catalog.Search(areas, zips, 4);
+  ASSERT_EQ(2u, m.size());
+  EXPECT_EQ(0, m[0].area);
+  EXPECT_EQ(1, m[0].record);
+  EXPECT_EQ(1, m[1].area);
+  EXPECT_STREQ("C       .ZIP", m[1].u.filename);
+
+  catalog_query_t door;
+  door.text = "DOOR";
+  door.since = 15;
+  m = catalog.Search(areas, door, 1);
+  ASSERT_EQ(1u, m.size());
+  EXPECT_STREQ("C       .ZIP", m[0].u.filename);
+
+  auto a = catalog.AreasWithMatches(areas, [](const uploadsrec& u) { return u.daten >= 20; });
+  EXPECT_EQ((vector<int>{0, 1}), a);
+}
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/file.h"
 #include "core/strings.h"
@@ -29,6 +30,7 @@
 #include "sdk/msgapi/message_api_wwiv.h"
 #include "sdk/msgapi/msgapi.h"
 #include "sdk/networks.h"
+#include "sdk/status.h"
 #include "sdk_test/sdk_helper.h"
 
 using namespace std;
@@ -164,3 +166,27 @@ TEST_F(MsgApiTest, Resynch_MessageNumber) {
   a2->ResyncMessage(msgnum);
   EXPECT_EQ(1, msgnum);
 }
+
+TEST_F(MsgApiTest, AddMessage_SharesQScanWithStatusMgr) {
+  subboard_t sub{};
+  sub.filename = "a1";
+  ASSERT_TRUE(api->Create(sub, -1));
+  unique_ptr<MessageArea> area(api->Open(sub, -1));
+  // Like a BBS node posting while network2 imports messages.
+  StatusMgr node(helper.data(), [](int) {});
+  ASSERT_TRUE(node.shared());
+
+  std::vector<uint32_t> qscans;
+  for (int i = 0; i < 5; i++) {
+    unique_ptr<Message> m(CreateMessage(*area, 1, "From", StrCat("Title", i), "Text\r\n"));
+    EXPECT_TRUE(area->AddMessage(*m, {}));
+    qscans.push_back(area->ReadMessageHeader(area->number_of_messages())->last_read());
+    qscans.push_back(node.Increment(StatusCounter::qscan_pointer));
+  }
+  // Each message checkpoints STATUS.DAT; the node's increments since then
+  // must survive it.
+  EXPECT_EQ(12u, node.GetStatus()->GetQScanPointer());
+  for (size_t i = 1; i < qscans.size(); i++) {
+    EXPECT_LT(qscans[i - 1], qscans[i]) << "at " << i;
+  }
+}
@@ -144,4 +144,20 @@ TEST_F(CalloutsTest, ShouldCall_CallAnyay_MinKNotMet) {
   ncn_.set_bytes_waiting(8 * 1024);
 
   EXPECT_FALSE(should_call(ncn_, c_, dt_));
-}
\ No newline at end of file
+}
+TEST_F(CalloutsTest, NextAllowedToCall) {
+  EXPECT_EQ(t_, next_allowed_to_call(c_, dt_));
+
+  // dt_ is 06:01, so 08:00 is the next allowed time.
+  c_.min_hr = 8;
+  c_.max_hr = 10;
+  EXPECT_EQ(to_time_t(0, 1, 8, 0), next_allowed_to_call(c_, dt_));
+
+  // Tomorrow at 05:00.
+  c_.min_hr = 5;
+  c_.max_hr = 6;
+  EXPECT_EQ(to_time_t(0, 2, 5, 0), next_allowed_to_call(c_, dt_));
+
+  c_.options = options_no_call;
+  EXPECT_EQ(0, next_allowed_to_call(c_, dt_));
+}
@@ -16,10 +16,13 @@
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
 #include "core/datetime.h"
+#include "core/file.h"
 #include "core/strings.h"
+#include "core/textfile.h"
 #include "core_test/file_helper.h"
 #include "networkb/net_util.h"
 #include "sdk/net/packets.h"
+#include "sdk/subxtr.h"
 #include "gtest/gtest.h"
 
 #include <cstdint>
@@ -55,6 +58,45 @@ public:
   PacketsTest() {}
 
 protected:
+  net_networks_rec CreateNet(const string& name, uint16_t sysnum) {
+    helper_.Mkdir(name);
+    net_networks_rec net{};
+    net.dir = File::EnsureTrailingSlash(helper_.DirName(name));
+    to_char_array(net.name, name);
+    net.sysnum = sysnum;
+    net.type = network_type_t::wwivnet;
+    return net;
+  }
+
+  Packet CreatePost(const string& subtype, uint16_t fromsys, const string& body) {
+    auto text = CreateFakePacketText(subtype, "title", "Sysop #1", "date", body);
+    net_header_rec nh{};
+    nh.fromsys = fromsys;
+    nh.fromuser = 1;
+    nh.main_type = main_type_new_post;
+    nh.length = text.size();
+    return Packet(nh, {}, text);
+  }
+
+  // Returns all packets in the only pending file in dir.
+  std::vector<Packet> ReadPendingPackets(const string& dir) {
+    std::vector<Packet> packets;
+    int num_files = 0;
+    for (int i = 0; i < 10; i++) {
+      File f(FilePath(dir, StrCat("p1-2-", i, ".net")));
+      if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+        continue;
+      }
+      ++num_files;
+      Packet p;
+      while (read_packet(f, p, false) == ReadPacketResponse::OK) {
+        packets.push_back(p);
+      }
+    }
+    EXPECT_EQ(1, num_files);
+    return packets;
+  }
+
   FileHelper helper_;
 };
 
@@ -176,3 +218,106 @@ TEST_F(PacketsTest, FromPacketText_Malformed) {
   EXPECT_EQ(pp.sender(), "");
   EXPECT_EQ(pp.date(), "");
 }
+
+TEST_F(PacketsTest, PacketFanout_OnePendingFilePerNetwork) {
+  const auto net1 = CreateNet("net1", 1);
+  const auto net2 = CreateNet("net2", 1);
+  PacketFanout fanout;
+  for (const auto& body : {"a", "bb", "ccc"}) {
+    auto p = CreatePost("SUB", 2, body);
+    ASSERT_TRUE(fanout.Add(net1, p.nh, {}, p.text()));
+  }
+  auto p = CreatePost("SUB2", 3, "d");
+  p.nh.list_len = 2;
+  ASSERT_TRUE(fanout.Add(net2, p.nh, {4, 5}, p.text()));
+  EXPECT_EQ(4, fanout.pending());
+
+  ASSERT_TRUE(fanout.Flush());
+  EXPECT_EQ(0, fanout.pending());
+
+  auto packets1 = ReadPendingPackets(net1.dir);
+  ASSERT_EQ(3u, packets1.size());
+  EXPECT_EQ(CreatePost("SUB", 2, "a").text(), packets1[0].text());
+  EXPECT_EQ(CreatePost("SUB", 2, "ccc").text(), packets1[2].text());
+
+  auto packets2 = ReadPendingPackets(net2.dir);
+  ASSERT_EQ(1u, packets2.size());
+  EXPECT_EQ(std::vector<uint16_t>({4, 5}), packets2[0].list);
+}
+
+TEST_F(PacketsTest, PacketFanout_MismatchedHeader) {
+  const auto net = CreateNet("net1", 1);
+  PacketFanout fanout;
+  auto p = CreatePost("SUB", 2, "a");
+  p.nh.length++;
+  EXPECT_FALSE(fanout.Add(net, p.nh, {}, p.text()));
+  p.nh.length--;
+  EXPECT_FALSE(fanout.Add(net, p.nh, {4}, p.text()));
+  EXPECT_EQ(0, fanout.pending());
+}
+
+TEST_F(PacketsTest, SendPostToSubscribers_Hosted) {
+  const auto net = CreateNet("net1", 1);
+  {
+    TextFile subs(FilePath(net.dir, "nSUB.net"), "wt");
+    subs.WriteLine("2");
+    subs.WriteLine("3");
+    subs.WriteLine("4");
+    subs.WriteLine("5");
+  }
+  subboard_t sub{};
+  subboard_network_data_t subnet{};
+  subnet.stype = "SUB";
+  subnet.net_num = 0;
+  subnet.host = 0;
+  sub.nets.push_back(subnet);
+  // Gated to a sub with a different subtype.
+  const auto gated = CreateNet("net2", 7);
+  subnet.stype = "GATED";
+  subnet.net_num = 1;
+  subnet.host = 9;
+  sub.nets.push_back(subnet);
+  const std::vector<net_networks_rec> nets{net, gated};
+
+  PacketFanout fanout;
+  for (const auto& body : {"a", "b"}) {
+    auto p = CreatePost("SUB", 2, body);
+    ASSERT_TRUE(send_post_to_subscribers(nets, 0, "SUB", sub, p, {3},
+                                         subscribers_send_to_t::hosted_and_gated_only, fanout));
+  }
+  ASSERT_TRUE(fanout.Flush());
+
+  auto packets = ReadPendingPackets(net.dir);
+  ASSERT_EQ(2u, packets.size());
+  for (const auto& p : packets) {
+    EXPECT_EQ(0, p.nh.tosys);
+    EXPECT_EQ(std::vector<uint16_t>({4, 5}), p.list);
+  }
+  EXPECT_EQ(CreatePost("SUB", 2, "b").text(), packets[1].text());
+
+  auto gated_packets = ReadPendingPackets(gated.dir);
+  ASSERT_EQ(2u, gated_packets.size());
+  EXPECT_EQ(9, gated_packets[0].nh.tosys);
+  EXPECT_EQ(7, gated_packets[0].nh.fromsys);
+  EXPECT_EQ(CreatePost("GATED", 2, "a").text(), gated_packets[0].text());
+  EXPECT_EQ(gated_packets[0].text().size(), gated_packets[0].nh.length);
+}
+
+TEST_F(PacketsTest, SendPostToSubscribers_AddFails) {
+  const auto net = CreateNet("net1", 1);
+  subboard_t sub{};
+  subboard_network_data_t subnet{};
+  subnet.stype = "SUB";
+  subnet.net_num = 0;
+  subnet.host = 9;
+  sub.nets.push_back(subnet);
+  const std::vector<net_networks_rec> nets{net};
+
+  PacketFanout fanout;
+  auto p = CreatePost("SUB", 2, "a");
+  // Doesn't match the text, so the fanout refuses it.
+  p.nh.length++;
+  EXPECT_FALSE(send_post_to_subscribers(nets, 0, "SUB", sub, p, {},
+                                        subscribers_send_to_t::all_subscribers, fanout));
+  EXPECT_EQ(0, fanout.pending());
+}
@@ -25,11 +25,13 @@
 #include "core/file.h"
 #include "core/strings.h"
 #include "sdk/config.h"
+#include "sdk/filenames.h"
 #include "sdk/qscan.h"
 #include "sdk_test/sdk_helper.h"
 
 using namespace std;
 
+using namespace wwiv::core;
 using namespace wwiv::sdk;
 using namespace wwiv::strings;
 
@@ -114,3 +116,103 @@ TEST_F(QScanTest, BitSet) {
   b.flip(32);
   ASSERT_TRUE(b.test(32));
 }
+
+TEST_F(QScanTest, View) {
+  const auto max_subs = 8;
+  const auto max_dirs = 10;
+  uint32_t q[100];
+  memset(q, 0, sizeof(q));
+  RawUserQScan qscan(&q[0], calculate_qscan_length(max_subs, max_dirs), max_subs, max_dirs, false);
+  ASSERT_EQ(&q[0], qscan.qsc());
+  qscan.subs().set(3);
+  qscan.lastread_pointer(2, 1234);
+  EXPECT_EQ(1u << 3, q[2]);
+  EXPECT_EQ(1234u, q[5]);
+}
+
+TEST_F(QScanTest, AllUserQScan_ReadWrite) {
+  const auto max_subs = 2000;
+  const auto max_dirs = 64;
+  const auto qscn_len = static_cast<int>(calculate_qscan_length(max_subs, max_dirs));
+  const auto fn = FilePath(helper.data(), USER_QSC);
+  AllUserQScan all(fn, qscn_len, max_subs, max_dirs);
+  ASSERT_TRUE(all.IsOpen());
+  EXPECT_EQ(0, all.num_records());
+  EXPECT_FALSE(all.exists(1));
+
+  RawUserQScan q(qscn_len, max_subs, max_dirs);
+  q.lastread_pointer(1999, 42);
+  ASSERT_TRUE(all.write(3, q.qsc()));
+  EXPECT_EQ(4, all.num_records());
+  ASSERT_TRUE(all.flush());
+
+  RawUserQScan r(qscn_len, max_subs, max_dirs);
+  ASSERT_TRUE(all.read(3, r.qsc()));
+  EXPECT_EQ(42u, r.lastread_pointer(1999));
+  EXPECT_EQ(999u, *r.qsc());
+
+  // Views write straight into the file.
+  auto v = all.user(3);
+  v->lastread_pointer(5, 55);
+  all.dirty(3);
+  ASSERT_TRUE(all.flush());
+  {
+    File f(fn);
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeReadOnly));
+    EXPECT_EQ(4 * qscn_len, f.length());
+    RawUserQScan fq(qscn_len, max_subs, max_dirs);
+    f.Seek(3 * qscn_len, File::Whence::begin);
+    f.Read(fq.qsc(), qscn_len);
+    EXPECT_EQ(55u, fq.lastread_pointer(5));
+    EXPECT_EQ(42u, fq.lastread_pointer(1999));
+  }
+
+  // Growing the file keeps earlier views valid.
+  ASSERT_TRUE(all.write(20, q.qsc()));
+  EXPECT_EQ(55u, v->lastread_pointer(5));
+
+  // Another instance sees the same data.
+  AllUserQScan other(fn, qscn_len, max_subs, max_dirs);
+  EXPECT_EQ(21, other.num_records());
+  ASSERT_TRUE(other.read(20, r.qsc()));
+  EXPECT_EQ(42u, r.lastread_pointer(1999));
+}
+
+TEST_F(QScanTest, RewriteQScanFile) {
+  const auto fn = FilePath(helper.data(), USER_QSC);
+  const auto old_len = static_cast<int>(calculate_qscan_length(32, 32));
+  {
+    AllUserQScan all(fn, old_len, 32, 32);
+    for (int i = 0; i < 3; i++) {
+      RawUserQScan q(old_len, 32, 32);
+      *q.qsc() = i;
+      q.subs().reset(1);
+      q.dirs().reset(2);
+      q.lastread_pointer(31, 100 + i);
+      ASSERT_TRUE(all.write(i, q.qsc()));
+    }
+  }
+
+  int count = 0;
+  ASSERT_TRUE(rewrite_qscan_file(fn, 32, 32, 64, 96, [&](int, RawUserQScan&, RawUserQScan& n) {
+    n.lastread_pointer(63, 7);
+    ++count;
+  }));
+  EXPECT_EQ(3, count);
+
+  const auto new_len = static_cast<int>(calculate_qscan_length(64, 96));
+  AllUserQScan all(fn, new_len, 64, 96);
+  ASSERT_EQ(3, all.num_records());
+  for (int i = 0; i < 3; i++) {
+    auto q = all.user(i);
+    EXPECT_EQ(static_cast<uint32_t>(i), *q->qsc());
+    EXPECT_FALSE(q->subs().test(1));
+    EXPECT_TRUE(q->subs().test(2));
+    EXPECT_TRUE(q->subs().test(40));
+    EXPECT_FALSE(q->dirs().test(2));
+    EXPECT_TRUE(q->dirs().test(80));
+    EXPECT_EQ(static_cast<uint32_t>(100 + i), q->lastread_pointer(31));
+    EXPECT_EQ(0u, q->lastread_pointer(32));
+    EXPECT_EQ(7u, q->lastread_pointer(63));
+  }
+}
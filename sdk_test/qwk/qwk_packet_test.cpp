@@ -0,0 +1,266 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/config.h"
+#include "sdk/msgapi/message_api_wwiv.h"
+#include "sdk/msgapi/msgapi.h"
+#include "sdk/msgapi/type2_text.h"
+#include "sdk/qwk/qwk_packet.h"
+#include "sdk/qwk/qwk_prefetch.h"
+#include "sdk_test/sdk_helper.h"
+
+using namespace std;
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::msgapi;
+using namespace wwiv::sdk::qwk;
+using namespace wwiv::strings;
+
+static qwk_record CreateRecord(const string& subject) {
+  qwk_record rec{};
+  memset(&rec, ' ', sizeof(qwk_record));
+  memcpy(rec.subject, subject.data(), subject.size());
+  rec.conf_num = 1;
+  return rec;
+}
+
+TEST(QwkMessagesWriterTest, Blocks) {
+  string out;
+  {
+    QwkMessagesWriter w([&out](const char* d, size_t n) {
+      out.append(d, n);
+      return true;
+    });
+    EXPECT_TRUE(w.Append(CreateRecord("Short"), "Hello\xE3", {"001.NDX"}));
+    EXPECT_TRUE(w.Append(CreateRecord("Long"), string(200, 'x'), {"001.NDX", "PERSONAL.NDX"}));
+    EXPECT_EQ(3, w.next_logical_num());
+    // header, 1 + 1 blocks, then 1 + 2 blocks.
+    EXPECT_EQ(7u, w.next_block());
+    EXPECT_TRUE(out.empty());
+  }
+  ASSERT_EQ(6 * QWK_BLOCK_SIZE, out.size());
+  EXPECT_TRUE(starts_with(out, "Produced by Qmail..."));
+
+  auto first = reinterpret_cast<const qwk_record*>(&out[QWK_BLOCK_SIZE]);
+  EXPECT_EQ("2     ", string(first->amount_blocks, sizeof(first->amount_blocks)));
+  EXPECT_EQ(1, first->logical_num);
+  EXPECT_EQ("Hello\xE3", out.substr(2 * QWK_BLOCK_SIZE, 6));
+
+  auto second = reinterpret_cast<const qwk_record*>(&out[3 * QWK_BLOCK_SIZE]);
+  EXPECT_EQ("3     ", string(second->amount_blocks, sizeof(second->amount_blocks)));
+  EXPECT_EQ(2, second->logical_num);
+  EXPECT_EQ(string(200, 'x') + string(56, ' '), out.substr(4 * QWK_BLOCK_SIZE));
+}
+
+TEST(QwkMessagesWriterTest, Indexes) {
+  QwkMessagesWriter w([](const char*, size_t) { return true; });
+  w.Append(CreateRecord("1"), "a", {"001.NDX"});
+  w.Append(CreateRecord("2"), "b", {"001.NDX", "PERSONAL.NDX"});
+  w.Append(CreateRecord("3"), "c", {"002.NDX"});
+
+  const auto& ndx = w.indexes();
+  ASSERT_EQ(3u, ndx.size());
+  EXPECT_EQ(2 * sizeof(qwk_index), ndx.at("001.NDX").size());
+  EXPECT_EQ(sizeof(qwk_index), ndx.at("PERSONAL.NDX").size());
+
+  // Message 2 starts at block 4, 4.0 in MBF is 0x83000000.
+  auto pos = reinterpret_cast<const qwk_index*>(ndx.at("PERSONAL.NDX").data())->pos;
+  uint32_t bits;
+  memcpy(&bits, &pos, sizeof(bits));
+  EXPECT_EQ(0x83000000u, bits);
+}
+
+TEST(QwkMessagesWriterTest, LargeWrites) {
+  std::vector<size_t> writes;
+  QwkMessagesWriter w(
+      [&writes](const char*, size_t n) {
+        writes.push_back(n);
+        return true;
+      },
+      4096);
+  for (int i = 0; i < 100; i++) {
+    w.Append(CreateRecord("x"), string(300, 'x'), {"001.NDX"});
+  }
+  w.Flush();
+  ASSERT_FALSE(writes.empty());
+  EXPECT_LT(writes.size(), 20u);
+  for (size_t i = 0; i + 1 < writes.size(); i++) {
+    EXPECT_GE(writes[i], 4096u);
+  }
+}
+
+TEST(ToQwkMessageTest, Post) {
+  const string raw = "Rushfan #1 @1\r\nWed Jan 01 00:00:00 2020\r\n"
+                     "\x04" "0R 1\r\n\x04" "1Kludge\r\nHello \x03" "1World\r\nBye\r\n";
+  qwk_message_info_t info;
+  info.msgnum = 12;
+  info.daten = 915192000;
+  info.ownersys = 1;
+  info.to = "all";
+  info.subject = "\x03" "1Subject";
+  info.conf_num = 3;
+  qwk_text_options_t options;
+  options.remove_color = true;
+
+  qwk_record rec{};
+  string text;
+  ASSERT_TRUE(ToQwkMessage(raw, info, options, rec, text));
+  EXPECT_EQ("QWKFrom:Rushfan #1 @1\xE3\xE3Kludge\xE3Hello World\xE3" "Bye\xE3", text.substr(2));
+  EXPECT_EQ(string("\x04" "0"), text.substr(0, 2));
+  EXPECT_EQ("12     ", string(rec.msgnum, sizeof(rec.msgnum)));
+  EXPECT_EQ("ALL", string(rec.to, 3));
+  EXPECT_EQ("RUSHFAN #1 @1", string(rec.from, 13));
+  EXPECT_EQ("Subject  ", string(rec.subject, 9));
+  EXPECT_EQ(3, rec.conf_num);
+}
+
+TEST(ToQwkMessageTest, KeepRouting) {
+  const string raw = "Rushfan #1\r\ndate\r\n\x04" "0R 1\r\nHi\r\n";
+  qwk_message_info_t info;
+  info.ownersys = 2;
+  qwk_text_options_t options;
+  options.keep_routing = true;
+
+  qwk_record rec{};
+  string text;
+  ASSERT_TRUE(ToQwkMessage(raw, info, options, rec, text));
+  EXPECT_EQ("\x04" "0R 1\xE3\x04" "0QWKFrom:Rushfan #1@2\xE3\xE3Hi\xE3", text);
+}
+
+TEST(ToQwkMessageTest, NoText) {
+  qwk_record rec{};
+  string text;
+  EXPECT_FALSE(ToQwkMessage("Rushfan #1\r\ndate\r", {}, {}, rec, text));
+}
+
+class QwkSubPrefetcherTest : public testing::Test {
+public:
+  void SetUp() override {
+    MessageApiOptions options;
+    options.overflow_strategy = OverflowStrategy::delete_none;
+    config = make_unique<Config>(helper.root());
+    api.reset(new WWIVMessageApi(options, *config, {}, new NullLastReadImpl()));
+  }
+
+  void CreateSub(const string& name, int num) {
+    subboard_t sub{};
+    sub.filename = name;
+    sub.maxmsgs = 100;
+    ASSERT_TRUE(api->Create(sub, -1));
+    unique_ptr<MessageArea> area(api->Open(sub, -1));
+    for (int i = 1; i <= num; i++) {
+      unique_ptr<Message> msg(area->CreateMessage());
+      msg->header().set_from("From");
+      msg->header().set_to("To");
+      msg->header().set_title(StrCat("Title", i));
+      msg->header().set_daten(915192000 + i);
+      msg->text().set_text(StrCat(name, " message ", i, "\r\n", string(600, 'x')));
+      ASSERT_TRUE(area->AddMessage(*msg, {}));
+    }
+  }
+
+  SdkHelper helper;
+  unique_ptr<MessageApi> api;
+  unique_ptr<Config> config;
+};
+
+TEST_F(QwkSubPrefetcherTest, Read) {
+  CreateSub("a1", 3);
+  auto all = QwkSubPrefetcher::Read(helper.data(), helper.msgs(), {"a1", 0, 0});
+  ASSERT_TRUE(all->ok);
+  EXPECT_EQ(3, all->num_messages);
+  ASSERT_EQ(3u, all->messages.size());
+  EXPECT_NE(string::npos, all->messages[2].text.find("a1 message 3"));
+  Type2Text type2(FilePath(helper.msgs(), "a1.dat"));
+  string expected;
+  ASSERT_TRUE(type2.readfile(&all->messages[2].header.msg, &expected));
+  EXPECT_EQ(expected, all->messages[2].text);
+
+  // Only messages newer than the first.
+  const auto q = all->messages[0].header.qscan;
+  auto newer = QwkSubPrefetcher::Read(helper.data(), helper.msgs(), {"a1", q, 0});
+  ASSERT_EQ(2u, newer->messages.size());
+  EXPECT_EQ(2, newer->messages[0].msgnum);
+  EXPECT_EQ(nullptr, newer->text(q));
+  ASSERT_NE(nullptr, newer->text(all->messages[1].header.qscan));
+  EXPECT_EQ(all->messages[1].text, *newer->text(all->messages[1].header.qscan));
+
+  auto limited = QwkSubPrefetcher::Read(helper.data(), helper.msgs(), {"a1", 0, 1});
+  EXPECT_EQ(1u, limited->messages.size());
+
+  auto missing = QwkSubPrefetcher::Read(helper.data(), helper.msgs(), {"nope", 0, 0});
+  EXPECT_FALSE(missing->ok);
+}
+
+TEST_F(QwkSubPrefetcherTest, InOrder) {
+  vector<qwk_prefetch_request_t> requests;
+  for (int i = 1; i <= 6; i++) {
+    const auto name = StrCat("s", i);
+    CreateSub(name, i);
+    requests.push_back({name, 0, 0});
+  }
+  QwkSubPrefetcher prefetcher(helper.data(), helper.msgs(), requests, 2);
+  for (int i = 1; i <= 6; i++) {
+    auto sub = prefetcher.Next();
+    ASSERT_TRUE(sub);
+    EXPECT_EQ(StrCat("s", i), sub->request.filename);
+    EXPECT_EQ(static_cast<size_t>(i), sub->messages.size());
+  }
+  EXPECT_FALSE(prefetcher.Next());
+}
+
+TEST_F(QwkSubPrefetcherTest, Cancel) {
+  CreateSub("a1", 1);
+  vector<qwk_prefetch_request_t> requests(10, {"a1", 0, 0});
+  QwkSubPrefetcher prefetcher(helper.data(), helper.msgs(), requests, 1);
+  EXPECT_TRUE(prefetcher.Next());
+  prefetcher.Cancel();
+}
+
+TEST_F(QwkSubPrefetcherTest, Type2TextKeepOpen) {
+  CreateSub("a1", 3);
+  auto all = QwkSubPrefetcher::Read(helper.data(), helper.msgs(), {"a1", 0, 0});
+  ASSERT_EQ(3u, all->messages.size());
+
+  Type2Text type2(FilePath(helper.msgs(), "a1.dat"));
+  ASSERT_TRUE(type2.keep_open_for_read());
+  for (const auto& m : all->messages) {
+    string text;
+    ASSERT_TRUE(type2.readfile(&m.header.msg, &text));
+    EXPECT_EQ(m.text, text);
+  }
+
+  // Writing closes the file kept open for reading rather than waiting on it.
+  messagerec msg{};
+  msg.storage_type = 2;
+  string saved("New text\x1a");
+  saved.resize(MSG_BLOCK_SIZE, ' ');
+  ASSERT_TRUE(type2.savefile(saved, &msg));
+  string text;
+  ASSERT_TRUE(type2.readfile(&msg, &text));
+  EXPECT_EQ("New text", text);
+}
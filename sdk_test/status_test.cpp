@@ -0,0 +1,200 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "core/file.h"
+#include "sdk/filenames.h"
+#include "sdk/status.h"
+#include "sdk/vardec.h"
+#include "sdk_test/sdk_helper.h"
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+
+class StatusTest : public testing::Test {
+public:
+  statusrec_t ReadStatusDat() {
+    statusrec_t s{};
+    File f(FilePath(helper.data(), STATUS_DAT));
+    EXPECT_TRUE(f.Open(File::modeReadOnly | File::modeBinary));
+    f.Read(&s, sizeof(statusrec_t));
+    return s;
+  }
+
+  SdkHelper helper;
+};
+
+TEST_F(StatusTest, Increment_SharedBetweenManagers) {
+  StatusMgr a(helper.data(), [](int) {});
+  StatusMgr b(helper.data(), [](int) {});
+  ASSERT_TRUE(a.shared());
+  ASSERT_TRUE(File::Exists(FilePath(helper.data(), STATUS_SHM)));
+
+  EXPECT_EQ(0u, a.Increment(StatusCounter::posts_today));
+  EXPECT_EQ(1u, b.Increment(StatusCounter::posts_today));
+  EXPECT_EQ(2, a.GetStatus()->GetNumMessagesPostedToday());
+
+  // Counters only reach STATUS.DAT on a checkpoint.
+  EXPECT_EQ(0, ReadStatusDat().msgposttoday);
+  EXPECT_TRUE(b.Checkpoint());
+  EXPECT_EQ(2, ReadStatusDat().msgposttoday);
+}
+
+TEST_F(StatusTest, Increment_ReturnsPrevious) {
+  StatusMgr sm(helper.data(), [](int) {});
+  // SdkHelper starts qscanptr at 2.
+  EXPECT_EQ(2u, sm.Increment(StatusCounter::qscan_pointer));
+  EXPECT_EQ(3u, sm.Increment(StatusCounter::qscan_pointer));
+  EXPECT_EQ(4u, sm.GetStatus()->GetQScanPointer());
+}
+
+TEST_F(StatusTest, Transaction_KeepsConcurrentIncrements) {
+  StatusMgr a(helper.data(), [](int) {});
+  StatusMgr b(helper.data(), [](int) {});
+
+  auto status = a.BeginTransaction();
+  status->IncrementNumCallsToday();
+  status->SetNumUsers(10);
+  // Another node logs on in the middle of the transaction.
+  b.Increment(StatusCounter::calls_today);
+  EXPECT_TRUE(a.CommitTransaction(std::move(status)));
+
+  auto s = ReadStatusDat();
+  EXPECT_EQ(2, s.callstoday);
+  EXPECT_EQ(10, s.users);
+}
+
+TEST_F(StatusTest, Transaction_WaitsForOtherTransaction) {
+  StatusMgr a(helper.data(), [](int) {});
+  ASSERT_TRUE(a.shared());
+  auto status = a.BeginTransaction();
+
+  std::atomic<bool> done{false};
+  std::thread other([&] {
+    StatusMgr b(helper.data(), [](int) {});
+    b.Run([](WStatus& s) { s.SetNumUsers(s.GetNumUsers() + 1); });
+    done.store(true);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(done.load());
+
+  status->SetNumUsers(10);
+  EXPECT_TRUE(a.CommitTransaction(std::move(status)));
+  other.join();
+  EXPECT_EQ(11, ReadStatusDat().users);
+}
+
+TEST_F(StatusTest, Transaction_NestedDoesNotWait) {
+  StatusMgr a(helper.data(), [](int) {});
+  StatusMgr b(helper.data(), [](int) {});
+  ASSERT_TRUE(a.shared());
+  auto status = a.BeginTransaction();
+  status->IncrementNumCallsToday();
+  // Would never finish if it waited on the transaction above.
+  b.Run([](WStatus& s) { s.IncrementNumUploadsToday(); });
+  EXPECT_TRUE(a.CommitTransaction(std::move(status)));
+
+  auto s = ReadStatusDat();
+  EXPECT_EQ(1, s.callstoday);
+  EXPECT_EQ(1, s.uptoday);
+}
+
+TEST_F(StatusTest, Transaction_NewDayResetsCounters) {
+  StatusMgr sm(helper.data(), [](int) {});
+  sm.Increment(StatusCounter::uploads_today, 3);
+  sm.Run([](WStatus& s) { s.NewDay(); });
+  EXPECT_EQ(0, sm.GetStatus()->GetNumUploadsToday());
+  EXPECT_EQ(0, ReadStatusDat().uptoday);
+}
+
+TEST_F(StatusTest, Destructor_Checkpoints) {
+  {
+    StatusMgr sm(helper.data(), [](int) {});
+    sm.Increment(StatusCounter::email_today);
+  }
+  EXPECT_EQ(1, ReadStatusDat().emailtoday);
+}
+
+TEST_F(StatusTest, FileChangedFlag_InvokesCallback) {
+  int changed = -1;
+  StatusMgr reader(helper.data(), [&](int i) { changed = i; });
+  StatusMgr writer(helper.data(), [](int) {});
+  reader.RefreshStatusCache();
+  changed = -1;
+
+  writer.IncrementFileChangedFlag(WStatus::fileChangePosts);
+  reader.RefreshStatusCache();
+  EXPECT_EQ(WStatus::fileChangePosts, changed);
+}
+
+TEST_F(StatusTest, StatusDatChangedOutside_Reloads) {
+  {
+    StatusMgr sm(helper.data(), [](int) {});
+    sm.Increment(StatusCounter::calls_today);
+  }
+  auto s = ReadStatusDat();
+  s.callstoday = 42;
+  {
+    File f(FilePath(helper.data(), STATUS_DAT));
+    ASSERT_TRUE(f.Open(File::modeReadWrite | File::modeBinary));
+    f.Write(&s, sizeof(statusrec_t));
+    f.Close();
+    f.set_last_write_time(f.last_write_time() + 10);
+  }
+  StatusMgr sm(helper.data(), [](int) {});
+  EXPECT_EQ(42, sm.GetStatus()->GetNumCallsToday());
+}
+
+TEST_F(StatusTest, StatusDatChangedOutside_KeepsIncrements) {
+  StatusMgr sm(helper.data(), [](int) {});
+  ASSERT_TRUE(sm.shared());
+  EXPECT_EQ(2u, sm.Increment(StatusCounter::qscan_pointer));
+  auto s = ReadStatusDat();
+  s.callstoday = 42;
+  s.qscanptr = 10;
+  {
+    File f(FilePath(helper.data(), STATUS_DAT));
+    ASSERT_TRUE(f.Open(File::modeReadWrite | File::modeBinary));
+    f.Write(&s, sizeof(statusrec_t));
+    f.Close();
+    f.set_last_write_time(f.last_write_time() + 10);
+  }
+  // Noticed without waiting for a checkpoint, and the increment that was
+  // not yet in STATUS.DAT is added on top of it.
+  auto status = sm.GetStatus();
+  EXPECT_EQ(42, status->GetNumCallsToday());
+  EXPECT_EQ(11u, status->GetQScanPointer());
+  EXPECT_EQ(11u, sm.Increment(StatusCounter::qscan_pointer));
+  EXPECT_TRUE(sm.Checkpoint());
+  EXPECT_EQ(12u, ReadStatusDat().qscanptr);
+}
+
+TEST_F(StatusTest, NoStatusDat_NotShared) {
+  const auto dir = helper.files().CreateTempFilePath("empty");
+  File::mkdirs(dir);
+  StatusMgr sm(dir, [](int) {});
+  EXPECT_FALSE(sm.shared());
+  EXPECT_FALSE(File::Exists(FilePath(dir, STATUS_SHM)));
+}
@@ -0,0 +1,86 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+#include "core/file.h"
+#include "core_test/file_helper.h"
+#include "sdk/subscribers.h"
+
+using std::set;
+using std::string;
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+
+class SubscriberCacheTest : public testing::Test {
+protected:
+  FileHelper helper_;
+};
+
+TEST_F(SubscriberCacheTest, Get) {
+  ASSERT_TRUE(WriteSubcriberFile(helper_.TempDir(), "nSUB.net", {1, 2, 3}));
+  SubscriberCache cache;
+  auto subscribers = cache.Get(helper_.TempDir(), "nSUB.net");
+  ASSERT_TRUE(subscribers);
+  EXPECT_EQ(set<uint16_t>({1, 2, 3}), *subscribers);
+}
+
+TEST_F(SubscriberCacheTest, Get_Missing) {
+  SubscriberCache cache;
+  EXPECT_FALSE(cache.Get(helper_.TempDir(), "nMISSING.net"));
+}
+
+TEST_F(SubscriberCacheTest, Get_Cached) {
+  ASSERT_TRUE(WriteSubcriberFile(helper_.TempDir(), "nSUB.net", {1, 2, 3}));
+  File f(FilePath(helper_.TempDir(), "nSUB.net"));
+  // Make the file old enough that the cache trusts its mtime.
+  ASSERT_TRUE(f.set_last_write_time(time(nullptr) - 10));
+
+  SubscriberCache cache;
+  auto first = cache.Get(helper_.TempDir(), "nSUB.net");
+  auto second = cache.Get(helper_.TempDir(), "nSUB.net");
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(1, cache.loads());
+}
+
+TEST_F(SubscriberCacheTest, Get_Changed) {
+  ASSERT_TRUE(WriteSubcriberFile(helper_.TempDir(), "nSUB.net", {1, 2, 3}));
+  File f(FilePath(helper_.TempDir(), "nSUB.net"));
+  ASSERT_TRUE(f.set_last_write_time(time(nullptr) - 10));
+
+  SubscriberCache cache;
+  ASSERT_EQ(3u, cache.Get(helper_.TempDir(), "nSUB.net")->size());
+
+  ASSERT_TRUE(WriteSubcriberFile(helper_.TempDir(), "nSUB.net", {1, 2, 3, 4}));
+  auto subscribers = cache.Get(helper_.TempDir(), "nSUB.net");
+  ASSERT_TRUE(subscribers);
+  EXPECT_EQ(set<uint16_t>({1, 2, 3, 4}), *subscribers);
+  EXPECT_EQ(2, cache.loads());
+}
+
+TEST_F(SubscriberCacheTest, Get_Removed) {
+  ASSERT_TRUE(WriteSubcriberFile(helper_.TempDir(), "nSUB.net", {1}));
+  SubscriberCache cache;
+  ASSERT_TRUE(cache.Get(helper_.TempDir(), "nSUB.net"));
+  ASSERT_TRUE(File::Remove(helper_.TempDir(), "nSUB.net"));
+  EXPECT_FALSE(cache.Get(helper_.TempDir(), "nSUB.net"));
+}
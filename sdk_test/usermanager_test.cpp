@@ -0,0 +1,203 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/config.h"
+#include "sdk/filenames.h"
+#include "sdk/user.h"
+#include "sdk/usermanager.h"
+#include "sdk_test/sdk_helper.h"
+
+using namespace std;
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::strings;
+
+class UserManagerTest : public testing::Test {
+public:
+  UserManagerTest() : config_(helper.root()) {
+    EXPECT_TRUE(config_.IsInitialized());
+    config_.max_users(20);
+  }
+
+  User CreateUser(const string& name, int logons) {
+    User u{};
+    strcpy(reinterpret_cast<char*>(u.data.name), name.c_str());
+    u.SetNumLogons(logons);
+    return u;
+  }
+
+  SdkHelper helper;
+  Config config_;
+};
+
+TEST_F(UserManagerTest, Mapped_RoundTrip) {
+  UserManager um(config_, true);
+  ASSERT_TRUE(um.mapped());
+  EXPECT_TRUE(File::Exists(FilePath(helper.data(), USER_SEQ)));
+
+  auto u1 = CreateUser("ONE", 1);
+  auto u2 = CreateUser("TWO", 2);
+  ASSERT_TRUE(um.writeuser(&u1, 1));
+  ASSERT_TRUE(um.writeuser(&u2, 2));
+  EXPECT_EQ(2, um.num_user_records());
+
+  User u;
+  ASSERT_TRUE(um.readuser(&u, 2));
+  EXPECT_STREQ("TWO", u.GetName());
+  EXPECT_EQ(2, u.GetNumLogons());
+
+  u.SetNumLogons(22);
+  ASSERT_TRUE(um.writeuser(&u, 2));
+  User again;
+  ASSERT_TRUE(um.readuser(&again, 2));
+  EXPECT_EQ(22, again.GetNumLogons());
+}
+
+TEST_F(UserManagerTest, Mapped_SharedWithFileMode) {
+  UserManager mapped(config_, true);
+  UserManager plain(config_);
+  ASSERT_TRUE(mapped.mapped());
+  ASSERT_FALSE(plain.mapped());
+
+  auto u1 = CreateUser("ONE", 1);
+  ASSERT_TRUE(plain.writeuser(&u1, 1));
+
+  // Written through the file, read through the mapping.
+  User u;
+  ASSERT_TRUE(mapped.readuser(&u, 1));
+  EXPECT_STREQ("ONE", u.GetName());
+
+  // Written through the mapping, read through the file.
+  u.SetNumLogons(10);
+  ASSERT_TRUE(mapped.writeuser(&u, 1));
+  User other;
+  ASSERT_TRUE(plain.readuser(&other, 1));
+  EXPECT_EQ(10, other.GetNumLogons());
+
+  // Another mapped instance sees the same record.
+  UserManager mapped2(config_, true);
+  ASSERT_TRUE(mapped2.readuser(&other, 1));
+  EXPECT_EQ(10, other.GetNumLogons());
+}
+
+TEST_F(UserManagerTest, Mapped_Growth) {
+  UserManager um(config_, true);
+  UserManager other(config_, true);
+  for (int i = 1; i <= 10; i++) {
+    auto u = CreateUser(StrCat("USER", i), i);
+    ASSERT_TRUE(um.writeuser(&u, i));
+  }
+  User u;
+  ASSERT_TRUE(other.readuser(&u, 10));
+  EXPECT_STREQ("USER10", u.GetName());
+  EXPECT_EQ(10, other.num_user_records());
+}
+
+TEST_F(UserManagerTest, Mapped_InterruptedWrite) {
+  UserManager um(config_, true);
+  auto u1 = CreateUser("ONE", 1);
+  ASSERT_TRUE(um.writeuser(&u1, 1));
+
+  // Leave the version for user #1 odd, as if a node died while writing it.
+  File seq(FilePath(helper.data(), USER_SEQ));
+  ASSERT_TRUE(seq.Open(File::modeBinary | File::modeReadWrite));
+  uint32_t version = 0;
+  seq.Seek(sizeof(uint32_t), File::Whence::begin);
+  ASSERT_EQ(sizeof(uint32_t), seq.Read(&version, sizeof(uint32_t)));
+  version |= 1;
+  seq.Seek(sizeof(uint32_t), File::Whence::begin);
+  seq.Write(&version, sizeof(uint32_t));
+  seq.Close();
+
+  // Readers fall back to the file rather than waiting on it.
+  User u;
+  ASSERT_TRUE(um.readuser(&u, 1));
+  EXPECT_STREQ("ONE", u.GetName());
+
+  // The next write repairs it.
+  u.SetNumLogons(5);
+  ASSERT_TRUE(um.writeuser(&u, 1));
+  ASSERT_TRUE(seq.Open(File::modeBinary | File::modeReadOnly));
+  seq.Seek(sizeof(uint32_t), File::Whence::begin);
+  ASSERT_EQ(sizeof(uint32_t), seq.Read(&version, sizeof(uint32_t)));
+  EXPECT_EQ(0u, version & 1);
+  seq.Close();
+
+  User again;
+  ASSERT_TRUE(um.readuser(&again, 1));
+  EXPECT_EQ(5, again.GetNumLogons());
+}
+
+TEST_F(UserManagerTest, FileMode_BumpsVersion) {
+  UserManager mapped(config_, true);
+  UserManager plain(config_);
+  auto u1 = CreateUser("ONE", 1);
+  ASSERT_TRUE(mapped.writeuser(&u1, 1));
+
+  auto read_version = [&]() {
+    File seq(FilePath(helper.data(), USER_SEQ));
+    uint32_t version = 0;
+    EXPECT_TRUE(seq.Open(File::modeBinary | File::modeReadOnly));
+    seq.Seek(sizeof(uint32_t), File::Whence::begin);
+    EXPECT_EQ(sizeof(uint32_t), seq.Read(&version, sizeof(uint32_t)));
+    return version;
+  };
+  const auto before = read_version();
+
+  u1.SetNumLogons(7);
+  ASSERT_TRUE(plain.writeuser(&u1, 1));
+  EXPECT_EQ(before + 2, read_version());
+
+  User u;
+  ASSERT_TRUE(mapped.readuser(&u, 1));
+  EXPECT_EQ(7, u.GetNumLogons());
+}
+
+TEST_F(UserManagerTest, ForEachUser) {
+  for (auto mapped : {false, true}) {
+    UserManager um(config_, mapped);
+    for (int i = 1; i <= 5; i++) {
+      auto u = CreateUser(StrCat("USER", i), i);
+      ASSERT_TRUE(um.writeuser(&u, i));
+    }
+
+    int count = 0;
+    um.for_each_user([&](int n, User& u) {
+      EXPECT_EQ(++count, n);
+      EXPECT_EQ(StrCat("USER", n), u.GetName());
+      return true;
+    });
+    EXPECT_EQ(5, count);
+
+    int found = 0;
+    um.for_each_user([&](int n, User&) {
+      found = n;
+      return n < 3;
+    });
+    EXPECT_EQ(3, found);
+  }
+}
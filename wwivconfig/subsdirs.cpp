@@ -25,7 +25,6 @@
 #endif
 #include <sys/stat.h>
 
-#include "core/scope_exit.h"
 #include "core/strings.h"
 #include "core/wwivport.h"
 #include "core/file.h"
@@ -36,6 +35,7 @@
 #include "localui/wwiv_curses.h"
 #include "localui/input.h"
 #include "sdk/filenames.h"
+#include "sdk/qscan.h"
 
 static const int MAX_SUBS_DIRS = 4096;
 
@@ -63,8 +63,6 @@ static T input_number(CursesWindow* window, int max_digits) {
 
 static void convert_to(CursesWindow* window, uint16_t num_subs, uint16_t num_dirs,
                        Config& config) {
-  int l1, l2, l3;
-
   if (num_subs % 32) {
     num_subs = (num_subs / 32 + 1) * 32;
   }
@@ -86,78 +84,20 @@ static void convert_to(CursesWindow* window, uint16_t num_subs, uint16_t num_dir
     num_dirs = MAX_SUBS_DIRS;
   }
 
-  auto nqscn_len =
-      static_cast<uint16_t>(4 * (1 + num_subs + ((num_subs + 31) / 32) + ((num_dirs + 31) / 32)));
-  uint32_t* nqsc = (uint32_t *)malloc(nqscn_len);
-  wwiv::core::ScopeExit free_nqsc([&]() { free(nqsc); nqsc = nullptr; });
-  if (!nqsc) {
-    return;
-  }
-  memset(nqsc, 0, nqscn_len);
-
-  uint32_t* nqsc_n = nqsc + 1;
-  uint32_t* nqsc_q = nqsc_n + ((num_dirs + 31) / 32);
-  uint32_t* nqsc_p = nqsc_q + ((num_subs + 31) / 32);
-
-  memset(nqsc_n, 0xff, ((num_dirs + 31) / 32) * 4);
-  memset(nqsc_q, 0xff, ((num_subs + 31) / 32) * 4);
-
-  uint32_t* oqsc = (uint32_t *)malloc(config.qscn_len());
-  wwiv::core::ScopeExit free_oqsc([&]() { free(oqsc); oqsc = nullptr; });
-  if (!oqsc) {
-    messagebox(window, StringPrintf("Could not allocate %d bytes for old quickscan rec\n",
-                                    config.qscn_len()));
+  const auto nqscn_len = static_cast<uint16_t>(calculate_qscan_length(num_subs, num_dirs));
+  const auto qscan_fn = FilePath(config.datadir(), USER_QSC);
+  const auto nu = File(qscan_fn).length() / config.qscn_len();
+  const auto ok = rewrite_qscan_file(
+      qscan_fn, config.max_subs(), config.max_dirs(), num_subs, num_dirs,
+      [&](int i, RawUserQScan&, RawUserQScan&) {
+        if (i % 10 == 0) {
+          window->Puts(StrCat(i, "/", nu, "\r"));
+        }
+      });
+  if (!ok) {
+    messagebox(window, "Could not rewrite user.qsc");
     return;
   }
-  memset(oqsc, 0, config.qscn_len());
-
-  uint32_t* oqsc_n = oqsc + 1;
-  uint32_t* oqsc_q = oqsc_n + ((config.max_dirs() + 31) / 32);
-  uint32_t* oqsc_p = oqsc_q + ((config.max_subs() + 31) / 32);
-
-  if (num_dirs < config.max_dirs()) {
-    l1 = ((num_dirs + 31) / 32) * 4;
-  } else {
-    l1 = ((config.max_dirs() + 31) / 32) * 4;
-  }
-
-  if (num_subs < config.max_subs()) {
-    l2 = ((num_subs + 31) / 32) * 4;
-    l3 = num_subs * 4;
-  } else {
-    l2 = ((config.max_subs() + 31) / 32) * 4;
-    l3 = config.max_subs() * 4;
-  }
-
-  File oqf(FilePath(config.datadir(), USER_QSC));
-  if (!oqf.Open(File::modeBinary|File::modeReadWrite)) {
-    messagebox(window, "Could not open user.qsc");
-    return;
-  }
-  File nqf(FilePath(config.datadir(), "userqsc.new"));
-  if (!nqf.Open(File::modeBinary|File::modeReadWrite|File::modeCreateFile|File::modeTruncate)) {
-    messagebox(window, "Could not open userqsc.new");
-    return;
-  }
-
-  const auto nu = oqf.length() / config.qscn_len();
-  for (int i = 0; i < nu; i++) {
-    if (i % 10 == 0) {
-      window->Puts(StrCat(i, "/", nu, "\r"));
-    }
-    oqf.Read(oqsc, config.qscn_len());
-
-    *nqsc = *oqsc;
-    memcpy(nqsc_n, oqsc_n, l1);
-    memcpy(nqsc_q, oqsc_q, l2);
-    memcpy(nqsc_p, oqsc_p, l3);
-    nqf.Write(nqsc, nqscn_len);
-  }
-
-  oqf.Close();
-  nqf.Close();
-  oqf.Delete();
-  File::Rename(nqf.full_pathname(), oqf.full_pathname());
 
   config.max_subs(num_subs);
   config.max_dirs(num_dirs);
@@ -42,6 +42,7 @@
 #include "sdk/filenames.h"
 #include "sdk/names.h"
 #include "sdk/networks.h"
+#include "sdk/status.h"
 #include "sdk/subxtr.h"
 #include "sdk/user.h"
 #include "sdk/usermanager.h"
@@ -124,9 +125,6 @@ void create_sysop_account(wwiv::sdk::Config& config) {
     names.Save();
   }
 
-  statusrec_t statusrec{};
-  if (read_status(config.datadir(), statusrec)) {
-    statusrec.users++;
-    save_status(config.datadir(), statusrec);
-  }
+  StatusMgr sm(config.datadir(), [](int) {});
+  sm.Increment(StatusCounter::users);
 }
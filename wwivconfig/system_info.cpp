@@ -29,6 +29,7 @@
 #include "localui/wwiv_curses.h"
 #include "localui/input.h"
 #include "wwivconfig/utility.h"
+#include "sdk/status.h"
 #include "sdk/vardec.h"
 
 using std::unique_ptr;
@@ -110,15 +111,13 @@ protected:
 
 void sysinfo1(wwiv::sdk::Config& config) {
   configrec cfg = *config.config();
+  {
+    wwiv::sdk::StatusMgr sm(config.datadir(), [](int) {});
+    sm.Run([](wwiv::sdk::WStatus& s) { s.EnsureCallerNumberIsValid(); });
+  }
   statusrec_t statusrec{};
   read_status(config.datadir(), statusrec);
 
-  if (statusrec.callernum != 65535) {
-    statusrec.callernum1 = static_cast<long>(statusrec.callernum);
-    statusrec.callernum = 65535;
-    save_status(config.datadir(), statusrec);
-  }
-
   static constexpr int LABEL1_POSITION = 2;
   static constexpr int LABEL1_WIDTH = 18;
   static constexpr int LABEL2_WIDTH = 10;
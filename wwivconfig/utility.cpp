@@ -34,6 +34,8 @@
 #include "wwivconfig/wwivconfig.h"
 #include "sdk/vardec.h"
 #include "sdk/filenames.h"
+#include "sdk/user.h"
+#include "sdk/usermanager.h"
 
 // Make sure it's after windows.h
 #include "localui/wwiv_curses.h"
@@ -91,14 +93,14 @@ void write_user(const Config& config, unsigned int un, userrec* u) {
     return;
   }
 
-  DataFile<userrec> file(FilePath(config.datadir(), USER_LST),
-      File::modeReadWrite | File::modeBinary | File::modeCreateFile);
-  if (file) {
-    file.Seek(un);
-    file.Write(u);
-  }
+  // Through UserManager so the version in USER.SEQ is bumped for any node
+  // that has USER.LST mapped.
+  User user;
+  user.data = *u;
+  UserManager(config).writeuser_nocache(&user, static_cast<int>(un));
 }
 
+// Only for creating STATUS.DAT, once it exists it is changed through StatusMgr.
 void save_status(const std::string& datadir, const statusrec_t& statusrec) {
   DataFile<statusrec_t> file(FilePath(datadir, STATUS_DAT),
                              File::modeBinary | File::modeReadWrite | File::modeCreateFile);
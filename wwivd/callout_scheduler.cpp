@@ -0,0 +1,221 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "wwivd/callout_scheduler.h"
+
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <utility>
+
+#include "core/log.h"
+
+namespace wwiv {
+namespace wwivd {
+
+using std::chrono::seconds;
+
+time_t next_callout_time(bool should_call_now, time_t last_contact, int call_every_x_minutes,
+                         time_t now, const callout_scheduler_options_t& options) {
+  if (should_call_now) {
+    return now;
+  }
+  const auto max_idle = now + static_cast<time_t>(options.max_idle.count());
+  if (call_every_x_minutes <= 0) {
+    // Only called when enough is waiting, which we find out on the next reload.
+    return max_idle;
+  }
+  const auto next = last_contact + static_cast<time_t>(call_every_x_minutes) * 60;
+  // A peer that isn't callable right now even though it's been long enough
+  // (i.e. outside of its allowed hours) is checked again later, not in a loop.
+  const auto earliest = now + static_cast<time_t>(options.min_interval.count());
+  return std::min(std::max(next, earliest), max_idle);
+}
+
+struct CalloutScheduler::state_t {
+  mutable std::mutex mu;
+  std::condition_variable cv;
+  callout_scheduler_options_t options;
+  std::vector<callout_peer_t> peers;
+  std::set<std::string> running;
+  // Networks with a callout running.  networkb holds networkb.bsy for the
+  // whole callout, so a second one on the same network would only fail.
+  std::set<int> running_networks;
+  // When each peer was last started, used to honor min_interval.
+  std::map<std::string, time_t> last_started;
+  // Earliest time that a peer which wasn't due at the last Reload becomes due.
+  time_t reload_at{0};
+  bool completed_since_reload{false};
+  callout_scheduler_stats_t stats;
+};
+
+CalloutScheduler::CalloutScheduler(const callout_scheduler_options_t& options, peers_fn peers,
+                                   exec_fn exec)
+    : peers_(std::move(peers)), exec_(std::move(exec)), state_(std::make_shared<state_t>()) {
+  set_options(options);
+}
+
+CalloutScheduler::~CalloutScheduler() = default;
+
+void CalloutScheduler::set_options(const callout_scheduler_options_t& options) {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  state_->options = options;
+  state_->options.max_concurrent = std::max<int>(1, options.max_concurrent);
+  state_->stats.max_concurrent = state_->options.max_concurrent;
+}
+
+// static
+std::string CalloutScheduler::key(const callout_peer_t& p) {
+  return std::to_string(p.network_number) + ":" + p.address;
+}
+
+// static
+time_t CalloutScheduler::effective_due(const state_t& state, const callout_peer_t& p) {
+  auto it = state.last_started.find(key(p));
+  if (it == std::end(state.last_started)) {
+    return p.due;
+  }
+  return std::max(p.due, it->second + static_cast<time_t>(state.options.min_interval.count()));
+}
+
+void CalloutScheduler::Reload(time_t now) {
+  {
+    // Cleared before reading, so that a callout which finishes while we
+    // read still causes another Reload.
+    std::lock_guard<std::mutex> lock(state_->mu);
+    state_->completed_since_reload = false;
+  }
+  // Don't hold the lock while reading the network configuration from disk.
+  auto peers = peers_(now);
+  std::lock_guard<std::mutex> lock(state_->mu);
+  state_->reload_at = now + static_cast<time_t>(state_->options.max_idle.count());
+  for (const auto& p : peers) {
+    if (p.due > now) {
+      state_->reload_at = std::min(state_->reload_at, p.due);
+    }
+  }
+  state_->peers = std::move(peers);
+  ++state_->stats.reloads;
+}
+
+bool CalloutScheduler::needs_reload(time_t now) const {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  return state_->completed_since_reload || now >= state_->reload_at;
+}
+
+int CalloutScheduler::RunDue(time_t now) {
+  std::vector<callout_peer_t> to_start;
+  seconds timeout;
+  {
+    std::lock_guard<std::mutex> lock(state_->mu);
+    timeout = state_->options.timeout;
+    std::vector<const callout_peer_t*> due;
+    for (const auto& p : state_->peers) {
+      if (state_->running_networks.count(p.network_number) == 0 &&
+          effective_due(*state_, p) <= now) {
+        due.push_back(&p);
+      }
+    }
+    // The peer that has been waiting longest goes first.
+    std::stable_sort(std::begin(due), std::end(due),
+                     [](const callout_peer_t* l, const callout_peer_t* r) { return l->due < r->due; });
+    for (const auto* p : due) {
+      if (static_cast<int>(state_->running.size()) >= state_->options.max_concurrent) {
+        break;
+      }
+      if (!state_->running_networks.insert(p->network_number).second) {
+        // Another peer on this network was just started, leave the slot to
+        // other networks.
+        continue;
+      }
+      const auto k = key(*p);
+      state_->running.insert(k);
+      state_->last_started[k] = now;
+      ++state_->stats.started;
+      to_start.push_back(*p);
+    }
+    state_->stats.running = static_cast<int>(state_->running.size());
+  }
+
+  for (const auto& p : to_start) {
+    // Each callout holds a reference to the state so it may safely outlive the scheduler.
+    std::thread t([state = state_, exec = exec_, p, timeout]() {
+      bool ok = false;
+      try {
+        ok = exec(p, timeout);
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "CalloutScheduler: Handled Uncaught Exception: " << e.what();
+      }
+      {
+        std::lock_guard<std::mutex> lock(state->mu);
+        state->running.erase(key(p));
+        state->running_networks.erase(p.network_number);
+        state->stats.running = static_cast<int>(state->running.size());
+        if (!ok) {
+          ++state->stats.failed;
+        }
+        state->completed_since_reload = true;
+      }
+      state->cv.notify_all();
+    });
+    t.detach();
+  }
+  return static_cast<int>(to_start.size());
+}
+
+time_t CalloutScheduler::next_due(time_t now) const {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  auto next = state_->reload_at;
+  if (static_cast<int>(state_->running.size()) >= state_->options.max_concurrent) {
+    // Nothing else can start until a callout finishes, which wakes WaitForChange.
+    return next;
+  }
+  for (const auto& p : state_->peers) {
+    // Waiting on another callout on the same network also wakes WaitForChange.
+    if (state_->running_networks.count(p.network_number) == 0) {
+      next = std::min(next, effective_due(*state_, p));
+    }
+  }
+  return std::max(next, now);
+}
+
+void CalloutScheduler::WaitForChange(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(state_->mu);
+  state_->cv.wait_for(lock, timeout, [&] { return state_->completed_since_reload; });
+}
+
+callout_scheduler_stats_t CalloutScheduler::stats() const {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  auto s = state_->stats;
+  for (const auto& p : state_->peers) {
+    callout_peer_status_t ps{};
+    ps.network_name = p.network_name;
+    ps.address = p.address;
+    ps.due = effective_due(*state_, p);
+    ps.running = state_->running.count(key(p)) > 0;
+    s.peers.push_back(ps);
+  }
+  std::stable_sort(std::begin(s.peers), std::end(s.peers),
+                   [](const callout_peer_status_t& l, const callout_peer_status_t& r) {
+                     return l.due < r.due;
+                   });
+  return s;
+}
+
+} // namespace wwivd
+} // namespace wwiv
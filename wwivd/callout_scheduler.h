@@ -0,0 +1,141 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_WWIVD_CALLOUT_SCHEDULER_H__
+#define __INCLUDED_WWIVD_CALLOUT_SCHEDULER_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wwiv {
+namespace wwivd {
+
+struct callout_scheduler_options_t {
+  // Maximum number of callouts running at once.  Only one runs per network
+  // at a time.
+  int max_concurrent{4};
+  // Longest a single callout may run before it is killed.
+  std::chrono::seconds timeout{1800};
+  // Shortest time between two callouts to the same peer, so that a peer
+  // that keeps failing is not called again the moment it fails.
+  std::chrono::seconds min_interval{15};
+  // Longest time a peer that is not due goes without being checked again.
+  std::chrono::seconds max_idle{300};
+};
+
+/** A system that may be called, as returned by the peers function. */
+struct callout_peer_t {
+  int network_number{0};
+  std::string network_name;
+  /** WWIVnet node number or FidoNet address. */
+  std::string address;
+  /** Command line that performs the callout. */
+  std::string cmd;
+  /** FTN peers have their last contact time kept by wwivd. */
+  bool ftn{false};
+  /** When this peer should next be called. */
+  time_t due{0};
+};
+
+struct callout_peer_status_t {
+  std::string network_name;
+  std::string address;
+  time_t due{0};
+  bool running{false};
+};
+
+struct callout_scheduler_stats_t {
+  int max_concurrent{0};
+  int running{0};
+  int64_t started{0};
+  int64_t failed{0};
+  int64_t reloads{0};
+  /** Every known peer, ordered by when it is due. */
+  std::vector<callout_peer_status_t> peers;
+};
+
+/**
+ * Returns when a peer should next be called: now if it should be called now,
+ * otherwise once call_every_x_minutes have passed since last_contact, but
+ * no sooner than now + min_interval and no later than now + max_idle.
+ */
+time_t next_callout_time(bool should_call_now, time_t last_contact, int call_every_x_minutes,
+                         time_t now, const callout_scheduler_options_t& options);
+
+/**
+ * Keeps the peers to call ordered by when they are next due and runs up to
+ * max_concurrent callouts at a time, each on its own thread.
+ *
+ * The peers (and when they are due) only come from the peers function when
+ * Reload is called. The owner does that when the network configuration
+ * changes on disk or whenever needs_reload returns true, which is once a
+ * callout finishes (since that changes the contact records) or once a peer
+ * that wasn't due at the last Reload may have become due.
+ */
+class CalloutScheduler {
+public:
+  /** Returns every peer that may be called, and when it is due. */
+  typedef std::function<std::vector<callout_peer_t>(time_t now)> peers_fn;
+  /** Runs one callout, returns false if it failed or timed out. */
+  typedef std::function<bool(const callout_peer_t& peer, std::chrono::seconds timeout)> exec_fn;
+
+  CalloutScheduler(const callout_scheduler_options_t& options, peers_fn peers, exec_fn exec);
+  CalloutScheduler(const CalloutScheduler&) = delete;
+  CalloutScheduler& operator=(const CalloutScheduler&) = delete;
+  /** Running callouts are left to finish on their own. */
+  ~CalloutScheduler();
+
+  void set_options(const callout_scheduler_options_t& options);
+  /** Loads the peers and when they are due. */
+  void Reload(time_t now);
+  /** True if the peers should be loaded again. */
+  bool needs_reload(time_t now) const;
+  /** Starts every due callout that there is room for. Returns how many were started. */
+  int RunDue(time_t now);
+  /**
+   * Returns when the next peer is due or a Reload is needed, whichever is
+   * first. Peers on a network with a callout running are skipped.
+   */
+  time_t next_due(time_t now) const;
+  /** Waits until a callout finishes or until timeout elapses. */
+  void WaitForChange(std::chrono::milliseconds timeout);
+
+  callout_scheduler_stats_t stats() const;
+
+private:
+  struct state_t;
+  static std::string key(const callout_peer_t& p);
+  static time_t effective_due(const state_t& state, const callout_peer_t& p);
+
+  const peers_fn peers_;
+  const exec_fn exec_;
+  std::shared_ptr<state_t> state_;
+};
+
+} // namespace wwivd
+} // namespace wwiv
+
+#endif // __INCLUDED_WWIVD_CALLOUT_SCHEDULER_H__
@@ -23,8 +23,11 @@
 #include "core/net.h"
 #include "sdk/config.h"
 #include "sdk/wwivd_config.h"
+#include "wwivd/callout_scheduler.h"
+#include "wwivd/dns_cache.h"
 #include "wwivd/ips.h"
 #include "wwivd/node_manager.h"
+#include "wwivd/worker_pool.h"
 
 namespace wwiv {
 namespace wwivd {
@@ -41,6 +44,13 @@ struct ConnectionData {
   std::shared_ptr<wwiv::wwivd::GoodIp> good_ips_;
   std::shared_ptr<wwiv::wwivd::BadIp> bad_ips_;
   std::shared_ptr<wwiv::wwivd::AutoBlocker> auto_blocker_;
+  std::shared_ptr<wwiv::wwivd::DnsCache> dns_cache_;
+  // Telnet, SSH and BinkP sessions.
+  std::shared_ptr<wwiv::wwivd::WorkerPool> worker_pool_;
+  // HTTP requests, kept apart so that they never wait behind a session.
+  std::shared_ptr<wwiv::wwivd::WorkerPool> http_pool_;
+  std::shared_ptr<wwiv::wwivd::AcceptMetrics> accept_metrics_;
+  std::shared_ptr<wwiv::wwivd::CalloutScheduler> callout_scheduler_;
 };
 
 }  // namespace wwivd
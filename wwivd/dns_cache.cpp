@@ -0,0 +1,180 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "wwivd/dns_cache.h"
+
+#include <algorithm>
+#include <string>
+
+#include "core/log.h"
+#include "core/net.h"
+
+namespace wwiv {
+namespace wwivd {
+
+using std::string;
+using namespace wwiv::core;
+
+DnsCache::DnsCache(const string& rbl_address, const dns_cache_options_t& options, lookup_fn fn)
+    : rbl_address_(rbl_address), options_(options), fn_(fn),
+      hits_total_(global_metrics().counter("wwivd_dns_cache_hits_total",
+                                           "DNS country code lookups answered from the cache.")),
+      misses_total_(global_metrics().counter("wwivd_dns_cache_misses_total",
+                                             "DNS country code lookups not in the cache.")),
+      timeouts_total_(global_metrics().counter("wwivd_dns_cache_timeouts_total",
+                                               "DNS country code lookups that timed out.")) {
+  const auto num_workers = std::max<int>(1, options_.num_workers);
+  for (int i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&DnsCache::Worker, this);
+  }
+}
+
+DnsCache::DnsCache(const string& rbl_address, const dns_cache_options_t& options)
+    : DnsCache(rbl_address, options, get_dns_cc) {}
+
+DnsCache::~DnsCache() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
+  result_cv_.notify_all();
+  for (auto& t : workers_) {
+    t.join();
+  }
+}
+
+int DnsCache::Lookup(const string& address) {
+  std::unique_lock<std::mutex> lock(mu_);
+  int cc = 0;
+  if (find(address, cc)) {
+    ++stats_.hits;
+    hits_total_.Increment();
+    return cc;
+  }
+  ++stats_.misses;
+  misses_total_.Increment();
+
+  if (in_flight_.find(address) == in_flight_.end()) {
+    if (queue_.size() >= options_.max_entries) {
+      // The resolvers are hopelessly behind (most likely a connection flood),
+      // don't queue more work.
+      ++stats_.dropped;
+      return 0;
+    }
+    in_flight_.insert(address);
+    queue_.push_back(address);
+    queue_cv_.notify_one();
+  }
+
+  const auto done = result_cv_.wait_for(lock, options_.timeout, [&] {
+    return stopping_ || in_flight_.find(address) == in_flight_.end();
+  });
+  if (!done) {
+    ++stats_.timeouts;
+    timeouts_total_.Increment();
+    VLOG(1) << "Timed out waiting for DNS lookup of: " << address;
+    return 0;
+  }
+  // Don't use find here, a TTL of 0 would expire the result we just waited for.
+  auto it = cache_.find(address);
+  return it == cache_.end() ? 0 : it->second.cc;
+}
+
+dns_cache_stats_t DnsCache::stats() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto s = stats_;
+  s.entries = static_cast<int64_t>(cache_.size());
+  s.pending = static_cast<int64_t>(in_flight_.size());
+  return s;
+}
+
+int DnsCache::hit_rate() const {
+  const auto s = stats();
+  const auto total = s.hits + s.misses;
+  if (total == 0) {
+    return 0;
+  }
+  return static_cast<int>(s.hits * 100 / total);
+}
+
+bool DnsCache::find(const string& address, int& cc) {
+  auto it = cache_.find(address);
+  if (it == cache_.end()) {
+    return false;
+  }
+  if (clock_type::now() >= it->second.expires) {
+    lru_.erase(it->second.lru);
+    cache_.erase(it);
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru);
+  cc = it->second.cc;
+  return true;
+}
+
+void DnsCache::insert(const string& address, int cc) {
+  const auto ttl = (cc != 0) ? options_.ttl : options_.negative_ttl;
+  const auto expires = clock_type::now() + ttl;
+  auto it = cache_.find(address);
+  if (it != cache_.end()) {
+    it->second.cc = cc;
+    it->second.expires = expires;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return;
+  }
+  lru_.push_front(address);
+  entry_t e{};
+  e.cc = cc;
+  e.expires = expires;
+  e.lru = lru_.begin();
+  cache_.emplace(address, e);
+
+  while (cache_.size() > std::max<size_t>(1, options_.max_entries)) {
+    cache_.erase(lru_.back());
+    lru_.pop_back();
+  }
+}
+
+void DnsCache::Worker() {
+  while (true) {
+    string address;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      address = queue_.front();
+      queue_.pop_front();
+    }
+
+    // Resolve without holding the lock, getaddrinfo may block for seconds.
+    const auto cc = fn_(address, rbl_address_);
+
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      insert(address, cc);
+      in_flight_.erase(address);
+    }
+    result_cv_.notify_all();
+  }
+}
+
+} // namespace wwivd
+} // namespace wwiv
@@ -0,0 +1,123 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_WWIVD_DNS_CACHE_H__
+#define __INCLUDED_WWIVD_DNS_CACHE_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/metrics.h"
+
+namespace wwiv {
+namespace wwivd {
+
+struct dns_cache_options_t {
+  // How long a listed (non-zero) result stays cached.
+  std::chrono::seconds ttl{3600};
+  // How long an unlisted or failed (zero) result stays cached.
+  std::chrono::seconds negative_ttl{600};
+  // Maximum number of addresses cached before the least recently used is evicted.
+  size_t max_entries{4096};
+  // Number of resolver threads.
+  int num_workers{2};
+  // Longest time a caller will wait on an uncached lookup.
+  std::chrono::milliseconds timeout{1500};
+};
+
+struct dns_cache_stats_t {
+  int64_t hits{0};
+  int64_t misses{0};
+  int64_t timeouts{0};
+  int64_t dropped{0};
+  int64_t entries{0};
+  int64_t pending{0};
+};
+
+/**
+ * Caches the results of DNS RBL country code lookups (see get_dns_cc).
+ *
+ * Lookups run on a small pool of resolver threads; callers wait at most
+ * options.timeout for an answer and otherwise fail open with 0, the same
+ * result get_dns_cc returns when the lookup fails.  A lookup that times out
+ * still completes in the background and populates the cache for the next
+ * connection from that peer.
+ */
+class DnsCache {
+public:
+  typedef std::function<int(const std::string& address, const std::string& rbl_address)>
+      lookup_fn;
+
+  DnsCache(const std::string& rbl_address, const dns_cache_options_t& options, lookup_fn fn);
+  DnsCache(const std::string& rbl_address, const dns_cache_options_t& options);
+  DnsCache(const DnsCache&) = delete;
+  DnsCache& operator=(const DnsCache&) = delete;
+  ~DnsCache();
+
+  /** Returns the country code for address, or 0 if unknown within the timeout. */
+  int Lookup(const std::string& address);
+  dns_cache_stats_t stats() const;
+  /** Returns the percentage of lookups answered from the cache. */
+  int hit_rate() const;
+
+private:
+  typedef std::chrono::steady_clock clock_type;
+  struct entry_t {
+    int cc{0};
+    clock_type::time_point expires;
+    std::list<std::string>::iterator lru;
+  };
+
+  bool find(const std::string& address, int& cc);
+  void insert(const std::string& address, int cc);
+  void Worker();
+
+  const std::string rbl_address_;
+  const dns_cache_options_t options_;
+  lookup_fn fn_;
+
+  mutable std::mutex mu_;
+  std::condition_variable queue_cv_;
+  std::condition_variable result_cv_;
+  std::unordered_map<std::string, entry_t> cache_;
+  std::list<std::string> lru_;
+  std::deque<std::string> queue_;
+  std::unordered_set<std::string> in_flight_;
+  dns_cache_stats_t stats_;
+  // The same counts as stats_, exported for Prometheus.
+  wwiv::core::Counter& hits_total_;
+  wwiv::core::Counter& misses_total_;
+  wwiv::core::Counter& timeouts_total_;
+  bool stopping_{false};
+  std::vector<std::thread> workers_;
+};
+
+} // namespace wwivd
+} // namespace wwiv
+
+#endif // __INCLUDED_WWIVD_DNS_CACHE_H__
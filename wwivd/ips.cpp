@@ -17,6 +17,8 @@
 /**************************************************************************/
 #include "wwivd/ips.h"
 
+#include <algorithm>
+#include <cctype>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -39,6 +41,7 @@
 #include "core/inifile.h"
 #include "core/jsonfile.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/net.h"
 #include "core/os.h"
 #include "core/scope_exit.h"
@@ -66,21 +69,193 @@ using namespace wwiv::stl;
 using namespace wwiv::strings;
 using namespace wwiv::os;
 
-static bool LoadLinesIntoSet(std::unordered_set<string>& s, const std::vector<std::string>& lines) {
+size_t ip_address_hash::operator()(const ip_address_t& a) const {
+  // FNV-1a
+  size_t h = 14695981039346656037ULL;
+  for (const auto b : a.bytes) {
+    h = (h ^ b) * 1099511628211ULL;
+  }
+  return h;
+}
+
+bool ParseIpAddress(const std::string& s, ip_address_t& address) {
+  if (s.find(':') != string::npos) {
+    return inet_pton(AF_INET6, s.c_str(), address.bytes.data()) == 1;
+  }
+  address.bytes.fill(0);
+  address.bytes[10] = 0xff;
+  address.bytes[11] = 0xff;
+  return inet_pton(AF_INET, s.c_str(), address.bytes.data() + 12) == 1;
+}
+
+bool ParseCidr(const std::string& s, ip_address_t& address, int& prefix_len) {
+  const auto slash = s.find('/');
+  const auto ip = s.substr(0, slash);
+  if (!ParseIpAddress(ip, address)) {
+    return false;
+  }
+  const auto ipv4 = ip.find(':') == string::npos;
+  const auto max_bits = ipv4 ? 32 : 128;
+  if (slash == string::npos) {
+    prefix_len = 128;
+    return true;
+  }
+  const auto bits = s.substr(slash + 1);
+  // isdigit is undefined for negative chars other than EOF.
+  const auto is_digit = [](char c) { return ::isdigit(static_cast<unsigned char>(c)) != 0; };
+  if (bits.empty() || !std::all_of(std::begin(bits), std::end(bits), is_digit)) {
+    return false;
+  }
+  const auto n = to_number<int>(bits);
+  if (n > max_bits) {
+    return false;
+  }
+  prefix_len = ipv4 ? n + 96 : n;
+  return true;
+}
+
+IpTrie::IpTrie() : nodes_(1) {}
+
+static int bit_at(const ip_address_t& a, int i) { return (a.bytes[i / 8] >> (7 - i % 8)) & 1; }
+
+void IpTrie::Insert(const ip_address_t& address, int prefix_len) {
+  uint32_t n = 0;
+  for (int i = 0; i < prefix_len; i++) {
+    if (nodes_[n].terminal) {
+      // Already covered by a shorter prefix.
+      return;
+    }
+    const auto bit = bit_at(address, i);
+    if (nodes_[n].child[bit] == 0) {
+      nodes_[n].child[bit] = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+    }
+    n = nodes_[n].child[bit];
+  }
+  if (!nodes_[n].terminal) {
+    nodes_[n].terminal = true;
+    ++num_prefixes_;
+  }
+}
+
+bool IpTrie::Contains(const ip_address_t& address) const {
+  uint32_t n = 0;
+  for (int i = 0; i < 128; i++) {
+    if (nodes_[n].terminal) {
+      return true;
+    }
+    n = nodes_[n].child[bit_at(address, i)];
+    if (n == 0) {
+      return false;
+    }
+  }
+  return nodes_[n].terminal;
+}
+
+SlidingWindowCounter::SlidingWindowCounter(size_t max_entries, int window_seconds)
+    : max_entries_(std::max<size_t>(1, max_entries)),
+      window_seconds_(std::max<int>(1, window_seconds)) {
+  entries_.reserve(max_entries_);
+  index_.reserve(max_entries_);
+}
+
+void SlidingWindowCounter::Unlink(uint32_t i) {
+  auto& e = entries_[i];
+  if (e.prev != npos) {
+    entries_[e.prev].next = e.next;
+  } else {
+    head_ = e.next;
+  }
+  if (e.next != npos) {
+    entries_[e.next].prev = e.prev;
+  } else {
+    tail_ = e.prev;
+  }
+  e.prev = e.next = npos;
+}
+
+void SlidingWindowCounter::PushFront(uint32_t i) {
+  auto& e = entries_[i];
+  e.prev = npos;
+  e.next = head_;
+  if (head_ != npos) {
+    entries_[head_].prev = i;
+  }
+  head_ = i;
+  if (tail_ == npos) {
+    tail_ = i;
+  }
+}
+
+int SlidingWindowCounter::Add(const ip_address_t& address, time_t now) {
+  const time_t w = window_seconds_;
+  const auto window_start = now - now % w;
+
+  uint32_t i;
+  const auto it = index_.find(address);
+  if (it != std::end(index_)) {
+    i = it->second;
+    Unlink(i);
+  } else {
+    if (entries_.size() < max_entries_) {
+      i = static_cast<uint32_t>(entries_.size());
+      entries_.emplace_back();
+    } else {
+      // Reuse the least recently seen entry.
+      i = tail_;
+      Unlink(i);
+      index_.erase(entries_[i].address);
+    }
+    entries_[i] = entry_t{};
+    entries_[i].address = address;
+    index_.emplace(address, i);
+  }
+  PushFront(i);
+
+  auto& e = entries_[i];
+  if (e.window_start != window_start) {
+    e.previous = (e.window_start == window_start - w) ? e.current : 0;
+    e.current = 0;
+    e.window_start = window_start;
+  }
+  ++e.current;
+  const auto elapsed = now - window_start;
+  return static_cast<int>(e.previous * (w - elapsed) / w) + e.current;
+}
+
+static bool LoadLinesIntoTrie(IpTrie& trie, const std::vector<std::string>& lines) {
   for (auto line : lines) {
     auto space = line.find(' ');
     if (space != line.npos) {
       line = line.substr(0, space);
     }
-    s.emplace(StringTrim(line));
+    line = StringTrim(line);
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    ip_address_t address{};
+    int prefix_len = 0;
+    if (!ParseCidr(line, address, prefix_len)) {
+      LOG(WARNING) << "Ignoring invalid IP address: " << line;
+      continue;
+    }
+    trie.Insert(address, prefix_len);
   }
   return true;
 }
 
+static bool Contains(const IpTrie& trie, const std::string& ip) {
+  if (trie.empty()) {
+    return false;
+  }
+  ip_address_t address;
+  return ParseIpAddress(ip, address) && trie.Contains(address);
+}
+
 GoodIp::GoodIp(const std::vector<std::string>& lines) { LoadLines(lines); }
 
 bool GoodIp::LoadLines(const std::vector<std::string>& lines) {
-  return LoadLinesIntoSet(ips_, lines);
+  return LoadLinesIntoTrie(ips_, lines);
 }
 
 GoodIp::GoodIp(const std::string& fn) {
@@ -91,78 +266,77 @@ GoodIp::GoodIp(const std::string& fn) {
   }
 }
 
-bool GoodIp::IsAlwaysAllowed(const std::string& ip) {
-  if (ips_.empty()) {
-    return false;
-  }
-  return ips_.find(ip) != ips_.end();
-}
+bool GoodIp::IsAlwaysAllowed(const std::string& ip) { return Contains(ips_, ip); }
 
 BadIp::BadIp(const std::string& fn) : fn_(fn) {
   TextFile f(fn, "r");
   if (f) {
     auto lines = f.ReadFileIntoVector();
-    LoadLinesIntoSet(ips_, lines);
+    LoadLinesIntoTrie(ips_, lines);
   }
 }
-bool BadIp::IsBlocked(const std::string& ip) {
-  if (ips_.empty()) {
-    return false;
-  }
-  return ips_.find(ip) != ips_.end();
-}
+
+BadIp::~BadIp() { Flush(); }
+
+bool BadIp::IsBlocked(const std::string& ip) { return Contains(ips_, ip); }
+
 bool BadIp::Block(const std::string& ip) {
-  ips_.emplace(ip);
-  TextFile appender(fn_, "at");
+  ip_address_t address;
+  if (ParseIpAddress(ip, address)) {
+    ips_.Insert(address, 128);
+  }
   auto now = DateTime::now();
-  auto written =
-      appender.WriteLine(StrCat(ip, " # AutoBlocked by wwivd on: ", now.to_string("%FT%T")));
-  return written > 0;
+  pending_.push_back(StrCat(ip, " # AutoBlocked by wwivd on: ", now.to_string("%FT%T")));
+  return FlushIfDue();
 }
 
-AutoBlocker::AutoBlocker(std::shared_ptr<BadIp> bip, const wwiv::sdk::wwivd_blocking_t& b)
-    : bip_(bip), b_(b) {}
-
-AutoBlocker::~AutoBlocker() {}
+bool BadIp::FlushIfDue() {
+  if (pending_.empty() || std::chrono::steady_clock::now() - last_write_ < 1s) {
+    return true;
+  }
+  return Flush();
+}
 
-static string to_string(std::set<time_t> times) {
-  std::stringstream ss;
-  ss << "{";
-  for (const auto& t : times) {
-    ss << t << ", ";
+bool BadIp::Flush() {
+  if (pending_.empty()) {
+    return true;
+  }
+  TextFile appender(fn_, "at");
+  auto ok = true;
+  for (const auto& line : pending_) {
+    ok &= appender.WriteLine(line) > 0;
   }
-  ss << "}";
-  return ss.str();
+  pending_.clear();
+  last_write_ = std::chrono::steady_clock::now();
+  return ok;
 }
 
+AutoBlocker::AutoBlocker(std::shared_ptr<BadIp> bip, const wwiv::sdk::wwivd_blocking_t& b,
+                         size_t max_tracked_peers)
+    : bip_(bip), b_(b), sessions_(max_tracked_peers, b.auto_bl_seconds) {}
+
+AutoBlocker::~AutoBlocker() {}
+
 bool AutoBlocker::Connection(const std::string& ip) {
   VLOG(1) << "AutoBlocker::Connection: " << ip;
   if (!b_.auto_blacklist) {
     return true;
   }
+  // Write out any blocked addresses that were held back.
+  bip_->FlushIfDue();
 
-  const auto auto_bl_sessions = b_.auto_bl_sessions;
-  const auto auto_bl_seconds = b_.auto_bl_seconds;
-  auto now = DateTime::now();
-  auto oldest_in_window = now.to_time_t() - auto_bl_seconds;
-  auto& s = sessions_[ip];
-  s.emplace(now.to_time_t());
-  if (s.size() == 1) {
+  ip_address_t address;
+  if (!ParseIpAddress(ip, address)) {
     return true;
   }
-
-  for (auto iter = s.begin(); iter != s.end();) {
-    if (*iter < oldest_in_window) {
-      iter = s.erase(iter);
-    } else {
-      ++iter;
-    }
-  }
-
-  if (size_int(s) > auto_bl_sessions) {
-    LOG(INFO) << "Blocking since we have " << s.size() << " sessions within "
-              << auto_bl_seconds << " seconds.";
+  const auto sessions = sessions_.Add(address, DateTime::now().to_time_t());
+  if (sessions > b_.auto_bl_sessions) {
+    LOG(INFO) << "Blocking since we have " << sessions << " sessions within "
+              << b_.auto_bl_seconds << " seconds.";
     bip_->Block(ip);
+    static auto& blocked = global_metrics().counter(
+        "wwivd_autoblocker_blocked_total", "Addresses added to badip.txt by the AutoBlocker.");
+    blocked.Increment();
     return false;
   }
   return true;
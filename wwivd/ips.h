@@ -18,17 +18,98 @@
 #ifndef __INCLUDED_WWIVD_IPS_H__
 #define __INCLUDED_WWIVD_IPS_H__
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <ctime>
 #include "sdk/wwivd_config.h"
 #include <memory>
-#include <set>
+#include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace wwiv {
 namespace wwivd {
 
+/** An IPv6 address, or an IPv4 address stored as ::ffff:a.b.c.d */
+struct ip_address_t {
+  std::array<uint8_t, 16> bytes{};
+
+  bool operator==(const ip_address_t& o) const { return bytes == o.bytes; }
+};
+
+struct ip_address_hash {
+  size_t operator()(const ip_address_t& a) const;
+};
+
+/** Parses an IPv4 or IPv6 address, without allocating. */
+bool ParseIpAddress(const std::string& s, ip_address_t& address);
+
+/**
+ * Parses an address with an optional /bits suffix, i.e. "10.0.0.0/8" or
+ * "2001:db8::/32". prefix_len is in bits of the 128 bit address, so
+ * "10.0.0.0/8" has a prefix_len of 104.
+ */
+bool ParseCidr(const std::string& s, ip_address_t& address, int& prefix_len);
+
+/**
+ * Binary trie of address prefixes. Looking up an address walks at most one
+ * node per bit of the longest matching prefix.
+ */
+class IpTrie {
+public:
+  IpTrie();
+  /** Adds the prefix address/prefix_len. */
+  void Insert(const ip_address_t& address, int prefix_len);
+  /** Returns true if address is within any prefix that was added. */
+  bool Contains(const ip_address_t& address) const;
+  bool empty() const noexcept { return num_prefixes_ == 0; }
+  size_t size() const noexcept { return num_prefixes_; }
+
+private:
+  struct node_t {
+    // Index into nodes_ for each bit value, 0 means none.
+    uint32_t child[2]{0, 0};
+    bool terminal{false};
+  };
+  std::vector<node_t> nodes_;
+  size_t num_prefixes_{0};
+};
+
+/**
+ * Counts events per address over a sliding window, using the count in the
+ * current and previous windows, weighted by how far into the current window
+ * we are. Only the max_entries most recently seen addresses are tracked.
+ */
+class SlidingWindowCounter {
+public:
+  SlidingWindowCounter(size_t max_entries, int window_seconds);
+  /** Counts one event for address, returns the number in the last window including it. */
+  int Add(const ip_address_t& address, time_t now);
+  size_t size() const noexcept { return index_.size(); }
+
+private:
+  static constexpr uint32_t npos = UINT32_MAX;
+  struct entry_t {
+    ip_address_t address;
+    time_t window_start{0};
+    int current{0};
+    int previous{0};
+    // Neighbors in most-recently-used order.
+    uint32_t prev{npos};
+    uint32_t next{npos};
+  };
+  void Unlink(uint32_t i);
+  void PushFront(uint32_t i);
+
+  const size_t max_entries_;
+  const int window_seconds_;
+  std::vector<entry_t> entries_;
+  std::unordered_map<ip_address_t, uint32_t, ip_address_hash> index_;
+  uint32_t head_{npos};
+  uint32_t tail_{npos};
+};
+
 class GoodIp {
 public:
   GoodIp(const std::string& fn);
@@ -37,30 +118,45 @@ public:
 
 private:
   bool LoadLines(const std::vector<std::string>& ips);
-  std::unordered_set<std::string> ips_;
+  IpTrie ips_;
 };
 
+/**
+ * Addresses and CIDR ranges listed in badip.txt.
+ *
+ * Newly blocked addresses are appended to the file right away unless they
+ * were written less than a second ago, in which case they are written
+ * together by a later call to Block, Flush or FlushIfDue, or on destruction.
+ */
 class BadIp {
 public:
   BadIp(const std::string& fn);
+  ~BadIp();
   bool IsBlocked(const std::string& ip);
   bool Block(const std::string& ip);
+  /** Appends any pending blocked addresses to the file. */
+  bool Flush();
+  /** Flushes if there are pending addresses that have waited long enough. */
+  bool FlushIfDue();
 
 private:
   const std::string fn_;
-  std::unordered_set<std::string> ips_;
+  IpTrie ips_;
+  std::vector<std::string> pending_;
+  std::chrono::steady_clock::time_point last_write_;
 };
 
 class AutoBlocker {
 public:
-  AutoBlocker(std::shared_ptr<BadIp> bip, const wwiv::sdk::wwivd_blocking_t& b);
+  AutoBlocker(std::shared_ptr<BadIp> bip, const wwiv::sdk::wwivd_blocking_t& b,
+              size_t max_tracked_peers = 8192);
   virtual ~AutoBlocker();
   bool Connection(const std::string& ip);
 
 private:
   std::shared_ptr<BadIp> bip_;
   wwiv::sdk::wwivd_blocking_t b_;
-  std::unordered_map<std::string, std::set<time_t>> sessions_;
+  SlidingWindowCounter sessions_;
 };
 
 } // namespace wwivd
@@ -17,7 +17,9 @@
 /**************************************************************************/
 #include "wwivd/ips.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -42,6 +44,7 @@
 #include "core/inifile.h"
 #include "core/jsonfile.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/net.h"
 #include "core/os.h"
 #include "core/scope_exit.h"
@@ -55,9 +58,11 @@
 #include "sdk/config.h"
 #include "sdk/contact.h"
 #include "sdk/fido/fido_callout.h"
+#include "sdk/filenames.h"
 #include "sdk/net/callouts.h"
 #include "sdk/networks.h"
 #include "sdk/status.h"
+#include "wwivd/callout_scheduler.h"
 #include "wwivd/connection_data.h"
 #include "wwivd/wwivd.h"
 #include "wwivd/wwivd_non_http.h"
@@ -88,103 +93,182 @@ static NetworkContact network_contact_from_last_time(const std::string& address,
   return NetworkContact{ncr};
 }
 
-static void one_net_ftn_callout(const Config& config, const net_networks_rec& net,
-                                const wwivd_config_t& c, int network_number) {
-  wwiv::sdk::fido::FidoCallout callout(config, net);
+// TODO(rushfan): 1. Right now we just keep the map of last callout
+// time in memory, but we should checkpoint this to disk and reload
+// on startup.
+// 2. Also we should look for files outbound to the node so that we can
+// handle min_k right.
+// 3. We should look for outbound files to other addresses we don't
+// know about and then figure out how to contact them (since their
+// address is in the nodelist.
+static std::mutex ftn_last_contact_mu;
+static std::map<int, std::map<std::string, time_t>> ftn_last_contact;
 
-  // TODO(rushfan): 1. Right now we just keep the map of last callout
-  // time in memory, but we should checkpoint this to disk and reload
-  // on startup.
-  // 2. Also we should look for files outbound to the node so that we can
-  // handle min_k right.
-  // 3. We should look for outbound files to other addresses we don't
-  // know about and then figure out how to contact them (since their
-  // address is in the nodelist.
-  static std::map<int, std::map<std::string, time_t>> last_contact;
-  auto& current_last_contact = last_contact[network_number];
+static callout_scheduler_options_t callout_options(const wwivd_config_t& c) {
+  callout_scheduler_options_t o{};
+  o.max_concurrent = c.max_concurrent_callouts;
+  o.timeout = std::chrono::minutes(std::max<int>(1, c.callout_timeout_minutes));
+  return o;
+}
+
+static callout_peer_t create_peer(const wwivd_config_t& c, const net_networks_rec& net,
+                                  int network_number, const std::string& address) {
+  callout_peer_t p{};
+  p.network_number = network_number;
+  p.network_name = net.name;
+  p.address = address;
+  const std::map<char, string> params = {{'N', address}, {'T', std::to_string(network_number)}};
+  p.cmd = CreateCommandLine(c.network_callout_cmd, params);
+  return p;
+}
+
+static void ftn_peers(const Config& config, const net_networks_rec& net, const wwivd_config_t& c,
+                      int network_number, time_t now, std::vector<callout_peer_t>& peers) {
+  const auto options = callout_options(c);
+  const auto dt = DateTime::from_time_t(now);
+  wwiv::sdk::fido::FidoCallout callout(config, net);
+  std::lock_guard<std::mutex> lock(ftn_last_contact_mu);
+  auto& current_last_contact = ftn_last_contact[network_number];
 
   for (const auto& kv : callout.node_configs_map()) {
     const auto address = kv.first.as_string();
     const auto& callout = kv.second.callout_config;
-    if (!wwiv::sdk::net::allowed_to_call(callout, DateTime::now())) {
-      // Is the callout bit set.
-      continue;
-    }
-    auto ncn = network_contact_from_last_time(address, current_last_contact[address]);
-    if (!wwiv::sdk::net::should_call(ncn, callout, DateTime::now())) {
-      // Has it been long enough, or do we have enough k waiting.
+    if (!wwiv::sdk::net::allowed_to_call(callout, dt)) {
+      // Is the callout bit set.  This doesn't change with the time of day,
+      // only on a configuration change, which causes a reload.
       continue;
     }
-    // 1: Update the last contact time to now.
-    current_last_contact[address] = DateTime::now().to_time_t();
-    // 2: Call it.
-    LOG(INFO) << "ftn: should call out to: " << kv.first << "." << net.name;
-    const std::map<char, string> params = {{'N', address}, {'T', std::to_string(network_number)}};
-    const auto cmd = CreateCommandLine(c.network_callout_cmd, params);
-    if (!ExecCommandAndWait(cmd, StrCat("[", get_pid(), "]"), -1, -1)) {
-      LOG(ERROR) << "Error executing command: '" << cmd << "'";
-    }
+    const auto last_contact = current_last_contact[address];
+    auto ncn = network_contact_from_last_time(address, last_contact);
+    // Has it been long enough, or do we have enough k waiting.
+    const auto call_now = wwiv::sdk::net::should_call(ncn, callout, dt);
+    auto p = create_peer(c, net, network_number, address);
+    p.ftn = true;
+    p.due = next_callout_time(call_now, last_contact, callout.call_every_x_minutes, now, options);
+    peers.push_back(p);
   }
 }
 
-static void one_net_wwivnet_callout(const Config& config, const net_networks_rec& net,
-                                    const wwivd_config_t& c, int network_number) {
+static void wwivnet_peers(const net_networks_rec& net, const wwivd_config_t& c,
+                          int network_number, time_t now, std::vector<callout_peer_t>& peers) {
+  const auto options = callout_options(c);
+  const auto dt = DateTime::from_time_t(now);
   Contact contact(net);
   Callout callout(net);
   for (const auto& kv : callout.callout_config()) {
-    const auto& ncn = contact.contact_rec_for(kv.first);
-    if (!wwiv::sdk::net::allowed_to_call(kv.second, DateTime::now())) {
-      continue;
-    }
-    if (!wwiv::sdk::net::should_call(*ncn, kv.second, DateTime::now())) {
+    const auto address = std::to_string(kv.first);
+    if (!wwiv::sdk::net::allowed_to_call(kv.second, dt)) {
+      // Outside of its hours.  Keep it due when they start so that the
+      // reload then decides whether to call it, rather than the one after
+      // max_idle.
+      const auto allowed_at = wwiv::sdk::net::next_allowed_to_call(kv.second, dt);
+      if (allowed_at == 0) {
+        continue;
+      }
+      auto p = create_peer(c, net, network_number, address);
+      p.due = allowed_at;
+      peers.push_back(p);
       continue;
     }
-    // Call it.
-    LOG(INFO) << "should call out to: " << kv.first << "." << net.name;
-    const std::map<char, string> params = {{'N', std::to_string(kv.first)},
-                                           {'T', std::to_string(network_number)}};
-    const auto cmd = CreateCommandLine(c.network_callout_cmd, params);
-    if (!ExecCommandAndWait(cmd, StrCat("[", get_pid(), "]"), -1, -1)) {
-      LOG(ERROR) << "Error executing command: " << cmd;
-    }
+    const auto* rec = contact.contact_rec_for(kv.first);
+    const auto ncn = rec != nullptr ? *rec : network_contact_from_last_time(address, 0);
+    const auto last_contact = static_cast<time_t>(ncn.lastcontact());
+    const auto call_now = wwiv::sdk::net::should_call(ncn, kv.second, dt);
+    auto p = create_peer(c, net, network_number, address);
+    p.due = next_callout_time(call_now, last_contact, kv.second.call_every_x_minutes, now, options);
+    peers.push_back(p);
   }
 }
 
-static void one_callout_loop(const Config& config, const wwivd_config_t& c) {
-  VLOG(1) << "do_wwivd_callouts: one_callout_loop: ";
+static std::vector<callout_peer_t> all_peers(const Config& config, const wwivd_config_t& c,
+                                             time_t now) {
+  VLOG(1) << "do_wwivd_callouts: loading peers";
+  std::vector<callout_peer_t> peers;
   Networks networks(config);
-  const auto& nets = networks.networks();
   int network_number = 0;
-  for (const auto& net : nets) {
+  for (const auto& net : networks.networks()) {
     if (net.type == network_type_t::wwivnet) {
-      one_net_wwivnet_callout(config, net, c, network_number++);
+      wwivnet_peers(net, c, network_number++, now, peers);
     } else if (net.type == network_type_t::ftn) {
-      one_net_ftn_callout(config, net, c, network_number++);
+      ftn_peers(config, net, c, network_number++, now, peers);
     }
   }
+  return peers;
+}
+
+static bool exec_callout(const callout_peer_t& p, std::chrono::seconds timeout) {
+  if (p.ftn) {
+    // Update the last contact time to now.
+    std::lock_guard<std::mutex> lock(ftn_last_contact_mu);
+    ftn_last_contact[p.network_number][p.address] = DateTime::now().to_time_t();
+  }
+  LOG(INFO) << "should call out to: " << p.address << "." << p.network_name;
+  const auto start = std::chrono::steady_clock::now();
+  const auto ok = ExecCommandAndWait(p.cmd, StrCat("[", get_pid(), "]"), -1, -1, timeout);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  auto& m = global_metrics();
+  m.histogram("wwivd_callout_seconds", "Length of network callouts in seconds.",
+              exponential_buckets(1, 4, 7), {{"network", p.network_name}})
+      .Observe(elapsed.count());
+  m.counter("wwivd_callouts_total", "Network callouts made.",
+            {{"network", p.network_name}, {"result", ok ? "ok" : "failed"}})
+      .Increment();
+  if (!ok) {
+    LOG(ERROR) << "Error executing command: '" << p.cmd << "'";
+  }
+  return ok;
+}
+
+static void add_stamp(const std::string& dir, const std::string& filename, std::ostringstream& ss) {
+  File f(FilePath(dir, filename));
+  if (f.Exists()) {
+    ss << filename << ":" << f.length() << ":" << f.last_write_time() << ";";
+  }
+}
+
+/**
+ * Returns a string that changes whenever any of the files that determine
+ * who to call, and when, change on disk.
+ */
+static std::string network_config_stamp(const Config& config) {
+  std::ostringstream ss;
+  add_stamp(config.datadir(), NETWORKS_DAT, ss);
+  add_stamp(config.datadir(), NETWORKS_JSON, ss);
+  Networks networks(config);
+  for (const auto& net : networks.networks()) {
+    add_stamp(net.dir, CALLOUT_NET, ss);
+    add_stamp(net.dir, CONTACT_NET, ss);
+    add_stamp(net.dir, FIDO_CALLOUT_JSON, ss);
+  }
+  return ss.str();
 }
 
 // This is called from the thread
-static void do_wwivd_callout_loop(const Config& config, const wwivd_config_t& original_config) {
-  wwivd_config_t c{original_config};
+static void do_wwivd_callout_loop(const Config& config, std::shared_ptr<wwivd_config_t> callout_config,
+                                  std::shared_ptr<CalloutScheduler> scheduler) {
+  auto& c = *callout_config;
 
   StatusMgr sm(config.datadir(), [](int) {});
-  auto e = need_to_exit.load();
-  while (!e) {
+  std::string last_stamp;
+  while (!need_to_exit.load()) {
     // Reload the config if we've gotten a HUP?
+    bool force_reload = false;
     if (need_to_reload_config.load()) {
       LOG(INFO) << "Received HUP: Reloading Configuration for Callouts.";
       need_to_reload_config.store(false);
       c.Load(config);
+      scheduler->set_options(callout_options(c));
+      force_reload = true;
     }
+    auto now = DateTime::now().to_time_t();
     if (c.do_network_callouts) {
-      one_callout_loop(config, c);
-    }
-    if (need_to_exit.load()) {
-      return;
+      auto stamp = network_config_stamp(config);
+      if (force_reload || stamp != last_stamp || scheduler->needs_reload(now)) {
+        last_stamp = stamp;
+        scheduler->Reload(now);
+      }
+      scheduler->RunDue(now);
     }
-    sleep_for(15s);
-    e = need_to_exit.load();
 
     if (c.do_beginday_event) {
       auto last_date_status = sm.GetStatus();
@@ -200,18 +284,44 @@ static void do_wwivd_callout_loop(const Config& config, const wwivd_config_t& or
         }
       }
     }
+    // wwivd is the one process that's always running, so it keeps
+    // STATUS.DAT up to date with the counters the nodes bump in STATUS.SHM.
+    sm.Checkpoint();
+    if (need_to_exit.load()) {
+      return;
+    }
+
+    // Sleep until the next peer is due or a callout finishes, but still wake
+    // up often enough to notice changes to the network configuration.
+    if (c.do_network_callouts) {
+      now = DateTime::now().to_time_t();
+      const auto wait = std::chrono::seconds(std::min<time_t>(
+          std::max<time_t>(1, scheduler->next_due(now) - now), 15));
+      scheduler->WaitForChange(wait);
+    } else {
+      sleep_for(15s);
+    }
   }
 }
 
-void do_wwivd_callouts(const Config& config, const wwivd_config_t& c) {
+std::shared_ptr<CalloutScheduler> do_wwivd_callouts(const Config& config,
+                                                    const wwivd_config_t& c) {
   if (c.do_network_callouts) {
     LOG(INFO) << "WWIVD is handling network callouts.";
   }
   if (c.do_beginday_event) {
     LOG(INFO) << "WWIVD is handling beginday event.";
   }
-  std::thread callout_thread(do_wwivd_callout_loop, config, c);
+  // Shared with the peers function, which is only called (by Reload) from
+  // the callout thread, so reloading it on HUP needs no locking.
+  auto callout_config = std::make_shared<wwivd_config_t>(c);
+  auto peers = [config, callout_config](time_t now) {
+    return all_peers(config, *callout_config, now);
+  };
+  auto scheduler = std::make_shared<CalloutScheduler>(callout_options(c), peers, exec_callout);
+  std::thread callout_thread(do_wwivd_callout_loop, config, callout_config, scheduler);
   callout_thread.detach();
+  return scheduler;
 }
 
 } // namespace wwivd
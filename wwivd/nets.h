@@ -21,6 +21,7 @@
 #include <ctime>
 #include "sdk/config.h"
 #include "sdk/wwivd_config.h"
+#include "wwivd/callout_scheduler.h"
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -30,7 +31,12 @@
 namespace wwiv {
 namespace wwivd {
 
-void do_wwivd_callouts(const wwiv::sdk::Config& config, const wwiv::sdk::wwivd_config_t& c);
+/**
+ * Starts the thread that makes network callouts and runs the beginday event.
+ * Returns the scheduler used for the callouts so its status may be reported.
+ */
+std::shared_ptr<CalloutScheduler> do_wwivd_callouts(const wwiv::sdk::Config& config,
+                                                    const wwiv::sdk::wwivd_config_t& c);
 
 } // namespace wwivd
 } // namespace wwiv
@@ -18,11 +18,14 @@
 #include "wwivd/node_manager.h"
 
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/stl.h"
 #include <memory>
 #include <mutex>
 #include <unordered_map>
 
+using wwiv::core::exponential_buckets;
+using wwiv::core::global_metrics;
 using wwiv::stl::contains;
 
 namespace wwiv {
@@ -45,7 +48,12 @@ std::string to_string(ConnectionType t) {
 }
 
 NodeManager::NodeManager(const std::string& name, ConnectionType type, int start, int end)
-    : name_(name), type_(type), start_(start), end_(end) {
+    : name_(name), type_(type), start_(start), end_(end),
+      nodes_in_use_(global_metrics().gauge("wwivd_nodes_in_use", "Nodes with a session connected.",
+                                           {{"name", name}})),
+      session_seconds_(global_metrics().histogram("wwivd_session_seconds",
+                                                  "Length of sessions in seconds.",
+                                                  exponential_buckets(1, 4, 9), {{"name", name}})) {
   for (auto i = start; i <= end; i++) {
     clear_node(i);
   }
@@ -81,6 +89,18 @@ std::vector<std::string> NodeManager::status_lines() const {
 
 NodeStatus& NodeManager::status_for_unlocked(int node) { return nodes_[node]; }
 
+void NodeManager::set_connected_unlocked(NodeStatus& n, bool connected) {
+  if (connected && !n.connected) {
+    nodes_in_use_.Increment();
+    n.connected_at = std::chrono::steady_clock::now();
+  } else if (!connected && n.connected) {
+    nodes_in_use_.Decrement();
+    const auto d = std::chrono::steady_clock::now() - n.connected_at;
+    session_seconds_.Observe(std::chrono::duration<double>(d).count());
+  }
+  n.connected = connected;
+}
+
 NodeStatus NodeManager::status_for_copy(int node) {
   std::lock_guard<std::mutex> lock(mu_);
   auto n = status_for_unlocked(node);
@@ -93,7 +113,7 @@ void NodeManager::set_node(int node, ConnectionType type, const std::string& des
   n.node = node;
   n.type = type;
   n.description = description;
-  n.connected = true;
+  set_connected_unlocked(n, true);
 }
 
 void NodeManager::clear_node(int node) {
@@ -101,7 +121,7 @@ void NodeManager::clear_node(int node) {
   auto& n = status_for_unlocked(node);
   n.node = node;
   n.type = type_;
-  n.connected = false;
+  set_connected_unlocked(n, false);
   n.description = "Waiting for Call";
 }
 
@@ -120,7 +140,7 @@ bool NodeManager::AcquireNode(int& node) {
   std::lock_guard<std::mutex> lock(mu_);
   for (auto& e : nodes_) {
     if (!e.second.connected) {
-      e.second.connected = true;
+      set_connected_unlocked(e.second, true);
       e.second.type = type_;
       e.second.description = "Connecting...";
       node = e.second.node;
@@ -141,7 +161,7 @@ bool NodeManager::ReleaseNode(int node) {
   if (!n.connected) {
     return false;
   }
-  n.connected = false;
+  set_connected_unlocked(n, false);
   n.type = type_;
   n.description = "Waiting For Call";
   return true;
@@ -18,12 +18,15 @@
 #ifndef __INCLUDED_WWIVD_NODE_MANAGER_H__
 #define __INCLUDED_WWIVD_NODE_MANAGER_H__
 
+#include <chrono>
 #include <map>
 #include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
+#include "core/metrics.h"
+
 namespace wwiv {
 namespace wwivd {
 
@@ -42,6 +45,7 @@ public:
   int node = 0;
   std::string description;
   bool connected = false;
+  std::chrono::steady_clock::time_point connected_at;
 };
 
 class NodeManager {
@@ -54,6 +58,7 @@ public:
   std::vector<std::string> status_lines() const;
 
   NodeStatus& status_for_unlocked(int node);
+  void set_connected_unlocked(NodeStatus& n, bool connected);
 
   NodeStatus status_for_copy(int node);
 
@@ -78,6 +83,8 @@ private:
   int start_ = 0;
   int end_ = 0;
   std::map<int, NodeStatus> nodes_;
+  wwiv::core::Gauge& nodes_in_use_;
+  wwiv::core::Histogram& session_seconds_;
 
   mutable std::mutex mu_;
 };
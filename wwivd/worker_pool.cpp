@@ -0,0 +1,188 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "wwivd/worker_pool.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "core/log.h"
+
+namespace wwiv {
+namespace wwivd {
+
+struct WorkerPool::state_t {
+  explicit state_t(size_t m) : max_queue_depth(m) {}
+
+  const size_t max_queue_depth;
+  mutable std::mutex mu;
+  std::condition_variable cv;
+  std::deque<work_fn> queue;
+  bool stopping{false};
+  worker_pool_stats_t stats;
+};
+
+WorkerPool::WorkerPool(int num_workers, size_t max_queue_depth)
+    : state_(std::make_shared<state_t>(std::max<size_t>(1, max_queue_depth))) {
+  num_workers = std::max<int>(1, num_workers);
+  state_->stats.num_workers = num_workers;
+  state_->stats.max_queue_depth = static_cast<int64_t>(state_->max_queue_depth);
+  for (int i = 0; i < num_workers; i++) {
+    // Each worker holds a reference to the state so it may safely outlive the pool.
+    std::thread t(&WorkerPool::Worker, state_);
+    t.detach();
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mu);
+    state_->stopping = true;
+    state_->queue.clear();
+  }
+  state_->cv.notify_all();
+}
+
+bool WorkerPool::Submit(work_fn fn) {
+  {
+    std::lock_guard<std::mutex> lock(state_->mu);
+    if (state_->stopping || state_->queue.size() >= state_->max_queue_depth) {
+      ++state_->stats.rejected;
+      return false;
+    }
+    state_->queue.push_back(std::move(fn));
+  }
+  state_->cv.notify_one();
+  return true;
+}
+
+worker_pool_stats_t WorkerPool::stats() const {
+  std::lock_guard<std::mutex> lock(state_->mu);
+  auto s = state_->stats;
+  s.queue_depth = static_cast<int64_t>(state_->queue.size());
+  return s;
+}
+
+// static
+void WorkerPool::Worker(std::shared_ptr<state_t> state) {
+  while (true) {
+    work_fn fn;
+    {
+      std::unique_lock<std::mutex> lock(state->mu);
+      state->cv.wait(lock, [&] { return state->stopping || !state->queue.empty(); });
+      if (state->stopping) {
+        return;
+      }
+      fn = std::move(state->queue.front());
+      state->queue.pop_front();
+      ++state->stats.busy_workers;
+    }
+
+    try {
+      fn();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "WorkerPool: Handled Uncaught Exception: " << e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(state->mu);
+    --state->stats.busy_workers;
+    ++state->stats.completed;
+  }
+}
+
+ConnectionLimit::ConnectionLimit(int max_connections)
+    : max_connections_(std::max<int>(1, max_connections)) {}
+
+bool ConnectionLimit::TryAcquire() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (in_use_ >= max_connections_) {
+    return false;
+  }
+  ++in_use_;
+  return true;
+}
+
+void ConnectionLimit::Release() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (in_use_ > 0) {
+    --in_use_;
+  }
+}
+
+int ConnectionLimit::in_use() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return in_use_;
+}
+
+void AcceptMetrics::Accepted() {
+  std::lock_guard<std::mutex> lock(mu_);
+  ++accepted_;
+  const auto now = time(nullptr);
+  Tick(now);
+  ++buckets_[now % buckets_.size()];
+}
+
+void AcceptMetrics::Blocked() {
+  std::lock_guard<std::mutex> lock(mu_);
+  ++blocked_;
+}
+
+void AcceptMetrics::Busy() {
+  std::lock_guard<std::mutex> lock(mu_);
+  ++busy_;
+}
+
+int64_t AcceptMetrics::accepted() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return accepted_;
+}
+
+int64_t AcceptMetrics::blocked() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return blocked_;
+}
+
+int64_t AcceptMetrics::busy() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return busy_;
+}
+
+int64_t AcceptMetrics::accepted_last_minute() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  const auto now = time(nullptr);
+  int64_t total = 0;
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    if (now - bucket_time_[i] < static_cast<time_t>(buckets_.size())) {
+      total += buckets_[i];
+    }
+  }
+  return total;
+}
+
+void AcceptMetrics::Tick(time_t now) {
+  const auto idx = now % buckets_.size();
+  if (bucket_time_[idx] != now) {
+    // This bucket last counted a second from a previous minute.
+    bucket_time_[idx] = now;
+    buckets_[idx] = 0;
+  }
+}
+
+} // namespace wwivd
+} // namespace wwiv
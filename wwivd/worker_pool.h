@@ -0,0 +1,126 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_WWIVD_WORKER_POOL_H__
+#define __INCLUDED_WWIVD_WORKER_POOL_H__
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace wwiv {
+namespace wwivd {
+
+struct worker_pool_stats_t {
+  int num_workers{0};
+  int busy_workers{0};
+  int64_t queue_depth{0};
+  int64_t max_queue_depth{0};
+  int64_t completed{0};
+  int64_t rejected{0};
+};
+
+/**
+ * Fixed size pool of worker threads fed from a bounded queue.
+ *
+ * Submit never blocks; once the queue is full new work is rejected so the
+ * caller can turn the connection away instead of piling up threads.
+ */
+class WorkerPool {
+public:
+  typedef std::function<void()> work_fn;
+
+  WorkerPool(int num_workers, size_t max_queue_depth);
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  /**
+   * Stops the pool.  Queued work is discarded and workers still running
+   * a long lived session are detached, like the threads wwivd used to
+   * create per connection.
+   */
+  ~WorkerPool();
+
+  /** Queues fn to run on a worker.  Returns false if the queue is full. */
+  bool Submit(work_fn fn);
+  worker_pool_stats_t stats() const;
+
+private:
+  struct state_t;
+  static void Worker(std::shared_ptr<state_t> state);
+  std::shared_ptr<state_t> state_;
+};
+
+/**
+ * Caps how many connections of one type may be queued or running at once,
+ * so that one type can't take the workers that another needs.  Connections
+ * over the limit are turned away rather than queued.
+ */
+class ConnectionLimit {
+public:
+  explicit ConnectionLimit(int max_connections);
+
+  /** Returns false if the limit has been reached. */
+  bool TryAcquire();
+  void Release();
+  int in_use() const;
+  int max_connections() const noexcept { return max_connections_; }
+
+private:
+  const int max_connections_;
+  mutable std::mutex mu_;
+  int in_use_{0};
+};
+
+/**
+ * Counts accepted and rejected connections, and how many were accepted
+ * over the last minute.
+ */
+class AcceptMetrics {
+public:
+  AcceptMetrics() = default;
+
+  void Accepted();
+  void Blocked();
+  void Busy();
+
+  int64_t accepted() const;
+  int64_t blocked() const;
+  int64_t busy() const;
+  /** Number of connections accepted during the last 60 seconds. */
+  int64_t accepted_last_minute() const;
+
+private:
+  void Tick(time_t now);
+
+  mutable std::mutex mu_;
+  int64_t accepted_{0};
+  int64_t blocked_{0};
+  int64_t busy_{0};
+  std::array<int64_t, 60> buckets_{};
+  std::array<time_t, 60> bucket_time_{};
+};
+
+} // namespace wwivd
+} // namespace wwiv
+
+#endif // __INCLUDED_WWIVD_WORKER_POOL_H__
@@ -62,6 +62,7 @@
 #include "core/inifile.h"
 #include "core/jsonfile.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/net.h"
 #include "core/os.h"
 #include "core/scope_exit.h"
@@ -72,12 +73,15 @@
 #include "core/version.h"
 #include "core/wwivport.h"
 #include "sdk/config.h"
+#include "sdk/config_snapshot.h"
 #include "wwivd/connection_data.h"
+#include "wwivd/dns_cache.h"
 #include "wwivd/nets.h"
 #include "wwivd/node_manager.h"
 #include "wwivd/wwivd.h"
 #include "wwivd/wwivd_http.h"
 #include "wwivd/wwivd_non_http.h"
+#include "wwivd/worker_pool.h"
 
 using std::cerr;
 using std::clog;
@@ -172,18 +176,89 @@ int Main(CommandLine& cmdline) {
     }
     data.auto_blocker_ = std::make_shared<AutoBlocker>(data.bad_ips_, c.blocking);
   }
+  if (c.blocking.use_dns_cc && !c.blocking.dns_cc_server.empty()) {
+    data.dns_cache_ = std::make_shared<DnsCache>(c.blocking.dns_cc_server, dns_cache_options_t{});
+  }
 
+  // Each connection type may only have as many connections queued or running
+  // as it has nodes, plus a couple to tell callers there is no node free, so
+  // that the workers are never all taken by one type.  HTTP has its own pool.
+  static constexpr int kExtraConnections = 2;
+  int bbs_nodes = 0;
+  for (const auto& n : nodes) {
+    if (n.first != "BINKP") {
+      bbs_nodes += n.second->total_nodes();
+    }
+  }
+  auto bbs_limit = std::make_shared<ConnectionLimit>(bbs_nodes + kExtraConnections);
+  auto binkp_limit = std::make_shared<ConnectionLimit>(nodes.at("BINKP")->total_nodes() +
+                                                       kExtraConnections);
+  auto http_limit = std::make_shared<ConnectionLimit>(8);
+  const auto num_workers = bbs_limit->max_connections() + binkp_limit->max_connections();
+  data.worker_pool_ = std::make_shared<WorkerPool>(num_workers, num_workers);
+  data.http_pool_ = std::make_shared<WorkerPool>(4, http_limit->max_connections());
+  data.accept_metrics_ = std::make_shared<AcceptMetrics>();
+
+  // Looked up once since the accepting thread updates these on every connection.
+  auto accepted_counter = [](const std::string& type) -> Counter& {
+    return global_metrics().counter("wwivd_accepted_total", "Connections accepted.",
+                                    {{"type", type}});
+  };
+  auto& telnet_accepted = accepted_counter("telnet");
+  auto& ssh_accepted = accepted_counter("ssh");
+  auto& binkp_accepted = accepted_counter("binkp");
+  auto& http_accepted = accepted_counter("http");
+  auto& busy_total =
+      global_metrics().counter("wwivd_busy_total", "Connections sent BUSY since no worker was free.");
+
+  // Tells the caller why we are hanging up.  The socket was just accepted so
+  // this fits in its send buffer without blocking.
+  static const std::string busy_text = "BUSY\r\n";
+  static const std::string busy_http =
+      "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  auto send_busy = [](SOCKET sock, const std::string& text) {
+    send(sock, text.data(), static_cast<int>(text.size()), 0);
+  };
+
+  // These run on the accepting thread, so must never block.
+  auto dispatch = [&](accepted_socket_t r, bool filter, Counter& accepted,
+                      std::shared_ptr<ConnectionLimit> limit, WorkerPool& pool,
+                      const std::string& busy, WorkerPool::work_fn fn) {
+    data.accept_metrics_->Accepted();
+    accepted.Increment();
+    if (filter && !AllowPeerBeforeDispatch(data, r.client_socket)) {
+      data.accept_metrics_->Blocked();
+      send_busy(r.client_socket, busy);
+      closesocket(r.client_socket);
+      return;
+    }
+    if (limit->TryAcquire()) {
+      if (pool.Submit([limit, fn] {
+            ScopeExit release([&] { limit->Release(); });
+            fn();
+          })) {
+        return;
+      }
+      limit->Release();
+    }
+    LOG(INFO) << "Sending BUSY. Too many connections on port: " << r.port;
+    data.accept_metrics_->Busy();
+    busy_total.Increment();
+    send_busy(r.client_socket, busy);
+    closesocket(r.client_socket);
+  };
   auto telnet_or_ssh_fn = [&](accepted_socket_t r) {
-    std::thread client(HandleConnection, std::make_unique<ConnectionHandler>(data, r));
-    client.detach();
+    auto& accepted = r.port == c.ssh_port ? ssh_accepted : telnet_accepted;
+    dispatch(r, true, accepted, bbs_limit, *data.worker_pool_, busy_text,
+             [data, r] { ConnectionHandler(data, r).HandleConnection(); });
   };
   auto binkp_fn = [&](accepted_socket_t r) {
-    std::thread client(HandleBinkPConnection, std::make_unique<ConnectionHandler>(data, r));
-    client.detach();
+    dispatch(r, true, binkp_accepted, binkp_limit, *data.worker_pool_, busy_text,
+             [data, r] { ConnectionHandler(data, r).HandleBinkPConnection(); });
   };
   auto http_fn = [&](accepted_socket_t r) {
-    std::thread client(HandleHttpConnection, data, r);
-    client.detach();
+    dispatch(r, false, http_accepted, http_limit, *data.http_pool_, busy_http,
+             [data, r] { HandleHttpConnection(data, r); });
   };
 
   SocketSet sockets;
@@ -203,11 +278,16 @@ int Main(CommandLine& cmdline) {
   }
 
   SwitchToNonRootUser(wwiv_user);
+  // After dropping root, so the snapshot isn't owned by root and nothing is
+  // parsed with root privileges.
+  if (!ConfigSnapshot(config.datadir()).IsCurrent() && !ConfigSnapshot::Compile(config)) {
+    LOG(ERROR) << "Unable to create config snapshot, nodes will read the configuration files.";
+  }
   need_to_exit.store(false);
   need_to_reload_config.store(false);
 
   // Do network callouts if enabled.
-  do_wwivd_callouts(config, c);
+  data.callout_scheduler_ = do_wwivd_callouts(config, c);
 
   if (!sockets.Run(need_to_exit)) {
     LOG(INFO) << "Error accepting client socket. " << errno;
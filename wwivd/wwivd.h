@@ -19,6 +19,7 @@
 #ifndef __INCLUDED_WWIV_WWIV_WWIVD_H__
 #define __INCLUDED_WWIV_WWIV_WWIVD_H__
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include "core/net.h"
@@ -36,8 +37,11 @@ void SwitchToNonRootUser(const std::string& wwiv_user);
  * If sock is > -1 then we'll close the socket after executing the command 
  * since this is the child socket.
  * pid and node_number is just used for logging.
+ * If timeout is non-zero, the command is killed once it has run that long
+ * and false is returned.
  */
-bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node_number, SOCKET sock);
+bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node_number, SOCKET sock,
+                        std::chrono::seconds timeout = std::chrono::seconds::zero());
 
 
 #endif  // __INCLUDED_WWIV_WWIV_WWIVD_H__
@@ -16,6 +16,7 @@
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include "core/inifile.h"
 #include "core/jsonfile.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/net.h"
 #include "core/os.h"
 #include "core/scope_exit.h"
@@ -42,7 +44,9 @@
 #include "core/wwivport.h"
 #include "sdk/config.h"
 #include "core/datetime.h"
+#include "wwivd/callout_scheduler.h"
 #include "wwivd/connection_data.h"
+#include "wwivd/dns_cache.h"
 #include "wwivd/node_manager.h"
 
 namespace wwiv {
@@ -55,14 +59,83 @@ using namespace wwiv::stl;
 using namespace wwiv::strings;
 using namespace wwiv::os;
 
+struct dns_cache_status_t {
+  int64_t hits;
+  int64_t misses;
+  int64_t timeouts;
+  int64_t entries;
+  int hit_rate;
+
+  template <class Archive> void serialize(Archive& ar) {
+    ar(cereal::make_nvp("hits", hits), cereal::make_nvp("misses", misses),
+      cereal::make_nvp("timeouts", timeouts), cereal::make_nvp("entries", entries),
+      cereal::make_nvp("hit_rate", hit_rate));
+  }
+};
+
+struct connections_status_t {
+  int64_t accepted;
+  int64_t accepted_last_minute;
+  int64_t blocked;
+  int64_t busy;
+  int64_t queue_depth;
+  int64_t max_queue_depth;
+  int busy_workers;
+  int num_workers;
+  int http_busy_workers;
+  int http_num_workers;
+
+  template <class Archive> void serialize(Archive& ar) {
+    ar(cereal::make_nvp("accepted", accepted),
+      cereal::make_nvp("accepted_last_minute", accepted_last_minute),
+      cereal::make_nvp("blocked", blocked), cereal::make_nvp("busy", busy),
+      cereal::make_nvp("queue_depth", queue_depth),
+      cereal::make_nvp("max_queue_depth", max_queue_depth),
+      cereal::make_nvp("busy_workers", busy_workers), cereal::make_nvp("num_workers", num_workers),
+      cereal::make_nvp("http_busy_workers", http_busy_workers),
+      cereal::make_nvp("http_num_workers", http_num_workers));
+  }
+};
+
+struct callout_peer_status_json_t {
+  string network;
+  string address;
+  int64_t due_in;
+  bool running;
+
+  template <class Archive> void serialize(Archive& ar) {
+    ar(cereal::make_nvp("network", network), cereal::make_nvp("address", address),
+      cereal::make_nvp("due_in", due_in), cereal::make_nvp("running", running));
+  }
+};
+
+struct callouts_status_t {
+  int max_concurrent;
+  int running;
+  int64_t started;
+  int64_t failed;
+  std::vector<callout_peer_status_json_t> peers;
+
+  template <class Archive> void serialize(Archive& ar) {
+    ar(cereal::make_nvp("max_concurrent", max_concurrent), cereal::make_nvp("running", running),
+      cereal::make_nvp("started", started), cereal::make_nvp("failed", failed),
+      cereal::make_nvp("peers", peers));
+  }
+};
+
 struct status_reponse_t {
   int num_instances;
   int used_instances;
   std::vector<string> lines;
+  dns_cache_status_t dns_cache;
+  connections_status_t connections;
+  callouts_status_t callouts;
 
   template <class Archive> void serialize(Archive& ar) {
     ar(cereal::make_nvp("num_instances", num_instances),
-      cereal::make_nvp("used_instances", used_instances), cereal::make_nvp("lines", lines));
+      cereal::make_nvp("used_instances", used_instances), cereal::make_nvp("lines", lines),
+      cereal::make_nvp("dns_cache", dns_cache), cereal::make_nvp("connections", connections),
+      cereal::make_nvp("callouts", callouts));
   }
 };
 
@@ -80,15 +153,15 @@ string ToJson(status_reponse_t r) {
 
 class StatusHandler : public HttpHandler {
 public:
-  StatusHandler(std::map<const std::string, std::shared_ptr<NodeManager>>* nodes) : nodes_(nodes) {}
+  StatusHandler(const ConnectionData& data) : data_(data) {}
 
   HttpResponse Handle(HttpMethod, const std::string&, std::vector<std::string> headers) override {
     // We only handle status
     HttpResponse response(200);
-    response.headers.emplace("Content-Type: ", "text/json");
+    response.headers.emplace("Content-Type", "text/json");
 
     status_reponse_t r{};
-    for (const auto& n : *nodes_) {
+    for (const auto& n : *data_.nodes) {
       const auto v = n.second->status_lines();
       r.num_instances += n.second->total_nodes();
       r.used_instances += n.second->nodes_used();
@@ -96,12 +169,88 @@ public:
         r.lines.push_back(l);
       }
     }
+    if (data_.dns_cache_) {
+      const auto s = data_.dns_cache_->stats();
+      r.dns_cache.hits = s.hits;
+      r.dns_cache.misses = s.misses;
+      r.dns_cache.timeouts = s.timeouts;
+      r.dns_cache.entries = s.entries;
+      r.dns_cache.hit_rate = data_.dns_cache_->hit_rate();
+    }
+    if (data_.accept_metrics_) {
+      const auto& m = *data_.accept_metrics_;
+      r.connections.accepted = m.accepted();
+      r.connections.accepted_last_minute = m.accepted_last_minute();
+      r.connections.blocked = m.blocked();
+      r.connections.busy = m.busy();
+    }
+    if (data_.worker_pool_) {
+      const auto s = data_.worker_pool_->stats();
+      r.connections.queue_depth = s.queue_depth;
+      r.connections.max_queue_depth = s.max_queue_depth;
+      r.connections.busy_workers = s.busy_workers;
+      r.connections.num_workers = s.num_workers;
+    }
+    if (data_.http_pool_) {
+      const auto s = data_.http_pool_->stats();
+      r.connections.http_busy_workers = s.busy_workers;
+      r.connections.http_num_workers = s.num_workers;
+    }
+    if (data_.callout_scheduler_) {
+      const auto s = data_.callout_scheduler_->stats();
+      const auto now = time(nullptr);
+      r.callouts.max_concurrent = s.max_concurrent;
+      r.callouts.running = s.running;
+      r.callouts.started = s.started;
+      r.callouts.failed = s.failed;
+      for (const auto& p : s.peers) {
+        r.callouts.peers.push_back(
+            {p.network_name, p.address, std::max<int64_t>(0, p.due - now), p.running});
+      }
+    }
     response.text = ToJson(r);
     return response;
   }
 
 private:
-  std::map<const string, std::shared_ptr<NodeManager>>* nodes_;
+  const ConnectionData& data_;
+};
+
+class MetricsHandler : public HttpHandler {
+public:
+  MetricsHandler(const ConnectionData& data) : data_(data) {}
+
+  HttpResponse Handle(HttpMethod, const std::string&, std::vector<std::string>) override {
+    HttpResponse response(200);
+    response.headers.emplace("Content-Type", "text/plain; version=0.0.4");
+
+    // Values that are kept elsewhere are copied into gauges when scraped.
+    auto& m = global_metrics();
+    if (data_.worker_pool_) {
+      const auto s = data_.worker_pool_->stats();
+      m.gauge("wwivd_worker_queue_depth", "Connections waiting for a worker.").Set(s.queue_depth);
+      m.gauge("wwivd_workers_busy", "Workers handling a connection.").Set(s.busy_workers);
+    }
+    if (data_.http_pool_) {
+      const auto s = data_.http_pool_->stats();
+      m.gauge("wwivd_http_workers_busy", "Workers handling an HTTP connection.")
+          .Set(s.busy_workers);
+    }
+    if (data_.dns_cache_) {
+      const auto s = data_.dns_cache_->stats();
+      // Hits and misses are counted by the cache as wwivd_dns_cache_*_total.
+      m.gauge("wwivd_dns_cache_entries", "Entries in the DNS country code cache.").Set(s.entries);
+    }
+    if (data_.callout_scheduler_) {
+      const auto s = data_.callout_scheduler_->stats();
+      m.gauge("wwivd_callouts_running", "Network callouts running now.").Set(s.running);
+    }
+    response.text = m.Exposition();
+    return response;
+  }
+
+private:
+  const ConnectionData& data_;
 };
 
 void HandleHttpConnection(ConnectionData data, accepted_socket_t r) {
@@ -111,15 +260,24 @@ void HandleHttpConnection(ConnectionData data, accepted_socket_t r) {
   try {
     string remote_peer;
     if (GetRemotePeerAddress(sock, remote_peer)) {
-      auto cc = get_dns_cc(remote_peer, b.dns_cc_server);
+      auto cc = data.dns_cache_ ? data.dns_cache_->Lookup(remote_peer)
+                                : get_dns_cc(remote_peer, b.dns_cc_server);
       LOG(INFO) << "Accepted HTTP connection on port: " << r.port << "; from: " << remote_peer
         << "; coutry code: " << cc;
     }
 
     // HTTP Request
-    HttpServer h(std::make_unique<SocketConnection>(r.client_socket));
-    StatusHandler status(data.nodes);
+    http_server_options_t options{};
+    if (data.http_pool_) {
+      // Don't hold a worker for an idle connection while others wait for one.
+      auto pool = data.http_pool_;
+      options.close_idle = [pool] { return pool->stats().queue_depth > 0; };
+    }
+    HttpServer h(std::make_unique<SocketConnection>(r.client_socket), options);
+    StatusHandler status(data);
     h.add(HttpMethod::GET, "/status", &status);
+    MetricsHandler metrics(data);
+    h.add(HttpMethod::GET, "/metrics", &metrics);
     h.Run();
 
   }
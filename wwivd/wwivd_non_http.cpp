@@ -36,6 +36,7 @@
 #include "core/inifile.h"
 #include "core/jsonfile.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/net.h"
 #include "core/os.h"
 #include "core/scope_exit.h"
@@ -46,6 +47,7 @@
 #include "core/version.h"
 #include "core/wwivport.h"
 #include "sdk/config.h"
+#include "sdk/config_snapshot.h"
 #include "sdk/ansi/makeansi.h"
 #include "core/datetime.h"
 #include "wwivd/connection_data.h"
@@ -137,6 +139,21 @@ static bool launch_cmd(const std::string& raw_cmd, std::shared_ptr<NodeManager>
   return result;
 }
 
+// Rebuilds the config snapshot if the configuration changed since it was
+// written, so the node starting next can use it.
+static void ensure_config_snapshot(const Config& config) {
+  static std::mutex mu;
+  std::lock_guard<std::mutex> lock(mu);
+  ConfigSnapshot snapshot(config.datadir());
+  if (snapshot.IsCurrent()) {
+    return;
+  }
+  VLOG(1) << "Rebuilding config snapshot: " << snapshot.path();
+  if (!ConfigSnapshot::Compile(config)) {
+    LOG(ERROR) << "Unable to rebuild config snapshot: " << snapshot.path();
+  }
+}
+
 static bool launch_node(const Config& config, const std::string& raw_cmd,
                         std::shared_ptr<NodeManager> nodes, int node_number, int sock,
                         ConnectionType connection_type, const string remote_peer) {
@@ -153,6 +170,7 @@ static bool launch_node(const Config& config, const std::string& raw_cmd,
 
   try {
     auto semaphore_file = SemaphoreFile::try_acquire(sem_path, sem_text, std::chrono::seconds(60));
+    ensure_config_snapshot(config);
     return launch_cmd(raw_cmd, nodes, node_number, sock, connection_type, remote_peer);
   } catch (const semaphore_not_acquired& e) {
     LOG(ERROR) << pid << "Unable to create semaphore file: " << sem_path << "; errno: " << errno
@@ -175,12 +193,21 @@ static ConnectionType connection_type_for(const wwivd_config_t& c, int port) {
   return ConnectionType::TELNET;
 }
 
-static bool check_ansi(SocketConnection& conn) {
-  auto d = 3s;
+bool check_ansi(SocketConnection& conn, duration<double> d) {
   conn.send("Checking for ANSI Graphics... ", d);
   conn.send("\x1b[6n", d);
-  auto res = conn.receive_upto(10, d);
-  if (!res.empty() && res.front() == 27) {
+  // The reply (ESC [ row ; col R) may arrive in more than one read, so keep
+  // reading until the R or until the time is up.
+  const auto deadline = steady_clock::now() + d;
+  string res;
+  while (res.find('R') == string::npos && conn.is_open() && res.size() < 32) {
+    const auto left = deadline - steady_clock::now();
+    if (left <= 0s) {
+      break;
+    }
+    res += conn.receive_upto(32 - static_cast<int>(res.size()), left);
+  }
+  if (res.find('\x1b') != string::npos) {
     conn.send_line("ANSI detected.", d);
     return true;
   }
@@ -262,53 +289,91 @@ wwivd_matrix_entry_t ConnectionHandler::DoMatrixLogon(const Config& config,
   return {};
 }
 
-// Can throw
-ConnectionHandler::BlockedConnectionResult ConnectionHandler::CheckForBlockedConnection() {
-  auto sock = r.client_socket;
+static Counter& blocked_counter(const std::string& reason) {
+  return global_metrics().counter("wwivd_blocked_total", "Connections denied by blocking rules.",
+                                  {{"reason", reason}});
+}
+
+static Counter& binkp_sessions_counter(const std::string& result) {
+  return global_metrics().counter("wwivd_binkp_sessions_total", "Incoming BinkP connections.",
+                                  {{"result", result}});
+}
+
+bool AllowPeerBeforeDispatch(const ConnectionData& data, SOCKET sock) {
   string remote_peer;
   const auto& b = data.c->blocking;
 
   // We fail open when we can't get the remote peer
   if (!GetRemotePeerAddress(sock, remote_peer)) {
     LOG(ERROR) << "Allowing connections we can't determine the remote peer.";
-    return BlockedConnectionResult(BlockedConnectionAction::ALLOW, remote_peer);
+    return true;
   }
 
   // Check for always allowed addresses
   if (b.use_goodip_txt && data.good_ips_) {
     if (data.good_ips_->IsAlwaysAllowed(remote_peer)) {
-      LOG(INFO) << "Allowing connection for goodip.txt always-allowed peer: " << remote_peer;
-      return BlockedConnectionResult(BlockedConnectionAction::ALLOW, remote_peer);
+      return true;
     }
   }
 
   // Check for always blocked addresses
   if (b.use_badip_txt && data.bad_ips_) {
     if (data.bad_ips_->IsBlocked(remote_peer)) {
-      // We have a connection from a blocked country
       LOG(INFO) << "Denying connection attempt from badip.txt blocked peer: " << remote_peer;
-      return BlockedConnectionResult(BlockedConnectionAction::DENY, remote_peer);
+      static auto& badip = blocked_counter("badip");
+      badip.Increment();
+      return false;
     }
   }
 
+  // Not a blocked address. See if it's a new connection, and if so, should
+  // we block it now.
+  if (b.auto_blacklist && data.auto_blocker_) {
+    if (!data.auto_blocker_->Connection(remote_peer)) {
+      // We have a newly blocked address.
+      LOG(INFO) << "Denying connection attempt from AutoBlocker: " << remote_peer;
+      static auto& autoblocker = blocked_counter("autoblocker");
+      autoblocker.Increment();
+      return false;
+    }
+  }
+  return true;
+}
+
+// Can throw
+ConnectionHandler::BlockedConnectionResult ConnectionHandler::CheckForBlockedConnection() {
+  auto sock = r.client_socket;
+  string remote_peer;
+  const auto& b = data.c->blocking;
+
+  // We fail open when we can't get the remote peer
+  if (!GetRemotePeerAddress(sock, remote_peer)) {
+    LOG(ERROR) << "Allowing connections we can't determine the remote peer.";
+    return BlockedConnectionResult(BlockedConnectionAction::ALLOW, remote_peer);
+  }
+
+  // Check for always allowed addresses
+  if (b.use_goodip_txt && data.good_ips_) {
+    if (data.good_ips_->IsAlwaysAllowed(remote_peer)) {
+      LOG(INFO) << "Allowing connection for goodip.txt always-allowed peer: " << remote_peer;
+      return BlockedConnectionResult(BlockedConnectionAction::ALLOW, remote_peer);
+    }
+  }
+
+  // badip.txt and the AutoBlocker were already checked by
+  // AllowPeerBeforeDispatch on the accepting thread.
+
   // Check for country blocking if we have a DNS cc server defined.
   if (b.use_dns_cc && !b.dns_cc_server.empty()) {
-    auto cc = get_dns_cc(remote_peer, b.dns_cc_server);
+    auto cc = data.dns_cache_ ? data.dns_cache_->Lookup(remote_peer)
+                              : get_dns_cc(remote_peer, b.dns_cc_server);
     LOG(INFO) << "Accepted connection on port: " << r.port << "; from: " << remote_peer
               << "; coutry code: " << cc;
     if (contains(data.c->blocking.block_cc_countries, cc)) {
       // We have a connection from a blocked country
       LOG(INFO) << "Denying connection attempt from country " << cc << " for peer: " << remote_peer;
-      return BlockedConnectionResult(BlockedConnectionAction::DENY, remote_peer);
-    }
-  }
-
-  // Not blocked address nor blocked country. See if it's a new
-  // connection, and if so, should we block it now.
-  if (b.auto_blacklist && data.auto_blocker_) {
-    if (!data.auto_blocker_->Connection(remote_peer)) {
-      // We have a newly blocked address.
-      LOG(INFO) << "Denying connection attempt from AutoBlocker: " << remote_peer;
+      static auto& country = blocked_counter("country");
+      country.Increment();
       return BlockedConnectionResult(BlockedConnectionAction::DENY, remote_peer);
     }
   }
@@ -324,6 +389,7 @@ void ConnectionHandler::HandleBinkPConnection() {
     auto result = CheckForBlockedConnection();
     if (result.action == BlockedConnectionAction::DENY) {
       LOG(INFO) << "Sending BUSY. blocked.";
+      binkp_sessions_counter("blocked").Increment();
       SocketConnection conn(r.client_socket);
       conn.send_line("BUSY\r\n", 10s);
       closesocket(sock);
@@ -331,6 +397,7 @@ void ConnectionHandler::HandleBinkPConnection() {
     }
     if (!data.concurrent_connections_->aquire(result.remote_peer)) {
       LOG(INFO) << "Binkp Connection blocked by concurent connection limit.";
+      binkp_sessions_counter("busy").Increment();
       SocketConnection conn(r.client_socket);
       conn.send_line("BUSY\r\n", 10s);
       closesocket(sock);
@@ -345,7 +412,11 @@ void ConnectionHandler::HandleBinkPConnection() {
         closesocket(sock);
         VLOG(2) << "closed socket: " << sock;
       });
-      launch_cmd(data.c->binkp_cmd, nodemgr, 0, sock, ConnectionType::BINKP, result.remote_peer);
+      const auto ok =
+          launch_cmd(data.c->binkp_cmd, nodemgr, 0, sock, ConnectionType::BINKP, result.remote_peer);
+      binkp_sessions_counter(ok ? "ok" : "failed").Increment();
+    } else {
+      binkp_sessions_counter("busy").Increment();
     }
 
   } catch (const std::exception& e) {
@@ -363,7 +434,7 @@ ConnectionHandler::MailerModeResult ConnectionHandler::DoMailerMode() {
 
   auto end = system_clock::now() + 10s;
   int num_escapes = 0;
-  while (system_clock::now() < end && num_escapes < 2) {
+  while (conn.is_open() && system_clock::now() < end && num_escapes < 2) {
     conn.send(".", 1s);
     auto received = conn.receive_upto(1, 1s);
     if (!received.empty() && received.front() == 27) {
@@ -452,9 +523,5 @@ void ConnectionHandler::HandleConnection() {
   }
 }
 
-void HandleConnection(std::unique_ptr<ConnectionHandler> h) { h->HandleConnection(); }
-
-void HandleBinkPConnection(std::unique_ptr<ConnectionHandler> h) { h->HandleBinkPConnection(); }
-
 } // namespace wwivd
 } // namespace wwiv
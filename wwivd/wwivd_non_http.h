@@ -18,11 +18,13 @@
 #ifndef __INCLUDED_WWIVD_WWIVD_NON_HTTP_H__
 #define __INCLUDED_WWIVD_WWIVD_NON_HTTP_H__
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <unordered_set>
 #include <vector>
 
+#include "core/net.h"
 #include "core/socket_connection.h"
 #include "sdk/wwivd_config.h"
 
@@ -37,6 +39,21 @@ std::string to_string(const std::vector<wwiv::sdk::wwivd_matrix_entry_t>& elemen
 const std::string node_file(const wwiv::sdk::Config& config, ConnectionType ct, int node_number);
 std::string CreateCommandLine(const std::string& tmpl, std::map<char, std::string> params);
 
+/**
+ * Applies the goodip.txt, badip.txt and AutoBlocker checks to a newly
+ * accepted socket.  This runs on the accepting thread before the connection
+ * is handed to a worker, so that blocked peers never consume one.  Returns
+ * false if the connection should be dropped.
+ */
+bool AllowPeerBeforeDispatch(const ConnectionData& data, SOCKET sock);
+
+/**
+ * Asks the terminal on conn where its cursor is, returning true if it
+ * answers like an ANSI terminal within d.
+ */
+bool check_ansi(wwiv::core::SocketConnection& conn,
+                std::chrono::duration<double> d = std::chrono::seconds(3));
+
 class ConnectionHandler {
 public:
   enum class BlockedConnectionAction { ALLOW, DENY };
@@ -64,9 +81,6 @@ private:
   wwiv::core::accepted_socket_t r;
 };
 
-void HandleConnection(std::unique_ptr<ConnectionHandler> h);
-void HandleBinkPConnection(std::unique_ptr<ConnectionHandler> h);
-
 } // namespace wwivd
 } // namespace wwiv
 
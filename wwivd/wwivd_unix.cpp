@@ -19,9 +19,12 @@
 #include "wwivd/wwivd.h"
 
 #include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <string>
+#include <thread>
 
 #include <pwd.h>
 #include <signal.h>
@@ -155,7 +158,31 @@ void SwitchToNonRootUser(const std::string& wwiv_user) {
   }
 }
 
-bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node_number, SOCKET sock) {
+static pid_t wait_for_child(pid_t child_pid, int* status, int options) {
+  for (;;) {
+    const auto ret = waitpid(child_pid, status, options);
+    if (ret != -1 || errno != EINTR) {
+      return ret;
+    }
+  }
+}
+
+// Waits for the child to exit for up to timeout, returns false if it didn't.
+static bool wait_for_child(pid_t child_pid, int* status, std::chrono::seconds timeout) {
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  while (std::chrono::steady_clock::now() < end) {
+    const auto ret = wait_for_child(child_pid, status, WNOHANG);
+    if (ret != 0) {
+      // Either it exited or there's nothing left to wait for.
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  }
+  return false;
+}
+
+bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node_number, SOCKET sock,
+                        std::chrono::seconds timeout) {
   char sh[21];
   char dc[21];
   char cmdstr[4000];
@@ -179,11 +206,18 @@ bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node
   }
   bbs_pid = child_pid;
   int status = 0;
+  bool timed_out = false;
   VLOG(2) << pid << "before waitpid";
-  while (waitpid(child_pid, &status, 0) == -1) {
-    if (errno != EINTR) {
-      break;
+  if (timeout.count() > 0 && !wait_for_child(child_pid, &status, timeout)) {
+    LOG(ERROR) << pid << "Timed out after " << timeout.count() << "s; terminating: " << cmd;
+    timed_out = true;
+    kill(child_pid, SIGTERM);
+    if (!wait_for_child(child_pid, &status, std::chrono::seconds(10))) {
+      kill(child_pid, SIGKILL);
+      wait_for_child(child_pid, &status, 0);
     }
+  } else if (timeout.count() <= 0) {
+    wait_for_child(child_pid, &status, 0);
   }
   VLOG(2) << pid << "after waitpid";
 
@@ -206,6 +240,6 @@ bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node
     LOG(INFO) << err << " stopped by signal: " << WSTOPSIG(status);
   }
 
-  return true;
+  return !timed_out;
 }
 
@@ -81,7 +81,8 @@ void BeforeStartServer() {
 void SwitchToNonRootUser(const std::string& wwiv_user) {
 }
 
-bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node_number, SOCKET sock) {
+bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node_number, SOCKET sock,
+                        std::chrono::seconds timeout) {
 
   LOG(INFO) << pid << "Invoking Command Line (Win32):" << cmd;
 
@@ -117,7 +118,14 @@ bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node
   }
 
   // Wait until child process exits.
-  DWORD dwExitCode = WaitForSingleObject(pi.hProcess, INFINITE);
+  const DWORD wait_ms = timeout.count() > 0 ? static_cast<DWORD>(timeout.count() * 1000) : INFINITE;
+  DWORD dwExitCode = WaitForSingleObject(pi.hProcess, wait_ms);
+  const bool timed_out = (dwExitCode == WAIT_TIMEOUT);
+  if (timed_out) {
+    LOG(ERROR) << pid << "Timed out after " << timeout.count() << "s; terminating: " << cmd;
+    TerminateProcess(pi.hProcess, 1);
+    WaitForSingleObject(pi.hProcess, INFINITE);
+  }
   GetExitCodeProcess(pi.hProcess, &dwExitCode);
 
   // Close process and thread handles. 
@@ -128,6 +136,6 @@ bool ExecCommandAndWait(const std::string& cmd, const std::string& pid, int node
   } else {
     LOG(INFO) << "Command: '" << cmd << "' exited with error code: " << dwExitCode;
   }
-  return true;
+  return !timed_out;
 }
 
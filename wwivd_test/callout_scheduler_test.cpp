@@ -0,0 +1,230 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "wwivd/callout_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace wwiv::wwivd;
+
+namespace {
+
+// Callouts that block until released, recording who was called.
+class FakeCallouts {
+public:
+  bool Exec(const callout_peer_t& p, std::chrono::seconds) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      called_.push_back(p.address);
+    }
+    while (!release_.load()) {
+      std::this_thread::sleep_for(1ms);
+    }
+    return p.address != "fail";
+  }
+
+  std::vector<std::string> called() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return called_;
+  }
+  void release() { release_.store(true); }
+
+private:
+  std::mutex mu_;
+  std::vector<std::string> called_;
+  std::atomic<bool> release_{false};
+};
+
+callout_peer_t peer(const std::string& address, time_t due, int network_number = 0) {
+  callout_peer_t p{};
+  p.network_number = network_number;
+  p.network_name = "wwivnet";
+  p.address = address;
+  p.due = due;
+  return p;
+}
+
+void wait_for_running(const CalloutScheduler& s, int n) {
+  while (s.stats().running != n) {
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+} // namespace
+
+TEST(CalloutSchedulerTest, NextCalloutTime) {
+  callout_scheduler_options_t o{};
+  o.min_interval = 15s;
+  o.max_idle = 300s;
+  const time_t now = 100000;
+  EXPECT_EQ(now, next_callout_time(true, now - 10, 60, now, o));
+  // Not calling every x minutes, so wait until the next check.
+  EXPECT_EQ(now + 300, next_callout_time(false, now - 10, 0, now, o));
+  // Called 1 minute ago, every 2 minutes.
+  EXPECT_EQ(now + 60, next_callout_time(false, now - 60, 2, now, o));
+  // Already past due but should not call now (i.e. not allowed right now).
+  EXPECT_EQ(now + 15, next_callout_time(false, now - 3600, 2, now, o));
+  // Never more than max_idle.
+  EXPECT_EQ(now + 300, next_callout_time(false, now, 60, now, o));
+}
+
+TEST(CalloutSchedulerTest, RunsDueInParallel) {
+  FakeCallouts f;
+  const time_t now = 1000;
+  callout_scheduler_options_t o{};
+  o.max_concurrent = 2;
+  const std::vector<callout_peer_t> peers{peer("1", now, 1), peer("2", now - 5, 2),
+                                          peer("3", now, 3), peer("4", now + 60, 4)};
+  CalloutScheduler s(o, [&](time_t) { return peers; },
+                     [&](const callout_peer_t& p, std::chrono::seconds t) { return f.Exec(p, t); });
+  s.Reload(now);
+  EXPECT_FALSE(s.needs_reload(now));
+  EXPECT_EQ(2, s.RunDue(now));
+  wait_for_running(s, 2);
+  // Nothing more fits until one finishes.
+  EXPECT_EQ(0, s.RunDue(now));
+  // Longest waiting first.
+  while (f.called().size() < 2) {
+    std::this_thread::sleep_for(1ms);
+  }
+  const auto first = f.called();
+  EXPECT_EQ(std::set<std::string>({"1", "2"}), std::set<std::string>(first.begin(), first.end()));
+
+  f.release();
+  wait_for_running(s, 0);
+  EXPECT_TRUE(s.needs_reload(now));
+  EXPECT_EQ(1, s.RunDue(now));
+  wait_for_running(s, 0);
+  const auto called = f.called();
+  EXPECT_EQ(3u, called.size());
+  EXPECT_EQ(std::set<std::string>({"1", "2", "3"}),
+            std::set<std::string>(called.begin(), called.end()));
+  EXPECT_EQ(3, s.stats().started);
+  EXPECT_EQ(0, s.stats().failed);
+}
+
+TEST(CalloutSchedulerTest, NeverRunsSamePeerTwice) {
+  FakeCallouts f;
+  const time_t now = 1000;
+  CalloutScheduler s(callout_scheduler_options_t{},
+                     [&](time_t) { return std::vector<callout_peer_t>{peer("1", now)}; },
+                     [&](const callout_peer_t& p, std::chrono::seconds t) { return f.Exec(p, t); });
+  s.Reload(now);
+  EXPECT_EQ(1, s.RunDue(now));
+  s.Reload(now);
+  EXPECT_EQ(0, s.RunDue(now + 100));
+  f.release();
+  wait_for_running(s, 0);
+}
+
+TEST(CalloutSchedulerTest, OnePerNetwork) {
+  FakeCallouts f;
+  const time_t now = 1000;
+  const std::vector<callout_peer_t> peers{peer("1", now - 10, 0), peer("2", now - 5, 0),
+                                          peer("3", now, 1)};
+  CalloutScheduler s(callout_scheduler_options_t{}, [&](time_t) { return peers; },
+                     [&](const callout_peer_t& p, std::chrono::seconds t) { return f.Exec(p, t); });
+  s.Reload(now);
+  // The second peer on network 0 waits, its slot goes to network 1.
+  EXPECT_EQ(2, s.RunDue(now));
+  wait_for_running(s, 2);
+  EXPECT_EQ(0, s.RunDue(now));
+  while (f.called().size() < 2) {
+    std::this_thread::sleep_for(1ms);
+  }
+  const auto first = f.called();
+  EXPECT_EQ(std::set<std::string>({"1", "3"}), std::set<std::string>(first.begin(), first.end()));
+  f.release();
+  wait_for_running(s, 0);
+  EXPECT_EQ(1, s.RunDue(now));
+  wait_for_running(s, 0);
+}
+
+TEST(CalloutSchedulerTest, CompletedDuringReload) {
+  FakeCallouts f;
+  const time_t now = 1000;
+  std::atomic<bool> finished{false};
+  CalloutScheduler* sp = nullptr;
+  CalloutScheduler s(callout_scheduler_options_t{},
+                     [&](time_t) {
+                       if (sp != nullptr && !finished.load()) {
+                         // The callout finishes while the peers are being read.
+                         f.release();
+                         wait_for_running(*sp, 0);
+                         finished.store(true);
+                       }
+                       return std::vector<callout_peer_t>{peer("1", now)};
+                     },
+                     [&](const callout_peer_t& p, std::chrono::seconds t) { return f.Exec(p, t); });
+  s.Reload(now);
+  EXPECT_EQ(1, s.RunDue(now));
+  sp = &s;
+  s.Reload(now);
+  EXPECT_TRUE(finished.load());
+  EXPECT_TRUE(s.needs_reload(now));
+}
+
+TEST(CalloutSchedulerTest, MinInterval_AfterFailure) {
+  FakeCallouts f;
+  f.release();
+  const time_t now = 1000;
+  callout_scheduler_options_t o{};
+  o.min_interval = 15s;
+  CalloutScheduler s(o, [&](time_t) { return std::vector<callout_peer_t>{peer("fail", now)}; },
+                     [&](const callout_peer_t& p, std::chrono::seconds t) { return f.Exec(p, t); });
+  s.Reload(now);
+  EXPECT_EQ(1, s.RunDue(now));
+  s.WaitForChange(10s);
+  wait_for_running(s, 0);
+  EXPECT_EQ(1, s.stats().failed);
+  EXPECT_TRUE(s.needs_reload(now));
+
+  // Still due according to the contact records, but it just failed.
+  s.Reload(now + 1);
+  EXPECT_EQ(0, s.RunDue(now + 1));
+  EXPECT_EQ(now + 15, s.next_due(now + 1));
+  EXPECT_EQ(1, s.RunDue(now + 15));
+  wait_for_running(s, 0);
+}
+
+TEST(CalloutSchedulerTest, NextDue) {
+  const time_t now = 1000;
+  callout_scheduler_options_t o{};
+  o.max_idle = 300s;
+  std::vector<callout_peer_t> peers;
+  CalloutScheduler s(o, [&](time_t) { return peers; },
+                     [](const callout_peer_t&, std::chrono::seconds) { return true; });
+  s.Reload(now);
+  EXPECT_EQ(now + 300, s.next_due(now));
+
+  peers.push_back(peer("1", now + 60));
+  s.Reload(now);
+  EXPECT_EQ(now + 60, s.next_due(now));
+  EXPECT_FALSE(s.needs_reload(now + 59));
+  // Reload to see if it should really be called now.
+  EXPECT_TRUE(s.needs_reload(now + 60));
+}
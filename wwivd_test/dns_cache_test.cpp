@@ -0,0 +1,127 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "wwivd/dns_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using std::string;
+using namespace std::chrono_literals;
+using namespace wwiv::wwivd;
+
+class DnsCacheTest : public ::testing::Test {
+protected:
+  DnsCacheTest() {
+    options_.num_workers = 1;
+    options_.timeout = 5s;
+  }
+
+  DnsCache::lookup_fn fn() {
+    return [this](const string& address, const string&) {
+      ++calls_;
+      return (address == "10.0.0.1") ? 840 : 0;
+    };
+  }
+
+  dns_cache_options_t options_;
+  std::atomic<int> calls_{0};
+};
+
+TEST_F(DnsCacheTest, Hit) {
+  DnsCache cache("zz.countries.nerd.dk", options_, fn());
+  EXPECT_EQ(840, cache.Lookup("10.0.0.1"));
+  EXPECT_EQ(840, cache.Lookup("10.0.0.1"));
+  EXPECT_EQ(1, calls_.load());
+
+  const auto s = cache.stats();
+  EXPECT_EQ(1, s.hits);
+  EXPECT_EQ(1, s.misses);
+  EXPECT_EQ(1, s.entries);
+  EXPECT_EQ(50, cache.hit_rate());
+}
+
+TEST_F(DnsCacheTest, Counters) {
+  auto& m = wwiv::core::global_metrics();
+  auto& hits = m.counter("wwivd_dns_cache_hits_total", "");
+  auto& misses = m.counter("wwivd_dns_cache_misses_total", "");
+  const auto hits_before = hits.value();
+  const auto misses_before = misses.value();
+
+  DnsCache cache("zz.countries.nerd.dk", options_, fn());
+  cache.Lookup("10.0.0.1");
+  cache.Lookup("10.0.0.1");
+  cache.Lookup("10.0.0.1");
+  EXPECT_EQ(hits_before + 2, hits.value());
+  EXPECT_EQ(misses_before + 1, misses.value());
+  EXPECT_NE(std::string::npos, m.Exposition().find("# TYPE wwivd_dns_cache_hits_total counter"));
+}
+
+TEST_F(DnsCacheTest, NegativeCaching) {
+  options_.negative_ttl = 0s;
+  DnsCache cache("zz.countries.nerd.dk", options_, fn());
+  EXPECT_EQ(840, cache.Lookup("10.0.0.1"));
+  EXPECT_EQ(0, cache.Lookup("10.0.0.2"));
+  // Negative result has expired, positive one has not.
+  EXPECT_EQ(0, cache.Lookup("10.0.0.2"));
+  EXPECT_EQ(840, cache.Lookup("10.0.0.1"));
+  EXPECT_EQ(3, calls_.load());
+}
+
+TEST_F(DnsCacheTest, LruEviction) {
+  options_.max_entries = 2;
+  DnsCache cache("zz.countries.nerd.dk", options_, fn());
+  cache.Lookup("10.0.0.1");
+  cache.Lookup("10.0.0.2");
+  cache.Lookup("10.0.0.1");
+  // Evicts 10.0.0.2, the least recently used.
+  cache.Lookup("10.0.0.3");
+  EXPECT_EQ(3, calls_.load());
+  EXPECT_EQ(2, cache.stats().entries);
+
+  cache.Lookup("10.0.0.1");
+  EXPECT_EQ(3, calls_.load());
+  cache.Lookup("10.0.0.2");
+  EXPECT_EQ(4, calls_.load());
+}
+
+TEST_F(DnsCacheTest, Timeout) {
+  options_.timeout = 10ms;
+  std::atomic<bool> release{false};
+  DnsCache cache("zz.countries.nerd.dk", options_, [&](const string&, const string&) {
+    while (!release.load()) {
+      std::this_thread::sleep_for(1ms);
+    }
+    return 840;
+  });
+  // Fails open while the resolver is still busy.
+  EXPECT_EQ(0, cache.Lookup("10.0.0.1"));
+  EXPECT_EQ(1, cache.stats().timeouts);
+
+  release.store(true);
+  while (cache.stats().pending > 0) {
+    std::this_thread::sleep_for(1ms);
+  }
+  // The late answer was still cached.
+  EXPECT_EQ(840, cache.Lookup("10.0.0.1"));
+  EXPECT_EQ(1, cache.stats().hits);
+}
@@ -0,0 +1,98 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "wwivd/worker_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+using namespace wwiv::wwivd;
+
+static void wait_for_completed(const WorkerPool& pool, int64_t n) {
+  while (pool.stats().completed < n) {
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+TEST(WorkerPoolTest, RunsWork) {
+  WorkerPool pool(2, 10);
+  std::atomic<int> count{0};
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(pool.Submit([&] { ++count; }));
+  }
+  wait_for_completed(pool, 5);
+  EXPECT_EQ(5, count.load());
+  EXPECT_EQ(0, pool.stats().queue_depth);
+  EXPECT_EQ(2, pool.stats().num_workers);
+}
+
+TEST(WorkerPoolTest, RejectsWhenQueueIsFull) {
+  WorkerPool pool(1, 1);
+  std::atomic<bool> release{false};
+  std::atomic<bool> started{false};
+  auto blocker = [&] {
+    started.store(true);
+    while (!release.load()) {
+      std::this_thread::sleep_for(1ms);
+    }
+  };
+  ASSERT_TRUE(pool.Submit(blocker));
+  while (!started.load()) {
+    std::this_thread::sleep_for(1ms);
+  }
+  // Worker is busy, one slot in the queue.
+  EXPECT_TRUE(pool.Submit([] {}));
+  EXPECT_FALSE(pool.Submit([] {}));
+
+  auto s = pool.stats();
+  EXPECT_EQ(1, s.busy_workers);
+  EXPECT_EQ(1, s.queue_depth);
+  EXPECT_EQ(1, s.rejected);
+
+  release.store(true);
+  wait_for_completed(pool, 2);
+  EXPECT_EQ(0, pool.stats().busy_workers);
+}
+
+TEST(ConnectionLimitTest, Smoke) {
+  ConnectionLimit l(2);
+  EXPECT_TRUE(l.TryAcquire());
+  EXPECT_TRUE(l.TryAcquire());
+  EXPECT_FALSE(l.TryAcquire());
+  EXPECT_EQ(2, l.in_use());
+  l.Release();
+  EXPECT_TRUE(l.TryAcquire());
+  EXPECT_EQ(2, l.max_connections());
+}
+
+TEST(AcceptMetricsTest, Smoke) {
+  AcceptMetrics m;
+  m.Accepted();
+  m.Accepted();
+  m.Accepted();
+  m.Blocked();
+  m.Busy();
+  EXPECT_EQ(3, m.accepted());
+  EXPECT_EQ(3, m.accepted_last_minute());
+  EXPECT_EQ(1, m.blocked());
+  EXPECT_EQ(1, m.busy());
+}
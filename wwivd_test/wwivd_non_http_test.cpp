@@ -28,9 +28,15 @@
 
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <chrono>
 
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 using std::string;
 using std::vector;
 using namespace std::chrono_literals;
@@ -96,4 +102,120 @@ TEST(AutoBlock, ShouldNotBlock) {
   wwiv::os::sleep_for(2s);
   blocker.Connection("1.1.1.1");
   EXPECT_FALSE(bip->IsBlocked("1.1.1.1"));
-}
\ No newline at end of file
+}
+
+TEST(BadIps, Cidr) {
+  FileHelper helper;
+  auto fn = helper.CreateTempFile("badip.txt",
+                                  "# comment\r\n10.0.0.0/8 # ten\r\n2001:db8::/32\r\n192.168.1.1\r\n");
+  BadIp ip(fn);
+  EXPECT_TRUE(ip.IsBlocked("10.1.2.3"));
+  EXPECT_TRUE(ip.IsBlocked("10.255.255.255"));
+  EXPECT_FALSE(ip.IsBlocked("11.0.0.1"));
+  EXPECT_TRUE(ip.IsBlocked("2001:db8::1"));
+  EXPECT_FALSE(ip.IsBlocked("2001:db9::1"));
+  EXPECT_TRUE(ip.IsBlocked("192.168.1.1"));
+  EXPECT_FALSE(ip.IsBlocked("192.168.1.2"));
+  // IPv4 mapped IPv6 addresses match IPv4 entries.
+  EXPECT_TRUE(ip.IsBlocked("::ffff:10.0.0.1"));
+  EXPECT_FALSE(ip.IsBlocked("not an ip"));
+}
+
+TEST(BadIps, Block_Batched) {
+  FileHelper helper;
+  auto fn = helper.CreateTempFile("badip.txt", "");
+  {
+    BadIp ip(fn);
+    ip.Block("1.1.1.1");
+    ip.Block("2.2.2.2");
+    // The second block was held back since the first was just written.
+    EXPECT_TRUE(ip.IsBlocked("2.2.2.2"));
+    TextFile tf(fn, "rt");
+    auto contents = tf.ReadFileIntoString();
+    EXPECT_TRUE(contents.find("1.1.1.1") != contents.npos);
+    EXPECT_TRUE(contents.find("2.2.2.2") == contents.npos);
+  }
+  TextFile tf(fn, "rt");
+  auto contents = tf.ReadFileIntoString();
+  EXPECT_TRUE(contents.find("2.2.2.2") != contents.npos);
+}
+
+TEST(IpTrie, Prefixes) {
+  IpTrie t;
+  ip_address_t a{};
+  int bits = 0;
+  ASSERT_TRUE(ParseCidr("172.16.0.0/12", a, bits));
+  EXPECT_EQ(108, bits);
+  t.Insert(a, bits);
+  ASSERT_TRUE(ParseIpAddress("172.31.255.1", a));
+  EXPECT_TRUE(t.Contains(a));
+  ASSERT_TRUE(ParseIpAddress("172.32.0.1", a));
+  EXPECT_FALSE(t.Contains(a));
+  EXPECT_EQ(1u, t.size());
+
+  EXPECT_FALSE(ParseCidr("10.0.0.0/33", a, bits));
+  EXPECT_FALSE(ParseCidr("10.0.0.0/x", a, bits));
+  EXPECT_FALSE(ParseCidr("10.0.0.0/8\xe9", a, bits));
+  EXPECT_FALSE(ParseCidr("10.0.0", a, bits));
+}
+
+TEST(SlidingWindowCounter, Counts) {
+  SlidingWindowCounter c(10, 10);
+  ip_address_t a{};
+  ParseIpAddress("1.1.1.1", a);
+  EXPECT_EQ(1, c.Add(a, 100));
+  EXPECT_EQ(2, c.Add(a, 105));
+  // Half way into the next window, half of the previous one counts.
+  EXPECT_EQ(2, c.Add(a, 115));
+  // Long enough later, nothing before counts.
+  EXPECT_EQ(1, c.Add(a, 200));
+}
+
+TEST(SlidingWindowCounter, EvictsLeastRecentlySeen) {
+  SlidingWindowCounter c(2, 60);
+  ip_address_t a{}, b{}, d{};
+  ParseIpAddress("1.1.1.1", a);
+  ParseIpAddress("2.2.2.2", b);
+  ParseIpAddress("3.3.3.3", d);
+  c.Add(a, 100);
+  c.Add(b, 100);
+  c.Add(a, 101);
+  // b is evicted, not a.
+  c.Add(d, 102);
+  EXPECT_EQ(2u, c.size());
+  EXPECT_EQ(3, c.Add(a, 103));
+  EXPECT_EQ(1, c.Add(b, 103));
+}
+
+#ifndef _WIN32
+
+TEST(CheckAnsi, ReplyInPieces) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  std::thread terminal([&] {
+    char buf[64];
+    // "Checking for ANSI Graphics... " and the cursor position request.
+    ASSERT_GT(read(fds[1], buf, sizeof(buf)), 0);
+    ASSERT_EQ(2, write(fds[1], "\x1b[", 2));
+    wwiv::os::sleep_for(200ms);
+    ASSERT_EQ(6, write(fds[1], "24;80R", 6));
+    wwiv::os::sleep_for(200ms);
+    ASSERT_EQ(1, write(fds[1], "1", 1));
+  });
+  SocketConnection conn(fds[0]);
+  EXPECT_TRUE(check_ansi(conn, 2s));
+  // None of the reply is left over to be read as the user's input.
+  EXPECT_EQ("1", conn.receive_upto(10, 2s));
+  terminal.join();
+  close(fds[1]);
+}
+
+TEST(CheckAnsi, NoReply) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  SocketConnection conn(fds[0]);
+  EXPECT_FALSE(check_ansi(conn, 200ms));
+  close(fds[1]);
+}
+
+#endif  // _WIN32
@@ -22,6 +22,7 @@
 #include "core/file.h"
 #include "core/strings.h"
 #include "sdk/config.h"
+#include "sdk/config_snapshot.h"
 #include "sdk/filenames.h"
 #include "sdk/net.h"
 #include "sdk/networks.h"
@@ -126,8 +127,40 @@ public:
   }
 };
 
+class ConfigCompileCommand : public UtilCommand {
+public:
+  ConfigCompileCommand()
+      : UtilCommand("compile", "Creates the config snapshot used for fast node startup.") {}
+  std::string GetUsage() const override final {
+    std::ostringstream ss;
+    ss << "Usage: " << std::endl << std::endl;
+    ss << "  compile : Writes " << CONFIG_SNP << " from the current configuration." << std::endl
+       << std::endl;
+    return ss.str();
+  }
+  int Execute() override final {
+    const auto& config = *this->config()->config();
+    ConfigSnapshot snapshot(config.datadir());
+    if (snapshot.IsCurrent() && !barg("force")) {
+      cout << snapshot.path() << " is already current." << endl;
+      return 0;
+    }
+    if (!ConfigSnapshot::Compile(config)) {
+      cout << "Unable to write " << snapshot.path() << endl;
+      return 1;
+    }
+    cout << "Wrote " << snapshot.path() << endl;
+    return 0;
+  }
+  bool AddSubCommands() override final {
+    add_argument(BooleanCommandLineArgument("force", 'f', "Write even when current.", false));
+    return true;
+  }
+};
+
 bool ConfigCommand::AddSubCommands() {
   add(make_unique<ConfigVersionCommand>());
+  add(make_unique<ConfigCompileCommand>());
   return true;
 }
 
@@ -29,6 +29,7 @@
 #include "core/version.h"
 #include "core/datetime.h"
 #include "sdk/filenames.h"
+#include "sdk/status.h"
 #include "sdk/user.h"
 #include "sdk/usermanager.h"
 
@@ -75,17 +76,8 @@ static bool checkFileSize(File &file, unsigned long len) {
   return true;
 }
 
-static void saveStatus(const std::string& datadir) {
-  File statusDat(FilePath(datadir, STATUS_DAT));
-
-  statusDat.Open(File::modeReadWrite | File::modeBinary);
-  statusDat.Write(&st, sizeof(statusrec_t));
-  statusDat.Close();
-}
-
 static bool initStatusDat(const std::string& datadir) {
   int nFileMode = File::modeReadOnly | File::modeBinary;
-  bool update = false;
   File statusDat(FilePath(datadir, STATUS_DAT));
   if (!statusDat.Exists()) {
     LOG(INFO) << statusDat.full_pathname() << " NOT FOUND!";
@@ -99,64 +91,61 @@ static bool initStatusDat(const std::string& datadir) {
     to_char_array(st.gfiledate, "00/00/00");
     st.callernum = 65535;
     st.wwiv_version = wwiv_num_version;
-    update = true;
-  } else {
-    checkFileSize(statusDat, sizeof(statusrec_t));
-    LOG(INFO) << "Reading " << statusDat.full_pathname() << "...";
-    if (!statusDat.Open(nFileMode)) {
-      LOG(INFO) << statusDat.full_pathname() << " NOT FOUND.";
-      return false;
-    }
-    statusDat.Read(&st, sizeof(statusrec_t));
+    statusDat.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile);
+    statusDat.Write(&st, sizeof(statusrec_t));
     statusDat.Close();
+    return true;
+  }
+  checkFileSize(statusDat, sizeof(statusrec_t));
+  LOG(INFO) << "Reading " << statusDat.full_pathname() << "...";
+  if (!statusDat.Open(nFileMode)) {
+    LOG(INFO) << statusDat.full_pathname() << " NOT FOUND.";
+    return false;
+  }
+  statusDat.Read(&st, sizeof(statusrec_t));
+  statusDat.Close();
 
-    // version check
-    if (st.wwiv_version > wwiv_num_version) {
-      LOG(INFO) << "Incorrect version of fix (this is for "
-           << wwiv_num_version << ", you need " << st.wwiv_version << ")";
-    }
+  // version check
+  if (st.wwiv_version > wwiv_num_version) {
+    LOG(INFO) << "Incorrect version of fix (this is for "
+         << wwiv_num_version << ", you need " << st.wwiv_version << ")";
+  }
 
+  // The BBS may be running, so the fixes go through StatusMgr.
+  StatusMgr sm(datadir, [](int) {});
+  return sm.Run([](WStatus& s) {
     auto dt = DateTime::now();
     time_t val = dt.to_time_t();
-    auto cur_date = dateFromTimeT(val);
-    if (!iequals(st.date1, cur_date)) {
-      to_char_array(st.date1, cur_date);
-      update = true;
+    std::string cur_date = dateFromTimeT(val);
+    if (!iequals(s.GetLastDate(0), cur_date)) {
+      s.SetLastDate(0, cur_date);
       LOG(INFO) << "Date error in STATUS.DAT (st.date1) corrected";
     }
 
     val -= 86400L;
     cur_date = dateFromTimeT(val);
-    if (strcmp(st.date2, cur_date)) {
-      strcpy(st.date2, cur_date);
-      update = true;
+    if (s.GetLastDate(1) != cur_date) {
+      s.SetLastDate(1, cur_date);
       LOG(INFO) << "Date error in STATUS.DAT (st.date2) corrected";
     }
     auto log_file = StrCat(dateFromTimeTForLog(val), ".log");
-    if (!iequals(log_file, st.log1)) {
-      to_char_array(st.log1, log_file);
-      update = true;
+    if (!iequals(log_file, s.GetLogFileName(1))) {
+      s.SetLogFileName(1, log_file);
       LOG(INFO) << "Log filename error in STATUS.DAT (st.log1) corrected";
     }
 
     val -= 86400L;
     cur_date = dateFromTimeT(val);
-    if (!iequals(st.date3, cur_date)) {
-      strcpy(st.date3, cur_date);
-      update = true;
+    if (!iequals(s.GetLastDate(2), cur_date)) {
+      s.SetLastDate(2, cur_date);
       LOG(INFO) << "Date error in STATUS.DAT (st.date3) corrected";
     }
     log_file = StrCat(dateFromTimeTForLog(val), ".log");
-    if (!iequals(log_file, st.log2)) {
-      to_char_array(st.log2, log_file);
-      update = true;
+    if (!iequals(log_file, s.GetLogFileName(2))) {
+      s.SetLogFileName(2, log_file);
       LOG(INFO) << "Log filename error in STATUS.DAT (st.log2) corrected";
     }
-  }
-  if (update) {
-    saveStatus(datadir);
-  }
-  return true;
+  });
 }
 
 
@@ -29,6 +29,7 @@
 #include "sdk/names.h"
 #include "sdk/net.h"
 #include "sdk/networks.h"
+#include "wwivutil/messages/qwk.h"
 #include "wwivutil/util.h"
 #include <cstdio>
 #include <ctime>
@@ -434,6 +435,9 @@ bool MessagesCommand::AddSubCommands() {
   if (!add(make_unique<MessageAreasCommand>())) {
     return false;
   }
+  if (!add(make_unique<MessagesQwkCommand>())) {
+    return false;
+  }
   
   return true;
 }
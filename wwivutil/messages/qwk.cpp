@@ -0,0 +1,177 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "wwivutil/messages/qwk.h"
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/command_line.h"
+#include "core/datetime.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+#include "core/zip.h"
+#include "sdk/config.h"
+#include "sdk/qwk/qwk_packet.h"
+#include "sdk/qwk/qwk_prefetch.h"
+#include "sdk/subxtr.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using namespace std::chrono;
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::qwk;
+using namespace wwiv::strings;
+
+namespace wwiv {
+namespace wwivutil {
+
+std::string MessagesQwkCommand::GetUsage() const {
+  std::ostringstream ss;
+  ss << "Usage:   qwk [--since=N] [--max_msgs=N] <packet.qwk> [sub filenames...]" << endl;
+  ss << "Example: qwk --max_msgs=5000 /tmp/wwiv.qwk" << endl;
+  return ss.str();
+}
+
+bool MessagesQwkCommand::AddSubCommands() {
+  add_argument({"since", "Only include messages with a qscan pointer greater than this.", "0"});
+  add_argument({"max_msgs", "Maximum number of messages in the packet, 0 for no limit.", "0"});
+  add_argument({"max_per_sub", "Maximum number of messages per sub, 0 for no limit.", "0"});
+  add_argument({"lookahead", "Number of subs to read ahead of the packet builder.", "4"});
+  return true;
+}
+
+int MessagesQwkCommand::Execute() {
+  if (remaining().empty()) {
+    std::clog << "Missing QWK packet filename." << endl;
+    cout << GetUsage() << GetHelp() << endl;
+    return 2;
+  }
+  const auto start_time = steady_clock::now();
+  const auto& cfg = *config()->config();
+  Subs subs(cfg.datadir(), config()->networks().networks());
+  if (!subs.Load()) {
+    LOG(ERROR) << "Unable to load subs.";
+    return 1;
+  }
+
+  const string packet_name = remaining().front();
+  std::set<string> only(remaining().begin() + 1, remaining().end());
+  const auto since = static_cast<uint32_t>(iarg("since"));
+  const auto max_msgs = iarg("max_msgs");
+
+  vector<qwk_prefetch_request_t> requests;
+  vector<int> conferences;
+  for (size_t i = 0; i < subs.subs().size(); i++) {
+    const auto& sub = subs.sub(i);
+    if (!only.empty() && only.find(sub.filename) == only.end()) {
+      continue;
+    }
+    requests.push_back({sub.filename, since, iarg("max_per_sub")});
+    conferences.push_back(static_cast<int>(i) + 1);
+  }
+
+  ZipWriter zip(packet_name);
+  if (!zip) {
+    LOG(ERROR) << "Unable to create: " << packet_name;
+    return 1;
+  }
+  string messages_dat;
+  QwkMessagesWriter writer([&messages_dat](const char* data, size_t size) {
+    messages_dat.append(data, size);
+    return true;
+  });
+
+  // Plain text, without heart codes or routing lines.
+  qwk_text_options_t options;
+  options.remove_color = true;
+
+  QwkSubPrefetcher prefetcher(cfg.datadir(), cfg.msgsdir(), requests, iarg("lookahead"));
+  int num_messages = 0;
+  for (size_t i = 0; i < requests.size(); i++) {
+    auto sub = prefetcher.Next();
+    if (!sub) {
+      break;
+    }
+    const auto ndx_name = StringPrintf("%03d.NDX", conferences[i]);
+    for (const auto& m : sub->messages) {
+      if (max_msgs > 0 && num_messages >= max_msgs) {
+        break;
+      }
+      if (m.header.status & (status_unvalidated | status_delete)) {
+        continue;
+      }
+      qwk_message_info_t info;
+      info.msgnum = m.msgnum;
+      info.daten = m.header.daten;
+      info.ownersys = m.header.ownersys;
+      info.to = "ALL";
+      info.subject = m.header.title;
+      info.conf_num = static_cast<uint16_t>(conferences[i]);
+      qwk_record rec{};
+      string text;
+      if (!ToQwkMessage(m.text, info, options, rec, text)) {
+        continue;
+      }
+      writer.Append(rec, text, {ndx_name});
+      ++num_messages;
+    }
+  }
+  prefetcher.Cancel();
+  writer.Flush();
+
+  const auto now = time(nullptr);
+  std::ostringstream control;
+  control << "wwiv.qwk\r\n\r\n" << cfg.system_phone() << "\r\n" << cfg.sysop_name() << "\r\n"
+          << "00000," << cfg.system_name() << "\r\n"
+          << DateTime::now().to_string("%m-%d-%Y,%H:%M:%S") << "\r\n"
+          << cfg.sysop_name() << "\r\n\r\n0\r\n" << num_messages << "\r\n"
+          << requests.size() << "\r\n0\r\nE-Mail\r\n";
+  for (size_t i = 0; i < requests.size(); i++) {
+    control << conferences[i] << "\r\n" << stripcolors(subs.sub(conferences[i] - 1).name) << "\r\n";
+  }
+
+  bool ok = writer.ok() && zip.Add("MESSAGES.DAT", messages_dat, now) &&
+            zip.Add("CONTROL.DAT", control.str(), now);
+  for (const auto& ndx : writer.indexes()) {
+    ok = ok && zip.Add(ndx.first, ndx.second, now);
+  }
+  if (!zip.Close() || !ok) {
+    LOG(ERROR) << "Error writing: " << packet_name;
+    return 1;
+  }
+
+  const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start_time);
+  cout << "Subs:          " << requests.size() << endl;
+  cout << "Messages:      " << num_messages << endl;
+  cout << "MESSAGES.DAT:  " << writer.bytes_written() << " bytes" << endl;
+  cout << "Packet:        " << File(packet_name).length() << " bytes" << endl;
+  cout << "Elapsed:       " << elapsed.count() << " ms" << endl;
+  return 0;
+}
+
+}  // namespace wwivutil
+}  // namespace wwiv
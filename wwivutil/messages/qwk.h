@@ -0,0 +1,44 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*                Copyright (C)2018, WWIV Software Services               */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#ifndef __INCLUDED_WWIVUTIL_MESSAGES_QWK_H__
+#define __INCLUDED_WWIVUTIL_MESSAGES_QWK_H__
+
+#include <string>
+
+#include "wwivutil/command.h"
+
+namespace wwiv {
+namespace wwivutil {
+
+/**
+ * Builds a QWK packet from the message bases without a user online.  This
+ * is mostly useful for benchmarking the QWK packet builder.
+ */
+class MessagesQwkCommand final : public UtilCommand {
+public:
+  MessagesQwkCommand() : UtilCommand("qwk", "Builds a QWK packet offline.") {}
+  std::string GetUsage() const override final;
+  int Execute() override final;
+  bool AddSubCommands() override final;
+};
+
+}  // namespace wwivutil
+}  // namespace wwiv
+
+#endif  // __INCLUDED_WWIVUTIL_MESSAGES_QWK_H__